@@ -185,6 +185,37 @@ enum DW_LINE_EXTENDED_OPS
   DW_LNE_HP_define_proc              = 0x20
 };
 
+// Unit header types (DWARF 5).
+
+enum DW_UT
+{
+  DW_UT_compile = 0x01,
+  DW_UT_type = 0x02,
+  DW_UT_partial = 0x03,
+  DW_UT_skeleton = 0x04,
+  DW_UT_split_compile = 0x05,
+  DW_UT_split_type = 0x06,
+  DW_UT_lo_user = 0x80,
+  DW_UT_hi_user = 0xff
+};
+
+// Location list entry kinds (DWARF 5).
+
+enum DW_LLE
+{
+  DW_LLE_end_of_list = 0x00,
+  DW_LLE_base_addressx = 0x01,
+  DW_LLE_startx_endx = 0x02,
+  DW_LLE_startx_length = 0x03,
+  DW_LLE_offset_pair = 0x04,
+  DW_LLE_default_location = 0x05,
+  DW_LLE_base_address = 0x06,
+  DW_LLE_start_end = 0x07,
+  DW_LLE_start_length = 0x08,
+  // GNU extension.
+  DW_LLE_GNU_view_pair = 0x09
+};
+
 enum DW_CHILDREN
 {
   DW_CHILDREN_no		     =0x00,
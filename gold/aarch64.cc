@@ -1863,7 +1863,7 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
   // Count local symbols and (optionally) record mapping info.
   virtual void
   do_count_local_symbols(Stringpool_template<char>*,
-			 Stringpool_template<char>*);
+			 Stringpool_template<char>*, unsigned int);
 
  private:
   // Fix all errata in the object, and for each erratum, relocate corresponding
@@ -1897,9 +1897,11 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
 template<int size, bool big_endian>
 void
 AArch64_relobj<size, big_endian>::do_count_local_symbols(
-    Stringpool_template<char>* pool, Stringpool_template<char>* dynpool)
+    Stringpool_template<char>* pool, Stringpool_template<char>* dynpool,
+    unsigned int order)
 {
-  Sized_relobj_file<size, big_endian>::do_count_local_symbols(pool, dynpool);
+  Sized_relobj_file<size, big_endian>::do_count_local_symbols(pool, dynpool,
+							      order);
 
   // Only erratum-fixing work needs mapping symbols, so skip this time consuming
   // processing if not fixing erratum.
@@ -26,8 +26,13 @@
 #include <cstring>
 #include <climits>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
 #include "libiberty.h"
 #include "filenames.h"
+#include "binary-io.h"
 
 #include "elfcpp.h"
 #include "options.h"
@@ -178,6 +183,8 @@ struct Archive::Archive_header
 unsigned int Archive::total_archives;
 unsigned int Archive::total_members;
 unsigned int Archive::total_members_loaded;
+unsigned int Archive::total_cache_hits;
+unsigned int Archive::total_cache_misses;
 
 // Archive methods.
 
@@ -201,7 +208,7 @@ Archive::Archive(const std::string& name, Input_file* input_file,
     armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
     members_(), is_thin_archive_(is_thin_archive), included_member_(false),
     nested_archives_(), dirpath_(dirpath), num_members_(0),
-    included_all_members_(false)
+    included_all_members_(false), from_cache_(false)
 {
   this->no_export_ =
     parameters->options().check_excluded_libs(input_file->found_name());
@@ -217,6 +224,19 @@ Archive::setup()
   if (this->input_file_->file().filesize() == sarmag)
     return;
 
+  std::string real_name;
+  std::string cache_name;
+  if (parameters->options().archive_cache() != NULL)
+    {
+      this->cache_file_name(&real_name, &cache_name);
+      if (this->read_cache(real_name, cache_name))
+	{
+	  this->from_cache_ = true;
+	  this->maybe_preread_symbols();
+	  return;
+	}
+    }
+
   // The first member of the archive should be the symbol table.
   std::string armap_name;
   off_t header_size = this->read_header(sarmag, false, &armap_name, NULL);
@@ -257,6 +277,19 @@ Archive::setup()
       const char* px = reinterpret_cast<const char*>(p);
       this->extended_names_.assign(px, extended_size);
     }
+
+  if (!cache_name.empty() && !this->armap_.empty())
+    this->write_cache(real_name, cache_name);
+
+  this->maybe_preread_symbols();
+}
+
+// Read the symbols of all the members in parallel with other tasks,
+// if requested.
+
+void
+Archive::maybe_preread_symbols()
+{
   bool preread_syms = (parameters->options().threads()
                        && parameters->options().preread_archive_symbols());
 #ifndef ENABLE_THREADS
@@ -587,6 +620,281 @@ Archive::end()
   return Archive::const_iterator(this, this->input_file_->file().filesize());
 }
 
+// The --archive-cache directory holds a file for each archive, with
+// the parsed symbol map, the extended name table and the offsets of
+// the member headers.  The file starts with this header.  All fields
+// are in host byte order, and are 64 bits so that the arrays which
+// follow are aligned.  A cache file is only used if its archive name,
+// size and modification time match those of the archive.  It is
+// small, so it is read in with a single read call.
+//
+// The header is followed by
+//   symbol_count entries of two words each: the offset of the symbol
+//     name in the names, and the file offset of the defining member;
+//   member_count words: the file offset of each member header;
+//   the absolute name of the archive, path_size bytes;
+//   the symbol names, names_size bytes;
+//   the extended name table, extended_names_size bytes.
+
+struct Archive_cache_header
+{
+  // The magic string, "GOLDARC" followed by a version number.
+  char magic[8];
+  // A marker used to check the byte order.
+  uint64_t byte_order;
+  // The size of the archive.
+  uint64_t file_size;
+  // The modification time of the archive.
+  int64_t mtime_seconds;
+  int64_t mtime_nanoseconds;
+  // The sizes of the parts of the file.
+  uint64_t symbol_count;
+  uint64_t member_count;
+  uint64_t path_size;
+  uint64_t names_size;
+  uint64_t extended_names_size;
+  // The number of members, as counted by read_armap.
+  uint64_t num_members;
+};
+
+static const char archive_cache_magic[8] =
+{
+  'G', 'O', 'L', 'D', 'A', 'R', 'C', '1'
+};
+
+static const uint64_t archive_cache_byte_order = 0x0102030405060708ULL;
+
+// Return the name of the cache file for this archive, and the
+// absolute name of the archive which is recorded in it.  The cache
+// file name is the base name of the archive followed by a hash of the
+// absolute name, so that archives with the same base name in
+// different directories do not share a cache file.
+
+void
+Archive::cache_file_name(std::string* real_name,
+			 std::string* cache_name) const
+{
+  // We do not resolve symbolic links, which would cost a system
+  // call for each directory in the name.
+  const std::string& name(this->filename());
+  real_name->clear();
+  if (!IS_ABSOLUTE_PATH(name.c_str()))
+    {
+      std::vector<char> cwd(256);
+      while (::getcwd(&cwd[0], cwd.size()) == NULL && errno == ERANGE)
+	cwd.resize(cwd.size() * 2);
+      cwd.back() = '\0';
+      real_name->assign(&cwd[0]);
+      real_name->append(1, '/');
+    }
+  real_name->append(name);
+
+  char buf[32];
+  size_t hash = string_hash<char>(real_name->data(), real_name->size());
+  snprintf(buf, sizeof buf, "-%016llx.armap",
+	   static_cast<unsigned long long>(hash));
+  cache_name->assign(parameters->options().archive_cache());
+  cache_name->append(1, '/');
+  cache_name->append(lbasename(real_name->c_str()));
+  cache_name->append(buf);
+}
+
+// Read the cache file CACHE_NAME.  Return false if it does not exist,
+// is malformed, or is for a different version of the archive.  In
+// that case the caller reads the archive itself and writes a new
+// cache file.
+
+bool
+Archive::read_cache(const std::string& real_name,
+		    const std::string& cache_name)
+{
+  int o = ::open(cache_name.c_str(), O_RDONLY | O_BINARY);
+  if (o < 0)
+    return false;
+
+  struct stat statbuf;
+  if (::fstat(o, &statbuf) < 0
+      || static_cast<size_t>(statbuf.st_size) < sizeof(Archive_cache_header))
+    {
+      ::close(o);
+      return false;
+    }
+
+  // Read the file into a buffer of 64-bit words, so that the arrays
+  // in it are aligned.
+  size_t cache_size = statbuf.st_size;
+  std::vector<uint64_t> buf((cache_size + 7) / 8);
+  unsigned char* p = reinterpret_cast<unsigned char*>(&buf[0]);
+  size_t got = 0;
+  while (got < cache_size)
+    {
+      ssize_t len = ::read(o, p + got, cache_size - got);
+      if (len <= 0)
+	break;
+      got += len;
+    }
+  ::close(o);
+  if (got < cache_size)
+    return false;
+
+  const Archive_cache_header* hdr =
+    reinterpret_cast<const Archive_cache_header*>(p);
+  Timespec mtime = this->file().get_mtime();
+  bool ok = (memcmp(hdr->magic, archive_cache_magic,
+		    sizeof archive_cache_magic) == 0
+	     && hdr->byte_order == archive_cache_byte_order
+	     && hdr->file_size
+		== static_cast<uint64_t>(this->file().filesize())
+	     && hdr->mtime_seconds == static_cast<int64_t>(mtime.seconds)
+	     && hdr->mtime_nanoseconds
+		== static_cast<int64_t>(mtime.nanoseconds)
+	     && hdr->path_size == real_name.size());
+
+  // Check the sizes before using them, so that a truncated file is
+  // simply ignored.
+  const uint64_t max = cache_size;
+  ok = (ok
+	&& hdr->symbol_count <= max / 16
+	&& hdr->member_count <= max / 8
+	&& hdr->names_size <= max
+	&& hdr->extended_names_size <= max
+	&& (sizeof(Archive_cache_header)
+	    + hdr->symbol_count * 16
+	    + hdr->member_count * 8
+	    + hdr->path_size
+	    + hdr->names_size
+	    + hdr->extended_names_size) == max);
+
+  const uint64_t* pentries =
+    reinterpret_cast<const uint64_t*>(p + sizeof(Archive_cache_header));
+  const uint64_t* pmembers = pentries + (ok ? hdr->symbol_count * 2 : 0);
+  const char* ppath =
+    reinterpret_cast<const char*>(pmembers + (ok ? hdr->member_count : 0));
+  ok = ok && memcmp(ppath, real_name.data(), real_name.size()) == 0;
+
+  if (ok)
+    {
+      const char* pnames = ppath + hdr->path_size;
+      this->armap_names_.assign(pnames, hdr->names_size);
+      this->extended_names_.assign(pnames + hdr->names_size,
+				   hdr->extended_names_size);
+
+      size_t symbol_count = hdr->symbol_count;
+      this->armap_.resize(symbol_count);
+      for (size_t i = 0; i < symbol_count; ++i)
+	{
+	  this->armap_[i].name_offset = pentries[i * 2];
+	  this->armap_[i].file_offset = pentries[i * 2 + 1];
+	  if (pentries[i * 2] >= hdr->names_size)
+	    ok = false;
+	}
+      this->armap_checked_.resize(symbol_count);
+
+      this->member_offsets_.assign(pmembers, pmembers + hdr->member_count);
+      this->num_members_ = hdr->num_members;
+
+      if (!ok)
+	{
+	  this->armap_.clear();
+	  this->armap_names_.clear();
+	  this->extended_names_.clear();
+	  this->armap_checked_.clear();
+	  this->member_offsets_.clear();
+	  this->num_members_ = 0;
+	}
+    }
+
+  return ok;
+}
+
+// Write the cache file CACHE_NAME for this archive.  We write a
+// temporary file and rename it, so that another link reading the
+// cache at the same time sees either the old file or the new one.
+// Failures are ignored; we will simply read the archive again next
+// time.
+
+void
+Archive::write_cache(const std::string& real_name,
+		     const std::string& cache_name)
+{
+  // Find the member headers.  This is the part which is expensive
+  // for a large archive, as it reads every header.
+  std::vector<off_t> member_offsets;
+  for (Archive::const_iterator p = this->begin(); p != this->end(); ++p)
+    member_offsets.push_back(p->off);
+
+  Archive_cache_header hdr;
+  memset(&hdr, 0, sizeof hdr);
+  memcpy(hdr.magic, archive_cache_magic, sizeof archive_cache_magic);
+  hdr.byte_order = archive_cache_byte_order;
+  hdr.file_size = this->file().filesize();
+  Timespec mtime = this->file().get_mtime();
+  hdr.mtime_seconds = mtime.seconds;
+  hdr.mtime_nanoseconds = mtime.nanoseconds;
+  hdr.symbol_count = this->armap_.size();
+  hdr.member_count = member_offsets.size();
+  hdr.path_size = real_name.size();
+  hdr.names_size = this->armap_names_.size();
+  hdr.extended_names_size = this->extended_names_.size();
+  hdr.num_members = this->num_members_;
+
+  std::string contents(reinterpret_cast<const char*>(&hdr), sizeof hdr);
+  std::vector<uint64_t> words;
+  words.reserve(this->armap_.size() * 2 + member_offsets.size());
+  for (std::vector<Armap_entry>::const_iterator p = this->armap_.begin();
+       p != this->armap_.end();
+       ++p)
+    {
+      words.push_back(p->name_offset);
+      words.push_back(p->file_offset);
+    }
+  words.insert(words.end(), member_offsets.begin(), member_offsets.end());
+  if (!words.empty())
+    contents.append(reinterpret_cast<const char*>(&words[0]),
+		    words.size() * sizeof(uint64_t));
+  contents.append(real_name);
+  contents.append(this->armap_names_);
+  contents.append(this->extended_names_);
+
+  std::string tmp_name(cache_name);
+  tmp_name.append(".XXXXXX");
+  std::vector<char> tmp(tmp_name.begin(), tmp_name.end());
+  tmp.push_back('\0');
+  int o = ::mkstemp(&tmp[0]);
+  if (o < 0)
+    return;
+  // mkstemp creates the file readable only by us, but the cache
+  // directory may be shared.
+  ::fchmod(o, 0644);
+
+  const char* p = contents.data();
+  size_t left = contents.size();
+  bool ok = true;
+  while (left > 0)
+    {
+      ssize_t bytes = ::write(o, p, left);
+      if (bytes < 0 && errno == EINTR)
+	continue;
+      if (bytes <= 0)
+	{
+	  ok = false;
+	  break;
+	}
+      p += bytes;
+      left -= bytes;
+    }
+
+  if (::close(o) < 0)
+    ok = false;
+  if (!ok || ::rename(&tmp[0], cache_name.c_str()) < 0)
+    {
+      ::unlink(&tmp[0]);
+      return;
+    }
+
+  this->member_offsets_.swap(member_offsets);
+}
+
 // Get the file and offset for an archive member, which may be an
 // external member of a thin archive.  Set *INPUT_FILE to the
 // file containing the actual member, *MEMOFF to the offset
@@ -736,6 +1044,16 @@ Archive::get_elf_object_for_member(off_t off, bool* punconfigured)
 void
 Archive::read_all_symbols()
 {
+  if (!this->member_offsets_.empty())
+    {
+      for (std::vector<off_t>::const_iterator p =
+	     this->member_offsets_.begin();
+	   p != this->member_offsets_.end();
+	   ++p)
+	this->read_symbols(*p);
+      return;
+    }
+
   for (Archive::const_iterator p = this->begin();
        p != this->end();
        ++p)
@@ -772,6 +1090,13 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 		     Input_objects* input_objects, Mapfile* mapfile)
 {
   ++Archive::total_archives;
+  if (parameters->options().archive_cache() != NULL)
+    {
+      if (this->from_cache_)
+	++Archive::total_cache_hits;
+      else if (!this->armap_.empty())
+	++Archive::total_cache_misses;
+    }
 
   if (this->input_file_->options().whole_archive())
     return this->include_all_members(symtab, layout, input_objects,
@@ -920,6 +1245,19 @@ Archive::include_all_members(Symbol_table* symtab, Layout* layout,
           ++Archive::total_members;
         }
     }
+  else if (!this->member_offsets_.empty())
+    {
+      for (std::vector<off_t>::const_iterator p =
+	     this->member_offsets_.begin();
+	   p != this->member_offsets_.end();
+	   ++p)
+	{
+	  if (!this->include_member(symtab, layout, input_objects, *p,
+				    mapfile, NULL, "--whole-archive"))
+	    return false;
+	  ++Archive::total_members;
+	}
+    }
   else
     {
       for (Archive::const_iterator p = this->begin();
@@ -944,6 +1282,9 @@ Archive::include_all_members(Symbol_table* symtab, Layout* layout,
 size_t
 Archive::count_members()
 {
+  if (!this->member_offsets_.empty())
+    return this->member_offsets_.size();
+
   size_t ret = 0;
   for (Archive::const_iterator p = this->begin();
        p != this->end();
@@ -1087,6 +1428,13 @@ Archive::print_stats()
           program_name, Archive::total_members);
   fprintf(stderr, _("%s: loaded archive members: %u\n"),
           program_name, Archive::total_members_loaded);
+  if (parameters->options().archive_cache() != NULL)
+    {
+      fprintf(stderr, _("%s: archive cache hits: %u\n"),
+	      program_name, Archive::total_cache_hits);
+      fprintf(stderr, _("%s: archive cache misses: %u\n"),
+	      program_name, Archive::total_cache_misses);
+    }
 }
 
 // Add_archive_symbols methods.
@@ -286,6 +286,10 @@ class Archive : public Library_base
   static unsigned int total_members;
   // Number of archive members loaded.
   static unsigned int total_members_loaded;
+  // Number of archives whose symbol map was found in, or missing
+  // from, the --archive-cache directory.
+  static unsigned int total_cache_hits;
+  static unsigned int total_cache_misses;
 
   // Get a view into the underlying file.
   const unsigned char*
@@ -297,6 +301,28 @@ class Archive : public Library_base
   void
   read_armap(off_t start, section_size_type size);
 
+  // Set *CACHE_NAME to the name of the file in the --archive-cache
+  // directory for this archive, and *REAL_NAME to the absolute name
+  // of the archive which is stored in that file.
+  void
+  cache_file_name(std::string* real_name, std::string* cache_name) const;
+
+  // Read the symbol map, the extended name table and the member
+  // offsets from the cache file CACHE_NAME.  Return false if there is
+  // no usable cache file for this version of the archive.
+  bool
+  read_cache(const std::string& real_name, const std::string& cache_name);
+
+  // Write the symbol map, the extended name table and the member
+  // offsets to the cache file CACHE_NAME.
+  void
+  write_cache(const std::string& real_name, const std::string& cache_name);
+
+  // Read the symbols of all the members when using
+  // --preread-archive-symbols.
+  void
+  maybe_preread_symbols();
+
   // Read an archive member header at OFF.  CACHE is whether to cache
   // the file view.  Return the size of the member, and set *PNAME to
   // the name.
@@ -397,6 +423,10 @@ class Archive : public Library_base
   Unordered_set<off_t, Seen_hash> seen_offsets_;
   // Table of objects whose symbols have been pre-read.
   std::map<off_t, Archive_member> members_;
+  // The file offsets of the member headers, when known from
+  // --archive-cache.  Otherwise this is empty, and we find the
+  // members by reading each header.
+  std::vector<off_t> member_offsets_;
   // True if this is a thin archive.
   const bool is_thin_archive_;
   // True if we have included at least one object from this archive.
@@ -411,6 +441,9 @@ class Archive : public Library_base
   bool no_export_;
   // True if this library has been included as a --whole-archive.
   bool included_all_members_;
+  // True if the symbol map was read from the --archive-cache
+  // directory.
+  bool from_cache_;
 };
 
 // This class is used to read an archive and pick out the desired
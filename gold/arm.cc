@@ -1674,7 +1674,7 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
   // Count the local symbols.
   void
   do_count_local_symbols(Stringpool_template<char>*,
-			 Stringpool_template<char>*);
+			 Stringpool_template<char>*, unsigned int);
 
   void
   do_relocate_sections(
@@ -6508,13 +6508,15 @@ template<bool big_endian>
 void
 Arm_relobj<big_endian>::do_count_local_symbols(
     Stringpool_template<char>* pool,
-    Stringpool_template<char>* dynpool)
+    Stringpool_template<char>* dynpool,
+    unsigned int order)
 {
   // We need to fix-up the values of any local symbols whose type are
   // STT_ARM_TFUNC.
 
   // Ask parent to count the local symbols.
-  Sized_relobj_file<32, big_endian>::do_count_local_symbols(pool, dynpool);
+  Sized_relobj_file<32, big_endian>::do_count_local_symbols(pool, dynpool,
+							    order);
   const unsigned int loccount = this->local_symbol_count();
   if (loccount == 0)
     return;
@@ -22,54 +22,106 @@
 
 #include "gold.h"
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
-// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
-// if it successfully compressed, false if it failed for any reason
-// (including not having zlib support in the library).  If it returns
-// true, it allocates memory for the compressed data using new, and
-// sets *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
-// It also writes a header before COMPRESSED_DATA: 4 bytes saying
-// "ZLIB", and 8 bytes indicating the uncompressed size, in big-endian
-// order.
+// The size of each independently compressed chunk of an output
+// section.  This does not depend on the number of threads, so that
+// the output file does not depend on --thread-count.
 
-static bool
-zlib_compress(int header_size,
-              const unsigned char* uncompressed_data,
-              unsigned long uncompressed_size,
-              unsigned char** compressed_data,
-              unsigned long* compressed_size)
-{
-  *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
-  *compressed_data = new unsigned char[*compressed_size + header_size];
+static const section_size_type compress_chunk_size = 1024 * 1024;
 
-  int compress_level;
+// Return the compression level to use.
+
+static int
+compress_level()
+{
   if (parameters->options().optimize() >= 1)
-    compress_level = 9;
+    return 9;
   else
-    compress_level = 1;
-
-  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
-                     compressed_size,
-                     reinterpret_cast<const Bytef*>(uncompressed_data),
-                     uncompressed_size,
-                     compress_level);
-  if (rc == Z_OK)
-    {
-      *compressed_size += header_size;
-      return true;
-    }
+    return 1;
+}
+
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE as one chunk
+// of a zlib stream.  The chunk is raw deflate data, without the zlib
+// header and trailer, which the caller writes.  If IS_LAST is true,
+// this is the last chunk of the stream; otherwise the output is
+// flushed to a byte boundary so that the next chunk may follow it.
+// Since each chunk starts with an empty dictionary, the chunks may be
+// compressed independently.  Returns true if it successfully
+// compressed, in which case it allocates memory for the compressed
+// data using new, and sets *COMPRESSED_DATA and *COMPRESSED_SIZE.
+// With a single chunk this produces the same data as compress2.
+
+static bool
+zlib_compress_chunk(const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    bool is_last,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  z_stream strm;
+  strm.zalloc = NULL;
+  strm.zfree = NULL;
+  strm.opaque = NULL;
+  if (deflateInit2(&strm, compress_level(), Z_DEFLATED, -MAX_WBITS, 8,
+		   Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  // Leave room for the empty stored block written by a sync flush.
+  unsigned long buffer_size = deflateBound(&strm, uncompressed_size) + 16;
+  *compressed_data = new unsigned char[buffer_size];
+
+  strm.next_in = const_cast<Bytef*>(uncompressed_data);
+  strm.avail_in = uncompressed_size;
+  strm.next_out = *compressed_data;
+  strm.avail_out = buffer_size;
+  int rc = deflate(&strm, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool success;
+  if (is_last)
+    success = rc == Z_STREAM_END;
   else
+    success = (rc == Z_OK && strm.avail_in == 0 && strm.avail_out > 0);
+  *compressed_size = buffer_size - strm.avail_out;
+  deflateEnd(&strm);
+
+  if (!success)
     {
       delete[] *compressed_data;
       *compressed_data = NULL;
-      return false;
     }
+  return success;
+}
+
+// Write the two byte zlib header which compress2 would write at the
+// compression level we use.
+
+static void
+zlib_header(unsigned char* p)
+{
+  int level = compress_level();
+  unsigned int level_flags;
+  if (level < 2)
+    level_flags = 0;
+  else if (level < 6)
+    level_flags = 1;
+  else if (level == 6)
+    level_flags = 2;
+  else
+    level_flags = 3;
+  unsigned int header = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8;
+  header |= level_flags << 6;
+  header += 31 - (header % 31);
+  p[0] = header >> 8;
+  p[1] = header & 0xff;
 }
 
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
@@ -115,6 +167,53 @@ zlib_decompress(const unsigned char* compressed_data,
   return true;
 }
 
+#ifdef HAVE_ZSTD
+
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE as a single
+// zstd frame.  A zstd stream may consist of several frames, so the
+// chunks of a section are simply concatenated.  Returns true if it
+// successfully compressed, in which case it allocates memory for the
+// compressed data using new, and sets *COMPRESSED_DATA and
+// *COMPRESSED_SIZE.
+
+static bool
+zstd_compress_chunk(const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  size_t buffer_size = ZSTD_compressBound(uncompressed_size);
+  *compressed_data = new unsigned char[buffer_size];
+  size_t rc = ZSTD_compress(*compressed_data, buffer_size,
+			    uncompressed_data, uncompressed_size,
+			    compress_level());
+  if (ZSTD_isError(rc))
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+      return false;
+    }
+  *compressed_size = rc;
+  return true;
+}
+
+// Decompress zstd COMPRESSED_DATA of size COMPRESSED_SIZE into a
+// buffer UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
+// if it decompressed successfully, false if it failed.
+
+static bool
+zstd_decompress(const unsigned char* compressed_data,
+		unsigned long compressed_size,
+		unsigned char* uncompressed_data,
+		unsigned long uncompressed_size)
+{
+  size_t rc = ZSTD_decompress(uncompressed_data, uncompressed_size,
+			      compressed_data, compressed_size);
+  return !ZSTD_isError(rc) && rc == uncompressed_size;
+}
+
+#endif // defined(HAVE_ZSTD)
+
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
 
@@ -148,20 +247,19 @@ decompress_input_section(const unsigned char* compressed_data,
   if ((sh_flags & elfcpp::SHF_COMPRESSED) != 0)
     {
       unsigned int compression_header_size;
+      elfcpp::Elf_Word ch_type;
       if (size == 32)
 	{
 	  compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
 	  if (big_endian)
 	    {
 	      elfcpp::Chdr<32, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	  else
 	    {
 	      elfcpp::Chdr<32, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	}
       else if (size == 64)
@@ -170,23 +268,30 @@ decompress_input_section(const unsigned char* compressed_data,
 	  if (big_endian)
 	    {
 	      elfcpp::Chdr<64, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	  else
 	    {
 	      elfcpp::Chdr<64, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	}
       else
 	gold_unreachable();
 
-      return zlib_decompress(compressed_data + compression_header_size,
-			     compressed_size - compression_header_size,
-			     uncompressed_data,
-			     uncompressed_size);
+      if (ch_type == elfcpp::ELFCOMPRESS_ZLIB)
+	return zlib_decompress(compressed_data + compression_header_size,
+			       compressed_size - compression_header_size,
+			       uncompressed_data,
+			       uncompressed_size);
+#ifdef HAVE_ZSTD
+      if (ch_type == elfcpp::ELFCOMPRESS_ZSTD)
+	return zstd_decompress(compressed_data + compression_header_size,
+			       compressed_size - compression_header_size,
+			       uncompressed_data,
+			       uncompressed_size);
+#endif
+      return false;
     }
 
   const unsigned int zlib_header_size = 12;
@@ -209,19 +314,77 @@ decompress_input_section(const unsigned char* compressed_data,
   return false;
 }
 
+// A Task to compress one chunk of an Output_compressed_section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, unsigned int chunk,
+		      Task_token* final_blocker)
+    : os_(os), chunk_(chunk), final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return std::string("Compress_chunk_task ") + this->os_->name(); }
+
+ private:
+  Output_compressed_section* const os_;
+  const unsigned int chunk_;
+  Task_token* const final_blocker_;
+};
+
 // Class Output_compressed_section.
 
-// Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+Output_compressed_section::Output_compressed_section(
+    const General_options* options,
+    const char* name,
+    elfcpp::Elf_Word flags,
+    elfcpp::Elf_Xword type)
+  : Output_section(name, flags, type),
+    options_(options), format_(COMPRESS_NONE), chunks_(),
+    chunks_prepared_(false), is_compressed_(false), header_(), trailer_(),
+    new_section_name_()
+{
+  this->set_requires_postprocessing();
+
+  const char* compress = options->compress_debug_sections();
+  if (strcmp(compress, "zlib-gnu") == 0)
+    this->format_ = COMPRESS_ZLIB_GNU;
+  else if (strcmp(compress, "zlib-gabi") == 0
+	   || strcmp(compress, "zlib") == 0)
+    this->format_ = COMPRESS_ZLIB_GABI;
+  else if (strcmp(compress, "zstd") == 0)
+    this->format_ = COMPRESS_ZSTD;
+}
 
-void
-Output_compressed_section::set_final_data_size()
+Output_compressed_section::~Output_compressed_section()
 {
-  off_t uncompressed_size = this->postprocessing_buffer_size();
+  this->free_chunks();
+}
+
+// Copy the contents of anything other than a regular input section
+// into the postprocessing buffer, and split the buffer into chunks.
 
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+void
+Output_compressed_section::prepare_chunks()
+{
+  if (this->chunks_prepared_)
+    return;
+  this->chunks_prepared_ = true;
 
   // At this point the contents of all regular input sections will
   // have been copied into the postprocessing buffer, and relocations
@@ -229,61 +392,165 @@ Output_compressed_section::set_final_data_size()
   // anything other than a regular input section.
   this->write_to_postprocessing_buffer();
 
-  bool success = false;
-  enum { none, gnu_zlib, gabi_zlib } compress;
-  int compression_header_size = 12;
-  const int size = parameters->target().get_size();
-  if (strcmp(this->options_->compress_debug_sections(), "zlib-gnu") == 0)
-    compress = gnu_zlib;
-  else if (strcmp(this->options_->compress_debug_sections(), "zlib-gabi") == 0
-	   || strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
+  if (this->format_ == COMPRESS_NONE)
+    return;
+
+  section_size_type uncompressed_size =
+    convert_to_section_size_type(this->postprocessing_buffer_size());
+  size_t count = 1;
+  if (uncompressed_size > 0)
+    count = (uncompressed_size - 1) / compress_chunk_size + 1;
+  this->chunks_.resize(count);
+}
+
+// Queue a task to compress each chunk.
+
+void
+Output_compressed_section::do_queue_postprocessing_tasks(Workqueue* workqueue,
+							  Task_token* blocker)
+{
+  this->prepare_chunks();
+  for (unsigned int i = 0; i < this->chunks_.size(); ++i)
     {
-      compress = gabi_zlib;
-      if (size == 32)
-	compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
-      else if (size == 64)
-	compression_header_size = elfcpp::Elf_sizes<64>::chdr_size;
-      else
-	gold_unreachable();
+      workqueue->add_blocker(blocker);
+      workqueue->queue(new Compress_chunk_task(this, i, blocker));
     }
-  else
-    compress = none;
-  if (compress != none)
-    success = zlib_compress(compression_header_size, uncompressed_data,
-			    uncompressed_size, &this->data_,
-			    &compressed_size);
+}
+
+// Compress chunk number CHUNK.  Each chunk is compressed
+// independently, so this may run in parallel for different chunks.
+
+void
+Output_compressed_section::compress_chunk(unsigned int chunk)
+{
+  gold_assert(chunk < this->chunks_.size());
+  section_size_type uncompressed_size =
+    convert_to_section_size_type(this->postprocessing_buffer_size());
+  section_size_type start = chunk * compress_chunk_size;
+  section_size_type len = std::min(compress_chunk_size,
+				   uncompressed_size - start);
+  const unsigned char* uncompressed_data =
+    this->postprocessing_buffer() + start;
+  bool is_last = chunk + 1 == this->chunks_.size();
+
+  Compressed_chunk* pc = &this->chunks_[chunk];
+  unsigned long compressed_size = 0;
+  switch (this->format_)
+    {
+    case COMPRESS_ZLIB_GNU:
+    case COMPRESS_ZLIB_GABI:
+      pc->ok = zlib_compress_chunk(uncompressed_data, len, is_last,
+				   &pc->data, &compressed_size);
+      pc->checksum = adler32(adler32(0L, Z_NULL, 0), uncompressed_data,
+			     len);
+      break;
+
+    case COMPRESS_ZSTD:
+#ifdef HAVE_ZSTD
+      pc->ok = zstd_compress_chunk(uncompressed_data, len, &pc->data,
+				   &compressed_size);
+#endif
+      break;
+
+    default:
+      gold_unreachable();
+    }
+  if (pc->ok)
+    pc->size = compressed_size;
+}
+
+// Free the compressed chunks.
+
+void
+Output_compressed_section::free_chunks()
+{
+  for (std::vector<Compressed_chunk>::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      delete[] p->data;
+      p->data = NULL;
+    }
+}
+
+// Set the final data size of a compressed section.  The chunks have
+// normally been compressed by tasks queued by
+// do_queue_postprocessing_tasks; here we add up their sizes and
+// build the header and trailer.
+
+void
+Output_compressed_section::set_final_data_size()
+{
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+
+  // If no tasks were queued, compress the chunks now.
+  if (!this->chunks_prepared_)
+    {
+      this->prepare_chunks();
+      for (unsigned int i = 0; i < this->chunks_.size(); ++i)
+	this->compress_chunk(i);
+    }
+
+  bool success = !this->chunks_.empty();
+  off_t compressed_size = 0;
+  for (std::vector<Compressed_chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (!p->ok)
+	success = false;
+      compressed_size += p->size;
+    }
+
+  const int size = parameters->target().get_size();
   if (success)
     {
       elfcpp::Elf_Xword flags = this->flags();
-      if (compress == gabi_zlib)
+      if (this->format_ == COMPRESS_ZLIB_GNU)
+	{
+	  // Write out the zlib header.
+	  this->header_.resize(12);
+	  memcpy(&this->header_[0], "ZLIB", 4);
+	  elfcpp::Swap_unaligned<64, true>::writeval(&this->header_[4],
+						     uncompressed_size);
+	  // This converts .debug_foo to .zdebug_foo
+	  this->new_section_name_ = std::string(".z") + (this->name() + 1);
+	  this->set_name(this->new_section_name_.c_str());
+	}
+      else
 	{
 	  // Set the SHF_COMPRESSED bit.
 	  flags |= elfcpp::SHF_COMPRESSED;
+	  elfcpp::Elf_Word ch_type = (this->format_ == COMPRESS_ZSTD
+				      ? elfcpp::ELFCOMPRESS_ZSTD
+				      : elfcpp::ELFCOMPRESS_ZLIB);
 	  const bool is_big_endian = parameters->target().is_big_endian();
 	  uint64_t addralign = this->addralign();
 	  if (size == 32)
 	    {
+	      this->header_.resize(elfcpp::Elf_sizes<32>::chdr_size);
 	      if (is_big_endian)
 		{
-		  elfcpp::Chdr_write<32, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  elfcpp::Chdr_write<32, true> chdr(&this->header_[0]);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
 	      else
 		{
-		  elfcpp::Chdr_write<32, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  elfcpp::Chdr_write<32, false> chdr(&this->header_[0]);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
 	    }
 	  else if (size == 64)
 	    {
+	      this->header_.resize(elfcpp::Elf_sizes<64>::chdr_size);
 	      if (is_big_endian)
 		{
-		  elfcpp::Chdr_write<64, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  elfcpp::Chdr_write<64, true> chdr(&this->header_[0]);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -291,8 +558,8 @@ Output_compressed_section::set_final_data_size()
 		}
 	      else
 		{
-		  elfcpp::Chdr_write<64, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  elfcpp::Chdr_write<64, false> chdr(&this->header_[0]);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -302,29 +569,51 @@ Output_compressed_section::set_final_data_size()
 	  else
 	    gold_unreachable();
 	}
-      else
+
+      if (this->format_ != COMPRESS_ZSTD)
 	{
-	  // Write out the zlib header.
-	  memcpy(this->data_, "ZLIB", 4);
-	  elfcpp::Swap_unaligned<64, true>::writeval(this->data_ + 4,
-						     uncompressed_size);
-	  // This converts .debug_foo to .zdebug_foo
-	  this->new_section_name_ = std::string(".z") + (this->name() + 1);
-	  this->set_name(this->new_section_name_.c_str());
+	  // The chunks are raw deflate data.  Wrap them in a zlib
+	  // stream by adding the zlib header, and a trailer holding
+	  // the Adler-32 checksum of all the uncompressed data.
+	  unsigned char zhdr[2];
+	  zlib_header(zhdr);
+	  this->header_.insert(this->header_.end(), zhdr, zhdr + 2);
+
+	  unsigned long checksum = this->chunks_[0].checksum;
+	  for (unsigned int i = 1; i < this->chunks_.size(); ++i)
+	    {
+	      section_size_type start = i * compress_chunk_size;
+	      section_size_type len = std::min(compress_chunk_size,
+					       (static_cast<section_size_type>
+						(uncompressed_size) - start));
+	      checksum = adler32_combine(checksum, this->chunks_[i].checksum,
+					 len);
+	    }
+	  this->trailer_.resize(4);
+	  elfcpp::Swap_unaligned<32, true>::writeval(&this->trailer_[0],
+						     checksum);
 	}
+
+      this->is_compressed_ = true;
       this->set_flags(flags);
-      this->set_data_size(compressed_size);
+      this->set_data_size(this->header_.size() + compressed_size
+			  + this->trailer_.size());
     }
   else
     {
-      gold_warning(_("not compressing section data: zlib error"));
-      gold_assert(this->data_ == NULL);
+      if (this->format_ == COMPRESS_ZSTD)
+	gold_warning(_("not compressing section data: zstd error"));
+      else
+	gold_warning(_("not compressing section data: zlib error"));
+      this->free_chunks();
       this->set_data_size(uncompressed_size);
     }
 }
 
 // Write out a compressed section.  If we couldn't compress, we just
-// write it out as normal, uncompressed data.
+// write it out as normal, uncompressed data.  Otherwise the
+// compressed chunks are copied straight into the output file between
+// the header and the trailer.
 
 void
 Output_compressed_section::do_write(Output_file* of)
@@ -332,10 +621,29 @@ Output_compressed_section::do_write(Output_file* of)
   off_t offset = this->offset();
   off_t data_size = this->data_size();
   unsigned char* view = of->get_output_view(offset, data_size);
-  if (this->data_ == NULL)
+  if (!this->is_compressed_)
     memcpy(view, this->postprocessing_buffer(), data_size);
   else
-    memcpy(view, this->data_, data_size);
+    {
+      unsigned char* pov = view;
+      memcpy(pov, &this->header_[0], this->header_.size());
+      pov += this->header_.size();
+      for (std::vector<Compressed_chunk>::const_iterator p =
+	     this->chunks_.begin();
+	   p != this->chunks_.end();
+	   ++p)
+	{
+	  memcpy(pov, p->data, p->size);
+	  pov += p->size;
+	}
+      if (!this->trailer_.empty())
+	{
+	  memcpy(pov, &this->trailer_[0], this->trailer_.size());
+	  pov += this->trailer_.size();
+	}
+      gold_assert(pov - view == data_size);
+      this->free_chunks();
+    }
   of->write_output_view(offset, data_size, view);
 }
 
@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Task_token;
+class Workqueue;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -51,19 +54,30 @@ decompress_input_section(const unsigned char*, unsigned long, unsigned char*,
 
 // This is used for a section whose data should be compressed.  It is
 // a regular Output_section which computes its contents into a buffer
-// and then postprocesses it.
+// and then postprocesses it.  The contents are compressed in
+// independent chunks, which may be compressed in parallel; the
+// chunks are concatenated into a single compressed stream when the
+// section is written.
 
 class Output_compressed_section : public Output_section
 {
  public:
   Output_compressed_section(const General_options* options,
 			    const char* name, elfcpp::Elf_Word flags,
-			    elfcpp::Elf_Xword type)
-    : Output_section(name, flags, type),
-      options_(options)
-  { this->set_requires_postprocessing(); }
+			    elfcpp::Elf_Xword type);
+
+  ~Output_compressed_section();
+
+  // Compress chunk number CHUNK of the section contents.  This is
+  // called by a separate task for each chunk.
+  void
+  compress_chunk(unsigned int chunk);
 
  protected:
+  // Queue a task to compress each chunk of the section contents.
+  void
+  do_queue_postprocessing_tasks(Workqueue*, Task_token*);
+
   // Set the final data size.
   void
   set_final_data_size();
@@ -73,10 +87,59 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // The compression format.
+  enum Compression_format
+  {
+    // No compression.
+    COMPRESS_NONE,
+    // zlib, with a "ZLIB" header and a .zdebug section name.
+    COMPRESS_ZLIB_GNU,
+    // zlib, with an ELF compression header.
+    COMPRESS_ZLIB_GABI,
+    // zstd, with an ELF compression header.
+    COMPRESS_ZSTD
+  };
+
+  // A single compressed chunk of the section contents.
+  struct Compressed_chunk
+  {
+    Compressed_chunk()
+      : data(NULL), size(0), checksum(0), ok(false)
+    { }
+
+    // The compressed data, allocated with new[].
+    unsigned char* data;
+    // The size of the compressed data.
+    section_size_type size;
+    // For zlib, the Adler-32 checksum of the uncompressed data.
+    unsigned long checksum;
+    // Whether the chunk was compressed successfully.
+    bool ok;
+  };
+
+  // Copy the remaining contents into the postprocessing buffer and
+  // set up the list of chunks to compress.
+  void
+  prepare_chunks();
+
+  // Free the compressed chunks.
+  void
+  free_chunks();
+
   // The options--this includes the compression type.
   const General_options* options_;
-  // The compressed data.
-  unsigned char* data_;
+  // The compression format, from the options.
+  Compression_format format_;
+  // The compressed chunks of the section contents.
+  std::vector<Compressed_chunk> chunks_;
+  // Whether prepare_chunks has been called.
+  bool chunks_prepared_;
+  // Whether we are writing out compressed data.
+  bool is_compressed_;
+  // The header to write before the compressed chunks.
+  std::vector<unsigned char> header_;
+  // The trailer to write after the compressed chunks.
+  std::vector<unsigned char> trailer_;
   // The new section name if we do compress.
   std::string new_section_name_;
 };
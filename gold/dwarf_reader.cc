@@ -282,7 +282,17 @@ Dwarf_abbrev_table::do_get_abbrev(unsigned int code)
 	  if (attr == elfcpp::DW_AT_sibling)
 	    entry->has_sibling_attribute = true;
 
-	  entry->add_attribute(attr, form);
+	  // For DW_FORM_implicit_const, the value follows the form.
+	  int64_t implicit_const = 0;
+	  if (form == elfcpp::DW_FORM_implicit_const)
+	    {
+	      if (this->buffer_pos_ >= this->buffer_end_)
+		return NULL;
+	      implicit_const = read_signed_LEB_128(this->buffer_pos_, &len);
+	      this->buffer_pos_ += len;
+	    }
+
+	  entry->add_attribute(attr, form, implicit_const);
 	}
 
       this->store_abbrev(nextcode, entry);
@@ -477,6 +487,226 @@ Dwarf_ranges_table::lookup_reloc(off_t off, off_t* target_off)
   return shndx;
 }
 
+// class Dwarf_location_table
+
+// Read the location table from an object file.
+
+bool
+Dwarf_location_table::read_location_table(
+    Relobj* object,
+    const unsigned char* symtab,
+    off_t symtab_size,
+    bool is_loclists,
+    unsigned int loc_shndx)
+{
+  // If we've already read this section, return immediately.
+  if (this->loc_shndx_ > 0
+      && this->is_loclists_ == is_loclists
+      && (loc_shndx == 0 || loc_shndx == this->loc_shndx_))
+    return true;
+
+  // If we don't have relocations, loc_shndx will be 0, and we'll
+  // have to hunt for the section.
+  if (loc_shndx == 0)
+    {
+      const char* name = is_loclists ? ".debug_loclists" : ".debug_loc";
+      const char* zname = is_loclists ? ".zdebug_loclists" : ".zdebug_loc";
+      for (unsigned int i = 1; i < object->shnum(); ++i)
+	{
+	  std::string section_name = object->section_name(i);
+	  if (section_name == name || section_name == zname)
+	    {
+	      loc_shndx = i;
+	      break;
+	    }
+	}
+      if (loc_shndx == 0)
+	return false;
+    }
+
+  // Get the section contents and decompress if necessary.
+  if (this->owns_loc_buffer_ && this->loc_buffer_ != NULL)
+    {
+      delete[] this->loc_buffer_;
+      this->owns_loc_buffer_ = false;
+    }
+  section_size_type buffer_size;
+  this->loc_buffer_ =
+      object->decompressed_section_contents(loc_shndx, &buffer_size,
+					    &this->owns_loc_buffer_);
+  this->loc_buffer_end_ = this->loc_buffer_ + buffer_size;
+  this->loc_shndx_ = loc_shndx;
+  this->is_loclists_ = is_loclists;
+
+  if (this->loc_reloc_mapper_ != NULL)
+    {
+      delete this->loc_reloc_mapper_;
+      this->loc_reloc_mapper_ = NULL;
+    }
+
+  // For incremental objects, we have no relocations.  We only need
+  // them to find the end of a .debug_loc list.
+  if (object->is_incremental() || is_loclists)
+    return true;
+
+  // Find the relocation section for the location table.
+  unsigned int reloc_shndx = 0;
+  unsigned int reloc_type = 0;
+  for (unsigned int i = 0; i < object->shnum(); ++i)
+    {
+      reloc_type = object->section_type(i);
+      if ((reloc_type == elfcpp::SHT_REL
+	   || reloc_type == elfcpp::SHT_RELA)
+	  && object->section_info(i) == loc_shndx)
+	{
+	  reloc_shndx = i;
+	  break;
+	}
+    }
+
+  this->loc_reloc_mapper_ = make_elf_reloc_mapper(object, symtab,
+						  symtab_size);
+  this->loc_reloc_mapper_->initialize(reloc_shndx, reloc_type);
+
+  return true;
+}
+
+// Read the location list at OFFSET, and add its location expressions
+// to EXPRS.
+
+bool
+Dwarf_location_table::read_location_list(
+    Relobj* object,
+    const unsigned char* symtab,
+    off_t symtab_size,
+    unsigned int addr_size,
+    unsigned int version,
+    unsigned int loc_shndx,
+    off_t offset,
+    Location_expressions* exprs)
+{
+  if (!this->read_location_table(object, symtab, symtab_size, version >= 5,
+				 loc_shndx))
+    return false;
+  if (offset < 0 || offset >= this->loc_buffer_end_ - this->loc_buffer_)
+    return false;
+
+  const unsigned char* p = this->loc_buffer_ + offset;
+  const unsigned char* pend = this->loc_buffer_end_;
+  size_t len;
+
+  if (version < 5)
+    {
+      // Each entry is a pair of addresses followed by a two-byte
+      // expression length.  The end of the list is marked by a pair
+      // of zeroes, and a base address selection entry by an address
+      // of all ones, neither of which has an expression.  In a
+      // relocatable object, the addresses may be zero until they
+      // are relocated.
+      while (p + 2 * addr_size <= pend)
+	{
+	  uint64_t start;
+	  uint64_t end;
+	  uint64_t all_ones;
+	  if (addr_size == 4)
+	    {
+	      start = this->dwinfo_->read_from_pointer<32>(p);
+	      end = this->dwinfo_->read_from_pointer<32>(p + 4);
+	      all_ones = 0xffffffffU;
+	    }
+	  else
+	    {
+	      start = this->dwinfo_->read_from_pointer<64>(p);
+	      end = this->dwinfo_->read_from_pointer<64>(p + 8);
+	      all_ones = -static_cast<uint64_t>(1);
+	    }
+	  off_t entry_offset = p - this->loc_buffer_;
+	  bool relocated = (this->has_reloc(entry_offset)
+			    || this->has_reloc(entry_offset + addr_size));
+	  p += 2 * addr_size;
+	  if (!relocated && start == 0 && end == 0)
+	    return true;
+	  if (!relocated && start == all_ones)
+	    continue;
+	  if (p + 2 > pend)
+	    return false;
+	  len = this->dwinfo_->read_from_pointer<16>(p);
+	  p += 2;
+	  if (p + len > pend)
+	    return false;
+	  exprs->push_back(std::make_pair(p, len));
+	  p += len;
+	}
+      return false;
+    }
+
+  while (p < pend)
+    {
+      unsigned int kind = *p++;
+      bool has_expr = true;
+      switch (kind)
+	{
+	case elfcpp::DW_LLE_end_of_list:
+	  return true;
+	case elfcpp::DW_LLE_base_addressx:
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  has_expr = false;
+	  break;
+	case elfcpp::DW_LLE_startx_endx:
+	case elfcpp::DW_LLE_startx_length:
+	case elfcpp::DW_LLE_offset_pair:
+	case elfcpp::DW_LLE_GNU_view_pair:
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  has_expr = kind != elfcpp::DW_LLE_GNU_view_pair;
+	  break;
+	case elfcpp::DW_LLE_default_location:
+	  break;
+	case elfcpp::DW_LLE_base_address:
+	  p += addr_size;
+	  has_expr = false;
+	  break;
+	case elfcpp::DW_LLE_start_end:
+	  p += 2 * addr_size;
+	  break;
+	case elfcpp::DW_LLE_start_length:
+	  p += addr_size;
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  break;
+	default:
+	  return false;
+	}
+      if (!has_expr)
+	continue;
+      if (p >= pend)
+	return false;
+      uint64_t expr_len = read_unsigned_LEB_128(p, &len);
+      p += len;
+      if (p + expr_len > pend)
+	return false;
+      exprs->push_back(std::make_pair(p, expr_len));
+      p += expr_len;
+    }
+  return false;
+}
+
+// Return true if there is a relocation at offset OFF in the location
+// table.
+
+bool
+Dwarf_location_table::has_reloc(off_t off)
+{
+  if (this->loc_reloc_mapper_ == NULL)
+    return false;
+  // Location lists are not read in order, so we can't just advance.
+  this->loc_reloc_mapper_->seek(off);
+  return this->loc_reloc_mapper_->next_offset() == off;
+}
+
 // class Dwarf_pubnames_table
 
 // Read the pubnames section from the object file.
@@ -736,6 +966,29 @@ Dwarf_die::read_attributes()
 	      ref_form = true;
 	      break;
 	    }
+	  case elfcpp::DW_FORM_line_strp:
+	    {
+	      off_t str_off;
+	      if (this->dwinfo_->offset_size() == 4)
+		str_off = this->dwinfo_->read_from_pointer<32>(&pattr);
+	      else
+		str_off = this->dwinfo_->read_from_pointer<64>(&pattr);
+	      unsigned int shndx =
+		  this->dwinfo_->lookup_reloc(attr_off, &str_off);
+	      attr_value.aux.shndx = shndx;
+	      attr_value.val.refval = str_off;
+	      break;
+	    }
+	  case elfcpp::DW_FORM_strp_sup:
+	  case elfcpp::DW_FORM_GNU_strp_alt:
+	  case elfcpp::DW_FORM_GNU_ref_alt:
+	    if (this->dwinfo_->offset_size() == 4)
+	      attr_value.val.uintval =
+		  this->dwinfo_->read_from_pointer<32>(&pattr);
+	    else
+	      attr_value.val.uintval =
+		  this->dwinfo_->read_from_pointer<64>(&pattr);
+	    break;
 	  case elfcpp::DW_FORM_addr:
 	    {
 	      off_t sec_off;
@@ -787,10 +1040,39 @@ Dwarf_die::read_attributes()
 	    attr_value.val.blockval = pattr + len;
 	    pattr += len + attr_value.aux.blocklen;
 	    break;
+	  case elfcpp::DW_FORM_data16:
+	    attr_value.aux.blocklen = 16;
+	    attr_value.val.blockval = pattr;
+	    pattr += 16;
+	    break;
 	  case elfcpp::DW_FORM_data1:
 	  case elfcpp::DW_FORM_flag:
 	    attr_value.val.intval = *pattr++;
 	    break;
+	  case elfcpp::DW_FORM_strx1:
+	  case elfcpp::DW_FORM_addrx1:
+	    attr_value.val.uintval = *pattr++;
+	    break;
+	  case elfcpp::DW_FORM_strx2:
+	  case elfcpp::DW_FORM_addrx2:
+	    attr_value.val.uintval =
+		this->dwinfo_->read_from_pointer<16>(&pattr);
+	    break;
+	  case elfcpp::DW_FORM_strx3:
+	  case elfcpp::DW_FORM_addrx3:
+	    attr_value.val.uintval =
+		this->dwinfo_->read_3bytes_from_pointer(&pattr);
+	    break;
+	  case elfcpp::DW_FORM_strx4:
+	  case elfcpp::DW_FORM_addrx4:
+	  case elfcpp::DW_FORM_ref_sup4:
+	    attr_value.val.uintval =
+		this->dwinfo_->read_from_pointer<32>(&pattr);
+	    break;
+	  case elfcpp::DW_FORM_ref_sup8:
+	    attr_value.val.uintval =
+		this->dwinfo_->read_from_pointer<64>(&pattr);
+	    break;
 	  case elfcpp::DW_FORM_ref1:
 	    attr_value.val.refval = *pattr++;
 	    ref_form = true;
@@ -858,9 +1140,17 @@ Dwarf_die::read_attributes()
 	  case elfcpp::DW_FORM_udata:
 	  case elfcpp::DW_FORM_GNU_addr_index:
 	  case elfcpp::DW_FORM_GNU_str_index:
+	  case elfcpp::DW_FORM_strx:
+	  case elfcpp::DW_FORM_addrx:
+	  case elfcpp::DW_FORM_loclistx:
+	  case elfcpp::DW_FORM_rnglistx:
 	    attr_value.val.uintval = read_unsigned_LEB_128(pattr, &len);
 	    pattr += len;
 	    break;
+	  case elfcpp::DW_FORM_implicit_const:
+	    attr_value.val.intval =
+		this->abbrev_code_->attributes[i].implicit_const;
+	    break;
 	  case elfcpp::DW_FORM_sdata:
 	    attr_value.val.intval = read_signed_LEB_128(pattr, &len);
 	    pattr += len;
@@ -954,9 +1244,14 @@ Dwarf_die::skip_attributes()
       switch(form)
 	{
 	  case elfcpp::DW_FORM_flag_present:
+	  case elfcpp::DW_FORM_implicit_const:
 	    break;
 	  case elfcpp::DW_FORM_strp:
 	  case elfcpp::DW_FORM_sec_offset:
+	  case elfcpp::DW_FORM_line_strp:
+	  case elfcpp::DW_FORM_strp_sup:
+	  case elfcpp::DW_FORM_GNU_strp_alt:
+	  case elfcpp::DW_FORM_GNU_ref_alt:
 	    pattr += this->dwinfo_->offset_size();
 	    break;
 	  case elfcpp::DW_FORM_addr:
@@ -993,25 +1288,44 @@ Dwarf_die::skip_attributes()
 	  case elfcpp::DW_FORM_data1:
 	  case elfcpp::DW_FORM_ref1:
 	  case elfcpp::DW_FORM_flag:
+	  case elfcpp::DW_FORM_strx1:
+	  case elfcpp::DW_FORM_addrx1:
 	    pattr += 1;
 	    break;
 	  case elfcpp::DW_FORM_data2:
 	  case elfcpp::DW_FORM_ref2:
+	  case elfcpp::DW_FORM_strx2:
+	  case elfcpp::DW_FORM_addrx2:
 	    pattr += 2;
 	    break;
+	  case elfcpp::DW_FORM_strx3:
+	  case elfcpp::DW_FORM_addrx3:
+	    pattr += 3;
+	    break;
 	  case elfcpp::DW_FORM_data4:
 	  case elfcpp::DW_FORM_ref4:
+	  case elfcpp::DW_FORM_strx4:
+	  case elfcpp::DW_FORM_addrx4:
+	  case elfcpp::DW_FORM_ref_sup4:
 	    pattr += 4;
 	    break;
 	  case elfcpp::DW_FORM_data8:
 	  case elfcpp::DW_FORM_ref8:
 	  case elfcpp::DW_FORM_ref_sig8:
+	  case elfcpp::DW_FORM_ref_sup8:
 	    pattr += 8;
 	    break;
+	  case elfcpp::DW_FORM_data16:
+	    pattr += 16;
+	    break;
 	  case elfcpp::DW_FORM_ref_udata:
 	  case elfcpp::DW_FORM_udata:
 	  case elfcpp::DW_FORM_GNU_addr_index:
 	  case elfcpp::DW_FORM_GNU_str_index:
+	  case elfcpp::DW_FORM_strx:
+	  case elfcpp::DW_FORM_addrx:
+	  case elfcpp::DW_FORM_loclistx:
+	  case elfcpp::DW_FORM_rnglistx:
 	    read_unsigned_LEB_128(pattr, &len);
 	    pattr += len;
 	    break;
@@ -1103,6 +1417,7 @@ Dwarf_die::int_attribute(unsigned int attr)
       case elfcpp::DW_FORM_data4:
       case elfcpp::DW_FORM_data8:
       case elfcpp::DW_FORM_sdata:
+      case elfcpp::DW_FORM_implicit_const:
         return attr_val->val.intval;
       default:
         return 0;
@@ -1125,6 +1440,8 @@ Dwarf_die::uint_attribute(unsigned int attr)
       case elfcpp::DW_FORM_ref_sig8:
       case elfcpp::DW_FORM_udata:
         return attr_val->val.uintval;
+      case elfcpp::DW_FORM_implicit_const:
+        return attr_val->val.intval;
       default:
         return 0;
     }
@@ -1313,6 +1630,24 @@ Dwarf_info_reader::do_parse()
 	  elfcpp::Swap_unaligned<16, big_endian>::readval(pinfo);
       pinfo += 2;
 
+      // In DWARF 5, the unit type and the address size come before
+      // the debug_abbrev_offset.
+      if (this->cu_version_ >= 5)
+	{
+	  if (!this->check_buffer(pinfo + 2 + this->offset_size_))
+	    break;
+
+	  // Read unit_type (1 byte).
+	  this->unit_type_ = *pinfo++;
+
+	  // Read address_size (1 byte).
+	  this->address_size_ = *pinfo++;
+	}
+      else
+	this->unit_type_ = (this->is_type_unit_
+			    ? elfcpp::DW_UT_type
+			    : elfcpp::DW_UT_compile);
+
       // Read debug_abbrev_offset (4 or 8 bytes).
       if (this->offset_size_ == 4)
 	abbrev_offset = elfcpp::Swap_unaligned<32, big_endian>::readval(pinfo);
@@ -1334,12 +1669,15 @@ Dwarf_info_reader::do_parse()
       pinfo += this->offset_size_;
 
       // Read address_size (1 byte).
-      this->address_size_ = *pinfo++;
+      if (this->cu_version_ < 5)
+	this->address_size_ = *pinfo++;
 
       // For type units, read the two extra fields.
       uint64_t signature = 0;
       off_t type_offset = 0;
-      if (this->is_type_unit_)
+      bool is_type_unit = (this->unit_type_ == elfcpp::DW_UT_type
+			   || this->unit_type_ == elfcpp::DW_UT_split_type);
+      if (is_type_unit)
         {
 	  if (!this->check_buffer(pinfo + 8 + this->offset_size_))
 	    break;
@@ -1357,6 +1695,14 @@ Dwarf_info_reader::do_parse()
 		elfcpp::Swap_unaligned<64, big_endian>::readval(pinfo);
 	  pinfo += this->offset_size_;
 	}
+      else if (this->unit_type_ == elfcpp::DW_UT_skeleton
+	       || this->unit_type_ == elfcpp::DW_UT_split_compile)
+	{
+	  // Skip the dwo_id (8 bytes).
+	  if (!this->check_buffer(pinfo + 8))
+	    break;
+	  pinfo += 8;
+	}
 
       // Read the .debug_abbrev table.
       this->abbrev_table_.read_abbrevs(this->object_, abbrev_shndx,
@@ -1369,7 +1715,7 @@ Dwarf_info_reader::do_parse()
       if (root_die.tag() != 0)
 	{
 	  // Visit the CU or TU.
-	  if (this->is_type_unit_)
+	  if (is_type_unit)
 	    this->visit_type_unit(section_offset + this->cu_offset_,
 				  cu_end - cu_start, type_offset, signature,
 				  &root_die);
@@ -1460,6 +1806,21 @@ Dwarf_info_reader::read_from_pointer(const unsigned char** source)
   return return_value;
 }
 
+// Read a possibly unaligned 3-byte integer.  Update SOURCE after read.
+
+uint32_t
+Dwarf_info_reader::read_3bytes_from_pointer(const unsigned char** source)
+{
+  const unsigned char* p = *source;
+  uint32_t return_value;
+  if (this->object_->is_big_endian())
+    return_value = (p[0] << 16) | (p[1] << 8) | p[2];
+  else
+    return_value = (p[2] << 16) | (p[1] << 8) | p[0];
+  *source += 3;
+  return return_value;
+}
+
 // Look for a relocation at offset ATTR_OFF in the dwarf info,
 // and return the section index and offset of the target.
 
@@ -2064,6 +2425,9 @@ Sized_dwarf_line_info<size, big_endian>::read_line_mappings(unsigned int shndx)
        ++it)
     // Each vector needs to be sorted by offset.
     std::sort(it->second.begin(), it->second.end());
+
+  // The relocations are only needed while reading the line programs.
+  this->reloc_map_.clear();
 }
 
 // Some processing depends on whether the input is a .o file or not.
@@ -2302,6 +2666,34 @@ Sized_dwarf_line_info<size, big_endian>::format_file_lineno(
 
 // Dwarf_line_info routines.
 
+// Create a Dwarf_line_info of the right size and endianness.
+
+Dwarf_line_info*
+Dwarf_line_info::make(Object* object, unsigned int read_shndx)
+{
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      return new Sized_dwarf_line_info<32, false>(object, read_shndx);
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      return new Sized_dwarf_line_info<32, true>(object, read_shndx);
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      return new Sized_dwarf_line_info<64, false>(object, read_shndx);
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      return new Sized_dwarf_line_info<64, true>(object, read_shndx);
+#endif
+    default:
+      gold_unreachable();
+    }
+}
+
 static unsigned int next_generation_count = 0;
 
 struct Addr2line_cache_entry
@@ -2354,27 +2746,7 @@ Dwarf_line_info::one_addr2line(Object* object,
   // cache.
   if (lineinfo == NULL)
   {
-    switch (parameters->size_and_endianness())
-      {
-#ifdef HAVE_TARGET_32_LITTLE
-        case Parameters::TARGET_32_LITTLE:
-          lineinfo = new Sized_dwarf_line_info<32, false>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_32_BIG
-        case Parameters::TARGET_32_BIG:
-          lineinfo = new Sized_dwarf_line_info<32, true>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_64_LITTLE
-        case Parameters::TARGET_64_LITTLE:
-          lineinfo = new Sized_dwarf_line_info<64, false>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_64_BIG
-        case Parameters::TARGET_64_BIG:
-          lineinfo = new Sized_dwarf_line_info<64, true>(object, shndx); break;
-#endif
-        default:
-          gold_unreachable();
-      }
+    lineinfo = Dwarf_line_info::make(object, shndx);
     addr2line_cache.push_back(Addr2line_cache_entry(object, shndx, lineinfo));
   }
 
@@ -67,6 +67,12 @@ class Elf_reloc_mapper
   advance(off_t offset)
   { this->do_advance(offset); }
 
+  // Move to the first relocation at or after OFFSET, in either
+  // direction.
+  void
+  seek(off_t offset)
+  { this->do_seek(offset); }
+
   // Return the section index and offset within the section of the target
   // of the relocation for RELOC_OFFSET in the referring section.
   unsigned int
@@ -95,6 +101,10 @@ class Elf_reloc_mapper
   virtual void
   do_advance(off_t offset) = 0;
 
+  // Move to the first relocation at or after OFFSET.
+  virtual void
+  do_seek(off_t offset) = 0;
+
   virtual unsigned int
   do_get_reloc_target(off_t reloc_offset, off_t* target_offset) = 0;
 
@@ -131,6 +141,11 @@ class Sized_elf_reloc_mapper : public Elf_reloc_mapper
   do_advance(off_t offset)
   { this->track_relocs_.advance(offset); }
 
+  // Move to the first relocation at or after OFFSET.
+  virtual void
+  do_seek(off_t offset)
+  { this->track_relocs_.seek(offset); }
+
   unsigned int
   do_get_reloc_target(off_t reloc_offset, off_t* target_offset);
 
@@ -173,11 +188,14 @@ class Dwarf_abbrev_table
   // An attribute list entry.
   struct Attribute
   {
-    Attribute(unsigned int a, unsigned int f)
-      : attr(a), form(f)
+    Attribute(unsigned int a, unsigned int f, int64_t c)
+      : attr(a), form(f), implicit_const(c)
     { }
     unsigned int attr;
     unsigned int form;
+    // The value of a DW_FORM_implicit_const attribute, which is
+    // stored in the abbreviation rather than in the DIE.
+    int64_t implicit_const;
   };
 
   // An abbrev code entry.
@@ -190,9 +208,9 @@ class Dwarf_abbrev_table
     }
 
     void
-    add_attribute(unsigned int attr, unsigned int form)
+    add_attribute(unsigned int attr, unsigned int form, int64_t implicit_const)
     {
-      this->attributes.push_back(Attribute(attr, form));
+      this->attributes.push_back(Attribute(attr, form, implicit_const));
     }
 
     // The DWARF tag.
@@ -391,6 +409,74 @@ class Dwarf_ranges_table
   uint64_t output_section_offset_;
 };
 
+// This class is used to read location lists from the .debug_loc
+// section (DWARF 4 and earlier) or the .debug_loclists section
+// (DWARF 5) of the object file.  We only collect the location
+// expressions, not the address ranges to which they apply.
+
+class Dwarf_location_table
+{
+ public:
+  // The location expressions of a location list, with their lengths.
+  typedef std::vector<std::pair<const unsigned char*, size_t> >
+    Location_expressions;
+
+  Dwarf_location_table(Dwarf_info_reader* dwinfo)
+    : dwinfo_(dwinfo), loc_shndx_(0), is_loclists_(false), loc_buffer_(NULL),
+      loc_buffer_end_(NULL), owns_loc_buffer_(false), loc_reloc_mapper_(NULL)
+  { }
+
+  ~Dwarf_location_table()
+  {
+    if (this->owns_loc_buffer_ && this->loc_buffer_ != NULL)
+      delete[] this->loc_buffer_;
+    if (this->loc_reloc_mapper_ != NULL)
+      delete this->loc_reloc_mapper_;
+  }
+
+  // Read the location list at OFFSET in section LOC_SHNDX, which is
+  // the .debug_loclists section if VERSION is 5 or more, and add its
+  // location expressions to EXPRS.  Return false if the list cannot
+  // be read.
+  bool
+  read_location_list(Relobj* object,
+		     const unsigned char* symtab,
+		     off_t symtab_size,
+		     unsigned int addr_size,
+		     unsigned int version,
+		     unsigned int loc_shndx,
+		     off_t offset,
+		     Location_expressions* exprs);
+
+ private:
+  // Read the .debug_loc or .debug_loclists section.
+  bool
+  read_location_table(Relobj* object,
+		      const unsigned char* symtab,
+		      off_t symtab_size,
+		      bool is_loclists,
+		      unsigned int loc_shndx);
+
+  // Return true if there is a relocation at offset OFF in the
+  // section.
+  bool
+  has_reloc(off_t off);
+
+  // The Dwarf_info_reader, for reading data.
+  Dwarf_info_reader* dwinfo_;
+  // The section index of the location table.
+  unsigned int loc_shndx_;
+  // True if the location table is the .debug_loclists section.
+  bool is_loclists_;
+  // The buffer containing the section.
+  const unsigned char* loc_buffer_;
+  const unsigned char* loc_buffer_end_;
+  // True if this object owns the buffer and needs to delete it.
+  bool owns_loc_buffer_;
+  // Relocation mapper for the section.
+  Elf_reloc_mapper* loc_reloc_mapper_;
+};
+
 // This class is used to read the pubnames and pubtypes tables from the
 // .debug_pubnames and .debug_pubtypes sections of the object file.
 
@@ -527,6 +613,11 @@ class Dwarf_die
     return this->abbrev_code_->has_sibling_attribute;
   }
 
+  // Read all the attributes of the DIE.  Return false if they
+  // cannot be read, for example because of an unknown form.
+  bool
+  read_attributes();
+
   // Return the value of attribute ATTR.
   const Attribute_value*
   attribute(unsigned int attr);
@@ -624,10 +715,6 @@ class Dwarf_die
  private:
   typedef Dwarf_abbrev_table::Abbrev_code Abbrev_code;
 
-  // Read all the attributes of the DIE.
-  bool
-  read_attributes();
-
   // Set the name of the DIE if present.
   void
   set_name();
@@ -699,7 +786,7 @@ class Dwarf_info_reader
       symtab_size_(symtab_size), shndx_(shndx), reloc_shndx_(reloc_shndx),
       reloc_type_(reloc_type), abbrev_shndx_(0), string_shndx_(0),
       buffer_(NULL), buffer_end_(NULL), cu_offset_(0), cu_length_(0),
-      offset_size_(0), address_size_(0), cu_version_(0),
+      offset_size_(0), address_size_(0), cu_version_(0), unit_type_(0),
       abbrev_table_(), ranges_table_(this),
       reloc_mapper_(NULL), string_buffer_(NULL), string_buffer_end_(NULL),
       owns_string_buffer_(false), string_output_section_offset_(0)
@@ -745,6 +832,10 @@ class Dwarf_info_reader
   inline typename elfcpp::Valtype_base<valsize>::Valtype
   read_from_pointer(const unsigned char** source);
 
+  // Read a possibly unaligned 3-byte integer.  Update SOURCE after read.
+  uint32_t
+  read_3bytes_from_pointer(const unsigned char** source);
+
   // Look for a relocation at offset ATTR_OFF in the dwarf info,
   // and return the section index and offset of the target.
   unsigned int
@@ -764,6 +855,17 @@ class Dwarf_info_reader
   address_size() const
   { return this->address_size_; }
 
+  // Return the version number of the current unit.
+  unsigned int
+  cu_version() const
+  { return this->cu_version_; }
+
+  // Return the type of the current unit, as a DW_UT code.  Units
+  // before DWARF 5 are DW_UT_compile or DW_UT_type.
+  unsigned int
+  unit_type() const
+  { return this->unit_type_; }
+
   // Return the size of a DW_FORM_ref_addr.
   // In DWARF v2, this was the size of an address; in DWARF v3 and later,
   // it is the size of an DWARF offset.
@@ -841,6 +943,12 @@ class Dwarf_info_reader
   reset_relocs(uint64_t checkpoint)
   { this->reloc_mapper_->reset(checkpoint); }
 
+  // Move the relocation tracker to OFFSET in the section, in either
+  // direction.
+  void
+  seek_relocs(off_t offset)
+  { this->reloc_mapper_->seek(offset); }
+
  private:
   // Print a warning about a corrupt debug section.
   void
@@ -904,6 +1012,8 @@ class Dwarf_info_reader
   unsigned int address_size_;
   // Compilation unit version number.
   unsigned int cu_version_;
+  // Compilation unit type (DW_UT).
+  unsigned int unit_type_;
   // Abbreviations table for current compilation unit.
   Dwarf_abbrev_table abbrev_table_;
   // Ranges table for the current compilation unit.
@@ -973,6 +1083,15 @@ class Dwarf_line_info
             std::vector<std::string>* other_lines)
   { return this->do_addr2line(shndx, offset, other_lines); }
 
+  // Create a Dwarf_line_info for OBJECT, using the size and
+  // endianness of the target.  If READ_SHNDX is not -1U, only the line
+  // information for that section is read; otherwise the line programs
+  // of the whole object are decoded once, and addr2line may be called
+  // for any section.  The caller must lock OBJECT, and must delete
+  // the result.
+  static Dwarf_line_info*
+  make(Object* object, unsigned int read_shndx = -1U);
+
   // A helper function for a single addr2line lookup.  It also keeps a
   // cache of the last CACHE_SIZE Dwarf_line_info objects it created;
   // set to 0 not to cache at all.  The larger CACHE_SIZE is, the more
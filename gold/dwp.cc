@@ -32,6 +32,11 @@
 #include <vector>
 #include <algorithm>
 
+#ifdef HAVE_GETRUSAGE
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
 #include "getopt.h"
 #include "libiberty.h"
 #include "../bfd/bfdver.h"
@@ -45,6 +50,8 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
+#include "timer.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -108,9 +115,14 @@ class Dwo_file
 {
  public:
   Dwo_file(const char* name)
-    : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+    : name_(name), obj_(NULL), input_file_(NULL), target_info_(),
+      is_compressed_(), sect_offsets_(), debug_types_(), debug_str_(0),
+      debug_cu_index_(0), debug_tu_index_(0), str_hash_codes_(),
+      str_offset_map_()
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -119,9 +131,21 @@ class Dwo_file
   void
   read_executable(File_list* files);
 
-  // Read the input file and send its contents to OUTPUT_FILE.
+  // Return the filename.
+  const char*
+  name() const
+  { return this->name_; }
+
+  // Open the input file, collect its debug sections, and read the
+  // contents that do not depend on the output file.  This may run in
+  // parallel with other input files.
+  void
+  read_sections();
+
+  // Send the contents of the input file to OUTPUT_FILE.  This must
+  // be called after read_sections, and for each input file in order.
   void
-  read(Dwp_output_file* output_file);
+  add_sections(Dwp_output_file* output_file);
 
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
@@ -144,16 +168,27 @@ class Dwo_file
     { return i1.first < i2.first; }
   };
 
+  // The ELF header parameters of the input file, which are passed
+  // on to the output file.
+  struct Target_info
+  {
+    int machine;
+    int size;
+    bool big_endian;
+    int osabi;
+    int abiversion;
+  };
+
   // Create a Sized_relobj_dwo of the given size and endianness,
-  // and record the target info.  P is a pointer to the ELF header
-  // in memory.
+  // and record the target info.  If DECOMPRESS is true, decompress
+  // any compressed sections now.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object(bool decompress);
 
   template <int size, bool big_endian>
   Relobj*
   sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+		    bool decompress);
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -198,6 +233,11 @@ class Dwo_file
   bool
   sized_verify_dwo_list(unsigned int, const File_list& files);
 
+  // Compute the hash codes of the strings in the input string table
+  // section, for use by add_strings.
+  void
+  hash_strings(unsigned int);
+
   // Merge the input string table section into the output file.
   void
   add_strings(Dwp_output_file*, unsigned int);
@@ -232,10 +272,24 @@ class Dwo_file
   Relobj* obj_;
   // The Input_file object.
   Input_file* input_file_;
+  // The ELF header parameters.
+  Target_info target_info_;
   // Flags indicating which sections are compressed.
   std::vector<bool> is_compressed_;
   // Map input section index onto output section offset and size.
   std::vector<Section_bounds> sect_offsets_;
+  // The input section index of each DW_SECT section, set by
+  // read_sections.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // The input section indexes of the .debug_types.dwo sections.
+  std::vector<unsigned int> debug_types_;
+  // The input section indexes of the string table and the unit
+  // index sections.
+  unsigned int debug_str_;
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // The hash codes of the strings in the input string table.
+  std::vector<size_t> str_hash_codes_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
 };
@@ -258,11 +312,12 @@ class Sized_relobj_dwo : public Sized_relobj<size, big_endian>
   { }
 
   ~Sized_relobj_dwo()
-  { }
+  { this->discard_decompressed_sections(); }
 
-  // Setup the section information.
+  // Setup the section information.  If DECOMPRESS is true, decompress
+  // the compressed sections and keep their contents.
   void
-  setup();
+  setup(bool decompress);
 
  protected:
   // Return section type.
@@ -412,7 +467,7 @@ class Sized_relobj_dwo : public Sized_relobj<size, big_endian>
   // Count the local symbols.
   void
   do_count_local_symbols(Stringpool_template<char>*,
-			 Stringpool_template<char>*)
+			 Stringpool_template<char>*, unsigned int)
   { gold_unreachable(); }
 
   // Finalize the local symbols.
@@ -463,11 +518,13 @@ class Dwp_output_file
   record_target_info(const char* name, int machine, int size, bool big_endian,
 		     int osabi, int abiversion);
 
-  // Add a string to the debug strings section.
+  // Add a string to the debug strings section.  HASH_CODE is
+  // Stringpool::hash_string(STR, LEN).
   section_offset_type
-  add_string(const char* str, size_t len);
+  add_string(const char* str, size_t len, size_t hash_code);
 
   // Add a section to the output file, and return the new section offset.
+  // CONTENTS is still owned by the caller.
   section_offset_type
   add_contribution(elfcpp::DW_SECT section_id, const unsigned char* contents,
 		   section_size_type len, int align);
@@ -490,14 +547,6 @@ class Dwp_output_file
   finalize();
 
  private:
-  // Contributions to output sections.
-  struct Contribution
-  {
-    section_offset_type output_offset;
-    section_size_type size;
-    const unsigned char* contents;
-  };
-
   // Sections in the output file.
   struct Section
   {
@@ -505,10 +554,12 @@ class Dwp_output_file
     off_t offset;
     section_size_type size;
     int align;
-    std::vector<Contribution> contributions;
+    // A temporary file holding the contributions to the section
+    // until we know its offset in the output file.
+    FILE* spill;
 
     Section(const char* n, int a)
-      : name(n), offset(0), size(0), align(a), contributions()
+      : name(n), offset(0), size(0), align(a), spill(NULL)
     { }
   };
 
@@ -634,7 +685,7 @@ class Dwp_output_file
 
   // Write the contributions to an output section.
   void
-  write_contributions(const Section& sect);
+  write_contributions(Section* sect);
 
   // Write a CU or TU index section.
   template<bool big_endian>
@@ -771,7 +822,7 @@ get_dwarf_section_name(elfcpp::DW_SECT section_id)
 
 template <int size, bool big_endian>
 void
-Sized_relobj_dwo<size, big_endian>::setup()
+Sized_relobj_dwo<size, big_endian>::setup(bool decompress)
 {
   const int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
   const off_t shoff = this->elf_file_.shoff();
@@ -801,8 +852,28 @@ Sized_relobj_dwo<size, big_endian>::setup()
   Compressed_section_map* compressed_sections =
       build_compressed_section_map<size, big_endian>(
 	  pshdrs, this->shnum(), names, section_names_size, this, true);
-  if (compressed_sections != NULL && !compressed_sections->empty())
-    this->set_compressed_sections(compressed_sections);
+  if (compressed_sections == NULL || compressed_sections->empty())
+    return;
+  this->set_compressed_sections(compressed_sections);
+
+  // Decompress the sections now if asked, so that the work is done
+  // while reading the input files in parallel.  The contents are
+  // freed by discard_decompressed_sections.
+  if (!decompress)
+    return;
+  for (Compressed_section_map::iterator p = compressed_sections->begin();
+       p != compressed_sections->end();
+       ++p)
+    {
+      if (p->second.contents != NULL)
+	continue;
+      section_size_type len;
+      bool is_new;
+      const unsigned char* contents =
+	  this->decompressed_section_contents(p->first, &len, &is_new);
+      if (is_new)
+	p->second.contents = contents;
+    }
 }
 
 // Return a view of the contents of a section.
@@ -840,7 +911,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object(false);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -880,25 +951,20 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Open the input file, collect its debug sections, and read the
+// contents that do not depend on the output file: decompress any
+// compressed sections and hash the strings of the string table.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::read_sections()
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object(true);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
 
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  unsigned int* debug_shndx = this->debug_shndx_;
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -920,7 +986,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       if (strcmp(suffix, "info.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
@@ -928,7 +994,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "loc.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
@@ -936,30 +1002,46 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "macro.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
     }
 
+  this->hash_strings(this->debug_str_);
+}
+
+// Send the contents of the input file to OUTPUT_FILE.
+
+void
+Dwo_file::add_sections(Dwp_output_file* output_file)
+{
+  const Target_info& ti(this->target_info_);
+  output_file->record_target_info(this->name_, ti.machine, ti.size,
+				  ti.big_endian, ti.osabi, ti.abiversion);
+
+  unsigned int* debug_shndx = this->debug_shndx_;
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file, this->debug_str_);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
-	  if (debug_types.size() > 1)
+	  if (this->debug_types_.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
 			 ".debug_types.dwo section"), this->name_);
-          if (debug_types.size() == 1)
-            debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
+          if (this->debug_types_.size() == 1)
+            debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx,
+				output_file, true);
 	}
       return;
     }
@@ -969,8 +1051,9 @@ Dwo_file::read(Dwp_output_file* output_file)
     this->add_unit_set(output_file, debug_shndx, false);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
+  for (std::vector<unsigned int>::const_iterator tp =
+	 this->debug_types_.begin();
+       tp != this->debug_types_.end();
        ++tp)
     {
       debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
@@ -985,7 +1068,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object(false);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1024,7 +1107,7 @@ Dwo_file::verify(const File_list& files)
 // and record the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object(bool decompress)
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1059,14 +1142,14 @@ Dwo_file::make_object(Dwp_output_file* output_file)
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
 	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+						 decompress);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
 	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+						  decompress);
 #else
 	gold_unreachable();
 #endif
@@ -1076,14 +1159,14 @@ Dwo_file::make_object(Dwp_output_file* output_file)
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
 	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+						 decompress);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
 	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+						  decompress);
 #else
 	gold_unreachable();
 #endif
@@ -1098,17 +1181,17 @@ Dwo_file::make_object(Dwp_output_file* output_file)
 template <int size, bool big_endian>
 Relobj*
 Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+			    bool decompress)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
-  obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+  obj->setup(decompress);
+  this->target_info_.machine = ehdr.get_e_machine();
+  this->target_info_.size = size;
+  this->target_info_.big_endian = big_endian;
+  this->target_info_.osabi = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->target_info_.abiversion = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   return obj;
 }
 
@@ -1236,15 +1319,6 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 	      info_contents + unit_set->sections[info_sect].offset;
 	  section_size_type unit_length = unit_set->sections[info_sect].size;
 
-	  // Dwp_output_file::add_contribution writes the .debug_info.dwo
-	  // section directly to the output file, so we only need to
-	  // duplicate contributions for .debug_types.dwo section.
-	  if (is_tu_index)
-	    {
-	      unsigned char *copy = new unsigned char[unit_length];
-	      memcpy(copy, unit_start, unit_length);
-	      unit_start = copy;
-	    }
 	  section_offset_type off =
 	      output_file->add_contribution(info_sect, unit_start,
 					    unit_length, 1);
@@ -1360,10 +1434,13 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
   return nmissing == 0;
 }
 
-// Merge the input string table section into the output file.
+// Compute the hash codes of the strings in the input string table
+// section.  Hashing is the most expensive part of merging the strings,
+// and it does not depend on the output string table, so we do it while
+// reading the input files in parallel.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::hash_strings(unsigned int debug_str)
 {
   section_size_type len;
   bool is_new;
@@ -1378,23 +1455,49 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
 	       this->name_,
 	       this->section_name(debug_str).c_str());
 
-  // Count the number of strings in the section, and size the map.
+  // Count the number of strings in the section, and size the vector.
   size_t count = 0;
   for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
     ++count;
-  this->str_offset_map_.reserve(count + 1);
+  this->str_hash_codes_.reserve(count);
+
+  while (p < pend)
+    {
+      size_t len = strlen(p);
+      this->str_hash_codes_.push_back(Stringpool::hash_string(p, len));
+      p += len + 1;
+    }
+  if (is_new)
+    delete[] pdata;
+}
+
+// Merge the input string table section into the output file.
+
+void
+Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+{
+  section_size_type len;
+  bool is_new;
+  const unsigned char* pdata = this->section_contents(debug_str, &len, &is_new);
+  const char* p = reinterpret_cast<const char*>(pdata);
+  const char* pend = p + len;
+
+  this->str_offset_map_.reserve(this->str_hash_codes_.size() + 1);
 
   // Add the strings to the output string table, and record the new offsets
   // in the map.
   section_offset_type i = 0;
   section_offset_type new_offset;
+  std::vector<size_t>::const_iterator hash_code = this->str_hash_codes_.begin();
   while (p < pend)
     {
       size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
+      gold_assert(hash_code != this->str_hash_codes_.end());
+      new_offset = output_file->add_string(p, len, *hash_code);
       this->str_offset_map_.push_back(std::make_pair(i, new_offset));
       p += len + 1;
       i += len + 1;
+      ++hash_code;
     }
   new_offset = 0;
   this->str_offset_map_.push_back(std::make_pair(i, new_offset));
@@ -1418,8 +1521,7 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
 
   // Get the section contents. Upon return, if IS_NEW is true, the memory
   // has been allocated via new; if false, the memory is part of the mapped
-  // input file, and we will need to duplicate it so that it will persist
-  // after we close the input file.
+  // input file or is owned by the object.
   section_size_type len;
   bool is_new;
   const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
@@ -1430,18 +1532,15 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
       if (is_new)
 	delete[] contents;
       contents = remapped;
-    }
-  else if (!is_new)
-    {
-      unsigned char* copy = new unsigned char[len];
-      memcpy(copy, contents, len);
-      contents = copy;
+      is_new = true;
     }
 
   // Add the contents of the input section to the output section.
-  // The output file takes ownership of the memory pointed to by CONTENTS.
+  // The output file writes out or saves a copy of CONTENTS.
   section_offset_type off = output_file->add_contribution(section_id, contents,
 							  len, 1);
+  if (is_new)
+    delete[] contents;
 
   // Store the output section bounds.
   Section_bounds bounds(off, len);
@@ -1582,10 +1681,10 @@ Dwp_output_file::record_target_info(const char*, int machine,
 // Add a string to the debug strings section.
 
 section_offset_type
-Dwp_output_file::add_string(const char* str, size_t len)
+Dwp_output_file::add_string(const char* str, size_t len, size_t hash_code)
 {
   Stringpool::Key key;
-  this->stringpool_.add_with_length(str, len, true, &key);
+  this->stringpool_.add_prehashed(str, len, hash_code, true, &key);
   this->have_strings_ = true;
   // We aren't supposed to call get_offset() until after
   // calling set_string_offsets(), but the offsets will
@@ -1614,9 +1713,11 @@ Dwp_output_file::add_output_section(const char* section_name, int align)
 // Add a contribution to a section in the output file, and return the offset
 // of the contribution within the output section.  The .debug_info.dwo section
 // is expected to be the largest one, so we will write the contents of this
-// section directly to the output file as we receive contributions, allowing
-// us to free that memory as soon as possible. We will save the remaining
-// contributions until we finalize the layout of the output file.
+// section directly to the output file as we receive contributions.  We write
+// the remaining contributions to a temporary file for each section, and copy
+// them to the output file when we finalize its layout.  Either way, we do
+// not hold on to the contents, so the memory for each input file can be
+// freed as soon as it has been added.
 
 section_offset_type
 Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
@@ -1676,13 +1777,24 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
     }
   else
     {
-      // Collect the contributions and keep track of the total size.
+      // Spill the contributions and keep track of the total size.
+      if (section.spill == NULL)
+	{
+	  section.spill = ::tmpfile();
+	  if (section.spill == NULL)
+	    gold_fatal(_("%s: cannot create temporary file for section '%s': "
+			 "%s"),
+		       this->name_, section_name, strerror(errno));
+	}
       if (align > section.align)
 	section.align = align;
       section_offset = align_offset(section.size, align);
+      for (section_offset_type i = section.size; i < section_offset; ++i)
+	::putc(0, section.spill);
+      if (::fwrite(contents, 1, len, section.spill) < len)
+	gold_fatal(_("%s: error writing temporary file for section '%s': %s"),
+		   this->name_, section_name, strerror(errno));
       section.size = section_offset + len;
-      Contribution contrib = { section_offset, len, contents };
-      section.contributions.push_back(contrib);
     }
 
   return section_offset;
@@ -1848,7 +1960,7 @@ Dwp_output_file::finalize()
       off_t file_offset = this->next_file_offset_;
       file_offset = align_offset(file_offset, sect.align);
       sect.offset = file_offset;
-      this->write_contributions(sect);
+      this->write_contributions(&sect);
       this->next_file_offset_ = file_offset + sect.size;
     }
 
@@ -1927,19 +2039,34 @@ Dwp_output_file::finalize()
   this->fd_ = NULL;
 }
 
-// Write the contributions to an output section.
+// Write the contributions to an output section, by copying them from
+// the temporary file, and close the temporary file.
 
 void
-Dwp_output_file::write_contributions(const Section& sect)
+Dwp_output_file::write_contributions(Section* sect)
 {
-  for (unsigned int i = 0; i < sect.contributions.size(); ++i)
+  gold_assert(sect->spill != NULL);
+  if (::fflush(sect->spill) != 0 || ::fseek(sect->spill, 0, SEEK_SET) != 0)
+    gold_fatal(_("%s: error reading temporary file for section '%s': %s"),
+	       this->name_, sect->name, strerror(errno));
+  ::fseek(this->fd_, sect->offset, SEEK_SET);
+
+  unsigned char buf[65536];
+  section_size_type left = sect->size;
+  while (left > 0)
     {
-      const Contribution& c = sect.contributions[i];
-      ::fseek(this->fd_, sect.offset + c.output_offset, SEEK_SET);
-      if (::fwrite(c.contents, 1, c.size, this->fd_) < c.size)
-	gold_fatal(_("%s: error writing section '%s'"), this->name_, sect.name);
-      delete[] c.contents;
+      size_t len = std::min(left, static_cast<section_size_type>(sizeof buf));
+      if (::fread(buf, 1, len, sect->spill) < len)
+	gold_fatal(_("%s: error reading temporary file for section '%s': %s"),
+		   this->name_, sect->name, strerror(errno));
+      if (::fwrite(buf, 1, len, this->fd_) < len)
+	gold_fatal(_("%s: error writing section '%s'"), this->name_,
+		   sect->name);
+      left -= len;
     }
+
+  ::fclose(sect->spill);
+  sect->spill = NULL;
 }
 
 // Write a new section to the output file.
@@ -2248,7 +2375,7 @@ Unit_reader::visit_compilation_unit(off_t, off_t cu_length, Dwarf_die* die)
 
   // Dwp_output_file::add_contribution writes the .debug_info.dwo section
   // directly to the output file, so we do not need to duplicate the
-  // section contents, and add_contribution does not need to free the memory.
+  // section contents.
   section_offset_type off =
       this->output_file_->add_contribution(elfcpp::DW_SECT_INFO,
 					   this->buffer_at_offset(0),
@@ -2274,16 +2401,167 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
   for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
     unit_set->sections[i] = this->sections_[i];
 
-  unsigned char* contents = new unsigned char[tu_length];
-  memcpy(contents, this->buffer_at_offset(0), tu_length);
   section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_TYPES, contents,
+      this->output_file_->add_contribution(elfcpp::DW_SECT_TYPES,
+					   this->buffer_at_offset(0),
 					   tu_length, 1);
   Section_bounds bounds(off, tu_length);
   unit_set->sections[elfcpp::DW_SECT_TYPES] = bounds;
   this->output_file_->add_tu_set(unit_set);
 }
 
+// A Task to read one input file.  These tasks run in parallel, but
+// WINDOW_BLOCKER, if not NULL, keeps us from reading too far ahead
+// of the files being added to the output file.
+
+class Dwo_read_task : public Task
+{
+ public:
+  Dwo_read_task(Dwo_file* dwo_file, Task_token* window_blocker,
+		Task_token* next_blocker)
+    : dwo_file_(dwo_file), window_blocker_(window_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->window_blocker_ != NULL && this->window_blocker_->is_blocked())
+      return this->window_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->read_sections(); }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_read_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Task_token* window_blocker_;
+  Task_token* next_blocker_;
+};
+
+// A Task to add the contents of one input file to the output file, and
+// then free the input file.  These tasks run in input order, so that the
+// output does not depend on the number of threads.  READ_BLOCKER is the
+// blocker for the read task, and is deleted by this task.  THIS_BLOCKER
+// is the blocker for the previous input file.
+
+class Dwo_add_task : public Task
+{
+ public:
+  Dwo_add_task(Dwo_file* dwo_file, Dwp_output_file* output_file,
+	       bool verbose, Task_token* read_blocker,
+	       Task_token* this_blocker, Task_token* next_blocker)
+    : dwo_file_(dwo_file), name_(dwo_file->name()),
+      output_file_(output_file), verbose_(verbose),
+      read_blocker_(read_blocker), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Dwo_add_task()
+  { delete this->read_blocker_; }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->read_blocker_->is_blocked())
+      return this->read_blocker_;
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  {
+    if (this->verbose_)
+      fprintf(stderr, "%s\n", this->name_);
+    this->dwo_file_->add_sections(this->output_file_);
+    delete this->dwo_file_;
+    this->dwo_file_ = NULL;
+  }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_add_task ") + this->name_; }
+
+ private:
+  Dwo_file* dwo_file_;
+  const char* name_;
+  Dwp_output_file* output_file_;
+  bool verbose_;
+  Task_token* read_blocker_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Queue the tasks to read the files in FILES and add them to
+// OUTPUT_FILE.  At most WINDOW files are read ahead of the file being
+// added, which bounds the memory used by files waiting their turn.
+// ADDED_BLOCKERS is set to the blockers released as each file is added;
+// the caller must delete them after running the workqueue.
+
+static void
+queue_dwo_tasks(Workqueue* workqueue, const File_list& files,
+		Dwp_output_file* output_file, bool verbose,
+		unsigned int window, std::vector<Task_token*>* added_blockers)
+{
+  gold_assert(window > 0);
+  added_blockers->reserve(files.size());
+  Task_token* this_blocker = NULL;
+  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+    {
+      Dwo_file* dwo_file = new Dwo_file(f->dwo_name.c_str());
+      size_t i = added_blockers->size();
+
+      Task_token* window_blocker = NULL;
+      if (i >= window)
+	window_blocker = (*added_blockers)[i - window];
+      Task_token* read_blocker = new Task_token(true);
+      read_blocker->add_blocker();
+      workqueue->queue(new Dwo_read_task(dwo_file, window_blocker,
+					 read_blocker));
+
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      added_blockers->push_back(next_blocker);
+      workqueue->queue(new Dwo_add_task(dwo_file, output_file, verbose,
+					read_blocker, this_blocker,
+					next_blocker));
+      this_blocker = next_blocker;
+    }
+}
+
+// Print the time used by a phase of the program for --stats.
+
+static void
+print_phase_time(const char* phase, const Timer::TimeStats& elapsed)
+{
+  fprintf(stderr,
+	  _("%s: %s time: (user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+	  program_name, phase,
+	  elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+	  elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+	  elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+}
+
 }; // End namespace gold
 
 using namespace gold;
@@ -2292,6 +2570,9 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS,
+  THREAD_COUNT,
+  STATS
 };
 
 struct option dwp_options[] =
@@ -2299,6 +2580,9 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "stats", no_argument, NULL, STATS },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
+    { "threads", no_argument, NULL, THREADS },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2315,6 +2599,11 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --stats                  Print time and memory usage"
+					   " statistics\n"));
+  fprintf(fd, _("  --threads                Read input files in parallel\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use with"
+					   " --threads\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2378,6 +2667,9 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool threads = false;
+  int thread_count = 0;
+  bool stats = false;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2397,6 +2689,21 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    threads = true;
+	    break;
+	  case THREAD_COUNT:
+	    {
+	      char* endptr;
+	      long count = strtol(optarg, &endptr, 0);
+	      if (*endptr != '\0' || count <= 0 || count > 1024)
+		gold_fatal(_("invalid thread count: %s"), optarg);
+	      thread_count = count;
+	    }
+	    break;
+	  case STATS:
+	    stats = true;
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2413,6 +2720,12 @@ main(int argc, char** argv)
       output_filename.append(".dwp");
     }
 
+  options.set_thread_options(threads, thread_count, stats);
+
+  Timer timer;
+  if (stats)
+    timer.start();
+
   // Get list of .dwo files from the executable.
   if (exe_filename != NULL)
     {
@@ -2436,16 +2749,52 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-  // Process each file, adding its contents to the output file.
-  Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+  if (stats)
+    timer.stamp(0);
+
+  // Read the files, in parallel if using threads, and add their contents
+  // to the output file in order.
+  Workqueue workqueue(options);
+  if (threads && thread_count == 0)
     {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+      thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+      if (thread_count <= 0)
+	thread_count = 2;
     }
+  if (threads)
+    workqueue.set_thread_count(thread_count);
+
+  Dwp_output_file output_file(output_filename.c_str());
+  std::vector<Task_token*> added_blockers;
+  queue_dwo_tasks(&workqueue, files, &output_file, verbose,
+		  2 * std::max(thread_count, 1), &added_blockers);
+  workqueue.process(0);
+  for (size_t i = 0; i < added_blockers.size(); ++i)
+    delete added_blockers[i];
+
+  if (stats)
+    timer.stamp(1);
+
   output_file.finalize();
 
+  if (stats)
+    {
+      timer.stamp(2);
+      print_phase_time(_("read executable"), timer.get_pass_time(0));
+      print_phase_time(_("read and merge"), timer.get_pass_time(1));
+      print_phase_time(_("finalize"), timer.get_pass_time(2));
+      print_phase_time(_("total run"), timer.get_elapsed_time());
+#ifdef HAVE_GETRUSAGE
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) == 0)
+	fprintf(stderr, _("%s: peak resident set size: %ld kilobytes\n"),
+		program_name, static_cast<long>(usage.ru_maxrss));
+#endif
+      workqueue.print_stats();
+      File_read::print_stats();
+    }
+
   return EXIT_SUCCESS;
 }
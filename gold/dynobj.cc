@@ -22,10 +22,12 @@
 
 #include "gold.h"
 
+#include <algorithm>
 #include <vector>
 #include <cstring>
 
 #include "elfcpp.h"
+#include "workqueue.h"
 #include "parameters.h"
 #include "script.h"
 #include "symtab.h"
@@ -850,6 +852,306 @@ Sized_dynobj<size, big_endian>::do_get_global_symbol_counts(
   *used = count;
 }
 
+// Statistics for --stats about the dynamic hash tables we created.
+
+Dynobj::Hash_table_stats Dynobj::gnu_hash_stats;
+Dynobj::Hash_table_stats Dynobj::elf_hash_stats;
+
+// The number of symbols in one piece of the parallel jobs used to
+// build the hash tables.  With fewer symbols than this the tables are
+// built by a single thread.
+
+static const unsigned int hash_piece_size = 8192;
+
+// The number of bucket counts which --hash-optimize tries.
+
+static const unsigned int optimize_bucket_candidates = 128;
+
+// Return the number of pieces to use for a job over COUNT symbols
+// which needs separate storage for each piece.
+
+static unsigned int
+hash_piece_count(unsigned int count)
+{
+  unsigned int pieces = (count + hash_piece_size - 1) / hash_piece_size;
+  pieces = std::min(pieces, Parallel_job::thread_count());
+  return std::max(pieces, 1U);
+}
+
+// A Parallel_job which computes the hash codes of the names of a
+// vector of symbols.  Each piece hashes hash_piece_size symbols.
+
+class Dynsym_hash_job : public Parallel_job
+{
+ public:
+  Dynsym_hash_job(const std::vector<Symbol*>& syms,
+		  uint32_t (*hashfn)(const char*),
+		  std::vector<uint32_t>* hashvals)
+    : syms_(syms), hashfn_(hashfn), hashvals_(hashvals)
+  { }
+
+  void
+  run_piece(unsigned int index)
+  {
+    unsigned int begin = index * hash_piece_size;
+    unsigned int end = std::min(begin + hash_piece_size,
+				static_cast<unsigned int>(this->syms_.size()));
+    for (unsigned int i = begin; i < end; ++i)
+      (*this->hashvals_)[i] = this->hashfn_(this->syms_[i]->name());
+  }
+
+ private:
+  const std::vector<Symbol*>& syms_;
+  uint32_t (*hashfn_)(const char*);
+  std::vector<uint32_t>* hashvals_;
+};
+
+// A Parallel_job which sorts hash codes by bucket.  This is a
+// counting sort done in two passes: first each piece counts the
+// entries in each bucket, then each piece stores its entries at the
+// positions which start_scatter computed.  The sort is stable, so the
+// result does not depend on the number of pieces.
+
+class Bucket_sort_job : public Parallel_job
+{
+ public:
+  Bucket_sort_job(const std::vector<uint32_t>& hashvals,
+		  unsigned int bucketcount, unsigned int pieces,
+		  std::vector<uint32_t>* order)
+    : hashvals_(hashvals), bucketcount_(bucketcount),
+      piece_size_((hashvals.size() + pieces - 1) / pieces),
+      positions_(pieces), order_(order), scatter_(false)
+  { }
+
+  void
+  run_piece(unsigned int index)
+  {
+    const unsigned int count = this->hashvals_.size();
+    unsigned int begin = std::min(index * this->piece_size_, count);
+    unsigned int end = std::min(begin + this->piece_size_, count);
+    std::vector<uint32_t>& positions(this->positions_[index]);
+    if (!this->scatter_)
+      {
+	positions.assign(this->bucketcount_, 0);
+	for (unsigned int i = begin; i < end; ++i)
+	  ++positions[this->hashvals_[i] % this->bucketcount_];
+      }
+    else
+      {
+	for (unsigned int i = begin; i < end; ++i)
+	  (*this->order_)[positions[this->hashvals_[i] % this->bucketcount_]++]
+	    = i;
+      }
+  }
+
+  // Called after the counting pass.  Turn the counts of each piece
+  // into the positions where the piece stores its entries, and set
+  // *BUCKET_START to the position of the first entry of each bucket,
+  // with a final entry for the end.
+  void
+  start_scatter(std::vector<uint32_t>* bucket_start)
+  {
+    const unsigned int pieces = this->positions_.size();
+    bucket_start->resize(this->bucketcount_ + 1);
+    uint32_t pos = 0;
+    for (unsigned int b = 0; b < this->bucketcount_; ++b)
+      {
+	(*bucket_start)[b] = pos;
+	for (unsigned int p = 0; p < pieces; ++p)
+	  {
+	    uint32_t c = this->positions_[p][b];
+	    this->positions_[p][b] = pos;
+	    pos += c;
+	  }
+      }
+    (*bucket_start)[this->bucketcount_] = pos;
+    this->order_->resize(pos);
+    this->scatter_ = true;
+  }
+
+ private:
+  const std::vector<uint32_t>& hashvals_;
+  unsigned int bucketcount_;
+  unsigned int piece_size_;
+  // For each piece, the count of its entries in each bucket, and then
+  // the position of its next entry in each bucket.
+  std::vector<std::vector<uint32_t> > positions_;
+  std::vector<uint32_t>* order_;
+  bool scatter_;
+};
+
+// A Parallel_job which computes the collision cost of a series of
+// bucket counts for --hash-optimize.  Piece I tries FIRST + 2 * I
+// buckets.
+
+class Bucket_cost_job : public Parallel_job
+{
+ public:
+  Bucket_cost_job(const std::vector<uint32_t>& hashvals, unsigned int first,
+		  std::vector<uint64_t>* costs)
+    : hashvals_(hashvals), first_(first), costs_(costs)
+  { }
+
+  void
+  run_piece(unsigned int index)
+  {
+    const unsigned int bucketcount = this->first_ + 2 * index;
+    std::vector<uint32_t> counts(bucketcount);
+    for (std::vector<uint32_t>::const_iterator p = this->hashvals_.begin();
+	 p != this->hashvals_.end();
+	 ++p)
+      ++counts[*p % bucketcount];
+
+    // A lookup of the symbol in position K of a chain reads K + 1
+    // chain entries, so the total for all the symbols in a chain of
+    // length C is C * (C + 1) / 2.  Summing C * C orders the bucket
+    // counts the same way, since the sum of C is fixed.
+    uint64_t cost = 0;
+    for (unsigned int i = 0; i < bucketcount; ++i)
+      cost += static_cast<uint64_t>(counts[i]) * counts[i];
+    (*this->costs_)[index] = cost;
+  }
+
+ private:
+  const std::vector<uint32_t>& hashvals_;
+  unsigned int first_;
+  std::vector<uint64_t>* costs_;
+};
+
+// A Parallel_job which fills in the chains of a standard ELF hash
+// table, given the dynamic symbols sorted by bucket.  The chain of a
+// symbol points to the previous symbol in the same bucket, and the
+// bucket points to the last one, which is what we get by pushing the
+// symbols onto the bucket lists in order.
+
+class Elf_hash_chain_job : public Parallel_job
+{
+ public:
+  Elf_hash_chain_job(const std::vector<Symbol*>& dynsyms,
+		     const std::vector<uint32_t>& hashvals,
+		     const std::vector<uint32_t>& bucket_start,
+		     const std::vector<uint32_t>& order,
+		     std::vector<uint32_t>* bucket,
+		     std::vector<uint32_t>* chain)
+    : dynsyms_(dynsyms), hashvals_(hashvals), bucket_start_(bucket_start),
+      order_(order), bucket_(bucket), chain_(chain)
+  { }
+
+  void
+  run_piece(unsigned int index)
+  {
+    const unsigned int bucketcount = this->bucket_->size();
+    unsigned int begin = index * hash_piece_size;
+    unsigned int end = std::min(begin + hash_piece_size,
+				static_cast<unsigned int>(this->order_.size()));
+    for (unsigned int k = begin; k < end; ++k)
+      {
+	unsigned int i = this->order_[k];
+	unsigned int b = this->hashvals_[i] % bucketcount;
+	unsigned int dynsym_index = this->dynsyms_[i]->dynsym_index();
+	if (k > this->bucket_start_[b])
+	  (*this->chain_)[dynsym_index] =
+	    this->dynsyms_[this->order_[k - 1]]->dynsym_index();
+	if (k + 1 == this->bucket_start_[b + 1])
+	  (*this->bucket_)[b] = dynsym_index;
+      }
+  }
+
+ private:
+  const std::vector<Symbol*>& dynsyms_;
+  const std::vector<uint32_t>& hashvals_;
+  const std::vector<uint32_t>& bucket_start_;
+  const std::vector<uint32_t>& order_;
+  std::vector<uint32_t>* bucket_;
+  std::vector<uint32_t>* chain_;
+};
+
+// A Parallel_job which fills in the hash values of a GNU hash table
+// and the bloom filter, and assigns the dynamic symbol indexes, given
+// the hashed symbols sorted by bucket.  Each piece builds its own
+// bloom filter, and merge_bitmask combines them.
+
+template<int size, bool big_endian>
+class Gnu_hash_fill_job : public Parallel_job
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_WXword Word;
+
+  Gnu_hash_fill_job(const std::vector<Symbol*>& hashed_dynsyms,
+		    const std::vector<uint32_t>& hashvals,
+		    const std::vector<uint32_t>& bucket_start,
+		    const std::vector<uint32_t>& order,
+		    unsigned int symindx, uint32_t shift1, uint32_t shift2,
+		    uint32_t maskwords, unsigned char* pchains,
+		    unsigned int pieces)
+    : hashed_dynsyms_(hashed_dynsyms), hashvals_(hashvals),
+      bucket_start_(bucket_start), order_(order), symindx_(symindx),
+      shift1_(shift1), shift2_(shift2), maskwords_(maskwords),
+      pchains_(pchains),
+      piece_size_((order.size() + pieces - 1) / pieces),
+      bitmasks_(pieces)
+  { }
+
+  void
+  run_piece(unsigned int index)
+  {
+    const unsigned int bucketcount = this->bucket_start_.size() - 1;
+    const unsigned int count = this->order_.size();
+    const uint32_t mask = (1U << this->shift1_) - 1U;
+    unsigned int begin = std::min(index * this->piece_size_, count);
+    unsigned int end = std::min(begin + this->piece_size_, count);
+    std::vector<Word>& bitmask(this->bitmasks_[index]);
+    bitmask.resize(this->maskwords_);
+    for (unsigned int k = begin; k < end; ++k)
+      {
+	unsigned int i = this->order_[k];
+	uint32_t hashval = this->hashvals_[i];
+	unsigned int bucket = hashval % bucketcount;
+
+	unsigned int w = (hashval >> this->shift1_) & (this->maskwords_ - 1);
+	bitmask[w] |= (static_cast<Word>(1U)) << (hashval & mask);
+	bitmask[w] |= ((static_cast<Word>(1U))
+		       << ((hashval >> this->shift2_) & mask));
+
+	uint32_t val = hashval & ~ 1U;
+	if (k + 1 == this->bucket_start_[bucket + 1])
+	  {
+	    // Last element terminates the chain.
+	    val |= 1;
+	  }
+	elfcpp::Swap<32, big_endian>::writeval(this->pchains_ + k * 4, val);
+
+	this->hashed_dynsyms_[i]->set_dynsym_index(this->symindx_ + k);
+      }
+  }
+
+  // Combine the bloom filters of the pieces into *BITMASK.
+  void
+  merge_bitmask(std::vector<Word>* bitmask) const
+  {
+    bitmask->assign(this->maskwords_, 0);
+    for (typename std::vector<std::vector<Word> >::const_iterator p =
+	   this->bitmasks_.begin();
+	 p != this->bitmasks_.end();
+	 ++p)
+      for (unsigned int i = 0; i < p->size(); ++i)
+	(*bitmask)[i] |= (*p)[i];
+  }
+
+ private:
+  const std::vector<Symbol*>& hashed_dynsyms_;
+  const std::vector<uint32_t>& hashvals_;
+  const std::vector<uint32_t>& bucket_start_;
+  const std::vector<uint32_t>& order_;
+  unsigned int symindx_;
+  uint32_t shift1_;
+  uint32_t shift2_;
+  uint32_t maskwords_;
+  unsigned char* pchains_;
+  unsigned int piece_size_;
+  std::vector<std::vector<Word> > bitmasks_;
+};
+
 // Given a vector of hash codes, compute the number of hash buckets to
 // use.
 
@@ -857,7 +1159,8 @@ unsigned int
 Dynobj::compute_bucket_count(const std::vector<uint32_t>& hashcodes,
 			     bool for_gnu_hash_table)
 {
-  // FIXME: Implement optional hash table optimization.
+  if (parameters->options().hash_optimize())
+    return Dynobj::optimize_bucket_count(hashcodes, for_gnu_hash_table);
 
   // Array used to determine the number of hash table buckets to use
   // based on the number of symbols there are.  If there are fewer
@@ -889,6 +1192,162 @@ Dynobj::compute_bucket_count(const std::vector<uint32_t>& hashcodes,
   return ret;
 }
 
+// Compute the number of hash buckets to use for --hash-optimize.  We
+// aim for one symbol per bucket, with no upper limit, and try a range
+// of odd bucket counts starting there.  We pick the one for which
+// looking up each of the symbols once reads the fewest chain entries,
+// which is the one with the fewest collisions for these particular
+// hash codes.  The candidates are tried in parallel, and the smallest
+// of equally good ones wins, so the result does not depend on the
+// number of threads.
+
+unsigned int
+Dynobj::optimize_bucket_count(const std::vector<uint32_t>& hashcodes,
+			      bool for_gnu_hash_table)
+{
+  const unsigned int symcount = hashcodes.size();
+  unsigned int first = std::max(symcount, for_gnu_hash_table ? 2U : 1U);
+  first |= 1;
+  const unsigned int candidates =
+    std::min(optimize_bucket_candidates, symcount / 2 + 1);
+
+  std::vector<uint64_t> costs(candidates);
+  Bucket_cost_job job(hashcodes, first, &costs);
+  job.run(candidates);
+
+  unsigned int best = 0;
+  for (unsigned int i = 1; i < candidates; ++i)
+    if (costs[i] < costs[best])
+      best = i;
+  return first + 2 * best;
+}
+
+// Set *HASHVALS to the hash codes computed by HASHFN of the names of
+// SYMS.  This is done in parallel when using threads.
+
+void
+Dynobj::hash_dynsym_names(const std::vector<Symbol*>& syms,
+			  uint32_t (*hashfn)(const char*),
+			  std::vector<uint32_t>* hashvals)
+{
+  hashvals->resize(syms.size());
+  Dynsym_hash_job job(syms, hashfn, hashvals);
+  job.run((syms.size() + hash_piece_size - 1) / hash_piece_size);
+}
+
+// Sort the indexes of HASHVALS by bucket, stably, for a hash table
+// with BUCKETCOUNT buckets.  Set *ORDER to the sorted indexes, and
+// *BUCKET_START to the position in *ORDER of the first entry of each
+// bucket, followed by the number of entries.  This is done in
+// parallel when using threads.
+
+void
+Dynobj::sort_by_bucket(const std::vector<uint32_t>& hashvals,
+		       unsigned int bucketcount,
+		       std::vector<uint32_t>* bucket_start,
+		       std::vector<uint32_t>* order)
+{
+  const unsigned int pieces = hash_piece_count(hashvals.size());
+  Bucket_sort_job job(hashvals, bucketcount, pieces, order);
+  job.run(pieces);
+  job.start_scatter(bucket_start);
+  job.run(pieces);
+}
+
+// Record the sizes of a hash table with the symbols in BUCKET_START
+// sorted into buckets for --stats, and how many chain entries lookups
+// read.  MISS_HASHVALS are the hash codes of names which are not in
+// the table.  For a GNU hash table, MISS_PASSED says which of them
+// get past the bloom filter; for a standard ELF hash table it is
+// NULL.
+
+void
+Dynobj::record_hash_table_stats(Hash_table_stats* stats,
+				const std::vector<uint32_t>& bucket_start,
+				const std::vector<uint32_t>& miss_hashvals,
+				const std::vector<bool>* miss_passed,
+				unsigned int bloom_bits)
+{
+  const unsigned int bucketcount = bucket_start.size() - 1;
+  stats->created = true;
+  stats->symbols = bucket_start[bucketcount];
+  stats->buckets = bucketcount;
+  stats->bloom_bits = bloom_bits;
+
+  stats->hit_chain_entries = 0;
+  for (unsigned int b = 0; b < bucketcount; ++b)
+    {
+      uint64_t c = bucket_start[b + 1] - bucket_start[b];
+      stats->hit_chain_entries += c * (c + 1) / 2;
+    }
+
+  stats->misses = miss_hashvals.size();
+  stats->miss_bloom_passes = 0;
+  stats->miss_chain_entries = 0;
+  for (unsigned int i = 0; i < miss_hashvals.size(); ++i)
+    {
+      if (miss_passed != NULL && !(*miss_passed)[i])
+	continue;
+      ++stats->miss_bloom_passes;
+      unsigned int b = miss_hashvals[i] % bucketcount;
+      stats->miss_chain_entries += bucket_start[b + 1] - bucket_start[b];
+    }
+}
+
+// Print statistics about the hash tables to stderr.  This is used
+// for --stats.
+
+void
+Dynobj::print_stats()
+{
+  static const struct
+  {
+    const char* name;
+    const Hash_table_stats* stats;
+  } tables[] =
+  {
+    { ".gnu.hash", &Dynobj::gnu_hash_stats },
+    { ".hash", &Dynobj::elf_hash_stats }
+  };
+
+  for (unsigned int i = 0; i < sizeof tables / sizeof tables[0]; ++i)
+    {
+      const char* name = tables[i].name;
+      const Hash_table_stats* stats = tables[i].stats;
+      if (!stats->created)
+	continue;
+      fprintf(stderr, _("%s: %s symbols: %u\n"),
+	      program_name, name, stats->symbols);
+      fprintf(stderr, _("%s: %s buckets: %u\n"),
+	      program_name, name, stats->buckets);
+      if (stats->bloom_bits != 0)
+	fprintf(stderr, _("%s: %s bloom filter bits: %u\n"),
+		program_name, name, stats->bloom_bits);
+      if (stats->symbols != 0)
+	fprintf(stderr,
+		_("%s: %s chain entries read per defined symbol lookup: "
+		  "%.3f\n"),
+		program_name, name,
+		(static_cast<double>(stats->hit_chain_entries)
+		 / stats->symbols));
+      if (stats->misses != 0)
+	{
+	  if (stats->bloom_bits != 0)
+	    fprintf(stderr,
+		    _("%s: %s undefined symbol lookups passing bloom filter: "
+		      "%.2f%%\n"),
+		    program_name, name,
+		    (100.0 * stats->miss_bloom_passes) / stats->misses);
+	  fprintf(stderr,
+		  _("%s: %s chain entries read per undefined symbol lookup: "
+		    "%.3f\n"),
+		  program_name, name,
+		  (static_cast<double>(stats->miss_chain_entries)
+		   / stats->misses));
+	}
+    }
+}
+
 // The standard ELF hash function.  This hash function must not
 // change, as the dynamic linker uses it also.
 
@@ -928,22 +1387,38 @@ Dynobj::create_elf_hash_table(const std::vector<Symbol*>& dynsyms,
   unsigned int dynsym_count = dynsyms.size();
 
   // Get the hash values for all the symbols.
-  std::vector<uint32_t> dynsym_hashvals(dynsym_count);
-  for (unsigned int i = 0; i < dynsym_count; ++i)
-    dynsym_hashvals[i] = Dynobj::elf_hash(dynsyms[i]->name());
+  std::vector<uint32_t> dynsym_hashvals;
+  Dynobj::hash_dynsym_names(dynsyms, Dynobj::elf_hash, &dynsym_hashvals);
 
   const unsigned int bucketcount =
     Dynobj::compute_bucket_count(dynsym_hashvals, false);
 
+  std::vector<uint32_t> bucket_start;
+  std::vector<uint32_t> order;
+  Dynobj::sort_by_bucket(dynsym_hashvals, bucketcount, &bucket_start, &order);
+
   std::vector<uint32_t> bucket(bucketcount);
   std::vector<uint32_t> chain(local_dynsym_count + dynsym_count);
 
-  for (unsigned int i = 0; i < dynsym_count; ++i)
+  Elf_hash_chain_job job(dynsyms, dynsym_hashvals, bucket_start, order,
+			 &bucket, &chain);
+  job.run((dynsym_count + hash_piece_size - 1) / hash_piece_size);
+
+  if (parameters->options().stats())
     {
-      unsigned int dynsym_index = dynsyms[i]->dynsym_index();
-      unsigned int bucketpos = dynsym_hashvals[i] % bucketcount;
-      chain[dynsym_index] = bucket[bucketpos];
-      bucket[bucketpos] = dynsym_index;
+      // Measure lookups of names which are not here by appending a
+      // character to each name.  This is one step of elf_hash.
+      std::vector<uint32_t> miss_hashvals(dynsym_count);
+      for (unsigned int i = 0; i < dynsym_count; ++i)
+	{
+	  uint32_t h = (dynsym_hashvals[i] << 4) + '.';
+	  uint32_t g = h & 0xf0000000;
+	  if (g != 0)
+	    h ^= (g >> 24) ^ g;
+	  miss_hashvals[i] = h;
+	}
+      Dynobj::record_hash_table_stats(&Dynobj::elf_hash_stats, bucket_start,
+				      miss_hashvals, NULL, 0);
     }
 
   int size = parameters->target().hash_entry_size();
@@ -1072,7 +1547,8 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
   // not want to put into the hash table we store into
   // UNHASHED_DYNSYMS.  Symbols which we do want to store we put into
   // HASHED_DYNSYMS.  DYNSYM_HASHVALS is parallel to HASHED_DYNSYMS,
-  // and records the hash codes.
+  // and records the hash codes, which we compute in parallel when
+  // using threads.
 
   std::vector<Symbol*> unhashed_dynsyms;
   unhashed_dynsyms.reserve(count);
@@ -1081,8 +1557,7 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
   hashed_dynsyms.reserve(count);
 
   std::vector<uint32_t> dynsym_hashvals;
-  dynsym_hashvals.reserve(count);
-  
+
   for (unsigned int i = 0; i < count; ++i)
     {
       Symbol* sym = dynsyms[i];
@@ -1093,12 +1568,12 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	      || sym->is_forced_local()))
 	unhashed_dynsyms.push_back(sym);
       else
-	{
-	  hashed_dynsyms.push_back(sym);
-	  dynsym_hashvals.push_back(Dynobj::gnu_hash(sym->name()));
-	}
+	hashed_dynsyms.push_back(sym);
     }
 
+  Dynobj::hash_dynsym_names(hashed_dynsyms, Dynobj::gnu_hash,
+			    &dynsym_hashvals);
+
   // Put the unhashed symbols at the start of the global portion of
   // the dynamic symbol table.
   const unsigned int unhashed_count = unhashed_dynsyms.size();
@@ -1226,6 +1701,12 @@ Dynobj::sized_create_gnu_hash_table(
   else
     maskbitslog2 += 2;
 
+  // With --hash-optimize, use a bloom filter twice as large, so that
+  // the dynamic linker can reject more lookups of symbols which are
+  // not defined here without reading the hash chains.
+  if (parameters->options().hash_optimize())
+    ++maskbitslog2;
+
   uint32_t shift1;
   if (size == 32)
     shift1 = 5;
@@ -1241,21 +1722,13 @@ Dynobj::sized_create_gnu_hash_table(
   uint32_t maskwords = 1U << (maskbitslog2 - shift1);
 
   typedef typename elfcpp::Elf_types<size>::Elf_WXword Word;
-  std::vector<Word> bitmask(maskwords);
-  std::vector<uint32_t> counts(bucketcount);
-  std::vector<uint32_t> indx(bucketcount);
   uint32_t symindx = unhashed_dynsym_count;
 
-  // Count the number of times each hash bucket is used.
-  for (unsigned int i = 0; i < nsyms; ++i)
-    ++counts[dynsym_hashvals[i] % bucketcount];
-
-  unsigned int cnt = symindx;
-  for (unsigned int i = 0; i < bucketcount; ++i)
-    {
-      indx[i] = cnt;
-      cnt += counts[i];
-    }
+  // Sort the symbols by bucket.  Each bucket points to the first
+  // symbol in its chain.
+  std::vector<uint32_t> bucket_start;
+  std::vector<uint32_t> order;
+  Dynobj::sort_by_bucket(dynsym_hashvals, bucketcount, &bucket_start, &order);
 
   unsigned int hashlen = (4 + bucketcount + nsyms) * 4;
   hashlen += maskbits / 8;
@@ -1269,36 +1742,22 @@ Dynobj::sized_create_gnu_hash_table(
   unsigned char* p = phash + 16 + maskbits / 8;
   for (unsigned int i = 0; i < bucketcount; ++i)
     {
-      if (counts[i] == 0)
+      if (bucket_start[i] == bucket_start[i + 1])
 	elfcpp::Swap<32, big_endian>::writeval(p, 0);
       else
-	elfcpp::Swap<32, big_endian>::writeval(p, indx[i]);
+	elfcpp::Swap<32, big_endian>::writeval(p, symindx + bucket_start[i]);
       p += 4;
     }
 
-  for (unsigned int i = 0; i < nsyms; ++i)
-    {
-      Symbol* sym = hashed_dynsyms[i];
-      uint32_t hashval = dynsym_hashvals[i];
-
-      unsigned int bucket = hashval % bucketcount;
-      unsigned int val = ((hashval >> shift1)
-			  & ((maskbits >> shift1) - 1));
-      bitmask[val] |= (static_cast<Word>(1U)) << (hashval & mask);
-      bitmask[val] |= (static_cast<Word>(1U)) << ((hashval >> shift2) & mask);
-      val = hashval & ~ 1U;
-      if (counts[bucket] == 1)
-	{
-	  // Last element terminates the chain.
-	  val |= 1;
-	}
-      elfcpp::Swap<32, big_endian>::writeval(p + (indx[bucket] - symindx) * 4,
-					     val);
-      --counts[bucket];
+  const unsigned int pieces = hash_piece_count(nsyms);
+  Gnu_hash_fill_job<size, big_endian> job(hashed_dynsyms, dynsym_hashvals,
+					  bucket_start, order, symindx,
+					  shift1, shift2, maskwords, p,
+					  pieces);
+  job.run(pieces);
 
-      sym->set_dynsym_index(indx[bucket]);
-      ++indx[bucket];
-    }
+  std::vector<Word> bitmask;
+  job.merge_bitmask(&bitmask);
 
   p = phash + 16;
   for (unsigned int i = 0; i < maskwords; ++i)
@@ -1307,6 +1766,25 @@ Dynobj::sized_create_gnu_hash_table(
       p += size / 8;
     }
 
+  if (parameters->options().stats())
+    {
+      // Measure lookups of names which are not here by appending a
+      // character to each name, and checking them against the bloom
+      // filter as the dynamic linker does.
+      std::vector<uint32_t> miss_hashvals(nsyms);
+      std::vector<bool> miss_passed(nsyms);
+      for (unsigned int i = 0; i < nsyms; ++i)
+	{
+	  uint32_t h = (dynsym_hashvals[i] << 5) + dynsym_hashvals[i] + '.';
+	  Word w = bitmask[(h >> shift1) & (maskwords - 1)];
+	  miss_hashvals[i] = h;
+	  miss_passed[i] = (((w >> (h & mask)) & 1) != 0
+			    && ((w >> ((h >> shift2) & mask)) & 1) != 0);
+	}
+      Dynobj::record_hash_table_stats(&Dynobj::gnu_hash_stats, bucket_start,
+				      miss_hashvals, &miss_passed, maskbits);
+    }
+
   *phashlen = hashlen;
   *pphash = phash;
 }
@@ -1546,6 +2024,18 @@ Versions::record_version(const Symbol_table* symtab,
     }
 }
 
+// Record that the output needs version VERSION of DYNOBJ.
+
+void
+Versions::add_version_need(Stringpool* dynpool, const Dynobj* dynobj,
+			   const char* version)
+{
+  gold_assert(!this->is_finalized_);
+  Stringpool::Key version_key;
+  version = dynpool->add(version, true, &version_key);
+  this->add_need(dynpool, dynobj->soname(), version, version_key);
+}
+
 // We've found a symbol SYM defined in version VERSION.
 
 void
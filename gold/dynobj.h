@@ -105,6 +105,11 @@ class Dynobj : public Object
 			unsigned int local_dynsym_count,
 			unsigned char** pphash, unsigned int* phashlen);
 
+  // Print statistics about the hash tables to stderr.  This is used
+  // for --stats.
+  static void
+  print_stats();
+
  protected:
   // Return a pointer to this object.
   virtual Dynobj*
@@ -131,6 +136,24 @@ class Dynobj : public Object
   compute_bucket_count(const std::vector<uint32_t>& hashcodes,
 		       bool for_gnu_hash_table);
 
+  // Compute the number of hash buckets to use for --hash-optimize.
+  static unsigned int
+  optimize_bucket_count(const std::vector<uint32_t>& hashcodes,
+			bool for_gnu_hash_table);
+
+  // Compute the hash codes of the names of SYMS.
+  static void
+  hash_dynsym_names(const std::vector<Symbol*>& syms,
+		    uint32_t (*hashfn)(const char*),
+		    std::vector<uint32_t>* hashvals);
+
+  // Sort hash codes by bucket.
+  static void
+  sort_by_bucket(const std::vector<uint32_t>& hashvals,
+		 unsigned int bucketcount,
+		 std::vector<uint32_t>* bucket_start,
+		 std::vector<uint32_t>* order);
+
   // Sized version of create_elf_hash_table.
   template<int size, bool big_endian>
   static void
@@ -148,6 +171,40 @@ class Dynobj : public Object
 			      unsigned char** pphash,
 			      unsigned int* phashlen);
 
+  // Statistics about a hash table we created, for --stats.
+  struct Hash_table_stats
+  {
+    // Whether we created this kind of hash table.
+    bool created;
+    // The number of symbols in the table.
+    unsigned int symbols;
+    // The number of buckets.
+    unsigned int buckets;
+    // The number of bits in the bloom filter of a GNU hash table.
+    unsigned int bloom_bits;
+    // The number of chain entries read to look up each symbol once.
+    uint64_t hit_chain_entries;
+    // The number of lookups of names which are not in the table.
+    unsigned int misses;
+    // The number of those which got past the bloom filter.
+    unsigned int miss_bloom_passes;
+    // The number of chain entries read by those lookups.
+    uint64_t miss_chain_entries;
+  };
+
+  // Record statistics about a hash table.
+  static void
+  record_hash_table_stats(Hash_table_stats*,
+			  const std::vector<uint32_t>& bucket_start,
+			  const std::vector<uint32_t>& miss_hashvals,
+			  const std::vector<bool>* miss_passed,
+			  unsigned int bloom_bits);
+
+  // Statistics about the GNU hash table.
+  static Hash_table_stats gnu_hash_stats;
+  // Statistics about the standard ELF hash table.
+  static Hash_table_stats elf_hash_stats;
+
   // Values for the has_unknown_needed_entries_ field.
   enum Unknown_needed
   {
@@ -569,6 +626,11 @@ class Versions
   void
   record_version(const Symbol_table* symtab, Stringpool*, const Symbol* sym);
 
+  // Record that the output needs version VERSION of DYNOBJ, although
+  // no symbol refers to it.
+  void
+  add_version_need(Stringpool*, const Dynobj* dynobj, const char* version);
+
   // Set the version indexes.  DYNSYM_INDEX is the index we should use
   // for the next dynamic symbol.  We add new dynamic symbols to SYMS
   // and return an updated DYNSYM_INDEX.
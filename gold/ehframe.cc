@@ -188,8 +188,7 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
 						&fde_addresses);
 
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
+      this->sort_fde_addresses<size>(&fde_addresses);
 
       typename elfcpp::Elf_types<size>::Elf_Addr output_address;
       output_address = this->address();
@@ -212,6 +211,58 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
   of->write_output_view(off, oview_size, oview);
 }
 
+// Sort FDE_ADDRESSES by PC.  We write out the FDEs grouped by CIE,
+// and within each CIE in input order, and the input sections are
+// normally laid out in input order too.  So the list is normally made
+// up of a small number of long runs which are already sorted, and
+// merging those runs is much cheaper than sorting the whole list.  If
+// the list is not like that, just sort it.
+
+template<int size>
+void
+Eh_frame_hdr::sort_fde_addresses(Fde_addresses<size>* fde_addresses)
+{
+  typedef typename Fde_addresses<size>::iterator iterator;
+  const iterator begin = fde_addresses->begin();
+  const size_t count = fde_addresses->count();
+
+  // Find the start of each sorted run.
+  std::vector<size_t> runs;
+  runs.push_back(0);
+  for (size_t i = 1; i < count; ++i)
+    {
+      if (begin[i].first < begin[i - 1].first)
+	{
+	  runs.push_back(i);
+	  if (runs.size() * 16 > count)
+	    {
+	      std::sort(begin, fde_addresses->end(),
+			Fde_address_compare<size>());
+	      return;
+	    }
+	}
+    }
+  runs.push_back(count);
+
+  // Merge adjacent pairs of runs until there is only one left.
+  while (runs.size() > 2)
+    {
+      std::vector<size_t> merged;
+      size_t i;
+      for (i = 0; i + 2 < runs.size(); i += 2)
+	{
+	  std::inplace_merge(begin + runs[i], begin + runs[i + 1],
+			     begin + runs[i + 2],
+			     Fde_address_compare<size>());
+	  merged.push_back(runs[i]);
+	}
+      if (i + 1 < runs.size())
+	merged.push_back(runs[i]);
+      merged.push_back(count);
+      runs.swap(merged);
+    }
+}
+
 // Given the offset FDE_OFFSET of an FDE in the .eh_frame section, and
 // the contents of the .eh_frame section EH_FRAME_CONTENTS, where the
 // FDE's encoding is FDE_ENCODING, return the output address of the
@@ -602,38 +653,188 @@ Eh_frame::add_ehframe_input_section(
     unsigned int reloc_shndx,
     unsigned int reloc_type)
 {
+  // When running multi-threaded the Read_symbols task has normally
+  // parsed the section already.
+  Parsed_eh_frame* parsed = object->release_parsed_eh_frame(shndx);
+  if (parsed != NULL && parsed->reloc_shndx() != reloc_shndx)
+    {
+      delete parsed;
+      parsed = NULL;
+    }
+  if (parsed == NULL)
+    parsed = Eh_frame::parse_ehframe_input_section(object, symbols,
+						   symbols_size,
+						   symbol_names,
+						   symbol_names_size,
+						   shndx, reloc_shndx,
+						   reloc_type);
+
+  Eh_frame_section_disposition disposition = parsed->disposition();
+  if (disposition == EH_UNRECOGNIZED_SECTION)
+    {
+      if (this->eh_frame_hdr_ != NULL)
+	this->eh_frame_hdr_->found_unrecognized_eh_frame_section();
+    }
+  else if (disposition == EH_OPTIMIZABLE_SECTION)
+    this->add_parsed_ehframe_input_section(object, parsed);
+
+  delete parsed;
+  return disposition;
+}
+
+// Parse input section SHNDX in OBJECT into CIEs and FDEs.  The
+// arguments are as for add_ehframe_input_section.  This only looks at
+// OBJECT, so it may run in any thread which holds the lock on the
+// input file.
+
+template<int size, bool big_endian>
+Parsed_eh_frame*
+Eh_frame::parse_ehframe_input_section(
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type)
+{
+  Parsed_eh_frame* parsed = new Parsed_eh_frame(shndx, reloc_shndx);
+
   // Get the section contents.
   section_size_type contents_len;
   const unsigned char* pcontents = object->section_contents(shndx,
 							    &contents_len,
 							    false);
   if (contents_len == 0)
-    return EH_EMPTY_SECTION;
+    {
+      parsed->set_disposition(EH_EMPTY_SECTION);
+      return parsed;
+    }
 
-  // If this is the marker section for the end of the data, then
-  // return false to force it to be handled as an ordinary input
-  // section.  If we don't do this, we won't correctly handle the case
-  // of unrecognized .eh_frame sections.
+  // If this is the marker section for the end of the data, then it
+  // must be handled as an ordinary input section.  If we don't do
+  // this, we won't correctly handle the case of unrecognized
+  // .eh_frame sections.
   if (contents_len == 4
       && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0)
-    return EH_END_MARKER_SECTION;
+    {
+      parsed->set_disposition(EH_END_MARKER_SECTION);
+      return parsed;
+    }
+
+  if (!Eh_frame::do_parse_ehframe_input_section(object, symbols,
+						symbols_size, symbol_names,
+						symbol_names_size, shndx,
+						reloc_shndx, reloc_type,
+						pcontents, contents_len,
+						parsed))
+    {
+      // Throw away anything we managed to read.
+      delete parsed;
+      return new Parsed_eh_frame(shndx, reloc_shndx);
+    }
+
+  parsed->set_disposition(EH_OPTIMIZABLE_SECTION);
+  return parsed;
+}
+
+// Add a section parsed by parse_ehframe_input_section.  This is where
+// we look at the rest of the link: we merge the CIEs with the ones we
+// have seen in earlier input sections, and discard the FDEs which
+// describe discarded sections.  This is done in input order, so the
+// output does not depend on the order in which the sections were
+// parsed.
+
+template<int size, bool big_endian>
+void
+Eh_frame::add_parsed_ehframe_input_section(
+    Sized_relobj_file<size, big_endian>* object,
+    Parsed_eh_frame* parsed)
+{
+  const unsigned int shndx = parsed->shndx();
+  Parsed_eh_frame::Entries* entries = parsed->entries();
+
+  // The CIE to use for each entry which is a CIE.
+  std::vector<Cie*> cies(entries->size(), NULL);
 
   New_cies new_cies;
-  if (!this->do_add_ehframe_input_section(object, symbols, symbols_size,
-					  symbol_names, symbol_names_size,
-					  shndx, reloc_shndx,
-					  reloc_type, pcontents,
-					  contents_len, &new_cies))
+  for (size_t i = 0; i < entries->size(); ++i)
     {
-      if (this->eh_frame_hdr_ != NULL)
-	this->eh_frame_hdr_->found_unrecognized_eh_frame_section();
+      Parsed_eh_frame::Entry* pe = &(*entries)[i];
 
-      for (New_cies::iterator p = new_cies.begin();
-	   p != new_cies.end();
-	   ++p)
-	delete p->first;
+      if (pe->cie != NULL)
+	{
+	  Cie* cie_pointer = NULL;
+	  if (pe->mergeable)
+	    {
+	      Cie_offsets::iterator find_cie;
+	      find_cie = this->cie_offsets_.find(pe->cie);
+	      if (find_cie != this->cie_offsets_.end())
+		cie_pointer = *find_cie;
+	      else
+		{
+		  // See if we already saw this CIE in this object file.
+		  for (New_cies::const_iterator pc = new_cies.begin();
+		       pc != new_cies.end();
+		       ++pc)
+		    {
+		      if (*(pc->first) == *pe->cie)
+			{
+			  cie_pointer = pc->first;
+			  break;
+			}
+		    }
+		}
+	    }
+
+	  if (cie_pointer == NULL)
+	    {
+	      cie_pointer = pe->cie;
+	      new_cies.push_back(std::make_pair(cie_pointer, pe->mergeable));
+	    }
+	  else
+	    {
+	      // We are deleting this CIE.  Record that in our mapping
+	      // from input sections to the output section.
+	      delete pe->cie;
+	      object->add_merge_mapping(this, shndx, pe->input_offset,
+					pe->length, -1);
+	    }
+	  pe->cie = NULL;
+	  cies[i] = cie_pointer;
+	  continue;
+	}
 
-      return EH_UNRECOGNIZED_SECTION;
+      // Find the section index for code that this FDE describes.
+      // If we have discarded the section, we can also discard the FDE.
+      bool is_discarded = pe->fde == NULL;
+      if (!is_discarded)
+	{
+	  bool is_ordinary;
+	  unsigned int fde_shndx = object->adjust_sym_shndx(pe->symndx,
+							    pe->sym_shndx,
+							    &is_ordinary);
+	  is_discarded = (is_ordinary
+			  && fde_shndx != elfcpp::SHN_UNDEF
+			  && fde_shndx < object->shnum()
+			  && !object->is_section_included(fde_shndx));
+	}
+
+      if (is_discarded)
+	{
+	  // This FDE applies to a discarded function.  We
+	  // can discard this FDE.
+	  delete pe->fde;
+	  object->add_merge_mapping(this, shndx, pe->input_offset,
+				    pe->length, -1);
+	}
+      else
+	{
+	  gold_assert(cies[pe->cie_index] != NULL);
+	  cies[pe->cie_index]->add_fde(pe->fde);
+	}
+      pe->fde = NULL;
     }
 
   // Now that we know we are using this section, record any new CIEs
@@ -647,15 +848,13 @@ Eh_frame::add_ehframe_input_section(
       else
 	this->unmergeable_cie_offsets_.push_back(p->first);
     }
-
-  return EH_OPTIMIZABLE_SECTION;
 }
 
-// The bulk of the implementation of add_ehframe_input_section.
+// The bulk of the implementation of parse_ehframe_input_section.
 
 template<int size, bool big_endian>
 bool
-Eh_frame::do_add_ehframe_input_section(
+Eh_frame::do_parse_ehframe_input_section(
     Sized_relobj_file<size, big_endian>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -666,7 +865,7 @@ Eh_frame::do_add_ehframe_input_section(
     unsigned int reloc_type,
     const unsigned char* pcontents,
     section_size_type contents_len,
-    New_cies* new_cies)
+    Parsed_eh_frame* parsed)
 {
   Track_relocs<size, big_endian> relocs;
 
@@ -718,17 +917,18 @@ Eh_frame::do_add_ehframe_input_section(
       if (id == 0)
 	{
 	  // CIE.
-	  if (!this->read_cie(object, shndx, symbols, symbols_size,
-			      symbol_names, symbol_names_size,
-			      pcontents, p, pentend, &relocs, &cies,
-			      new_cies))
+	  if (!Eh_frame::read_cie(object, shndx, symbols, symbols_size,
+				  symbol_names, symbol_names_size,
+				  pcontents, p, pentend, &relocs, &cies,
+				  parsed))
 	    return false;
 	}
       else
 	{
 	  // FDE.
-	  if (!this->read_fde(object, shndx, symbols, symbols_size,
-			      pcontents, id, p, pentend, &relocs, &cies))
+	  if (!Eh_frame::read_fde(object, shndx, symbols, symbols_size,
+				  pcontents, id, p, pentend, &relocs, &cies,
+				  parsed))
 	    return false;
 	}
 
@@ -753,7 +953,7 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pcieend,
 		   Track_relocs<size, big_endian>* relocs,
 		   Offsets_to_cie* cies,
-		   New_cies* new_cies)
+		   Parsed_eh_frame* parsed)
 {
   bool mergeable = true;
 
@@ -946,48 +1146,23 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
   if (relocs->advance(pcieend - pcontents) > 0)
     return false;
 
-  Cie cie(object, shndx, (pcie - 8) - pcontents, fde_encoding, 
-	  personality_name, pcie, pcieend - pcie);
-  Cie* cie_pointer = NULL;
-  if (mergeable)
-    {
-      Cie_offsets::iterator find_cie = this->cie_offsets_.find(&cie);
-      if (find_cie != this->cie_offsets_.end())
-	cie_pointer = *find_cie;
-      else
-	{
-	  // See if we already saw this CIE in this object file.
-	  for (New_cies::const_iterator pc = new_cies->begin();
-	       pc != new_cies->end();
-	       ++pc)
-	    {
-	      if (*(pc->first) == cie)
-		{
-		  cie_pointer = pc->first;
-		  break;
-		}
-	    }
-	}
-    }
-
-  if (cie_pointer == NULL)
-    {
-      cie_pointer = new Cie(cie);
-      new_cies->push_back(std::make_pair(cie_pointer, mergeable));
-    }
-  else
-    {
-      // We are deleting this CIE.  Record that in our mapping from
-      // input sections to the output section.  At this point we don't
-      // know for sure that we are doing a special mapping for this
-      // input section, but that's OK--if we don't do a special
-      // mapping, nobody will ever ask for the mapping we add here.
-      object->add_merge_mapping(this, shndx, (pcie - 8) - pcontents,
-                                pcieend - (pcie - 8), -1);
-    }
+  // Whether this CIE is merged with another one is decided when the
+  // section is added to the output.
+  Parsed_eh_frame::Entries* entries = parsed->entries();
+  Parsed_eh_frame::Entry entry;
+  entry.cie = new Cie(object, shndx, (pcie - 8) - pcontents, fde_encoding,
+		      personality_name, pcie, pcieend - pcie);
+  entry.fde = NULL;
+  entry.mergeable = mergeable;
+  entry.cie_index = 0;
+  entry.symndx = 0;
+  entry.sym_shndx = 0;
+  entry.input_offset = (pcie - 8) - pcontents;
+  entry.length = pcieend - (pcie - 8);
 
   // Record this CIE plus the offset in the input section.
-  cies->insert(std::make_pair(pcie - pcontents, cie_pointer));
+  cies->insert(std::make_pair(pcie - pcontents, entries->size()));
+  entries->push_back(entry);
 
   return true;
 }
@@ -1005,7 +1180,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pfde,
 		   const unsigned char* pfdeend,
 		   Track_relocs<size, big_endian>* relocs,
-		   Offsets_to_cie* cies)
+		   Offsets_to_cie* cies,
+		   Parsed_eh_frame* parsed)
 {
   // OFFSET is the distance between the 4 bytes before PFDE to the
   // start of the CIE.  The offset we recorded for the CIE is 8 bytes
@@ -1014,7 +1190,18 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   Offsets_to_cie::const_iterator pcie = cies->find(cie_offset);
   if (pcie == cies->end())
     return false;
-  Cie* cie = pcie->second;
+  Parsed_eh_frame::Entries* entries = parsed->entries();
+  const Cie* cie = (*entries)[pcie->second].cie;
+
+  Parsed_eh_frame::Entry entry;
+  entry.cie = NULL;
+  entry.fde = NULL;
+  entry.mergeable = false;
+  entry.cie_index = pcie->second;
+  entry.symndx = 0;
+  entry.sym_shndx = 0;
+  entry.input_offset = (pfde - 8) - pcontents;
+  entry.length = pfdeend - (pfde - 8);
 
   int pc_size = 0;
   switch (cie->fde_encoding() & 7)
@@ -1070,8 +1257,7 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 	{
 	  // This FDE applies to a discarded function.  We
 	  // can discard this FDE.
-	  object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-				    pfdeend - (pfde - 8), -1);
+	  entries->push_back(entry);
 	  return true;
 	}
 
@@ -1089,20 +1275,14 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   // pointer to a PC relative offset when generating a shared library.
   relocs->advance(pfdeend - pcontents);
 
-  // Find the section index for code that this FDE describes.
-  // If we have discarded the section, we can also discard the FDE.
-  unsigned int fde_shndx;
+  // Whether the code that this FDE describes has been discarded is
+  // decided when the section is added to the output.
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
   if (symndx >= symbols_size / sym_size)
     return false;
   elfcpp::Sym<size, big_endian> sym(symbols + symndx * sym_size);
-  bool is_ordinary;
-  fde_shndx = object->adjust_sym_shndx(symndx, sym.get_st_shndx(),
-				       &is_ordinary);
-  bool is_discarded = (is_ordinary
-		       && fde_shndx != elfcpp::SHN_UNDEF
-		       && fde_shndx < object->shnum()
-		       && !object->is_section_included(fde_shndx));
+  entry.symndx = symndx;
+  entry.sym_shndx = sym.get_st_shndx();
 
   // Fetch the address range field from the FDE. The offset and size
   // of the field depends on the PC encoding given in the CIE, but
@@ -1125,17 +1305,11 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
       gold_unreachable();
     }
 
-  if (is_discarded || address_range == 0)
-    {
-      // This FDE applies to a discarded function.  We
-      // can discard this FDE.
-      object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-                                pfdeend - (pfde - 8), -1);
-      return true;
-    }
-
-  cie->add_fde(new Fde(object, shndx, (pfde - 8) - pcontents,
-		       pfde, pfdeend - pfde));
+  // If the address range is 0 we can discard this FDE.
+  if (address_range != 0)
+    entry.fde = new Fde(object, shndx, (pfde - 8) - pcontents,
+			pfde, pfdeend - pfde);
+  entries->push_back(entry);
 
   return true;
 }
@@ -1329,6 +1503,21 @@ Eh_frame::do_sized_write(unsigned char* oview)
 					  this->eh_frame_hdr_);
 }
 
+// Class Parsed_eh_frame.
+
+// Delete the CIEs and FDEs which were not added to the output.
+
+Parsed_eh_frame::~Parsed_eh_frame()
+{
+  for (Entries::iterator p = this->entries_.begin();
+       p != this->entries_.end();
+       ++p)
+    {
+      delete p->cie;
+      delete p->fde;
+    }
+}
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 Eh_frame::Eh_frame_section_disposition
@@ -1341,6 +1530,18 @@ Eh_frame::add_ehframe_input_section<32, false>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame*
+Eh_frame::parse_ehframe_input_section<32, false>(
+    Sized_relobj_file<32, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
@@ -1355,6 +1556,18 @@ Eh_frame::add_ehframe_input_section<32, true>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame*
+Eh_frame::parse_ehframe_input_section<32, true>(
+    Sized_relobj_file<32, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
@@ -1369,6 +1582,18 @@ Eh_frame::add_ehframe_input_section<64, false>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame*
+Eh_frame::parse_ehframe_input_section<64, false>(
+    Sized_relobj_file<64, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
@@ -1383,6 +1608,18 @@ Eh_frame::add_ehframe_input_section<64, true>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame*
+Eh_frame::parse_ehframe_input_section<64, true>(
+    Sized_relobj_file<64, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 } // End namespace gold.
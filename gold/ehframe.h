@@ -37,6 +37,7 @@ template<int size, bool big_endian>
 class Track_relocs;
 
 class Eh_frame;
+class Parsed_eh_frame;
 
 // This class manages the .eh_frame_hdr section, which holds the data
 // for the PT_GNU_EH_FRAME segment.  gcc's unwind support code uses
@@ -120,6 +121,10 @@ class Eh_frame_hdr : public Output_section_data
     end()
     { return this->fde_addresses_.end(); }
 
+    size_t
+    count() const
+    { return this->fde_addresses_.size(); }
+
    private:
     Fde_address_list fde_addresses_;
   };
@@ -148,6 +153,11 @@ class Eh_frame_hdr : public Output_section_data
 		    const Fde_offsets* fde_offsets,
 		    Fde_addresses<size>* fde_addresses);
 
+  // Sort Fde_addresses by PC.
+  template<int size>
+  static void
+  sort_fde_addresses(Fde_addresses<size>* fde_addresses);
+
   // The .eh_frame section.
   Output_section* eh_frame_section_;
   // The .eh_frame section data.
@@ -402,6 +412,22 @@ class Eh_frame : public Output_section_data
 			    unsigned int shndx, unsigned int reloc_shndx,
 			    unsigned int reloc_type);
 
+  // Parse the input section SHNDX in OBJECT, without adding it to the
+  // output.  The arguments are as for add_ehframe_input_section.
+  // This does not look at any other input file or at the output, so
+  // it may be called for several objects at once; when running
+  // multi-threaded it is called by the Read_symbols task.  The caller
+  // owns the result.
+  template<int size, bool big_endian>
+  static Parsed_eh_frame*
+  parse_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+			      const unsigned char* symbols,
+			      section_size_type symbols_size,
+			      const unsigned char* symbol_names,
+			      section_size_type symbol_names_size,
+			      unsigned int shndx, unsigned int reloc_shndx,
+			      unsigned int reloc_type);
+
   // Add a CIE and an FDE for a PLT section, to permit unwinding
   // through a PLT.  The FDE data should start with 8 bytes of zero,
   // which will be replaced by a 4 byte PC relative reference to the
@@ -457,9 +483,9 @@ class Eh_frame : public Output_section_data
   // A list of unmergeable CIEs.
   typedef std::vector<Cie*> Unmergeable_cie_offsets;
 
-  // A mapping from offsets to CIEs.  This is used while reading an
-  // input section.
-  typedef std::map<uint64_t, Cie*> Offsets_to_cie;
+  // A mapping from offsets to the index of the CIE in the list of
+  // parsed entries.  This is used while reading an input section.
+  typedef std::map<uint64_t, unsigned int> Offsets_to_cie;
 
   // A list of CIEs, and a bool indicating whether the CIE is
   // mergeable.
@@ -469,24 +495,24 @@ class Eh_frame : public Output_section_data
   static bool
   skip_leb128(const unsigned char**, const unsigned char*);
 
-  // The implementation of add_ehframe_input_section.
+  // The implementation of parse_ehframe_input_section.
   template<int size, bool big_endian>
-  bool
-  do_add_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
-			       const unsigned char* symbols,
-			       section_size_type symbols_size,
-			       const unsigned char* symbol_names,
-			       section_size_type symbol_names_size,
-			       unsigned int shndx,
-			       unsigned int reloc_shndx,
-			       unsigned int reloc_type,
-			       const unsigned char* pcontents,
-			       section_size_type contents_len,
-			       New_cies*);
+  static bool
+  do_parse_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+				 const unsigned char* symbols,
+				 section_size_type symbols_size,
+				 const unsigned char* symbol_names,
+				 section_size_type symbol_names_size,
+				 unsigned int shndx,
+				 unsigned int reloc_shndx,
+				 unsigned int reloc_type,
+				 const unsigned char* pcontents,
+				 section_size_type contents_len,
+				 Parsed_eh_frame*);
 
   // Read a CIE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_cie(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -498,11 +524,11 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pcieend,
 	   Track_relocs<size, big_endian>* relocs,
 	   Offsets_to_cie* cies,
-	   New_cies* new_cies);
+	   Parsed_eh_frame* parsed);
 
   // Read an FDE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_fde(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -512,7 +538,15 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pfde,
 	   const unsigned char* pfdeend,
 	   Track_relocs<size, big_endian>* relocs,
-	   Offsets_to_cie* cies);
+	   Offsets_to_cie* cies,
+	   Parsed_eh_frame* parsed);
+
+  // Add a parsed input section: merge its CIEs with the ones we
+  // already have, and discard the FDEs for discarded sections.
+  template<int size, bool big_endian>
+  void
+  add_parsed_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+				   Parsed_eh_frame* parsed);
 
   // Template version of write function.
   template<int size, bool big_endian>
@@ -534,6 +568,86 @@ class Eh_frame : public Output_section_data
   section_size_type final_data_size_;
 };
 
+// The result of parsing an input .eh_frame section.  Parsing an input
+// section does not depend on the rest of the link, so when running
+// multi-threaded it is done in parallel by the Read_symbols tasks.
+// Eh_frame::add_ehframe_input_section, which runs in the Layout task,
+// then only has to merge the CIEs and decide which FDEs to keep.
+
+class Parsed_eh_frame
+{
+ public:
+  // One CIE or FDE, in the order in which they appear in the input
+  // section.
+  struct Entry
+  {
+    // The CIE, or NULL if this is an FDE.
+    Cie* cie;
+    // The FDE, or NULL if this is a CIE or an FDE which is always
+    // discarded.
+    Fde* fde;
+    // For a CIE, whether it may be merged with other CIEs.
+    bool mergeable;
+    // For an FDE, the index in the list of entries of its CIE.
+    unsigned int cie_index;
+    // For an FDE, the symbol index of the code which it describes, and
+    // the section index from that symbol as found in the symbol table.
+    unsigned int symndx;
+    unsigned int sym_shndx;
+    // The offset within the input section of the start of the entry,
+    // and the length of the entry, including the length word.
+    section_offset_type input_offset;
+    section_size_type length;
+  };
+
+  typedef std::vector<Entry> Entries;
+
+  Parsed_eh_frame(unsigned int shndx, unsigned int reloc_shndx)
+    : shndx_(shndx), reloc_shndx_(reloc_shndx),
+      disposition_(Eh_frame::EH_UNRECOGNIZED_SECTION), entries_()
+  { }
+
+  ~Parsed_eh_frame();
+
+  // The input section index.
+  unsigned int
+  shndx() const
+  { return this->shndx_; }
+
+  // The reloc section index used when parsing.
+  unsigned int
+  reloc_shndx() const
+  { return this->reloc_shndx_; }
+
+  // What to do with the input section.
+  Eh_frame::Eh_frame_section_disposition
+  disposition() const
+  { return this->disposition_; }
+
+  void
+  set_disposition(Eh_frame::Eh_frame_section_disposition disposition)
+  { this->disposition_ = disposition; }
+
+  // The CIEs and FDEs.  Eh_frame takes ownership of the CIEs and FDEs
+  // which it keeps, and clears the pointers in the entries.
+  Entries*
+  entries()
+  { return &this->entries_; }
+
+ private:
+  Parsed_eh_frame(const Parsed_eh_frame&);
+  Parsed_eh_frame& operator=(const Parsed_eh_frame&);
+
+  // The input section index.
+  unsigned int shndx_;
+  // The reloc section index used when parsing.
+  unsigned int reloc_shndx_;
+  // What to do with the input section.
+  Eh_frame::Eh_frame_section_disposition disposition_;
+  // The CIEs and FDEs in the section.
+  Entries entries_;
+};
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_EHFRAME_H)
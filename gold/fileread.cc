@@ -25,6 +25,7 @@
 #include <cstring>
 #include <cerrno>
 #include <climits>
+#include <algorithm>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -47,6 +48,7 @@
 #include "binary.h"
 #include "descriptors.h"
 #include "gold-threads.h"
+#include "timer.h"
 #include "fileread.h"
 
 // For systems without mmap support.
@@ -83,6 +85,20 @@ gold_munmap(void *, size_t)
 
 #endif
 
+// For systems without posix_fadvise, read-ahead does nothing.
+#ifndef HAVE_POSIX_FADVISE
+# define posix_fadvise gold_posix_fadvise
+# ifndef POSIX_FADV_WILLNEED
+#  define POSIX_FADV_WILLNEED 0
+# endif
+
+static int
+gold_posix_fadvise(int, off_t, off_t, int)
+{
+  return ENOSYS;
+}
+#endif
+
 #ifndef HAVE_READV
 struct iovec { void* iov_base; size_t iov_len; };
 ssize_t
@@ -124,6 +140,8 @@ static Initialize_lock file_counts_initialize_lock(&file_counts_lock);
 unsigned long long File_read::total_mapped_bytes;
 unsigned long long File_read::current_mapped_bytes;
 unsigned long long File_read::maximum_mapped_bytes;
+unsigned long long File_read::readahead_requests;
+unsigned long long File_read::readahead_bytes;
 
 // Class File_read::View.
 
@@ -392,6 +410,9 @@ File_read::do_read(off_t start, section_size_type size, void* p)
     {
       this->reopen_descriptor();
 
+      Timer* timer = parameters->timer();
+      uint64_t start_usec = timer != NULL ? Timer::wall_time_usec() : 0;
+
       char *read_ptr = static_cast<char *>(p);
       off_t read_pos = start;
       size_t to_read = size;
@@ -405,10 +426,14 @@ File_read::do_read(off_t start, section_size_type size, void* p)
 	  read_pos += bytes;
 	  read_ptr += bytes;
 	  to_read -= bytes;
-	  if (to_read == 0)
-	    return;
 	}
-      while (bytes > 0);
+      while (to_read > 0 && bytes > 0);
+
+      if (timer != NULL)
+	Timer::add_io_wait(Timer::wall_time_usec() - start_usec);
+
+      if (to_read == 0)
+	return;
 
       bytes = size - to_read;
     }
@@ -425,6 +450,7 @@ File_read::do_read(off_t start, section_size_type size, void* p)
 void
 File_read::read(off_t start, section_size_type size, void* p)
 {
+  Hold_optional_lock hl(this->view_lock_);
   const File_read::View* pv = this->find_view(start, size, -1U, NULL);
   if (pv != NULL)
     {
@@ -615,6 +641,7 @@ const unsigned char*
 File_read::get_view(off_t offset, off_t start, section_size_type size,
 		    bool aligned, bool cache)
 {
+  Hold_optional_lock hl(this->view_lock_);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   return pv->data() + (offset + start - pv->start() + pv->byteshift());
@@ -624,6 +651,7 @@ File_view*
 File_read::get_lasting_view(off_t offset, off_t start, section_size_type size,
 			    bool aligned, bool cache)
 {
+  Hold_optional_lock hl(this->view_lock_);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   pv->lock();
@@ -679,8 +707,14 @@ File_read::do_readv(off_t base, const Read_multiple& rm, size_t start,
     gold_fatal(_("%s: lseek failed: %s"),
 	       this->filename().c_str(), strerror(errno));
 
+  Timer* timer = parameters->timer();
+  uint64_t start_usec = timer != NULL ? Timer::wall_time_usec() : 0;
+
   ssize_t got = ::readv(this->descriptor_, iov, iov_index);
 
+  if (timer != NULL)
+    Timer::add_io_wait(Timer::wall_time_usec() - start_usec);
+
   if (got < 0)
     gold_fatal(_("%s: readv failed: %s"),
 	       this->filename().c_str(), strerror(errno));
@@ -762,6 +796,79 @@ File_read::read_multiple(off_t base, const Read_multiple& rm)
     }
 }
 
+// Sort read-ahead entries by file offset.
+
+struct Readahead_entry_compare
+{
+  bool
+  operator()(const File_read::Readahead_entry& e1,
+	     const File_read::Readahead_entry& e2) const
+  { return e1.file_offset < e2.file_offset; }
+};
+
+// Ask the system to start reading data which we will need soon.  When
+// the file is mapped, this means that the page faults when we get to
+// the data will not wait for the disk.  This uses posix_fadvise, which
+// queues the reads in the kernel and returns immediately.
+
+void
+File_read::readahead(off_t base, Readahead* ra)
+{
+  // There is nothing to do if the contents were provided in memory.
+  if (ra->empty()
+      || (this->whole_file_view_ != NULL
+	  && this->whole_file_view_->is_permanent_view()))
+    return;
+
+  std::sort(ra->begin(), ra->end(), Readahead_entry_compare());
+
+  this->reopen_descriptor();
+
+  unsigned long long requests = 0;
+  unsigned long long bytes = 0;
+  off_t limit = this->size_ - base;
+  Readahead::const_iterator p = ra->begin();
+  while (p != ra->end())
+    {
+      // Ignore entries outside the file; they will be diagnosed when
+      // we try to read them.
+      if (p->file_offset < 0
+	  || p->file_offset > limit
+	  || static_cast<off_t>(p->size) > limit - p->file_offset)
+	{
+	  ++p;
+	  continue;
+	}
+
+      off_t start = p->file_offset;
+      off_t end = start + p->size;
+      for (++p; p != ra->end(); ++p)
+	{
+	  if (p->file_offset > end + File_read::readahead_gap
+	      || p->file_offset > limit
+	      || static_cast<off_t>(p->size) > limit - p->file_offset)
+	    break;
+	  end = std::max(end, static_cast<off_t>(p->file_offset + p->size));
+	}
+
+      if (end > start
+	  && ::posix_fadvise(this->descriptor_, base + start, end - start,
+			     POSIX_FADV_WILLNEED) == 0)
+	{
+	  ++requests;
+	  bytes += end - start;
+	}
+    }
+
+  if (parameters->options().stats())
+    {
+      file_counts_initialize_lock.initialize();
+      Hold_optional_lock hl(file_counts_lock);
+      File_read::readahead_requests += requests;
+      File_read::readahead_bytes += bytes;
+    }
+}
+
 // Mark all views as no longer cached.
 
 void
@@ -856,6 +963,10 @@ File_read::print_stats()
 	  program_name, File_read::total_mapped_bytes);
   fprintf(stderr, _("%s: maximum bytes mapped for read at one time: %llu\n"),
 	  program_name, File_read::maximum_mapped_bytes);
+  fprintf(stderr, _("%s: read-ahead requests: %llu\n"),
+	  program_name, File_read::readahead_requests);
+  fprintf(stderr, _("%s: total bytes requested for read-ahead: %llu\n"),
+	  program_name, File_read::readahead_bytes);
 }
 
 // Class File_view.
@@ -863,6 +974,7 @@ File_read::print_stats()
 File_view::~File_view()
 {
   gold_assert(this->file_.is_locked());
+  Hold_optional_lock hl(this->file_.view_lock_);
   this->view_->unlock();
 }
 
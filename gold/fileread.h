@@ -58,6 +58,7 @@ struct Timespec
 bool
 get_mtime(const char* filename, Timespec* mtime);
 
+class Lock;
 class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
@@ -72,7 +73,7 @@ class File_read
   File_read()
     : name_(), descriptor_(-1), is_descriptor_opened_(false), object_count_(0),
       size_(0), token_(false), views_(), saved_views_(), mapped_bytes_(0),
-      released_(true), whole_file_view_(NULL)
+      released_(true), whole_file_view_(NULL), view_lock_(NULL)
   { }
 
   ~File_read();
@@ -172,6 +173,13 @@ class File_read
   void
   clear_view_cache_marks();
 
+  // While LOCK is not NULL, get_view, read and get_lasting_view hold
+  // it, so that several threads working for the Task which locked
+  // the file may fetch views at once.  The caller owns LOCK.
+  void
+  set_view_lock(Lock* lock)
+  { this->view_lock_ = lock; }
+
   // Discard all uncached views.  This is normally done by release(),
   // but not for objects in archives.  FIXME: This is a complicated
   // interface, and it would be nice to have something more automatic.
@@ -203,6 +211,29 @@ class File_read
   void
   read_multiple(off_t base, const Read_multiple&);
 
+  // A struct used to describe data which will be read soon.
+  struct Readahead_entry
+  {
+    // The file offset of the data.
+    off_t file_offset;
+    // The amount of data.
+    section_size_type size;
+
+    Readahead_entry(off_t o, section_size_type s)
+      : file_offset(o), size(s)
+    { }
+  };
+
+  typedef std::vector<Readahead_entry> Readahead;
+
+  // Tell the system that we are going to read the data described by
+  // the vector soon, so that it can start reading it in the
+  // background.  This does not wait for the data.  BASE is a base
+  // offset to be added to all the offsets in the vector.  The vector
+  // is sorted, and nearby entries are merged into a single request.
+  void
+  readahead(off_t base, Readahead*);
+
   // Dump statistical information to stderr.
   static void
   print_stats();
@@ -247,6 +278,13 @@ class File_read
   // --stats.
   static unsigned long long maximum_mapped_bytes;
 
+  // Number of read-ahead requests made during the link if --stats.
+  static unsigned long long readahead_requests;
+
+  // Total bytes covered by read-ahead requests during the link if
+  // --stats.
+  static unsigned long long readahead_bytes;
+
   // A view into the file.
   class View
   {
@@ -408,6 +446,10 @@ class File_read
   // The maximum number of entries we will pass to ::readv.
   static const size_t max_readv_entries = 128;
 
+  // Read-ahead entries which are less than this far apart are merged
+  // into a single request.
+  static const off_t readahead_gap = 16 * page_size;
+
   // Use readv to read data.
   void
   do_readv(off_t base, const Read_multiple&, size_t start, size_t count);
@@ -442,6 +484,8 @@ class File_read
   // - The contents was specified in the constructor.  Used only for
   //   testing purposes).
   View* whole_file_view_;
+  // Held while looking up views, if not NULL; see set_view_lock.
+  Lock* view_lock_;
 };
 
 // A view of file data that persists even when the file is unlocked.
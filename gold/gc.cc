@@ -22,46 +22,229 @@
 
 
 #include "gold.h"
+
+#include <algorithm>
+
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
+#include "workqueue.h"
+#include "timer.h"
 
 namespace gold
 {
 
-// Garbage collection uses a worklist style algorithm to determine the 
-// transitive closure of all referenced sections.
-void 
-Garbage_collection::do_transitive_closure()
+// The number of sections a marking task may have in its worklist
+// before it hands half of them to a new task.
+
+static const size_t gc_split_threshold = 1024;
+
+// A task to mark the sections which can be reached from a list of
+// sections.  These tasks run in parallel.
+
+class Gc_mark_task : public Task
+{
+ public:
+  Gc_mark_task(Garbage_collection* gc, Garbage_collection::Mark_list* list,
+	       Task_token* blocker)
+    : gc_(gc), list_(list), blocker_(blocker)
+  { }
+
+  ~Gc_mark_task()
+  { delete this->list_; }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  { this->gc_->mark_sections(workqueue, this->list_, this->blocker_); }
+
+  std::string
+  get_name() const
+  { return "Gc_mark_task"; }
+
+ private:
+  Garbage_collection* gc_;
+  Garbage_collection::Mark_list* list_;
+  Task_token* blocker_;
+};
+
+// This class arranges to finish the closure when all the
+// Gc_mark_tasks are complete.
+
+class Gc_finish_runner : public Task_function_runner
+{
+ public:
+  Gc_finish_runner(Garbage_collection* gc)
+    : gc_(gc)
+  { }
+
+  void
+  run(Workqueue* workqueue, const Task* task)
+  { this->gc_->finish_closure(workqueue, task); }
+
+ private:
+  Garbage_collection* gc_;
+};
+
+// Set the mark for REF, and return true if it was not set before.
+// Several tasks may reach the same section at the same time, so the
+// mark is set with an atomic operation when there is one.
+
+bool
+Garbage_collection::mark(const Section_ref& ref)
+{
+  std::vector<unsigned char>& marks(ref.first->marks);
+  if (ref.second >= marks.size())
+    return false;
+  unsigned char* p = &marks[ref.second];
+  if (*p != 0)
+    return false;
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+  return __sync_bool_compare_and_swap(p, 0, 1);
+#else
+  *p = 1;
+  return true;
+#endif
+}
+
+// Garbage collection uses a worklist style algorithm to determine the
+// transitive closure of all referenced sections.  The sections in the
+// worklist are the roots.  They are marked here, and divided among
+// tasks which mark the sections they reach.
+
+void
+Garbage_collection::do_transitive_closure(Workqueue* workqueue,
+					  Task_function_runner* next)
+{
+  this->start_usec_ = Timer::wall_time_usec();
+  this->next_runner_ = next;
+
+  Mark_list* list = new Mark_list();
+  for (Worklist_type::const_iterator p = this->worklist().begin();
+       p != this->worklist().end();
+       ++p)
+    {
+      Section_ref ref(this->get_object_sections(p->first), p->second);
+      if (mark(ref))
+	list->push_back(ref);
+    }
+  Worklist_type().swap(this->worklist());
+
+  // Without an atomic operation on the marks the tasks may not run in
+  // parallel, so use a single task which never hands off its work.
+  Task_token* blocker = new Task_token(true);
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+  size_t per_task = gc_split_threshold / 2;
+#else
+  size_t per_task = list->size() + 1;
+#endif
+  Mark_list::const_iterator p = list->begin();
+  while (true)
+    {
+      size_t n = std::min(per_task,
+			  static_cast<size_t>(list->end() - p));
+      blocker->add_blocker();
+      workqueue->queue(new Gc_mark_task(this, new Mark_list(p, p + n),
+					blocker));
+      p += n;
+      if (p == list->end())
+	break;
+    }
+  delete list;
+
+  workqueue->queue(new Task_function(new Gc_finish_runner(this),
+				     blocker,
+				     "Task_function Gc_finish_runner"));
+}
+
+// Mark the sections reachable from the sections in LIST.  Each
+// section is added to a worklist by the task which set its mark, so
+// it is scanned exactly once.
+
+void
+Garbage_collection::mark_sections(Workqueue* workqueue, Mark_list* list,
+				  Task_token* blocker)
 {
-  while (!this->worklist().empty())
+  while (!list->empty())
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
-      Section_id entry = this->worklist().back();
-      this->worklist().pop_back();
-      if (!this->referenced_list().insert(entry).second)
-        continue;
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      const Garbage_collection::Sections_reachable &v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::const_iterator it_v =
-               v.begin();
-           it_v != v.end();
-           ++it_v)
-        {
-          // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push_back(*it_v);
-            }
-        }
+      Section_ref entry = list->back();
+      list->pop_back();
+      const std::vector<Mark_list>& refs(entry.first->refs);
+      if (entry.second >= refs.size())
+	continue;
+      const Mark_list& v(refs[entry.second]);
+      for (Mark_list::const_iterator p = v.begin(); p != v.end(); ++p)
+	if (mark(*p))
+	  list->push_back(*p);
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+      if (list->size() > gc_split_threshold)
+	{
+	  // Hand half of the work to a new task.  The new task adds a
+	  // blocker before this task releases its own, so the closure
+	  // can not finish early.
+	  size_t half = list->size() / 2;
+	  Mark_list* split = new Mark_list(list->begin() + half, list->end());
+	  list->resize(half);
+	  workqueue->add_blocker(blocker);
+	  workqueue->queue(new Gc_mark_task(this, split, blocker));
+	}
+#endif
     }
+}
+
+// Called when all the Gc_mark_tasks are complete.
+
+void
+Garbage_collection::finish_closure(Workqueue* workqueue, const Task* task)
+{
+  this->closure_usec_ = Timer::wall_time_usec() - this->start_usec_;
+
+  // The references are not needed any more.
+  this->num_reached_ = 0;
+  for (Object_sections_map::iterator p = this->object_sections_.begin();
+       p != this->object_sections_.end();
+       ++p)
+    {
+      std::vector<Mark_list>().swap(p->second.refs);
+      const std::vector<unsigned char>& marks(p->second.marks);
+      for (size_t i = 0; i < marks.size(); ++i)
+	if (marks[i] != 0)
+	  ++this->num_reached_;
+    }
+
   this->worklist_ready();
+
+  // Continue the link.
+  Task_function_runner* next = this->next_runner_;
+  this->next_runner_ = NULL;
+  next->run(workqueue, task);
+  delete next;
+}
+
+// Print statistics about garbage collection to stderr.
+
+void
+Garbage_collection::print_stats() const
+{
+  if (!this->is_worklist_ready_)
+    return;
+
+  fprintf(stderr, _("%s: GC sections reached: %u in %zu objects\n"),
+	  program_name, this->num_reached_, this->object_sections_.size());
+  fprintf(stderr, _("%s: GC closure time: %llu.%06llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(this->closure_usec_ / 1000000),
+	  static_cast<unsigned long long>(this->closure_usec_ % 1000000));
 }
 
 } // End namespace gold.
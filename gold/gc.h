@@ -41,33 +41,61 @@ class Sized_relobj_file;
 class Output_section;
 class General_options;
 class Layout;
+class Task_function_runner;
+class Task_token;
+class Workqueue;
+
+// Garbage collection records the references between input sections
+// while the relocs are processed, and then marks every section which
+// can be reached from the roots in the worklist.  The marking runs in
+// parallel tasks which each own a worklist; a task whose worklist
+// grows hands half of it to a new task.  Each section has a mark byte
+// which is set with an atomic operation, so every section is visited
+// exactly once and the result does not depend on the order in which
+// the tasks run.
 
 class Garbage_collection
 {
  public:
 
   typedef Unordered_set<Section_id, Section_id_hash> Sections_reachable;
-  typedef std::map<Section_id, Sections_reachable> Section_ref;
   typedef std::vector<Section_id> Worklist_type;
   // This maps the name of the section which can be represented as a C
   // identifier (cident) to the list of sections that have that name.
   // Different object files can have cident sections with the same name.
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
 
+  struct Object_sections;
+
+  // A reference to a section: the data for its object, and its index.
+  typedef std::pair<Object_sections*, unsigned int> Section_ref;
+
+  // A list of sections to be marked.
+  typedef std::vector<Section_ref> Mark_list;
+
+  // The references and marks for the sections of one object.
+  struct Object_sections
+  {
+    Object_sections()
+      : refs(), marks()
+    { }
+
+    // The sections referenced by each section, indexed by section
+    // index.  This is empty if no section refers to anything.
+    std::vector<Mark_list> refs;
+    // Nonzero for each section which has been reached.
+    std::vector<unsigned char> marks;
+  };
+
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : work_list_(), is_worklist_ready_(false), object_sections_(),
+    last_object_(NULL), last_sections_(NULL), cident_sections_(),
+    next_runner_(NULL), start_usec_(0), closure_usec_(0),
+    num_reached_(0)
   { }
 
   // Accessor methods for the private members.
 
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
-
-  Section_ref&
-  section_reloc_map()
-  { return this->section_reloc_map_; }
-
   Worklist_type&
   worklist()
   { return this->work_list_; }
@@ -80,13 +108,33 @@ class Garbage_collection
   worklist_ready()
   { this->is_worklist_ready_ = true; }
 
+  // Mark all the sections which can be reached from the worklist.
+  // This queues tasks on WORKQUEUE; when they are done, it runs NEXT
+  // and deletes it.
   void
-  do_transitive_closure();
+  do_transitive_closure(Workqueue* workqueue, Task_function_runner* next);
+
+  // Mark the sections reachable from the sections in LIST, which have
+  // already been marked.  This is called by the marking tasks, which
+  // unblock BLOCKER.  If LIST grows, part of it is handed to a new
+  // task.
+  void
+  mark_sections(Workqueue* workqueue, Mark_list* list, Task_token* blocker);
+
+  // Called when all the marking tasks are done.  Run the next
+  // function.
+  void
+  finish_closure(Workqueue* workqueue, const Task* task);
 
   bool
-  is_section_garbage(Relobj* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  is_section_garbage(Relobj* obj, unsigned int shndx) const
+  {
+    Object_sections_map::const_iterator p = this->object_sections_.find(obj);
+    if (p == this->object_sections_.end())
+      return true;
+    const std::vector<unsigned char>& marks(p->second.marks);
+    return shndx >= marks.size() || marks[shndx] == 0;
+  }
 
   Cident_section_map*
   cident_sections()
@@ -95,7 +143,10 @@ class Garbage_collection
   void
   add_cident_section(std::string section_name,
 		     Section_id secn)
-  { this->cident_sections_[section_name].insert(secn); }
+  {
+    this->cident_sections_[section_name].insert(secn);
+    this->get_object_sections(secn.first);
+  }
 
   // Add a reference from the SRC_SHNDX-th section of SRC_OBJECT to
   // DST_SHNDX-th section of DST_OBJECT.
@@ -103,19 +154,79 @@ class Garbage_collection
   add_reference(Relobj* src_object, unsigned int src_shndx,
 		Relobj* dst_object, unsigned int dst_shndx)
   {
-    Section_id src_id(src_object, src_shndx);
-    Section_id dst_id(dst_object, dst_shndx);
-    Sections_reachable& reachable = this->section_reloc_map_[src_id];
-    reachable.insert(dst_id);
+    Section_ref ref(this->get_object_sections(dst_object), dst_shndx);
+    Mark_list& refs(this->section_refs(src_object, src_shndx));
+    if (refs.empty() || refs.back() != ref)
+      refs.push_back(ref);
+  }
+
+  // Add a reference from the SRC_SHNDX-th section of SRC_OBJECT to
+  // all the sections named by a C identifier, which are in
+  // CIDENT_SECTIONS.  This is used for __start_ and __stop_ symbols.
+  void
+  add_cident_reference(Relobj* src_object, unsigned int src_shndx,
+		       const Sections_reachable& cident_sections)
+  {
+    for (Sections_reachable::const_iterator p = cident_sections.begin();
+	 p != cident_sections.end();
+	 ++p)
+      this->add_reference(src_object, src_shndx, p->first, p->second);
   }
 
+  // Print statistics to stderr.
+  void
+  print_stats() const;
+
  private:
+  // The entries are never removed, so pointers to them remain valid.
+  typedef Unordered_map<const Relobj*, Object_sections> Object_sections_map;
+
+  // Return the data for OBJECT, creating it if needed.
+  Object_sections*
+  get_object_sections(Relobj* object)
+  {
+    if (object == this->last_object_)
+      return this->last_sections_;
+    Object_sections* os = &this->object_sections_[object];
+    if (os->marks.empty())
+      os->marks.resize(object->shnum());
+    this->last_object_ = object;
+    this->last_sections_ = os;
+    return os;
+  }
+
+  // Return the list of sections referenced by section SHNDX of
+  // OBJECT.
+  Mark_list&
+  section_refs(Relobj* object, unsigned int shndx)
+  {
+    Object_sections* os = this->get_object_sections(object);
+    if (os->refs.empty())
+      os->refs.resize(object->shnum());
+    return os->refs[shndx];
+  }
+
+  // Set the mark for REF, and return true if it was not set before.
+  static bool
+  mark(const Section_ref& ref);
 
   Worklist_type work_list_;
   bool is_worklist_ready_;
-  Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
+  // The references and marks for each object.
+  Object_sections_map object_sections_;
+  // A cache for get_object_sections, which is usually called for the
+  // same object many times in a row.
+  const Relobj* last_object_;
+  Object_sections* last_sections_;
   Cident_section_map cident_sections_;
+  // The function to run when the closure is complete.
+  Task_function_runner* next_runner_;
+  // The time when the closure started, and the time it took, in
+  // microseconds.
+  uint64_t start_usec_;
+  uint64_t closure_usec_;
+  // The number of sections which were reached.
+  unsigned int num_reached_;
 };
 
 // Data to pass between successive invocations of do_layout
@@ -357,17 +468,8 @@ gc_process_relocs(
                 symtab->gc()->cident_sections()->find(std::string(cident_section_name));
               if (ele == symtab->gc()->cident_sections()->end())
                 continue;
-	      Section_id src_id(src_obj, src_indx);
-              Garbage_collection::Sections_reachable&
-                v(symtab->gc()->section_reloc_map()[src_id]);
-              Garbage_collection::Sections_reachable& cident_secn(ele->second);
-              for (Garbage_collection::Sections_reachable::iterator it_v
-                     = cident_secn.begin();
-                   it_v != cident_secn.end();
-                   ++it_v)
-                {
-                  v.insert(*it_v);
-                }
+	      symtab->gc()->add_cident_reference(src_obj, src_indx,
+						 ele->second);
             }
         }
     }
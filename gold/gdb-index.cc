@@ -28,6 +28,8 @@
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "int_encoding.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -42,6 +44,17 @@ const int gdb_index_tu_size = 24;
 const int gdb_index_addr_size = 16 + gdb_index_offset_size;
 const int gdb_index_sym_size = 2 * gdb_index_offset_size;
 
+const int debug_names_version = 5;
+
+// The augmentation string of the .debug_names section, which is
+// padded to a multiple of 4 bytes.
+const char debug_names_augmentation[] = "GOLD";
+const int debug_names_augmentation_size = 4;
+
+// The size of the .debug_names header, including the augmentation
+// string.
+const int debug_names_hdr_size = 36 + debug_names_augmentation_size;
+
 // This class manages the hashed symbol table for the .gdb_index section.
 // It is essentially equivalent to the hashtab implementation in libiberty,
 // but is copied into gdb sources and here for compatibility because its
@@ -171,6 +184,273 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+// The results of scanning the .debug_info and .debug_types sections
+// of one object.  The scan runs in a task which holds the lock on the
+// object, and only writes to this class.  The units, address ranges
+// and symbols are numbered within the object, and the numbers are
+// adjusted when they are added to the index.
+
+class Gdb_index_scan
+{
+ public:
+  Gdb_index_scan(Relobj* object)
+    : object_(object), symbols_(NULL), symbols_size_(0), sections_(),
+      comp_units_(), type_units_(), ranges_(), syms_(), names_(),
+      cu_count_(0), cu_nopubnames_count_(0), tu_count_(0),
+      tu_nopubnames_count_(0), cu_pubname_map_(), cu_pubtype_map_(),
+      pubnames_dwinfo_(NULL), pubnames_table_(NULL), pubtypes_table_(NULL),
+      stmt_list_offset_(-1), cant_index_()
+  { }
+
+  ~Gdb_index_scan();
+
+  // Return the object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Record a section to be scanned later.  SYMBOLS is copied, as the
+  // caller will free it.
+  void
+  add_section(bool is_type_unit, const unsigned char* symbols,
+	      off_t symbols_size, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type);
+
+  // Scan the sections recorded by add_section.
+  void
+  scan_sections();
+
+  // Scan a .debug_info or .debug_types section.
+  void
+  scan_section(bool is_type_unit, const unsigned char* symbols,
+	       off_t symbols_size, unsigned int shndx,
+	       unsigned int reloc_shndx, unsigned int reloc_type);
+
+  // Add a compilation unit, and return its index within the object.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(Gdb_index::Comp_unit(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit, and return its index within the object.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(Gdb_index::Type_unit(tu_offset, type_offset,
+						      signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(unsigned int cu_index, Dwarf_range_list* ranges)
+  {
+    this->ranges_.push_back(Gdb_index::Per_cu_range_list(this->object_,
+							  cu_index, ranges));
+  }
+
+  // Add a symbol.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+  {
+    this->syms_.push_back(Scan_symbol(this->names_.size(), cu_index, flags,
+				      0, 0, -1));
+    this->names_.append(sym_name, strlen(sym_name) + 1);
+  }
+
+  // Add an entry for the .debug_names section, and return its index
+  // within the object.  PARENT is the index of the entry for the
+  // parent DIE, or -1.
+  int
+  add_name_entry(int cu_index, const char* sym_name, unsigned int tag,
+		 off_t die_offset, int parent)
+  {
+    this->syms_.push_back(Scan_symbol(this->names_.size(), cu_index, 0,
+				      tag, die_offset, parent));
+    this->names_.append(sym_name, strlen(sym_name) + 1);
+    return this->syms_.size() - 1;
+  }
+
+  // Record that the debug info cannot be indexed for the
+  // .debug_names section, for REASON.  We only keep the first reason.
+  void
+  set_cant_index(const char* reason)
+  {
+    if (this->cant_index_.empty())
+      this->cant_index_ = reason;
+  }
+
+  // Return true if the debug info cannot be indexed for the
+  // .debug_names section.
+  bool
+  cant_index() const
+  { return !this->cant_index_.empty(); }
+
+  // Count a compilation unit or a type unit.
+  void
+  count_unit(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_count_;
+    else
+      ++this->cu_count_;
+  }
+
+  // Count a compilation unit or a type unit without pubnames.
+  void
+  count_unit_without_pubnames(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_nopubnames_count_;
+    else
+      ++this->cu_nopubnames_count_;
+  }
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUS associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset)
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Add the results of the scan to GDB_INDEX, and clear them.
+  void
+  add_to_index(Gdb_index* gdb_index);
+
+  // Print usage statistics.
+  static void
+  print_stats();
+
+ private:
+  // A section to be scanned.
+  struct Section
+  {
+    Section(bool is_type, unsigned int index, unsigned int rindex,
+	    unsigned int rtype)
+      : is_type_unit(is_type), shndx(index), reloc_shndx(rindex),
+	reloc_type(rtype)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  // A symbol found by the scan.  The name is at NAME_OFFSET in
+  // NAMES_.  The TAG, DIE_OFFSET and PARENT are only used for the
+  // .debug_names section.
+  struct Scan_symbol
+  {
+    Scan_symbol(size_t offset, int index, uint8_t f, unsigned int t,
+		off_t die, int p)
+      : name_offset(offset), cu_index(index), flags(f), tag(t),
+	die_offset(die), parent(p)
+    { }
+    size_t name_offset;
+    int cu_index;
+    uint8_t flags;
+    unsigned int tag;
+    off_t die_offset;
+    int parent;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr, const unsigned char* symbols,
+		       off_t symbols_size);
+
+  // Wrapper for map_pubtable_to_dies.
+  void
+  map_pubnames_and_types_to_dies(bool is_type_unit,
+				 const unsigned char* symbols,
+				 off_t symbols_size, unsigned int shndx,
+				 unsigned int reloc_shndx,
+				 unsigned int reloc_type);
+
+  // The object.
+  Relobj* object_;
+  // A copy of the symbols of the object, and its size.
+  unsigned char* symbols_;
+  off_t symbols_size_;
+  // The sections to scan.
+  std::vector<Section> sections_;
+  // The units, ranges and symbols found.
+  std::vector<Gdb_index::Comp_unit> comp_units_;
+  std::vector<Gdb_index::Type_unit> type_units_;
+  std::vector<Gdb_index::Per_cu_range_list> ranges_;
+  std::vector<Scan_symbol> syms_;
+  // The names of the symbols.
+  std::string names_;
+  // Statistics for this object.
+  unsigned int cu_count_;
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_count_;
+  unsigned int tu_nopubnames_count_;
+  // Maps from CU offsets to the offsets in the pubnames and pubtypes
+  // tables.
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // The reader used by the pubnames and pubtypes tables.
+  Gdb_index_info_reader* pubnames_dwinfo_;
+  // Tables to store the pubnames section of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Stmt list offset of the CUs and TUs associated with the last read
+  // pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // Why the debug info cannot be indexed for the .debug_names
+  // section, or empty if it can.
+  std::string cant_index_;
+
+  // Statistics for all objects.
+  // Total number of DWARF compilation units processed.
+  static unsigned int dwarf_cu_count;
+  // Number of DWARF compilation units with pubnames/pubtypes.
+  static unsigned int dwarf_cu_nopubnames_count;
+  // Total number of DWARF type units processed.
+  static unsigned int dwarf_tu_count;
+  // Number of DWARF type units with pubnames/pubtypes.
+  static unsigned int dwarf_tu_nopubnames_count;
+};
+
+// Total number of DWARF compilation units processed.
+unsigned int Gdb_index_scan::dwarf_cu_count = 0;
+// Number of DWARF compilation units without pubnames/pubtypes.
+unsigned int Gdb_index_scan::dwarf_cu_nopubnames_count = 0;
+// Total number of DWARF type units processed.
+unsigned int Gdb_index_scan::dwarf_tu_count = 0;
+// Number of DWARF type units without pubnames/pubtypes.
+unsigned int Gdb_index_scan::dwarf_tu_nopubnames_count = 0;
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,19 +463,15 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_scan* scan)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      scan_(scan), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
-  // Print usage statistics.
-  static void
-  print_stats();
-
  protected:
   // Visit a compilation unit.
   virtual void
@@ -285,8 +561,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The results of the scan of the object.
+  Gdb_index_scan* scan_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -294,35 +570,16 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   // Map from DIE offset to (parent offset, name) pair,
   // for DW_AT_specification.
   Declaration_map declarations_;
-
-  // Statistics.
-  // Total number of DWARF compilation units processed.
-  static unsigned int dwarf_cu_count;
-  // Number of DWARF compilation units with pubnames/pubtypes.
-  static unsigned int dwarf_cu_nopubnames_count;
-  // Total number of DWARF type units processed.
-  static unsigned int dwarf_tu_count;
-  // Number of DWARF type units with pubnames/pubtypes.
-  static unsigned int dwarf_tu_nopubnames_count;
 };
 
-// Total number of DWARF compilation units processed.
-unsigned int Gdb_index_info_reader::dwarf_cu_count = 0;
-// Number of DWARF compilation units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_cu_nopubnames_count = 0;
-// Total number of DWARF type units processed.
-unsigned int Gdb_index_info_reader::dwarf_tu_count = 0;
-// Number of DWARF type units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_tu_nopubnames_count = 0;
-
 // Process a compilation unit and parse its child DIE.
 
 void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  this->scan_->count_unit(false);
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +590,10 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
+  this->scan_->count_unit(true);
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->scan_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
@@ -380,10 +637,8 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 			     this->object()->name().c_str());
 		return;
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	    this->scan_->count_unit_without_pubnames(
+		die->tag() == elfcpp::DW_TAG_type_unit);
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -437,8 +692,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -477,8 +731,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -820,13 +1073,18 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
   unsigned int shndx;
   unsigned int shndx2;
 
-  off_t ranges_offset = die->ref_attribute(elfcpp::DW_AT_ranges, &shndx);
+  // In DWARF 5, DW_AT_ranges refers to the .debug_rnglists section,
+  // which we don't read.
+  off_t ranges_offset = -1;
+  if (this->cu_version() < 5)
+    ranges_offset = die->ref_attribute(elfcpp::DW_AT_ranges, &shndx);
+  else if (die->attribute(elfcpp::DW_AT_ranges) != NULL)
+    return;
   if (ranges_offset != -1)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->scan_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -851,8 +1109,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->scan_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -877,7 +1134,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->scan_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -916,8 +1173,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->scan_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -928,10 +1184,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->scan_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->scan_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -939,12 +1195,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->scan_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->scan_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->scan_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->scan_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -964,145 +1220,999 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
-// Print usage statistics.
-void
-Gdb_index_info_reader::print_stats()
+// A specialization of Dwarf_info_reader, for building the
+// .debug_names section.  Unlike the .gdb_index section, which holds
+// fully-qualified names, each entry in the .debug_names section is
+// named by the DW_AT_name of its DIE, and refers to the entry for the
+// enclosing scope with a DW_IDX_parent attribute.  The DIEs which are
+// indexed are those described by the DWARF 5 standard.  If a unit
+// cannot be indexed this way, we record the reason in the scan, and
+// no .debug_names section is written.
+
+class Debug_names_info_reader : public Dwarf_info_reader
 {
-  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_count);
-  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_nopubnames_count);
-  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_count);
-  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
-}
+ public:
+  Debug_names_info_reader(bool is_type_unit,
+			  Relobj* object,
+			  const unsigned char* symbols,
+			  off_t symbols_size,
+			  unsigned int shndx,
+			  unsigned int reloc_shndx,
+			  unsigned int reloc_type,
+			  Gdb_index_scan* scan)
+    : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
+			reloc_shndx, reloc_type),
+      scan_(scan), cu_index_(0), parents_(), location_table_(this)
+  { }
 
-// Class Gdb_index.
+ protected:
+  // Visit a compilation unit.
+  virtual void
+  visit_compilation_unit(off_t cu_offset, off_t cu_length, Dwarf_die*);
 
-// Construct the .gdb_index section.
+  // Visit a type unit.
+  virtual void
+  visit_type_unit(off_t tu_offset, off_t tu_length, off_t type_offset,
+		  uint64_t signature, Dwarf_die*);
 
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
-{
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
-}
+ private:
+  // The attributes of a DIE which decide whether and how it is
+  // indexed, including those found by following DW_AT_specification
+  // and DW_AT_abstract_origin.
+  struct Die_names
+  {
+    Die_names()
+      : name(NULL), linkage_name(NULL), has_address(false),
+	has_location(false), location(), origin(0)
+    { }
+    const char* name;
+    const char* linkage_name;
+    bool has_address;
+    bool has_location;
+    Dwarf_die::Attribute_value location;
+    off_t origin;
+  };
 
-Gdb_index::~Gdb_index()
-{
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
-}
+  typedef Unordered_map<off_t, int> Parent_map;
 
+  // Visit the children of DIE.  PARENT is the index of the entry for
+  // the enclosing scope, or -1.  Return false if the unit cannot be
+  // indexed.
+  bool
+  visit_children(Dwarf_die* die, int parent);
 
-// Scan the pubnames and pubtypes sections and build a map of the
-// various cus and tus they refer to, so we can process the entries
-// when we encounter the die for that cu or tu.
-// Return the just-read table so it can be cached.
+  // Visit a DIE.  Return false if the unit cannot be indexed.
+  bool
+  visit_die(Dwarf_die* die, int parent);
 
-Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+  // Read the names of DIE into NAMES, following references to other
+  // DIEs up to DEPTH levels.  Return false if the unit cannot be
+  // indexed.
+  bool
+  read_names(Dwarf_die* die, Die_names* names, int depth);
+
+  // Read the string attribute ATTR of DIE into *PNAME, unless it is
+  // already set.  Return false if the unit cannot be indexed.
+  bool
+  read_name(Dwarf_die* die, unsigned int attr, const char** pname);
+
+  // Return true if the variable with the location attribute LOCATION
+  // has a static address.
+  bool
+  has_static_location(const Dwarf_die::Attribute_value& location);
+
+  // Return true if the location expression from P to PEND includes
+  // an operator which gives a static address.
+  bool
+  has_static_address(const unsigned char* p, const unsigned char* pend);
+
+  // Record that the unit cannot be indexed, and return false.
+  bool
+  cant_index(const char* reason)
+  {
+    this->scan_->set_cant_index(reason);
+    return false;
+  }
+
+  // The results of the scan of the object.
+  Gdb_index_scan* scan_;
+  // The index of the current CU.
+  int cu_index_;
+  // Map from the offset of a DIE to the index of the entry for its
+  // enclosing scope, so that a DIE with a DW_AT_specification or
+  // DW_AT_abstract_origin attribute gets the scope of its declaration.
+  Parent_map parents_;
+  // The location lists of the object.
+  Dwarf_location_table location_table_;
+};
+
+// Process a compilation unit.  We only index complete compilation
+// units: type units and split units are left to the DWARF producer.
+
+void
+Debug_names_info_reader::visit_compilation_unit(off_t cu_offset,
+						off_t cu_length,
+						Dwarf_die* root_die)
 {
-  uint64_t section_offset = 0;
-  Dwarf_pubnames_table* table;
-  Pubname_offset_map* map;
+  this->scan_->count_unit(false);
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
+  if (this->scan_->cant_index())
+    return;
 
-  if (attr == elfcpp::DW_AT_GNU_pubnames)
+  if (this->cu_version() < 2 || this->cu_version() > 5)
     {
-      table = new Dwarf_pubnames_table(dwinfo, false);
-      map = &this->cu_pubname_map_;
+      this->cant_index(_("unsupported DWARF version"));
+      return;
     }
-  else
+  if (this->unit_type() != elfcpp::DW_UT_compile)
     {
-      table = new Dwarf_pubnames_table(dwinfo, true);
-      map = &this->cu_pubtype_map_;
+      this->cant_index(_("unsupported unit type"));
+      return;
     }
-
-  map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
-    return NULL;
-
-  while (table->read_header(section_offset))
+  if (root_die->tag() != elfcpp::DW_TAG_compile_unit)
     {
-      map->insert(std::make_pair(table->cu_offset(), section_offset));
-      section_offset += table->subsection_size();
+      this->cant_index(_("top level DIE is not DW_TAG_compile_unit"));
+      return;
+    }
+  if (!root_die->read_attributes())
+    {
+      this->cant_index(_("unreadable DIE"));
+      return;
+    }
+  if (root_die->attribute(elfcpp::DW_AT_GNU_dwo_name) != NULL
+      || root_die->attribute(elfcpp::DW_AT_dwo_name) != NULL)
+    {
+      this->cant_index(_("split DWARF"));
+      return;
     }
 
-  return table;
+  this->parents_.clear();
+  this->visit_children(root_die, -1);
 }
 
-// Wrapper for map_pubtable_to_dies
+// Process a type unit.  These cannot be represented in the
+// .debug_names section that we write.
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Debug_names_info_reader::visit_type_unit(off_t, off_t, off_t, uint64_t,
+					 Dwarf_die*)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = -1;
-
-  delete this->pubnames_table_;
-  this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
-  delete this->pubtypes_table_;
-  this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+  this->scan_->count_unit(true);
+  this->cant_index(_("type units are not supported"));
 }
 
-// Given a cu_offset, find the associated section of the pubnames
-// table.
+// Visit the children of DIE.
 
-off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+bool
+Debug_names_info_reader::visit_children(Dwarf_die* die, int parent)
 {
-  Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
-  if (it != this->cu_pubname_map_.end())
-    return it->second;
-  return -1;
+  off_t next_offset = 0;
+  for (off_t die_offset = die->child_offset();
+       die_offset != 0;
+       die_offset = next_offset)
+    {
+      Dwarf_die child(this, die_offset, die);
+      if (child.tag() == 0)
+	{
+	  // This should be the null entry which ends the list.
+	  const unsigned char* p = this->buffer_at_offset(die_offset);
+	  if (p == NULL || *p != 0)
+	    return this->cant_index(_("unreadable DIE"));
+	  break;
+	}
+      if (!this->visit_die(&child, parent))
+	return false;
+      next_offset = child.sibling_offset();
+      if (next_offset == 0)
+	return this->cant_index(_("unreadable DIE"));
+    }
+  return true;
 }
 
-// Given a cu_offset, find the associated section of the pubnames
-// table.
+// Visit a DIE, and add entries for its names if it is indexed.  The
+// rules follow section 6.1.1.1 of the DWARF 5 standard.
 
-off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+bool
+Debug_names_info_reader::visit_die(Dwarf_die* die, int parent)
 {
-  Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
-  if (it != this->cu_pubtype_map_.end())
-    return it->second;
-  return -1;
+  if (!die->read_attributes())
+    return this->cant_index(_("unreadable DIE"));
+
+  Die_names names;
+  if (!this->read_names(die, &names, 0))
+    return false;
+
+  // A DIE completing a declaration, or an instance of an abstract
+  // DIE, is in the scope of that DIE.
+  if (names.origin != 0)
+    {
+      Parent_map::const_iterator p = this->parents_.find(names.origin);
+      if (p != this->parents_.end())
+	parent = p->second;
+    }
+  this->parents_[die->offset()] = parent;
+
+  unsigned int tag = die->tag();
+  bool indexed;
+  switch (tag)
+    {
+    case elfcpp::DW_TAG_compile_unit:
+    case elfcpp::DW_TAG_module:
+    case elfcpp::DW_TAG_formal_parameter:
+    case elfcpp::DW_TAG_template_value_param:
+    case elfcpp::DW_TAG_template_type_param:
+    case elfcpp::DW_TAG_GNU_template_parameter_pack:
+    case elfcpp::DW_TAG_GNU_template_template_param:
+    case elfcpp::DW_TAG_member:
+    case elfcpp::DW_TAG_imported_declaration:
+      indexed = false;
+      break;
+    case elfcpp::DW_TAG_subprogram:
+    case elfcpp::DW_TAG_inlined_subroutine:
+    case elfcpp::DW_TAG_label:
+      indexed = names.has_address;
+      break;
+    case elfcpp::DW_TAG_variable:
+      indexed = (names.has_location
+		 && this->has_static_location(names.location));
+      break;
+    default:
+      indexed = true;
+      break;
+    }
+  if (die->is_declaration())
+    indexed = false;
+
+  const char* name = names.name;
+  if (name == NULL && tag == elfcpp::DW_TAG_namespace)
+    name = "(anonymous namespace)";
+
+  int entry = -1;
+  if (indexed && name != NULL)
+    entry = this->scan_->add_name_entry(this->cu_index_, name, tag,
+					die->offset(), parent);
+  if (indexed
+      && names.linkage_name != NULL
+      && (tag == elfcpp::DW_TAG_subprogram
+	  || tag == elfcpp::DW_TAG_inlined_subroutine)
+      && (name == NULL || strcmp(name, names.linkage_name) != 0))
+    this->scan_->add_name_entry(this->cu_index_, names.linkage_name, tag,
+				die->offset(), -1);
+
+  if (!die->has_children())
+    return true;
+
+  // The enumerators of an unscoped enumeration are in the enclosing
+  // scope.
+  int child_parent = entry != -1 ? entry : parent;
+  if (tag == elfcpp::DW_TAG_enumeration_type
+      && !die->flag_attribute(elfcpp::DW_AT_enum_class))
+    child_parent = parent;
+  return this->visit_children(die, child_parent);
 }
 
-// Scan a .debug_info or .debug_types input section.
+// Read the names of DIE, and whether it has an address.  An attribute
+// which is not on DIE is taken from the DIE named by its
+// DW_AT_specification or DW_AT_abstract_origin attribute.
 
-void
+bool
+Debug_names_info_reader::read_names(Dwarf_die* die, Die_names* names,
+				    int depth)
+{
+  if (!this->read_name(die, elfcpp::DW_AT_name, &names->name)
+      || !this->read_name(die, elfcpp::DW_AT_linkage_name,
+			  &names->linkage_name)
+      || !this->read_name(die, elfcpp::DW_AT_MIPS_linkage_name,
+			  &names->linkage_name))
+    return false;
+  if (die->attribute(elfcpp::DW_AT_low_pc) != NULL
+      || die->attribute(elfcpp::DW_AT_high_pc) != NULL
+      || die->attribute(elfcpp::DW_AT_ranges) != NULL
+      || die->attribute(elfcpp::DW_AT_entry_pc) != NULL)
+    names->has_address = true;
+  const Dwarf_die::Attribute_value* location =
+    die->attribute(elfcpp::DW_AT_location);
+  if (location != NULL && !names->has_location)
+    {
+      names->has_location = true;
+      names->location = *location;
+    }
+
+  const Dwarf_die::Attribute_value* ref =
+    die->attribute(elfcpp::DW_AT_specification);
+  if (ref == NULL)
+    ref = die->attribute(elfcpp::DW_AT_abstract_origin);
+  if (ref == NULL)
+    return true;
+
+  switch (ref->form)
+    {
+    case elfcpp::DW_FORM_ref1:
+    case elfcpp::DW_FORM_ref2:
+    case elfcpp::DW_FORM_ref4:
+    case elfcpp::DW_FORM_ref8:
+    case elfcpp::DW_FORM_ref_udata:
+      break;
+    default:
+      return this->cant_index(_("reference to another unit"));
+    }
+  if (depth == 0)
+    names->origin = ref->val.refval;
+  if (depth >= 8)
+    return this->cant_index(_("too many nested references"));
+
+  // The relocations are tracked in order, so we move the tracker to
+  // the other DIE to read it, and then go back to where we were.
+  uint64_t checkpoint = this->get_reloc_checkpoint();
+  this->seek_relocs(ref->val.refval);
+  Dwarf_die target(this, ref->val.refval, NULL);
+  bool ok;
+  if (target.tag() == 0 || !target.read_attributes())
+    ok = this->cant_index(_("unreadable DIE"));
+  else
+    ok = this->read_names(&target, names, depth + 1);
+  this->reset_relocs(checkpoint);
+  return ok;
+}
+
+// Read a string attribute.  We can only read strings in the
+// .debug_info and .debug_str sections.
+
+bool
+Debug_names_info_reader::read_name(Dwarf_die* die, unsigned int attr,
+				   const char** pname)
+{
+  if (*pname != NULL)
+    return true;
+  const Dwarf_die::Attribute_value* value = die->attribute(attr);
+  if (value == NULL)
+    return true;
+  if (value->form != elfcpp::DW_FORM_string
+      && value->form != elfcpp::DW_FORM_strp)
+    return this->cant_index(_("unsupported string form"));
+  *pname = die->string_attribute(attr);
+  if (*pname == NULL)
+    return this->cant_index(_("unreadable string"));
+  return true;
+}
+
+// Return true if the location of a variable, or any of the entries
+// of its location list, includes an operator which gives it a static
+// address.  We don't read the location lists of DWARF 3 and earlier,
+// which use a constant form.
+
+bool
+Debug_names_info_reader::has_static_location(
+    const Dwarf_die::Attribute_value& location)
+{
+  switch (location.form)
+    {
+    case elfcpp::DW_FORM_block1:
+    case elfcpp::DW_FORM_block2:
+    case elfcpp::DW_FORM_block4:
+    case elfcpp::DW_FORM_block:
+    case elfcpp::DW_FORM_exprloc:
+      return this->has_static_address(location.val.blockval,
+				      (location.val.blockval
+				       + location.aux.blocklen));
+    case elfcpp::DW_FORM_sec_offset:
+      {
+	Dwarf_location_table::Location_expressions exprs;
+	if (!this->location_table_.read_location_list(this->object(),
+						      this->symtab(),
+						      this->symtab_size(),
+						      this->address_size(),
+						      this->cu_version(),
+						      location.aux.shndx,
+						      location.val.refval,
+						      &exprs))
+	  return false;
+	for (Dwarf_location_table::Location_expressions::const_iterator p =
+	       exprs.begin();
+	     p != exprs.end();
+	     ++p)
+	  if (this->has_static_address(p->first, p->first + p->second))
+	    return true;
+	return false;
+      }
+    default:
+      return false;
+    }
+}
+
+// Return true if a location expression includes an operator which
+// gives a static address.
+
+bool
+Debug_names_info_reader::has_static_address(const unsigned char* p,
+					    const unsigned char* pend)
+{
+  size_t len;
+  while (p < pend)
+    {
+      unsigned int op = *p++;
+      if (op >= elfcpp::DW_OP_lit0 && op <= elfcpp::DW_OP_lit31)
+	continue;
+      if (op >= elfcpp::DW_OP_reg0 && op <= elfcpp::DW_OP_reg31)
+	continue;
+      if (op >= elfcpp::DW_OP_breg0 && op <= elfcpp::DW_OP_breg31)
+	{
+	  read_signed_LEB_128(p, &len);
+	  p += len;
+	  continue;
+	}
+      switch (op)
+	{
+	case elfcpp::DW_OP_addr:
+	case elfcpp::DW_OP_form_tls_address:
+	case elfcpp::DW_OP_GNU_push_tls_address:
+	case elfcpp::DW_OP_addrx:
+	case elfcpp::DW_OP_GNU_addr_index:
+	  return true;
+	case elfcpp::DW_OP_deref:
+	case elfcpp::DW_OP_dup:
+	case elfcpp::DW_OP_drop:
+	case elfcpp::DW_OP_over:
+	case elfcpp::DW_OP_swap:
+	case elfcpp::DW_OP_rot:
+	case elfcpp::DW_OP_xderef:
+	case elfcpp::DW_OP_abs:
+	case elfcpp::DW_OP_and:
+	case elfcpp::DW_OP_div:
+	case elfcpp::DW_OP_minus:
+	case elfcpp::DW_OP_mod:
+	case elfcpp::DW_OP_mul:
+	case elfcpp::DW_OP_neg:
+	case elfcpp::DW_OP_not:
+	case elfcpp::DW_OP_or:
+	case elfcpp::DW_OP_plus:
+	case elfcpp::DW_OP_shl:
+	case elfcpp::DW_OP_shr:
+	case elfcpp::DW_OP_shra:
+	case elfcpp::DW_OP_xor:
+	case elfcpp::DW_OP_eq:
+	case elfcpp::DW_OP_ge:
+	case elfcpp::DW_OP_gt:
+	case elfcpp::DW_OP_le:
+	case elfcpp::DW_OP_lt:
+	case elfcpp::DW_OP_ne:
+	case elfcpp::DW_OP_nop:
+	case elfcpp::DW_OP_push_object_address:
+	case elfcpp::DW_OP_call_frame_cfa:
+	case elfcpp::DW_OP_stack_value:
+	case elfcpp::DW_OP_GNU_uninit:
+	  break;
+	case elfcpp::DW_OP_const1u:
+	case elfcpp::DW_OP_const1s:
+	case elfcpp::DW_OP_pick:
+	case elfcpp::DW_OP_deref_size:
+	case elfcpp::DW_OP_xderef_size:
+	  p += 1;
+	  break;
+	case elfcpp::DW_OP_const2u:
+	case elfcpp::DW_OP_const2s:
+	case elfcpp::DW_OP_bra:
+	case elfcpp::DW_OP_skip:
+	case elfcpp::DW_OP_call2:
+	  p += 2;
+	  break;
+	case elfcpp::DW_OP_const4u:
+	case elfcpp::DW_OP_const4s:
+	case elfcpp::DW_OP_call4:
+	case elfcpp::DW_OP_GNU_parameter_ref:
+	  p += 4;
+	  break;
+	case elfcpp::DW_OP_const8u:
+	case elfcpp::DW_OP_const8s:
+	  p += 8;
+	  break;
+	case elfcpp::DW_OP_call_ref:
+	case elfcpp::DW_OP_GNU_variable_value:
+	  p += this->ref_addr_size();
+	  break;
+	case elfcpp::DW_OP_constu:
+	case elfcpp::DW_OP_plus_uconst:
+	case elfcpp::DW_OP_regx:
+	case elfcpp::DW_OP_piece:
+	case elfcpp::DW_OP_constx:
+	case elfcpp::DW_OP_convert:
+	case elfcpp::DW_OP_reinterpret:
+	case elfcpp::DW_OP_GNU_convert:
+	case elfcpp::DW_OP_GNU_reinterpret:
+	case elfcpp::DW_OP_GNU_const_index:
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  break;
+	case elfcpp::DW_OP_consts:
+	case elfcpp::DW_OP_fbreg:
+	  read_signed_LEB_128(p, &len);
+	  p += len;
+	  break;
+	case elfcpp::DW_OP_bregx:
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  read_signed_LEB_128(p, &len);
+	  p += len;
+	  break;
+	case elfcpp::DW_OP_bit_piece:
+	case elfcpp::DW_OP_regval_type:
+	case elfcpp::DW_OP_GNU_regval_type:
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  break;
+	case elfcpp::DW_OP_deref_type:
+	case elfcpp::DW_OP_xderef_type:
+	case elfcpp::DW_OP_GNU_deref_type:
+	  p += 1;
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  break;
+	case elfcpp::DW_OP_implicit_pointer:
+	case elfcpp::DW_OP_GNU_implicit_pointer:
+	  p += this->ref_addr_size();
+	  read_signed_LEB_128(p, &len);
+	  p += len;
+	  break;
+	case elfcpp::DW_OP_implicit_value:
+	case elfcpp::DW_OP_entry_value:
+	case elfcpp::DW_OP_GNU_entry_value:
+	  {
+	    uint64_t size = read_unsigned_LEB_128(p, &len);
+	    p += len + size;
+	  }
+	  break;
+	case elfcpp::DW_OP_const_type:
+	case elfcpp::DW_OP_GNU_const_type:
+	  read_unsigned_LEB_128(p, &len);
+	  p += len;
+	  if (p < pend)
+	    p += 1 + *p;
+	  break;
+	default:
+	  // We don't know the size of the operands, so we can't look
+	  // any further.
+	  return false;
+	}
+    }
+  return false;
+}
+
+// Class Gdb_index_scan.
+
+Gdb_index_scan::~Gdb_index_scan()
+{
+  delete[] this->symbols_;
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
+  delete this->pubnames_dwinfo_;
+}
+
+// Record a .debug_info or .debug_types section to be scanned later.
+// The symbols are the same for all the sections of the object, so we
+// only need to copy them once.
+
+void
+Gdb_index_scan::add_section(bool is_type_unit,
+			    const unsigned char* symbols,
+			    off_t symbols_size,
+			    unsigned int shndx,
+			    unsigned int reloc_shndx,
+			    unsigned int reloc_type)
+{
+  if (this->symbols_ == NULL && symbols != NULL && symbols_size > 0)
+    {
+      this->symbols_ = new unsigned char[symbols_size];
+      memcpy(this->symbols_, symbols, symbols_size);
+      this->symbols_size_ = symbols_size;
+    }
+  this->sections_.push_back(Section(is_type_unit, shndx, reloc_shndx,
+				    reloc_type));
+}
+
+// Scan the sections recorded by add_section.  Once this is done, we
+// no longer need the symbols or the pubnames tables.
+
+void
+Gdb_index_scan::scan_sections()
+{
+  for (std::vector<Section>::const_iterator p = this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    this->scan_section(p->is_type_unit, this->symbols_, this->symbols_size_,
+		       p->shndx, p->reloc_shndx, p->reloc_type);
+  this->sections_.clear();
+
+  delete[] this->symbols_;
+  this->symbols_ = NULL;
+  this->symbols_size_ = 0;
+  delete this->pubnames_table_;
+  this->pubnames_table_ = NULL;
+  delete this->pubtypes_table_;
+  this->pubtypes_table_ = NULL;
+  delete this->pubnames_dwinfo_;
+  this->pubnames_dwinfo_ = NULL;
+}
+
+// Scan a .debug_info or .debug_types input section.  The
+// .debug_names section does not use the pubnames and pubtypes
+// sections, since they have neither the tags of the DIEs nor their
+// parents.
+
+void
+Gdb_index_scan::scan_section(bool is_type_unit,
+			     const unsigned char* symbols,
+			     off_t symbols_size,
+			     unsigned int shndx,
+			     unsigned int reloc_shndx,
+			     unsigned int reloc_type)
+{
+  if (parameters->options().debug_names())
+    {
+      Debug_names_info_reader dwinfo(is_type_unit, this->object_,
+				     symbols, symbols_size,
+				     shndx, reloc_shndx,
+				     reloc_type, this);
+      dwinfo.parse();
+      return;
+    }
+
+  Gdb_index_info_reader dwinfo(is_type_unit, this->object_,
+			       symbols, symbols_size,
+			       shndx, reloc_shndx,
+			       reloc_type, this);
+  if (this->pubnames_dwinfo_ == NULL)
+    this->map_pubnames_and_types_to_dies(is_type_unit, symbols, symbols_size,
+					 shndx, reloc_shndx, reloc_type);
+  dwinfo.parse();
+}
+
+// Scan the pubnames and pubtypes sections and build a map of the
+// various cus and tus they refer to, so we can process the entries
+// when we encounter the die for that cu or tu.
+// Return the just-read table so it can be cached.
+
+Dwarf_pubnames_table*
+Gdb_index_scan::map_pubtable_to_dies(unsigned int attr,
+				     const unsigned char* symbols,
+				     off_t symbols_size)
+{
+  uint64_t section_offset = 0;
+  Dwarf_pubnames_table* table;
+  Pubname_offset_map* map;
+
+  if (attr == elfcpp::DW_AT_GNU_pubnames)
+    {
+      table = new Dwarf_pubnames_table(this->pubnames_dwinfo_, false);
+      map = &this->cu_pubname_map_;
+    }
+  else
+    {
+      table = new Dwarf_pubnames_table(this->pubnames_dwinfo_, true);
+      map = &this->cu_pubtype_map_;
+    }
+
+  map->clear();
+  if (!table->read_section(this->object_, symbols, symbols_size))
+    {
+      delete table;
+      return NULL;
+    }
+
+  while (table->read_header(section_offset))
+    {
+      map->insert(std::make_pair(table->cu_offset(), section_offset));
+      section_offset += table->subsection_size();
+    }
+
+  return table;
+}
+
+// Wrapper for map_pubtable_to_dies.  The tables keep a pointer to the
+// reader, so we create one which lives as long as they do.
+
+void
+Gdb_index_scan::map_pubnames_and_types_to_dies(bool is_type_unit,
+					       const unsigned char* symbols,
+					       off_t symbols_size,
+					       unsigned int shndx,
+					       unsigned int reloc_shndx,
+					       unsigned int reloc_type)
+{
+  this->pubnames_dwinfo_ = new Gdb_index_info_reader(is_type_unit,
+						     this->object_,
+						     symbols, symbols_size,
+						     shndx, reloc_shndx,
+						     reloc_type, this);
+  this->stmt_list_offset_ = -1;
+  this->pubnames_table_
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames,
+				   symbols, symbols_size);
+  this->pubtypes_table_
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes,
+				   symbols, symbols_size);
+}
+
+// Given a cu_offset, find the associated section of the pubnames
+// table.
+
+off_t
+Gdb_index_scan::find_pubname_offset(off_t cu_offset)
+{
+  Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
+  if (it != this->cu_pubname_map_.end())
+    return it->second;
+  return -1;
+}
+
+// Given a cu_offset, find the associated section of the pubnames
+// table.
+
+off_t
+Gdb_index_scan::find_pubtype_offset(off_t cu_offset)
+{
+  Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
+  if (it != this->cu_pubtype_map_.end())
+    return it->second;
+  return -1;
+}
+
+// Translate the index of a unit within an object to an index in the
+// index.  Negative indexes refer to a TU.
+
+static inline int
+rebase_unit_index(int cu_index, int cu_base, int tu_base)
+{
+  if (cu_index >= 0)
+    return cu_base + cu_index;
+  return -1 - (tu_base + (-1 - cu_index));
+}
+
+// Add the results of the scan to GDB_INDEX.
+
+void
+Gdb_index_scan::add_to_index(Gdb_index* gdb_index)
+{
+  int cu_base = gdb_index->comp_units_.size();
+  int tu_base = gdb_index->type_units_.size();
+
+  gdb_index->comp_units_.insert(gdb_index->comp_units_.end(),
+				this->comp_units_.begin(),
+				this->comp_units_.end());
+  gdb_index->type_units_.insert(gdb_index->type_units_.end(),
+				this->type_units_.begin(),
+				this->type_units_.end());
+
+  for (std::vector<Gdb_index::Per_cu_range_list>::const_iterator p
+	 = this->ranges_.begin();
+       p != this->ranges_.end();
+       ++p)
+    {
+      Gdb_index::Per_cu_range_list range_list = *p;
+      range_list.cu_index = rebase_unit_index(p->cu_index, cu_base, tu_base);
+      gdb_index->ranges_.push_back(range_list);
+    }
+
+  if (!gdb_index->is_debug_names_)
+    {
+      for (std::vector<Scan_symbol>::const_iterator p = this->syms_.begin();
+	   p != this->syms_.end();
+	   ++p)
+	gdb_index->add_symbol(rebase_unit_index(p->cu_index, cu_base,
+						tu_base),
+			      this->names_.data() + p->name_offset, p->flags);
+    }
+  else if (this->cant_index())
+    gdb_index->skip_debug_names(this->object_, this->cant_index_);
+  else if (!gdb_index->skip_debug_names_)
+    {
+      // The entries of this object follow those of the objects
+      // before it, so the index of a parent is rebased in the same
+      // way as the units.
+      int entry_base = gdb_index->name_entries_.size();
+      for (std::vector<Scan_symbol>::const_iterator p = this->syms_.begin();
+	   p != this->syms_.end();
+	   ++p)
+	gdb_index->add_name_entry(rebase_unit_index(p->cu_index, cu_base,
+						    tu_base),
+				  this->names_.data() + p->name_offset,
+				  p->tag, p->die_offset,
+				  (p->parent >= 0
+				   ? entry_base + p->parent
+				   : -1));
+    }
+
+  Gdb_index_scan::dwarf_cu_count += this->cu_count_;
+  Gdb_index_scan::dwarf_cu_nopubnames_count += this->cu_nopubnames_count_;
+  Gdb_index_scan::dwarf_tu_count += this->tu_count_;
+  Gdb_index_scan::dwarf_tu_nopubnames_count += this->tu_nopubnames_count_;
+
+  this->comp_units_.clear();
+  this->type_units_.clear();
+  this->ranges_.clear();
+  this->syms_.clear();
+  this->names_.clear();
+  this->cant_index_.clear();
+  this->cu_count_ = 0;
+  this->cu_nopubnames_count_ = 0;
+  this->tu_count_ = 0;
+  this->tu_nopubnames_count_ = 0;
+}
+
+// Print usage statistics.
+void
+Gdb_index_scan::print_stats()
+{
+  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
+          program_name, Gdb_index_scan::dwarf_cu_count);
+  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
+          program_name, Gdb_index_scan::dwarf_cu_nopubnames_count);
+  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
+          program_name, Gdb_index_scan::dwarf_tu_count);
+  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
+          program_name, Gdb_index_scan::dwarf_tu_nopubnames_count);
+}
+
+// A Task to scan the .debug_info and .debug_types sections of one
+// object.  This runs with the lock on the object, since it reads the
+// section contents.
+
+class Gdb_index_scan_task : public Task
+{
+ public:
+  Gdb_index_scan_task(Gdb_index* gdb_index, unsigned int index,
+		      Relobj* object, Task_token* next_blocker)
+    : gdb_index_(gdb_index), index_(index), object_(object),
+      next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->next_blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->gdb_index_->scan_object(this->index_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->object_->name(); }
+
+ private:
+  Gdb_index* gdb_index_;
+  unsigned int index_;
+  Relobj* object_;
+  Task_token* next_blocker_;
+};
+
+// A Task to add the results of the scan of one object to the index.
+// These tasks run in input order, so that the output does not depend
+// on the number of threads.  SCAN_BLOCKER is the blocker for the scan
+// task, and THIS_BLOCKER is the blocker for the previous object.
+// Both are deleted by this task.
+
+class Gdb_index_add_task : public Task
+{
+ public:
+  Gdb_index_add_task(Gdb_index* gdb_index, unsigned int index,
+		     Relobj* object, Task_token* scan_blocker,
+		     Task_token* this_blocker, Task_token* next_blocker)
+    : gdb_index_(gdb_index), index_(index), object_(object),
+      scan_blocker_(scan_blocker), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Gdb_index_add_task()
+  {
+    delete this->scan_blocker_;
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+  }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->scan_blocker_->is_blocked())
+      return this->scan_blocker_;
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->gdb_index_->add_object(this->index_); }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_add_task " + this->object_->name(); }
+
+ private:
+  Gdb_index* gdb_index_;
+  unsigned int index_;
+  Relobj* object_;
+  Task_token* scan_blocker_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    is_debug_names_(parameters->options().debug_names()),
+    scans_(),
+    debug_names_strings_(NULL),
+    skip_debug_names_(false),
+    name_entries_(),
+    name_entry_list_(),
+    name_hashes_(),
+    name_order_(),
+    name_buckets_(),
+    name_abbrevs_(),
+    name_entry_pool_(),
+    entry_offsets_(),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0)
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+  for (unsigned int i = 0; i < this->name_entry_list_.size(); ++i)
+    delete this->name_entry_list_[i];
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    delete this->scans_[i];
+}
+
+// Scan a .debug_info or .debug_types input section.  We only record
+// the section here; the scan itself is done by a task queued by
+// queue_scan_tasks.
+
+void
 Gdb_index::scan_debug_info(bool is_type_unit,
 			   Relobj* object,
 			   const unsigned char* symbols,
@@ -1111,19 +2221,123 @@ Gdb_index::scan_debug_info(bool is_type_unit,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  Gdb_index_scan* scan;
+  if (!this->scans_.empty()
+      && this->scans_.back() != NULL
+      && this->scans_.back()->object() == object)
+    scan = this->scans_.back();
+  else
+    {
+      scan = new Gdb_index_scan(object);
+      this->scans_.push_back(scan);
+    }
+  scan->add_section(is_type_unit, symbols, symbols_size, shndx, reloc_shndx,
+		    reloc_type);
 }
 
-// Add a symbol.
+// Queue the tasks to scan the objects.  Each object is scanned by a
+// separate task, and the results are added to the index by a chain
+// of tasks in the order of the objects.  The last task in the chain
+// holds a blocker on BLOCKER.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index::queue_scan_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  std::vector<unsigned int> deferred;
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    if (this->scans_[i] != NULL)
+      deferred.push_back(i);
+  if (deferred.empty())
+    return;
+
+  workqueue->add_blocker(blocker);
+
+  Task_token* this_blocker = NULL;
+  for (unsigned int i = 0; i < deferred.size(); ++i)
+    {
+      unsigned int index = deferred[i];
+      Relobj* object = this->scans_[index]->object();
+
+      Task_token* scan_blocker = new Task_token(true);
+      scan_blocker->add_blocker();
+      workqueue->queue(new Gdb_index_scan_task(this, index, object,
+					       scan_blocker));
+
+      Task_token* next_blocker;
+      if (i + 1 == deferred.size())
+	next_blocker = blocker;
+      else
+	{
+	  next_blocker = new Task_token(true);
+	  next_blocker->add_blocker();
+	}
+      workqueue->queue(new Gdb_index_add_task(this, index, object,
+					      scan_blocker, this_blocker,
+					      next_blocker));
+      this_blocker = next_blocker;
+    }
+}
+
+// Scan the sections of the object at INDEX.
+
+void
+Gdb_index::scan_object(unsigned int index)
+{
+  this->scans_[index]->scan_sections();
+}
+
+// Add the results of the scan of the object at INDEX to the index.
+
+void
+Gdb_index::add_object(unsigned int index)
+{
+  Gdb_index_scan* scan = this->scans_[index];
+  scan->add_to_index(this);
+  delete scan;
+  this->scans_[index] = NULL;
+}
+
+// Scan and add any objects which were not handled by the tasks
+// queued by queue_scan_tasks.
+
+void
+Gdb_index::add_remaining_scans()
+{
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    {
+      if (this->scans_[i] != NULL)
+	{
+	  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+	  Task_lock_obj<Object> tl(dummy_task, this->scans_[i]->object());
+	  this->scan_object(i);
+	  this->add_object(i);
+	}
+    }
+}
+
+// Compute the case-folded DJB hash of a name, as used by the
+// .debug_names section.
+
+static uint32_t
+debug_names_hash(const char* name)
+{
+  uint32_t hash = 5381;
+  for (const unsigned char* p = reinterpret_cast<const unsigned char*>(name);
+       *p != '\0';
+       ++p)
+    {
+      unsigned char c = *p;
+      if (c >= 'A' && c <= 'Z')
+	c += 'a' - 'A';
+      hash = hash * 33 + c;
+    }
+  return hash;
+}
+
+// Find the symbol for SYM_NAME, adding it if it is new.
+
+Gdb_index::Gdb_symbol*
+Gdb_index::find_symbol(const char* sym_name)
 {
   unsigned int hash = mapped_index_string_hash(
       reinterpret_cast<const unsigned char*>(sym_name));
@@ -1138,6 +2352,11 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
       // New symbol -- allocate a new CU index vector.
       found->cu_vector_index = this->cu_vector_list_.size();
       this->cu_vector_list_.push_back(new Cu_vector());
+      if (this->is_debug_names_)
+	{
+	  this->name_entry_list_.push_back(new Name_entry_vector());
+	  this->name_hashes_.push_back(debug_names_hash(sym_name));
+	}
     }
   else
     {
@@ -1145,6 +2364,15 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
       // CU index vector.
       delete sym;
     }
+  return found;
+}
+
+// Add a symbol.
+
+void
+Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+{
+  Gdb_symbol* found = this->find_symbol(sym_name);
 
   // Add the CU index to the vector list for this symbol,
   // if it's not already on the list.  We only need to
@@ -1156,25 +2384,46 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
+// Add an entry for the .debug_names section.
 
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
+void
+Gdb_index::add_name_entry(int cu_index, const char* sym_name,
+			  unsigned int tag, off_t die_offset, int parent)
 {
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
+  gold_assert(this->is_debug_names_ && cu_index >= 0);
+  gold_assert(parent < static_cast<int>(this->name_entries_.size()));
+  Gdb_symbol* found = this->find_symbol(sym_name);
+  this->name_entry_list_[found->cu_vector_index]->push_back(
+      this->name_entries_.size());
+  this->name_entries_.push_back(Name_entry(cu_index, tag, die_offset,
+					   parent));
 }
 
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
+// Record that the .debug_names section cannot be written.  We write
+// an empty section instead, as the section was already created.
 
 void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
+Gdb_index::skip_debug_names(Relobj* object, const std::string& reason)
+{
+  gold_warning(_("%s: cannot index debug info for --debug-names (%s); "
+		 "not writing .debug_names"),
+	       object->name().c_str(), reason.c_str());
+  this->skip_debug_names_ = true;
+}
+
+// Finalize the names for the .debug_names section, and return the
+// size of the strings.  This is called when the size of the
+// .debug_str section is set, by which time all the objects have been
+// added.
+
+section_size_type
+Gdb_index::finalize_names()
 {
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
+  this->add_remaining_scans();
+  if (this->skip_debug_names_)
+    return 0;
+  this->stringpool_.set_string_offsets();
+  return this->stringpool_.get_strtab_size();
 }
 
 // Set the size of the .gdb_index section.
@@ -1182,6 +2431,14 @@ Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
 void
 Gdb_index::set_final_data_size()
 {
+  this->add_remaining_scans();
+
+  if (this->is_debug_names_)
+    {
+      this->set_debug_names_size();
+      return;
+    }
+
   // Finalize the string pool.
   this->stringpool_.set_string_offsets();
 
@@ -1227,6 +2484,14 @@ Gdb_index::do_write(Output_file* of)
   unsigned char* const oview = of->get_output_view(off, oview_size);
   unsigned char* pov = oview;
 
+  if (this->is_debug_names_)
+    {
+      if (oview_size > 0)
+	this->write_debug_names(oview);
+      of->write_output_view(off, oview_size, oview);
+      return;
+    }
+
   // Write the file header.
   // (1) Version number.
   elfcpp::Swap<32, false>::writeval(pov, gdb_index_version);
@@ -1348,12 +2613,259 @@ Gdb_index::do_write(Output_file* of)
   of->write_output_view(off, oview_size, oview);
 }
 
+// Write a 4-byte value of the .debug_names section to POV, in the
+// byte order of the target.
+
+static void
+write_debug_names_word(unsigned char* pov, uint32_t value)
+{
+  if (parameters->target().is_big_endian())
+    elfcpp::Swap_unaligned<32, true>::writeval(pov, value);
+  else
+    elfcpp::Swap_unaligned<32, false>::writeval(pov, value);
+}
+
+// Append a 4-byte value of the .debug_names section to BUFFER.
+
+static void
+append_debug_names_word(std::vector<unsigned char>* buffer, uint32_t value)
+{
+  unsigned char bytes[4];
+  write_debug_names_word(bytes, value);
+  buffer->insert(buffer->end(), bytes, bytes + 4);
+}
+
+// Set the size of the .debug_names section.  The symbols are ordered
+// by the bucket of their hash, and within a bucket in the order in
+// which they were added, so the output does not depend on the layout
+// of the gdb_index hash table.  There is one abbreviation for each DIE
+// tag, with and without a parent.  Each entry gives the CU, the offset
+// of the DIE within it, and the offset in the entry pool of the entry
+// for the enclosing scope, if there is one.
+
+void
+Gdb_index::set_debug_names_size()
+{
+  if (this->skip_debug_names_)
+    {
+      this->set_data_size(0);
+      return;
+    }
+
+  unsigned int symbol_count = this->cu_vector_list_.size();
+  std::vector<const Gdb_symbol*> symbols(symbol_count, NULL);
+  for (unsigned int i = 0; i < this->gdb_symtab_->capacity(); ++i)
+    {
+      const Gdb_symbol* sym = (*this->gdb_symtab_)[i];
+      if (sym != NULL)
+	symbols[sym->cu_vector_index] = sym;
+    }
+
+  unsigned int name_count = symbol_count;
+  unsigned int bucket_count = name_count;
+
+  // Sort the symbols by bucket.
+  std::vector<std::pair<unsigned int, unsigned int> > order;
+  order.reserve(name_count);
+  for (unsigned int i = 0; i < symbol_count; ++i)
+    order.push_back(std::make_pair(this->name_hashes_[i] % bucket_count, i));
+  std::sort(order.begin(), order.end());
+
+  this->name_order_.clear();
+  this->name_buckets_.assign(bucket_count, 0);
+  for (unsigned int i = 0; i < order.size(); ++i)
+    {
+      if (this->name_buckets_[order[i].first] == 0)
+	this->name_buckets_[order[i].first] = i + 1;
+      this->name_order_.push_back(symbols[order[i].second]);
+    }
+
+  // Lay out the entry pool, assigning an abbreviation code to each
+  // tag as we see it.  A parent may come after its children in the
+  // pool, so we find the offset of every entry before writing any.
+  std::vector<std::pair<unsigned int, bool> > abbrevs;
+  std::vector<unsigned int> entry_codes(this->name_entries_.size(), 0);
+  std::vector<uint32_t> pool_offsets(this->name_entries_.size(), 0);
+  this->entry_offsets_.clear();
+  uint32_t pool_size = 0;
+  for (unsigned int i = 0; i < this->name_order_.size(); ++i)
+    {
+      this->entry_offsets_.push_back(pool_size);
+      const Name_entry_vector* entries =
+	this->name_entry_list_[this->name_order_[i]->cu_vector_index];
+      for (Name_entry_vector::const_iterator p = entries->begin();
+	   p != entries->end();
+	   ++p)
+	{
+	  const Name_entry& entry = this->name_entries_[*p];
+	  std::pair<unsigned int, bool> abbrev(entry.tag, entry.parent >= 0);
+	  unsigned int code = 0;
+	  while (code < abbrevs.size() && abbrevs[code] != abbrev)
+	    ++code;
+	  if (code == abbrevs.size())
+	    abbrevs.push_back(abbrev);
+	  entry_codes[*p] = code + 1;
+	  pool_offsets[*p] = pool_size;
+	  pool_size += (get_length_as_unsigned_LEB_128(code + 1)
+			+ get_length_as_unsigned_LEB_128(entry.cu_index)
+			+ 4
+			+ (entry.parent >= 0 ? 4 : 0));
+	}
+      ++pool_size;
+    }
+
+  // Write the entry pool.
+  this->name_entry_pool_.clear();
+  this->name_entry_pool_.reserve(pool_size);
+  for (unsigned int i = 0; i < this->name_order_.size(); ++i)
+    {
+      const Name_entry_vector* entries =
+	this->name_entry_list_[this->name_order_[i]->cu_vector_index];
+      for (Name_entry_vector::const_iterator p = entries->begin();
+	   p != entries->end();
+	   ++p)
+	{
+	  const Name_entry& entry = this->name_entries_[*p];
+	  gold_assert(this->name_entry_pool_.size() == pool_offsets[*p]);
+	  write_unsigned_LEB_128(&this->name_entry_pool_, entry_codes[*p]);
+	  write_unsigned_LEB_128(&this->name_entry_pool_, entry.cu_index);
+	  append_debug_names_word(&this->name_entry_pool_, entry.die_offset);
+	  if (entry.parent >= 0)
+	    append_debug_names_word(&this->name_entry_pool_,
+				    pool_offsets[entry.parent]);
+	}
+      this->name_entry_pool_.push_back(0);
+    }
+  gold_assert(this->name_entry_pool_.size() == pool_size);
+
+  this->name_abbrevs_.clear();
+  for (unsigned int i = 0; i < abbrevs.size(); ++i)
+    {
+      write_unsigned_LEB_128(&this->name_abbrevs_, i + 1);
+      write_unsigned_LEB_128(&this->name_abbrevs_, abbrevs[i].first);
+      write_unsigned_LEB_128(&this->name_abbrevs_,
+			     elfcpp::DW_IDX_compile_unit);
+      write_unsigned_LEB_128(&this->name_abbrevs_, elfcpp::DW_FORM_udata);
+      write_unsigned_LEB_128(&this->name_abbrevs_, elfcpp::DW_IDX_die_offset);
+      write_unsigned_LEB_128(&this->name_abbrevs_, elfcpp::DW_FORM_ref4);
+      if (abbrevs[i].second)
+	{
+	  write_unsigned_LEB_128(&this->name_abbrevs_, elfcpp::DW_IDX_parent);
+	  write_unsigned_LEB_128(&this->name_abbrevs_, elfcpp::DW_FORM_data4);
+	}
+      this->name_abbrevs_.push_back(0);
+      this->name_abbrevs_.push_back(0);
+    }
+  this->name_abbrevs_.push_back(0);
+
+  section_size_type data_size = debug_names_hdr_size;
+  data_size += 4 * this->comp_units_.size();
+  data_size += 4 * bucket_count;
+  data_size += 3 * 4 * name_count;
+  data_size += this->name_abbrevs_.size();
+  data_size += this->name_entry_pool_.size();
+  this->set_data_size(data_size);
+}
+
+// Write the .debug_names section.  The names themselves are in the
+// .debug_str section.
+
+void
+Gdb_index::write_debug_names(unsigned char* oview)
+{
+  const off_t oview_size = this->data_size();
+  unsigned char* pov = oview;
+
+  unsigned int comp_units_count = this->comp_units_.size();
+  unsigned int bucket_count = this->name_buckets_.size();
+  unsigned int name_count = this->name_order_.size();
+
+  // Write the header.
+  write_debug_names_word(pov, oview_size - 4);
+  if (parameters->target().is_big_endian())
+    elfcpp::Swap_unaligned<16, true>::writeval(pov + 4, debug_names_version);
+  else
+    elfcpp::Swap_unaligned<16, false>::writeval(pov + 4, debug_names_version);
+  pov[6] = 0;
+  pov[7] = 0;
+  write_debug_names_word(pov + 8, comp_units_count);
+  write_debug_names_word(pov + 12, 0);
+  write_debug_names_word(pov + 16, 0);
+  write_debug_names_word(pov + 20, bucket_count);
+  write_debug_names_word(pov + 24, name_count);
+  write_debug_names_word(pov + 28, this->name_abbrevs_.size());
+  write_debug_names_word(pov + 32, debug_names_augmentation_size);
+  memcpy(pov + 36, debug_names_augmentation, debug_names_augmentation_size);
+  pov += debug_names_hdr_size;
+
+  // Write the CU list.
+  for (unsigned int i = 0; i < comp_units_count; ++i)
+    {
+      write_debug_names_word(pov, this->comp_units_[i].cu_offset);
+      pov += 4;
+    }
+
+  // Write the buckets and the hashes.
+  for (unsigned int i = 0; i < bucket_count; ++i)
+    {
+      write_debug_names_word(pov, this->name_buckets_[i]);
+      pov += 4;
+    }
+  for (unsigned int i = 0; i < name_count; ++i)
+    {
+      const Gdb_symbol* sym = this->name_order_[i];
+      write_debug_names_word(pov, this->name_hashes_[sym->cu_vector_index]);
+      pov += 4;
+    }
+
+  // Write the offsets of the names in the .debug_str section.
+  const Output_section_data* strings = this->debug_names_strings_;
+  off_t strings_offset =
+    strings->output_section()->output_section_data_offset(strings);
+  for (unsigned int i = 0; i < name_count; ++i)
+    {
+      const Gdb_symbol* sym = this->name_order_[i];
+      write_debug_names_word(pov, (strings_offset
+				   + this->stringpool_.get_offset_from_key(
+				       sym->name_key)));
+      pov += 4;
+    }
+
+  // Write the offsets of the entries.
+  for (unsigned int i = 0; i < name_count; ++i)
+    {
+      write_debug_names_word(pov, this->entry_offsets_[i]);
+      pov += 4;
+    }
+
+  // Write the abbreviation table and the entry pool.
+  memcpy(pov, &this->name_abbrevs_[0], this->name_abbrevs_.size());
+  pov += this->name_abbrevs_.size();
+  if (!this->name_entry_pool_.empty())
+    memcpy(pov, &this->name_entry_pool_[0], this->name_entry_pool_.size());
+  pov += this->name_entry_pool_.size();
+
+  gold_assert(pov - oview == oview_size);
+}
+
+// Write the names for the .debug_names section.
+
+void
+Debug_names_strings::do_write(Output_file* of)
+{
+  const off_t off = this->offset();
+  const section_size_type oview_size = this->data_size();
+  unsigned char* const oview = of->get_output_view(off, oview_size);
+  this->gdb_index_->write_names(oview, oview_size);
+  of->write_output_view(off, oview_size, oview);
+}
+
 // Print usage statistics.
 void
 Gdb_index::print_stats()
 {
-  if (parameters->options().gdb_index())
-    Gdb_index_info_reader::print_stats();
+  if (parameters->options().debug_index())
+    Gdb_index_scan::print_stats();
 }
 
 } // End namespace gold.
@@ -43,11 +43,23 @@ class Dwarf_range_list;
 template <typename T>
 class Gdb_hashtab;
 class Gdb_index_info_reader;
+class Gdb_index_scan;
+class Debug_names_strings;
 class Dwarf_pubnames_table;
+class Workqueue;
+class Task_token;
 
 // This class manages the .gdb_index section, which is a fast
 // lookup table for DWARF information used by the gdb debugger.
 // The format of this section is described in gdb/doc/gdb.texinfo.
+// With --debug-names, a DWARF 5 .debug_names section is written
+// instead, which indexes the DIEs by their DW_AT_name.
+
+// The .debug_info and .debug_types sections of each object are
+// scanned by a separate task, which records the units and names it
+// finds in a Gdb_index_scan.  The results are then added to the
+// index in the order of the objects, so the output does not depend
+// on the number of threads.
 
 class Gdb_index : public Output_section_data
 {
@@ -56,7 +68,8 @@ class Gdb_index : public Output_section_data
 
   ~Gdb_index();
 
-  // Scan a .debug_info or .debug_types input section.
+  // Scan a .debug_info or .debug_types input section.  The scan is
+  // deferred until queue_scan_tasks is called.
   void scan_debug_info(bool is_type_unit,
 		       Relobj* object,
 		       const unsigned char* symbols,
@@ -65,64 +78,38 @@ class Gdb_index : public Output_section_data
 		       unsigned int reloc_shndx,
 		       unsigned int reloc_type);
 
-  // Add a compilation unit.
-  int
-  add_comp_unit(off_t cu_offset, off_t cu_length)
-  {
-    this->comp_units_.push_back(Comp_unit(cu_offset, cu_length));
-    return this->comp_units_.size() - 1;
-  }
-
-  // Add a type unit.
-  int
-  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
-  {
-    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
-    return this->type_units_.size() - 1;
-  }
-
-  // Add an address range.
+  // Queue the tasks to scan the deferred sections and add the
+  // results to the index.  The last task holds a blocker on BLOCKER.
   void
-  add_address_range_list(Relobj* object, unsigned int cu_index,
-			 Dwarf_range_list* ranges)
-  {
-    this->ranges_.push_back(Per_cu_range_list(object, cu_index, ranges));
-  }
+  queue_scan_tasks(Workqueue* workqueue, Task_token* blocker);
 
-  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
-  // the high-byte of the cu_index field.
+  // Scan the deferred sections of the object at INDEX.  This is
+  // called by a task which holds the lock on the object.
   void
-  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+  scan_object(unsigned int index);
 
-  // Return the offset into the pubnames table for the cu at the given
-  // offset.
-  off_t
-  find_pubname_offset(off_t cu_offset);
-
-  // Return the offset into the pubtypes table for the cu at the
-  // given offset.
-  off_t
-  find_pubtype_offset(off_t cu_offset);
-
-  // Return TRUE if we have already processed the pubnames and types
-  // set for OBJECT of the CUs and TUS associated with the statement
-  // list at OFFSET.
-  bool
-  pubnames_read(const Relobj* object, off_t offset);
+  // Add the results of the scan of the object at INDEX to the index.
+  void
+  add_object(unsigned int index);
 
-  // Record that we have already read the pubnames associated with
-  // OBJECT and OFFSET.
+  // Set the section which holds the names for .debug_names.
   void
-  set_pubnames_read(const Relobj* object, off_t offset);
+  set_debug_names_strings(Debug_names_strings* strings)
+  { this->debug_names_strings_ = strings; }
 
-  // Return a pointer to the given table.
-  Dwarf_pubnames_table*
-  pubnames_table()
-  { return pubnames_table_; }
+  // Finalize the names, before the size of the .debug_str section is
+  // set, and return the size of the string table.
+  section_size_type
+  finalize_names();
 
-  Dwarf_pubnames_table*
-  pubtypes_table()
-  { return pubtypes_table_; }
+  // Write the names to the .debug_str section.  There are none if
+  // the .debug_names section is not being written.
+  void
+  write_names(unsigned char* pov, section_size_type len)
+  {
+    if (len > 0)
+      this->stringpool_.write_to_buffer(pov, len);
+  }
 
   // Print usage statistics.
   static void
@@ -143,27 +130,27 @@ class Gdb_index : public Output_section_data
   void
   do_write(Output_file*);
 
-  // Write to a map file.
+  // Write the data to a buffer.  This is only used for a compressed
+  // .debug_names section.
   void
-  do_print_to_mapfile(Mapfile* mapfile) const
-  { mapfile->print_output_data(this, _("** gdb_index")); }
-
-  // Create a map from dies to pubnames.
-  Dwarf_pubnames_table*
-  map_pubtable_to_dies(unsigned int attr,
-                       Gdb_index_info_reader* dwinfo,
-                       Relobj* object,
-                       const unsigned char* symbols,
-                       off_t symbols_size);
+  do_write_to_buffer(unsigned char* buffer)
+  {
+    gold_assert(this->is_debug_names_);
+    this->write_debug_names(buffer);
+  }
 
-  // Wrapper for map_pubtable_to_dies
+  // Write to a map file.
   void
-  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                 Relobj* object,
-                                 const unsigned char* symbols,
-                                 off_t symbols_size);
+  do_print_to_mapfile(Mapfile* mapfile) const
+  {
+    mapfile->print_output_data(this, (this->is_debug_names_
+				      ? _("** debug_names")
+				      : _("** gdb_index")));
+  }
 
  private:
+  friend class Gdb_index_scan;
+
   // An entry in the compilation unit list.
   struct Comp_unit
   {
@@ -216,20 +203,79 @@ class Gdb_index : public Output_section_data
 
   typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
 
-  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
-  Pubname_offset_map cu_pubname_map_;
-  Pubname_offset_map cu_pubtype_map_;
+  // An entry in the .debug_names section: the index of the CU, the
+  // DIE tag, the offset of the DIE within the CU, and the index of
+  // the entry for the parent DIE, or -1 if it has none.
+  struct Name_entry
+  {
+    Name_entry(int index, unsigned int t, off_t offset, int p)
+      : cu_index(index), tag(t), die_offset(offset), parent(p)
+    { }
+    int cu_index;
+    unsigned int tag;
+    off_t die_offset;
+    int parent;
+  };
+
+  // The indexes of the entries for one name.
+  typedef std::vector<unsigned int> Name_entry_vector;
 
-  // Scan the given pubtable and build a map of the various dies it
-  // refers to, so we can process the entries when we encounter the
-  // die.
+  // Find or add a symbol for SYM_NAME.
+  Gdb_symbol*
+  find_symbol(const char* sym_name);
+
+  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
+  // the high-byte of the cu_index field.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Add an entry for the .debug_names section.  PARENT is the index
+  // of an entry added earlier, or -1.
+  void
+  add_name_entry(int cu_index, const char* sym_name, unsigned int tag,
+		 off_t die_offset, int parent);
+
+  // Record that the .debug_names section cannot be written, because
+  // the debug info of OBJECT cannot be indexed for REASON.
   void
-  map_pubtable_to_dies(Dwarf_pubnames_table* table,
-                       Pubname_offset_map* map);
+  skip_debug_names(Relobj* object, const std::string& reason);
 
-  // Tables to store the pubnames section of the current object.
-  Dwarf_pubnames_table* pubnames_table_;
-  Dwarf_pubnames_table* pubtypes_table_;
+  // Scan and add the objects which were not handled by the tasks.
+  void
+  add_remaining_scans();
+
+  // Set the size of the .debug_names section.
+  void
+  set_debug_names_size();
+
+  // Write the .debug_names section to OVIEW.
+  void
+  write_debug_names(unsigned char* oview);
+
+  // True if we are writing a .debug_names section.
+  bool is_debug_names_;
+  // The scans of the objects, in order.
+  std::vector<Gdb_index_scan*> scans_;
+  // The section which holds the names for .debug_names.
+  Debug_names_strings* debug_names_strings_;
+  // True if some debug info cannot be indexed, so that we write an
+  // empty .debug_names section.
+  bool skip_debug_names_;
+  // The .debug_names entries, in the order in which they were added.
+  std::vector<Name_entry> name_entries_;
+  // The .debug_names entries for each symbol, and the hash of its
+  // name, indexed by the cu_vector_index of the symbol.
+  std::vector<Name_entry_vector*> name_entry_list_;
+  std::vector<uint32_t> name_hashes_;
+  // The symbols written to the .debug_names section, in bucket order,
+  // and the index of the first symbol in each bucket plus one.
+  std::vector<const Gdb_symbol*> name_order_;
+  std::vector<unsigned int> name_buckets_;
+  // The .debug_names abbreviation table and entry pool, and the
+  // offset in the pool of the entries of each symbol.
+  std::vector<unsigned char> name_abbrevs_;
+  std::vector<unsigned char> name_entry_pool_;
+  std::vector<uint32_t> entry_offsets_;
 
   // The .gdb_index section.
   Output_section* gdb_index_section_;
@@ -253,10 +299,36 @@ class Gdb_index : public Output_section_data
   off_t symtab_offset_;
   off_t cu_pool_offset_;
   off_t stringpool_offset_;
-  // Object, stmt list offset of the CUs and TUs associated with the
-  // last read pubnames and pubtypes sections.
-  const Relobj* pubnames_object_;
-  off_t stmt_list_offset_;
+};
+
+// The names for the .debug_names section, which are added to the end
+// of the .debug_str section.
+
+class Debug_names_strings : public Output_section_data
+{
+ public:
+  Debug_names_strings(Gdb_index* gdb_index)
+    : Output_section_data(1), gdb_index_(gdb_index)
+  { }
+
+ protected:
+  void
+  set_final_data_size()
+  { this->set_data_size(this->gdb_index_->finalize_names()); }
+
+  void
+  do_write(Output_file*);
+
+  void
+  do_write_to_buffer(unsigned char* buffer)
+  { this->gdb_index_->write_names(buffer, this->data_size()); }
+
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** debug_names strings")); }
+
+ private:
+  Gdb_index* gdb_index_;
 };
 
 } // End namespace gold.
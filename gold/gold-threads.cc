@@ -22,6 +22,7 @@
 
 #include "gold.h"
 
+#include <cerrno>
 #include <cstring>
 
 #ifdef ENABLE_THREADS
@@ -56,6 +57,13 @@ class Lock_impl_nothreads : public Lock_impl
     this->acquired_ = true;
   }
 
+  bool
+  try_acquire()
+  {
+    this->acquire();
+    return true;
+  }
+
   void
   release()
   {
@@ -83,6 +91,8 @@ class Lock_impl_threads : public Lock_impl
 
   void acquire();
 
+  bool try_acquire();
+
   void release();
 
 private:
@@ -131,6 +141,17 @@ Lock_impl_threads::acquire()
     gold_fatal(_("pthread_mutex_lock failed: %s"), strerror(err));
 }
 
+bool
+Lock_impl_threads::try_acquire()
+{
+  int err = pthread_mutex_trylock(&this->mutex_);
+  if (err == EBUSY)
+    return false;
+  if (err != 0)
+    gold_fatal(_("pthread_mutex_trylock failed: %s"), strerror(err));
+  return true;
+}
+
 void
 Lock_impl_threads::release()
 {
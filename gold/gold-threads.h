@@ -53,6 +53,9 @@ class Lock_impl
   virtual void
   acquire() = 0;
 
+  virtual bool
+  try_acquire() = 0;
+
   virtual void
   release() = 0;
 };
@@ -71,6 +74,12 @@ class Lock
   acquire()
   { this->lock_->acquire(); }
 
+  // Acquire the lock if no other thread holds it, and return whether
+  // it was acquired.
+  bool
+  try_acquire()
+  { return this->lock_->try_acquire(); }
+
   // Release the lock.
   void
   release()
@@ -134,6 +134,72 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// This class arranges to run the rest of the functions done in the
+// middle of the link, after identical code folding.
+
+class Middle_layout_runner : public Task_function_runner
+{
+ public:
+  Middle_layout_runner(const General_options& options,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_layout_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
+// This class arranges to run the functions done in the middle of the
+// link after garbage collection.
+
+class Middle_icf_runner : public Task_function_runner
+{
+ public:
+  Middle_icf_runner(const General_options& options,
+		    const Input_objects* input_objects,
+		    Symbol_table* symtab,
+		    Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_icf_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_icf_tasks(this->options_, task, this->input_objects_,
+			 this->symtab_, this->layout_, workqueue,
+			 this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -475,6 +541,25 @@ queue_middle_gc_tasks(const General_options& options,
 				     "Task_function Middle_runner"));
 }
 
+// Return the blocker to be released by the relocation task for the
+// relobj at P.  This is a new blocker, except for the last relobj,
+// which uses LAST_BLOCKER.
+
+static Task_token*
+next_relocs_blocker(const Input_objects* input_objects,
+		    Input_objects::Relobj_iterator p,
+		    Task_token* last_blocker)
+{
+  Task_token* next_blocker;
+  ++p;
+  if (p == input_objects->relobj_end())
+    next_blocker = last_blocker;
+  else
+    next_blocker = new Task_token(true);
+  next_blocker->add_blocker();
+  return next_blocker;
+}
+
 // Queue up the middle set of tasks.  These are the tasks which run
 // after all the input objects have been found and all the symbols
 // have been read, but before we lay out the output file.
@@ -521,18 +606,65 @@ queue_middle_tasks(const General_options& options,
       // Symbols named with -u should not be considered garbage.
       symtab->gc_mark_undef_symbols(layout);
       gold_assert(symtab->gc() != NULL);
-      // Do a transitive closure on all references to determine the worklist.
-      symtab->gc()->do_transitive_closure();
+      // Do a transitive closure on all references to determine the
+      // worklist.  This runs in tasks, and we continue with the rest
+      // of the middle tasks when it is done.
+      Task_function_runner* next = new Middle_icf_runner(options,
+							 input_objects,
+							 symtab, layout,
+							 mapfile);
+      symtab->gc()->do_transitive_closure(workqueue, next);
+      return;
     }
 
+  queue_middle_icf_tasks(options, task, input_objects, symtab, layout,
+			 workqueue, mapfile);
+}
+
+// Queue up the middle set of tasks which follow garbage collection.
+// This is called by queue_middle_tasks, or when the garbage collection
+// closure is complete.
+
+void
+queue_middle_icf_tasks(const General_options& options,
+		       const Task* task,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout,
+		       Workqueue* workqueue,
+		       Mapfile* mapfile)
+{
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  ICF runs in tasks, and
+  // we continue with the rest of the middle tasks when it is done.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      Task_function_runner* next = new Middle_layout_runner(options,
+							    input_objects,
+							    symtab, layout,
+							    mapfile);
+      symtab->icf()->find_identical_sections(input_objects, symtab,
+					     workqueue, next);
+      return;
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks.  This is called by
+// queue_middle_tasks, or when identical code folding is complete.
+
+void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -564,19 +696,25 @@ queue_middle_tasks(const General_options& options,
   layout->finalize_eh_frame_section();
 
   /* If plugins have specified a section order, re-arrange input sections
-     according to a specified section order.  If --section-ordering-file is
-     also specified, do not do anything here.  */
+     according to a specified section order.  If --section-ordering-file or
+     --call-graph-ordering-file is also specified, do not do anything
+     here.  */
   if (parameters->options().has_plugins()
       && layout->is_section_ordering_specified()
-      && !parameters->options().section_ordering_file ())
+      && !parameters->options().section_ordering_file ()
+      && !parameters->options().call_graph_ordering_file())
     {
       for (Layout::Section_list::const_iterator p
 	     = layout->section_list().begin();
 	   p != layout->section_list().end();
 	   ++p)
-	(*p)->update_section_layout(layout->get_section_order_map());
+	(*p)->update_section_layout(layout->get_section_order_map(), 0);
     }
 
+  // Order the sections named in a call graph profile.
+  if (parameters->options().call_graph_ordering_file())
+    layout->order_sections_by_call_graph(task, symtab);
+
   if (parameters->options().gc_sections()
       || parameters->options().icf_enabled())
     {
@@ -697,6 +835,16 @@ queue_middle_tasks(const General_options& options,
   // Make sure we have symbols for any required group signatures.
   layout->define_group_signatures(symtab);
 
+  // Scan and add the strings of mergeable string sections, which we
+  // deferred when using threads, and scan the debug info for
+  // --gdb-index and --debug-names.  We queue these tasks before the
+  // relocation tasks, which may add output sections, and they may run
+  // in parallel with them.  The last relocation task also holds a
+  // blocker on LAYOUT_BLOCKER, which the layout task waits for.
+  Task_token* layout_blocker = new Task_token(true);
+  layout->queue_merge_tasks(workqueue, layout_blocker);
+  layout->queue_gdb_index_tasks(workqueue, layout_blocker);
+
   Task_token* this_blocker = NULL;
 
   // Allocate common symbols.  We use a blocker to run this before the
@@ -719,8 +867,8 @@ queue_middle_tasks(const General_options& options,
 	   p != input_objects->relobj_end();
 	   ++p)
 	{
-	  Task_token* next_blocker = new Task_token(true);
-	  next_blocker->add_blocker();
+	  Task_token* next_blocker = next_relocs_blocker(input_objects, p,
+							 layout_blocker);
 	  workqueue->queue(new Scan_relocs(symtab, layout, *p,
 					   (*p)->get_relocs_data(),
 					   this_blocker, next_blocker));
@@ -744,8 +892,8 @@ queue_middle_tasks(const General_options& options,
 	   p != input_objects->relobj_end();
 	   ++p)
 	{
-	  Task_token* next_blocker = new Task_token(true);
-	  next_blocker->add_blocker();
+	  Task_token* next_blocker = next_relocs_blocker(input_objects, p,
+							 layout_blocker);
 	  workqueue->queue(new Read_relocs(symtab, layout, *p, this_blocker,
 					   next_blocker));
 	  this_blocker = next_blocker;
@@ -759,7 +907,7 @@ queue_middle_tasks(const General_options& options,
 	  // If we are given only archives in input, we have no regular
 	  // objects and THIS_BLOCKER is NULL here.  Create a dummy
 	  // blocker here so that we can run the layout task immediately.
-	  this_blocker = new Task_token(true);
+	  this_blocker = layout_blocker;
 	}
       else
 	{
@@ -771,6 +919,14 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // If there were no relocation tasks, the layout task only waits for
+  // THIS_BLOCKER.  There are no mergeable sections in that case.
+  if (this_blocker != layout_blocker)
+    {
+      gold_assert(!layout_blocker->is_blocked());
+      delete layout_blocker;
+    }
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -830,6 +986,31 @@ queue_final_tasks(const General_options& options,
   if (!any_postprocessing_sections)
     final_blocker->add_blocker();
 
+  // For a chunked build ID, find the chunks of the output file which
+  // can be hashed as soon as the objects which write them are done.
+  // Those tasks also block FINAL_BLOCKER, which keeps them from
+  // running while the postprocessing tasks resize the output file.
+  Build_id_chunks* build_id_chunks = NULL;
+  bool is_chunked_build_id = (strcmp(options.build_id(), "tree") == 0
+			      || strcmp(options.build_id(), "fast") == 0);
+  if (is_chunked_build_id
+      && options.build_id_chunk_size_for_treehash() > 0
+      && layout->output_file_size() > 0
+      && (static_cast<uint64_t>(layout->output_file_size())
+	  >= options.build_id_min_file_size_for_treehash()))
+    {
+      build_id_chunks =
+	new Build_id_chunks(of, options.build_id_chunk_size_for_treehash(),
+			    strcmp(options.build_id(), "fast") == 0);
+      final_blocker->add_blockers(build_id_chunks->find_early_chunks(layout));
+    }
+
+  // Sort and write out the dynamic relocs in parallel.  This comes
+  // first so that FINAL_BLOCKER can not be released before these
+  // tasks add themselves to it.
+  if (options.threads())
+    layout->queue_dynamic_reloc_tasks(workqueue, of, final_blocker);
+
   // Queue a task to write out the symbol table.
   workqueue->queue(new Write_symbols_task(layout,
 					  symtab,
@@ -852,10 +1033,19 @@ queue_final_tasks(const General_options& options,
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
        ++p)
-    workqueue->queue(new Relocate_task(symtab, layout, *p, of,
-				       input_sections_blocker,
-				       output_sections_blocker,
-				       final_blocker));
+    {
+      Task_token* build_id_blocker = NULL;
+      if (build_id_chunks != NULL)
+	build_id_blocker = build_id_chunks->relocate_blocker(*p);
+      workqueue->queue(new Relocate_task(symtab, layout, *p, of,
+					 input_sections_blocker,
+					 output_sections_blocker,
+					 final_blocker, build_id_blocker));
+    }
+
+  if (build_id_chunks != NULL)
+    build_id_chunks->queue_early_tasks(workqueue, output_sections_blocker,
+				       final_blocker);
 
   // Queue a task to write out the output sections which depend on
   // input sections.  If there are any sections which require
@@ -870,25 +1060,28 @@ queue_final_tasks(const General_options& options,
     }
   else
     {
+      // Postprocess the sections, which may be done in parallel, and
+      // then write out the sections which depend on input sections.
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
-      Task* t = new Write_after_input_sections_task(layout, of,
-						    final_blocker,
-						    new_final_blocker);
-      workqueue->queue(t);
+      Task_function_runner* runner =
+	new Postprocessing_task_runner(layout, of, new_final_blocker);
+      workqueue->queue(new Task_function(runner, final_blocker,
+					 "Task_function "
+					 "Postprocessing_task_runner"));
       final_blocker = new_final_blocker;
     }
 
-  // Create tasks for tree-style build ID computation, if necessary.
-  if (strcmp(options.build_id(), "tree") == 0)
+  // Create tasks for tree-style or fast build ID computation, if
+  // necessary.
+  if (is_chunked_build_id)
     {
       // Queue a task to compute the build id.  This will be blocked by
       // FINAL_BLOCKER, and will in turn schedule the task to close
       // the output file.
-      workqueue->queue(new Task_function(new Build_id_task_runner(&options,
-								  layout,
-								  of),
-					 final_blocker,
+      Task_function_runner* runner =
+	new Build_id_task_runner(&options, layout, of, build_id_chunks);
+      workqueue->queue(new Task_function(runner, final_blocker,
 					 "Task_function Build_id_task_runner"));
     }
   else
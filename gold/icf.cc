@@ -132,6 +132,14 @@
 //
 //
 //
+// Parallelism :
+// -----------
+//
+// The checksums and contents of the sections are computed by tasks,
+// one for each object, which run in parallel.  The sections are then
+// matched on a single thread, in order, so the sections folded do not
+// depend on the number of threads.
+//
 // How to run  : --icf=[safe|all|none]
 // Optional parameters : --icf-iterations <num> --print-icf-sections
 //
@@ -147,6 +155,8 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -155,51 +165,27 @@ namespace gold
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
+// SECTION_CKSUMS : The checksum of each section which is not yet known
+//                  to be unique.  In the first iteration this is
+//                  computed on the section's text; in later iterations
+//                  it is computed on SECTION_CONTENTS, described below.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+preprocess_for_unique_sections(const std::vector<uint32_t>& section_cksums,
+                               std::vector<bool>* is_secn_or_group_unique)
 {
   Unordered_map<uint32_t, unsigned int> uniq_map;
   std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_cksums.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
+      uint32_t cksum = section_cksums[i];
       uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
       if (uniq_map_insert.second)
         {
@@ -252,48 +238,46 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// This computes the section's contents, both text and relocs.  Relocs
+// are differentiated as those pointing to sections that could be
+// folded and those that cannot.  The text and the relocs to sections
+// that cannot be folded do not change, and are stored in
+// SECTION_CONTENTS.  The relocs pointing to sections that could be
+// folded are stored in ICF_RELOCS, and get_icf_reloc_contents turns
+// them into the rest of the contents in each iteration.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
 // SECN               : Section for which contents are desired.
 // SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// ICF_RELOCS         : Store the relocs to ICF sections.
 // SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
 //                      sections.
+// IS_DEFERRED        : If not NULL, this is being called by a task which
+//                      only holds the lock on SECN's object.  If the
+//                      contents of a section in another object are
+//                      needed, this is set to true and nothing is
+//                      stored; the caller must call this again later
+//                      with IS_DEFERRED NULL.
+//
+// The caller must hold the lock on SECN's object.
 
-static std::string
-get_section_contents(bool first_iteration,
-                     const Section_id& secn,
+static void
+get_section_contents(const Section_id& secn,
                      unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
+                     Icf::Icf_relocs* icf_relocs,
                      Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+                     std::vector<std::string>* section_contents,
+                     bool* is_deferred)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
-
   section_size_type plen;
   const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+  contents = secn.first->section_contents(secn.second, &plen, false);
 
-  // The buffer to hold all the contents including relocs.  A checksum
-  // is then computed on this buffer.
+  // The buffer to hold the contents including relocs to non-ICF
+  // sections.
   std::string buffer;
-  std::string icf_reloc_buffer;
 
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
+  icf_relocs->section_nums.clear();
+  icf_relocs->addends.clear();
 
   Icf::Reloc_info_list& reloc_info_list = 
     symtab->icf()->reloc_info_list();
@@ -302,7 +286,6 @@ get_section_contents(bool first_iteration,
     reloc_info_list.find(secn);
 
   buffer.clear();
-  icf_reloc_buffer.clear();
 
   // Process relocs and put them into the buffer.
 
@@ -337,8 +320,7 @@ get_section_contents(bool first_iteration,
 	      gsym = NULL;
 	    }
 
-	  if (first_iteration
-	      && it_v->first != NULL)
+	  if (it_v->first != NULL)
 	    {
 	      Symbol_location loc;
 	      loc.object = it_v->first;
@@ -374,15 +356,12 @@ get_section_contents(bool first_iteration,
 	  // object is NULL.
 	  if (it_v->first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if (gsym != NULL)
-                      buffer.append(gsym->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+	      // If the symbol name is available, use it.
+	      if (gsym != NULL)
+		buffer.append(gsym->name());
+	      // Append the addend.
+	      buffer.append(addend_str);
+	      buffer.append("@");
 	      continue;
 	    }
 
@@ -393,12 +372,9 @@ get_section_contents(bool first_iteration,
           if (reloc_secn.first == secn.first
               && reloc_secn.second == secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+              buffer.append("R");
+              buffer.append(addend_str);
+              buffer.append("@");
               continue;
             }
           Icf::Uniq_secn_id_map& section_id_map =
@@ -413,36 +389,32 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+              // get_icf_reloc_contents uses the kept section and the
+              // addend.
+              buffer.append("ICF_R");
+              buffer.append(addend_str);
+              icf_relocs->section_nums.push_back(section_id_map_it->second);
+              icf_relocs->addends.append(addend_str);
+              icf_relocs->addends.append("@");
             }
           else
             {
               // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
               uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
               // This reloc points to a merge section.  Hash the
               // contents of this section.
               if ((secn_flags & elfcpp::SHF_MERGE) != 0
 		  && parameters->target().can_icf_inline_merge_sections())
                 {
+		  // We can't read the contents of a section in another
+		  // object while running in a task.  Anything we have
+		  // done so far will be done again in the same way.
+		  if (is_deferred != NULL && it_v->first != secn.first)
+		    {
+		      *is_deferred = true;
+		      return;
+		    }
+
                   uint64_t entsize =
                     (it_v->first)->section_entsize(it_v->second);
 		  long long offset = it_a->first;
@@ -565,23 +537,60 @@ get_section_contents(bool first_iteration,
         }
     }
 
-  if (first_iteration)
-    {
-      buffer.append("Contents = ");
-      buffer.append(reinterpret_cast<const char*>(contents), plen);
-      // Store the section contents that don't change to avoid recomputing
-      // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
-    }
-  else
+  buffer.append("Contents = ");
+  buffer.append(reinterpret_cast<const char*>(contents), plen);
+  // Store the section contents that don't change to avoid recomputing
+  // them in each iteration.
+  (*section_contents)[section_num].swap(buffer);
+}
+
+// This returns the part of a section's contents which comes from its
+// relocs to sections that could be folded, ICF_RELOCS.  This part is
+// recomputed in each iteration, using the current kept sections in
+// KEPT_SECTION_ID, and follows the contents stored by
+// get_section_contents.
+
+static std::string
+get_icf_reloc_contents(const Icf::Icf_relocs& icf_relocs,
+                       const std::vector<unsigned int>& kept_section_id)
+{
+  std::string icf_reloc_buffer;
+  std::string::size_type pos = 0;
+  for (std::vector<unsigned int>::const_iterator p =
+         icf_relocs.section_nums.begin();
+       p != icf_relocs.section_nums.end();
+       ++p)
     {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
+      char kept_section_str[10];
+      snprintf(kept_section_str, sizeof(kept_section_str), "%u",
+               kept_section_id[*p]);
+      icf_reloc_buffer.append(kept_section_str);
+      // Append the addend, including the terminating '@'.
+      std::string::size_type end = icf_relocs.addends.find('@', pos);
+      gold_assert(end != std::string::npos);
+      icf_reloc_buffer.append(icf_relocs.addends, pos, end + 1 - pos);
+      pos = end + 1;
     }
+  return icf_reloc_buffer;
+}
+
+// Return whether the concatenation of A1 and A2 is the same as the
+// concatenation of B1 and B2.
 
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+static bool
+concatenations_equal(const std::string& a1, const std::string& a2,
+                     const std::string& b1, const std::string& b2)
+{
+  if (a1.length() + a2.length() != b1.length() + b2.length())
+    return false;
+  if (a1.length() > b1.length())
+    return concatenations_equal(b1, b2, a1, a2);
+  // A1 is a prefix of B1, and B1 is a prefix of A1 + A2.
+  size_t len1 = a1.length();
+  size_t len2 = b1.length() - len1;
+  return (memcmp(a1.data(), b1.data(), len1) == 0
+          && memcmp(a2.data(), b1.data() + len1, len2) == 0
+          && memcmp(a2.data() + len2, b2.data(), a2.length() - len2) == 0);
 }
 
 // This function computes a checksum on each section to detect and form
@@ -597,83 +606,64 @@ get_section_contents(bool first_iteration,
 // identical sections.  A section is added to a group only after its
 // contents are explicitly compared with the kept section of the group.
 //
+// The contents of a section which do not change, and their checksums,
+// are computed in parallel before this is called.  This computes the
+// rest of the contents, from the relocs to sections that could be
+// folded, and continues the checksum.  Those contents depend on the
+// sections which have been folded so far, so this visits the sections
+// in order on a single thread.
+//
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
+// ICF_RELOCS         : The relocs of each section to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // ID_SECTION         : Vector mapping a section to an unique integer.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
+// SECTION_CONTENTS   : The section's text and relocs to non-ICF
 //                      sections.
+// SECTION_CKSUMS     : The checksums of SECTION_CONTENTS.
 
 static bool
 match_sections(unsigned int iteration_num,
-               Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
+               const std::vector<Icf::Icf_relocs>& icf_relocs,
                std::vector<unsigned int>* kept_section_id,
                const std::vector<Section_id>& id_section,
 	       const std::vector<uint64_t>& section_addraligns,
                std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               const std::vector<std::string>& section_contents,
+               const std::vector<uint32_t>& section_cksums)
 {
   Unordered_multimap<uint32_t, unsigned int> section_cksum;
   std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
             Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
   bool converged = true;
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
+  std::vector<std::string> icf_reloc_contents(id_section.size());
 
   for (unsigned int i = 0; i < id_section.size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
+      if (iteration_num != 1 && (*kept_section_id)[i] != i)
         {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
-        }
-      else
-        {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
+          // This section is already folded into something.
+          continue;
         }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
+      icf_reloc_contents[i] = get_icf_reloc_contents(icf_relocs[i],
+                                                     *kept_section_id);
+      const std::string& this_icf_contents(icf_reloc_contents[i]);
+      uint32_t cksum =
+        xcrc32(reinterpret_cast<const unsigned char*>(this_icf_contents.data()),
+               this_icf_contents.length(), section_cksums[i]);
       size_t count = section_cksum.count(cksum);
 
       if (count == 0)
         {
           // Start a group with this cksum.
           section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
         }
       else
         {
@@ -683,18 +673,18 @@ match_sections(unsigned int iteration_num,
           for (it = key_range.first; it != key_range.second; ++it)
             {
               unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
+              if (!concatenations_equal(section_contents[kept_section],
+                                        icf_reloc_contents[kept_section],
+                                        section_contents[i],
+                                        this_icf_contents))
+                continue;
 
 	      // Check section alignment here.
 	      // The section with the larger alignment requirement
 	      // should be kept.  We assume alignment can only be 
-	      // zero or positive integral powers of two.
+	      // zero or positive integral powers of two.  The two
+	      // sections have the same contents, so the new kept
+	      // section can be compared with later sections.
 	      uint64_t align_i = section_addraligns[i];
 	      uint64_t align_kept = section_addraligns[kept_section];
 	      if (align_i <= align_kept)
@@ -705,8 +695,6 @@ match_sections(unsigned int iteration_num,
 		{
 		  (*kept_section_id)[kept_section] = i;
 		  it->second = i;
-		  full_section_contents[kept_section].swap(
-		      full_section_contents[i]);
 		}
 
               converged = false;
@@ -716,12 +704,11 @@ match_sections(unsigned int iteration_num,
             {
               // Create a new group for this cksum.
               section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
             }
         }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && icf_relocs[i].section_nums.empty())
         (*is_secn_or_group_unique)[i] = true;
     }
 
@@ -766,19 +753,88 @@ is_function_ctor_or_dtor(const std::string& section_name)
   return false;
 }
 
+// A task to run a step of an ICF iteration for the candidate sections
+// of a single object.  These tasks run in parallel.
+
+class Icf_task : public Task
+{
+ public:
+  Icf_task(Icf* icf, Icf::Icf_step step, unsigned int object_index,
+	   Relobj* object, Task_token* blocker)
+    : icf_(icf), step_(step), object_index_(object_index), object_(object),
+      blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->icf_->run_step(this->step_, this->object_index_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_task " + this->object_->name(); }
+
+ private:
+  Icf* icf_;
+  Icf::Icf_step step_;
+  unsigned int object_index_;
+  Relobj* object_;
+  Task_token* blocker_;
+};
+
+// This class arranges to finish a step of an ICF iteration when all
+// the Icf_tasks for it are complete.
+
+class Icf_step_runner : public Task_function_runner
+{
+ public:
+  Icf_step_runner(Icf* icf, Icf::Icf_step step)
+    : icf_(icf), step_(step)
+  { }
+
+  void
+  run(Workqueue* workqueue, const Task* task)
+  { this->icf_->finish_step(workqueue, task, this->step_); }
+
+ private:
+  Icf* icf_;
+  Icf::Icf_step step_;
+};
+
 // This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (twice by default)
-// which computes the crc checksums and detects identical functions.
+// initialization and queues the tasks which run the iterations
+// (twice by default), computing the crc checksums and detecting
+// identical functions.  The checksums are computed in parallel by
+// tasks, one for each object, and the sections are then matched
+// single-threaded.
 
 void
 Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+                             Symbol_table* symtab, Workqueue* workqueue,
+                             Task_function_runner* next)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<uint64_t> section_addraligns;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
   // Decide which sections are possible candidates first.
@@ -793,6 +849,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
       const Task* dummy_task = reinterpret_cast<const Task*>(-1);
       Task_lock_obj<Object> tl(dummy_task, *p);
 
+      unsigned int first_section_num = section_num;
       for (unsigned int i = 0;i < (*p)->shnum(); ++i)
         {
 	  const std::string section_name = (*p)->section_name(i);
@@ -816,40 +873,171 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-	  section_addraligns.push_back((*p)->section_addralign(i));
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
+          this->icf_relocs_.push_back(Icf_relocs());
+	  this->section_addraligns_.push_back((*p)->section_addralign(i));
+          this->is_secn_or_group_unique_.push_back(false);
+          this->section_contents_.push_back("");
           section_num++;
         }
+      if (section_num > first_section_num)
+	this->object_sections_.push_back(Object_sections(*p,
+							 first_section_num,
+							 section_num));
     }
 
-  unsigned int num_iterations = 0;
+  this->section_cksums_.resize(section_num);
 
   // Default number of iterations to run ICF is 2.
-  unsigned int max_iterations = (parameters->options().icf_iterations() > 0)
-                            ? parameters->options().icf_iterations()
-                            : 2;
+  this->max_iterations_ = (parameters->options().icf_iterations() > 0)
+			  ? parameters->options().icf_iterations()
+			  : 2;
+
+  this->symtab_ = symtab;
+  this->next_runner_ = next;
+  this->converged_ = false;
+  this->num_iterations_ = 1;
+  this->queue_step(workqueue, ICF_STEP_CHECKSUMS);
+}
+
+// Queue an Icf_task for each object to run step STEP of the current
+// iteration, and a task to finish the step when they are done.
+
+void
+Icf::queue_step(Workqueue* workqueue, Icf_step step)
+{
+  Task_token* blocker = new Task_token(true);
+  unsigned int count = this->object_sections_.size();
+  blocker->add_blockers(count);
+  this->step_start_usec_ = Timer::wall_time_usec();
+  for (unsigned int i = 0; i < count; ++i)
+    workqueue->queue(new Icf_task(this, step, i,
+				  this->object_sections_[i].object,
+				  blocker));
+  workqueue->queue(new Task_function(new Icf_step_runner(this, step),
+				     blocker,
+				     "Task_function Icf_step_runner"));
+}
+
+// Run step STEP of the current iteration for the candidate sections of
+// the object at OBJECT_INDEX.  This only writes the entries for those
+// sections, so the tasks for different objects may run in parallel.
+
+void
+Icf::run_step(Icf_step step, unsigned int object_index)
+{
+  Object_sections& os(this->object_sections_[object_index]);
+  bool first_iteration = this->num_iterations_ == 1;
+  for (unsigned int i = os.first; i < os.last; ++i)
+    {
+      if (this->is_secn_or_group_unique_[i])
+	continue;
+
+      const unsigned char* contents;
+      section_size_type plen;
+      if (step == ICF_STEP_CHECKSUMS && first_iteration)
+	contents = os.object->section_contents(this->id_section_[i].second,
+					       &plen, false);
+      else
+	{
+	  if (step == ICF_STEP_CONTENTS)
+	    {
+	      bool is_deferred = false;
+	      get_section_contents(this->id_section_[i], i,
+				   &this->icf_relocs_[i], this->symtab_,
+				   &this->section_contents_, &is_deferred);
+	      if (is_deferred)
+		{
+		  os.deferred.push_back(i);
+		  continue;
+		}
+	    }
+	  contents = reinterpret_cast<const unsigned char*>(
+	      this->section_contents_[i].data());
+	  plen = this->section_contents_[i].length();
+	}
+      this->section_cksums_[i] = xcrc32(contents, plen, 0xffffffff);
+    }
+}
+
+// Finish step STEP of the current iteration.  After the checksums are
+// computed, find the unique sections.  In the first iteration, then
+// queue the tasks to compute the contents of the others.  After the
+// contents are known, match the sections and either start the next
+// iteration or finish.
+
+void
+Icf::finish_step(Workqueue* workqueue, const Task* task, Icf_step step)
+{
+  uint64_t start_usec = Timer::wall_time_usec();
+  this->hash_usec_ += start_usec - this->step_start_usec_;
+
+  if (step == ICF_STEP_CHECKSUMS)
+    {
+      preprocess_for_unique_sections(this->section_cksums_,
+				     &this->is_secn_or_group_unique_);
+      // The contents only need to be computed once.  In later
+      // iterations, the checksums of the contents were computed
+      // in this step.
+      if (this->num_iterations_ == 1)
+	{
+	  this->match_usec_ += Timer::wall_time_usec() - start_usec;
+	  this->queue_step(workqueue, ICF_STEP_CONTENTS);
+	  return;
+	}
+    }
+  else
+    {
+      // Compute the contents of the sections which the tasks could not.
+      for (std::vector<Object_sections>::iterator p =
+	     this->object_sections_.begin();
+	   p != this->object_sections_.end();
+	   ++p)
+	{
+	  for (std::vector<unsigned int>::const_iterator q =
+		 p->deferred.begin();
+	       q != p->deferred.end();
+	       ++q)
+	    {
+	      unsigned int i = *q;
+	      Task_lock_obj<Object> tl(task, p->object);
+	      get_section_contents(this->id_section_[i], i,
+				   &this->icf_relocs_[i], this->symtab_,
+				   &this->section_contents_, NULL);
+	      const std::string& contents(this->section_contents_[i]);
+	      this->section_cksums_[i] =
+		xcrc32(reinterpret_cast<const unsigned char*>(contents.data()),
+		       contents.length(), 0xffffffff);
+	    }
+	  p->deferred.clear();
+	}
+    }
 
-  bool converged = false;
+  this->converged_ = match_sections(this->num_iterations_,
+				    this->icf_relocs_,
+				    &this->kept_section_id_,
+				    this->id_section_,
+				    this->section_addraligns_,
+				    &this->is_secn_or_group_unique_,
+				    this->section_contents_,
+				    this->section_cksums_);
 
-  while (!converged && (num_iterations < max_iterations))
+  this->match_usec_ += Timer::wall_time_usec() - start_usec;
+
+  if (!this->converged_ && this->num_iterations_ < this->max_iterations_)
     {
-      num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+      ++this->num_iterations_;
+      this->queue_step(workqueue, ICF_STEP_CHECKSUMS);
+      return;
     }
 
   if (parameters->options().print_icf_sections())
     {
-      if (converged)
+      if (this->converged_)
         gold_info(_("%s: ICF Converged after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
       else
         gold_info(_("%s: ICF stopped after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
     }
 
   // Unfold --keep-unique symbols.
@@ -859,7 +1047,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
        ++p)
     {
       const char* name = p->c_str();
-      Symbol* sym = symtab->lookup(name);
+      Symbol* sym = this->symtab_->lookup(name);
       if (sym == NULL)
 	{
 	  gold_warning(_("Could not find symbol %s to unfold\n"), name);
@@ -878,7 +1066,49 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 
     }
 
+  // We no longer need the state of the iterations.
+  std::vector<Object_sections>().swap(this->object_sections_);
+  std::vector<Icf_relocs>().swap(this->icf_relocs_);
+  std::vector<uint64_t>().swap(this->section_addraligns_);
+  std::vector<bool>().swap(this->is_secn_or_group_unique_);
+  std::vector<std::string>().swap(this->section_contents_);
+  std::vector<uint32_t>().swap(this->section_cksums_);
+
   this->icf_ready();
+
+  // Continue the link.
+  Task_function_runner* next = this->next_runner_;
+  this->next_runner_ = NULL;
+  next->run(workqueue, task);
+  delete next;
+}
+
+// Print statistics about ICF to stderr.
+
+void
+Icf::print_stats() const
+{
+  if (!this->icf_ready_)
+    return;
+
+  unsigned int folded = 0;
+  for (unsigned int i = 0; i < this->kept_section_id_.size(); ++i)
+    if (this->kept_section_id_[i] != i)
+      ++folded;
+
+  fprintf(stderr, _("%s: ICF sections: %u candidates, %u folded\n"),
+	  program_name,
+	  static_cast<unsigned int>(this->id_section_.size()), folded);
+  fprintf(stderr, _("%s: ICF iterations: %u (%s)\n"),
+	  program_name, this->num_iterations_,
+	  this->converged_ ? _("converged") : _("stopped"));
+  fprintf(stderr,
+	  _("%s: ICF time: checksums: %llu.%06llu matching: %llu.%06llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(this->hash_usec_ / 1000000),
+	  static_cast<unsigned long long>(this->hash_usec_ % 1000000),
+	  static_cast<unsigned long long>(this->match_usec_ / 1000000),
+	  static_cast<unsigned long long>(this->match_usec_ % 1000000));
 }
 
 // Unfolds the section denoted by OBJ and SHNDX if folded.
@@ -35,6 +35,9 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Task;
+class Task_function_runner;
+class Workqueue;
 
 class Icf
 {
@@ -64,11 +67,36 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  // The relocs of a section to sections which might be folded.  For
+  // each reloc, SECTION_NUMS holds the number of the section it
+  // points to, and ADDENDS holds the symbol value, addend and offset
+  // as a string terminated by '@'.
+  struct Icf_relocs
+  {
+    std::vector<unsigned int> section_nums;
+    std::string addends;
+  };
+
+  // The steps of an ICF iteration which run in parallel tasks, one
+  // task per object.
+  enum Icf_step
+  {
+    // Compute the checksums used to find sections which are unique.
+    ICF_STEP_CHECKSUMS,
+    // Compute the contents and checksums of the sections which are
+    // not unique.  This is only done in the first iteration.
+    ICF_STEP_CONTENTS
+  };
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
+    reloc_info_list_(), symtab_(NULL), next_runner_(NULL),
+    object_sections_(), icf_relocs_(), section_addraligns_(),
+    is_secn_or_group_unique_(), section_contents_(), section_cksums_(),
+    num_iterations_(0), max_iterations_(0), converged_(false),
+    step_start_usec_(0), hash_usec_(0), match_usec_(0)
   { }
 
   // Returns the kept folded identical section corresponding to
@@ -77,10 +105,29 @@ class Icf
   get_folded_section(Relobj* dup_obj, unsigned int dup_shndx);
 
   // Forms groups of identical sections where the first member
-  // of each group is the kept section during folding.
+  // of each group is the kept section during folding.  This queues
+  // tasks which do the work; NEXT is run, and then deleted, when
+  // they are complete.
   void
   find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+                          Symbol_table* symtab, Workqueue* workqueue,
+                          Task_function_runner* next);
+
+  // Run step STEP of the current iteration for the sections of the
+  // object at index OBJECT_INDEX.  This is called by a task which
+  // holds the lock on the object.
+  void
+  run_step(Icf_step step, unsigned int object_index);
+
+  // Finish step STEP of the current iteration, after the tasks
+  // running it are complete, and queue the next step.  TASK is the
+  // task running this.
+  void
+  finish_step(Workqueue* workqueue, const Task* task, Icf_step step);
+
+  // Print statistics about ICF to stderr.  This is used for --stats.
+  void
+  print_stats() const;
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
@@ -160,6 +207,61 @@ class Icf
   bool icf_ready_;
   // This list is populated by gc_process_relocs in gc.h.
   Reloc_info_list reloc_info_list_;
+
+  // The candidate sections of an object, which are numbered from
+  // FIRST up to but not including LAST.  Sections whose contents
+  // could not be computed by the task for this object are recorded
+  // in DEFERRED.
+  struct Object_sections
+  {
+    Object_sections(Relobj* objecta, unsigned int firsta,
+		    unsigned int lasta)
+      : object(objecta), first(firsta), last(lasta), deferred()
+    { }
+
+    Relobj* object;
+    unsigned int first;
+    unsigned int last;
+    std::vector<unsigned int> deferred;
+  };
+
+  // Queue the tasks to run step STEP of the current iteration.
+  void
+  queue_step(Workqueue* workqueue, Icf_step step);
+
+  // The symbol table.
+  Symbol_table* symtab_;
+  // The runner to run when ICF is complete.
+  Task_function_runner* next_runner_;
+  // The candidate sections of each object.
+  std::vector<Object_sections> object_sections_;
+  // The remaining fields hold the state of the ICF iterations, and
+  // are indexed by section number.
+  // The relocs to sections which might be folded.
+  std::vector<Icf_relocs> icf_relocs_;
+  // The alignment of each section.
+  std::vector<uint64_t> section_addraligns_;
+  // Whether a section or group of identical sections is known to be
+  // unique.
+  std::vector<bool> is_secn_or_group_unique_;
+  // The contents of each section which do not change between
+  // iterations.
+  std::vector<std::string> section_contents_;
+  // The checksum of each section in the current step.  After the
+  // contents are computed, this is the checksum of SECTION_CONTENTS_.
+  std::vector<uint32_t> section_cksums_;
+  // The number of iterations started so far.
+  unsigned int num_iterations_;
+  // The maximum number of iterations.
+  unsigned int max_iterations_;
+  // Whether the iterations have converged.
+  bool converged_;
+  // The time at which the tasks for the current step were queued.
+  uint64_t step_start_usec_;
+  // The time spent in the parallel steps, for --stats.
+  uint64_t hash_usec_;
+  // The time spent matching sections, for --stats.
+  uint64_t match_usec_;
 };
 
 // This function returns true if this section corresponds to a function that
@@ -801,8 +801,11 @@ Sized_incremental_binary<size, big_endian>::do_apply_incremental_relocs(
 	      Addend r_addend = irelocs.get_r_addend(r_base);
 	      Output_section* os = this->output_section(r_shndx);
 	      Address address = os->address();
-	      off_t section_offset = os->offset();
-	      size_t view_size = os->data_size();
+	      // The relocations are applied before the file is resized,
+	      // so use the location of the section in the base file, in
+	      // case it has been moved to make it larger.
+	      off_t section_offset = os->fixed_layout_base_offset();
+	      size_t view_size = os->fixed_layout_base_size();
 	      unsigned char* const view = of->get_output_view(section_offset,
 							      view_size);
 
@@ -2469,7 +2472,8 @@ template<int size, bool big_endian>
 void
 Sized_relobj_incr<size, big_endian>::do_count_local_symbols(
     Stringpool_template<char>* pool,
-    Stringpool_template<char>*)
+    Stringpool_template<char>*,
+    unsigned int order)
 {
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
 
@@ -2494,7 +2498,8 @@ Sized_relobj_incr<size, big_endian>::do_count_local_symbols(
       if (!strtab.get_c_string(sym.get_st_name(), &name))
 	name = "";
       gold_debug(DEBUG_INCREMENTAL, "Local symbol %d: %s", i, name);
-      name = pool->add(name, true, NULL);
+      name = pool->add_ordered(name,
+			       (static_cast<uint64_t>(order) << 32) | i);
       this->local_symbols_.push_back(Local_symbol(name,
 						  sym.get_st_value(),
 						  sym.get_st_size(),
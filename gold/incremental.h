@@ -2000,7 +2000,7 @@ class Sized_relobj_incr : public Sized_relobj<size, big_endian>
   // Count the local symbols.
   void
   do_count_local_symbols(Stringpool_template<char>*,
-			 Stringpool_template<char>*);
+			 Stringpool_template<char>*, unsigned int);
 
   // Finalize the local symbols.
   unsigned int
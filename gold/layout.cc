@@ -49,6 +49,7 @@
 #include "dynobj.h"
 #include "ehframe.h"
 #include "gdb-index.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 #include "reduced_debug_output.h"
 #include "object.h"
@@ -56,6 +57,7 @@
 #include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "icf.h"
 #include "layout.h"
 
 namespace gold
@@ -92,6 +94,25 @@ Free_list::init(off_t len, bool extend)
   ++Free_list::num_nodes;
 }
 
+// Extend the region to length LEN.  The new space is merged with the
+// last free chunk if that chunk runs to the old end of the region.
+
+void
+Free_list::extend(off_t len)
+{
+  gold_assert(len >= this->length_);
+  if (len == this->length_)
+    return;
+  if (!this->list_.empty() && this->list_.back().end_ == this->length_)
+    this->list_.back().end_ = len;
+  else
+    {
+      this->list_.push_back(Free_list_node(this->length_, len));
+      ++Free_list::num_nodes;
+    }
+  this->length_ = len;
+}
+
 // Remove a chunk from the free list.  Because we start with a single
 // node that covers the entire section, and remove chunks from it one
 // at a time, we do not need to coalesce chunks or handle cases that
@@ -239,7 +260,101 @@ Free_list::print_stats()
 	  program_name, Free_list::num_allocate_visits);
 }
 
-// A Hash_task computes the MD5 checksum of an array of char.
+// Compute the 64-bit xxHash, with a seed of 0, of SIZE bytes at P.
+// This is much faster than MD5 or SHA-1, and is used for
+// --build-id=fast.
+
+static inline uint64_t
+xxhash64_round(uint64_t acc, uint64_t input)
+{
+  acc += input * 0xc2b2ae3d27d4eb4fULL;
+  acc = (acc << 31) | (acc >> 33);
+  return acc * 0x9e3779b185ebca87ULL;
+}
+
+static uint64_t
+xxhash64(const unsigned char* p, size_t size)
+{
+  static const uint64_t prime1 = 0x9e3779b185ebca87ULL;
+  static const uint64_t prime2 = 0xc2b2ae3d27d4eb4fULL;
+  static const uint64_t prime3 = 0x165667b19e3779f9ULL;
+  static const uint64_t prime4 = 0x85ebca77c2b2ae63ULL;
+  static const uint64_t prime5 = 0x27d4eb2f165667c5ULL;
+
+  const unsigned char* const pend = p + size;
+  uint64_t h;
+  if (size >= 32)
+    {
+      uint64_t v1 = prime1 + prime2;
+      uint64_t v2 = prime2;
+      uint64_t v3 = 0;
+      uint64_t v4 = -prime1;
+      const unsigned char* const plimit = pend - 32;
+      do
+	{
+	  typedef elfcpp::Swap_unaligned<64, false> Swap64;
+	  v1 = xxhash64_round(v1, Swap64::readval(p));
+	  v2 = xxhash64_round(v2, Swap64::readval(p + 8));
+	  v3 = xxhash64_round(v3, Swap64::readval(p + 16));
+	  v4 = xxhash64_round(v4, Swap64::readval(p + 24));
+	  p += 32;
+	}
+      while (p <= plimit);
+
+      h = (((v1 << 1) | (v1 >> 63)) + ((v2 << 7) | (v2 >> 57))
+	   + ((v3 << 12) | (v3 >> 52)) + ((v4 << 18) | (v4 >> 46)));
+      h = (h ^ xxhash64_round(0, v1)) * prime1 + prime4;
+      h = (h ^ xxhash64_round(0, v2)) * prime1 + prime4;
+      h = (h ^ xxhash64_round(0, v3)) * prime1 + prime4;
+      h = (h ^ xxhash64_round(0, v4)) * prime1 + prime4;
+    }
+  else
+    h = prime5;
+
+  h += size;
+
+  for (; p + 8 <= pend; p += 8)
+    {
+      h ^= xxhash64_round(0, elfcpp::Swap_unaligned<64, false>::readval(p));
+      h = ((h << 27) | (h >> 37)) * prime1 + prime4;
+    }
+  if (p + 4 <= pend)
+    {
+      uint64_t k = elfcpp::Swap_unaligned<32, false>::readval(p);
+      h ^= k * prime1;
+      h = ((h << 23) | (h >> 41)) * prime2 + prime3;
+      p += 4;
+    }
+  for (; p < pend; ++p)
+    {
+      h ^= *p * prime5;
+      h = ((h << 11) | (h >> 53)) * prime1;
+    }
+
+  h ^= h >> 33;
+  h *= prime2;
+  h ^= h >> 29;
+  h *= prime3;
+  h ^= h >> 32;
+  return h;
+}
+
+// Hash SIZE bytes at P into DST, as one chunk of a tree-style or fast
+// build ID.  Tree-style build IDs use MD5 for the chunks, and fast
+// build IDs use xxHash stored in little-endian order.
+
+static void
+hash_build_id_chunk(const unsigned char* p, size_t size, bool is_fast,
+		    unsigned char* dst)
+{
+  if (is_fast)
+    elfcpp::Swap_unaligned<64, false>::writeval(dst, xxhash64(p, size));
+  else
+    md5_buffer(reinterpret_cast<const char*>(p), size, dst);
+}
+
+// A Hash_task computes the hash of a chunk of the output file for a
+// tree-style or fast build ID.
 
 class Hash_task : public Task
 {
@@ -247,9 +362,10 @@ class Hash_task : public Task
   Hash_task(Output_file* of,
 	    size_t offset,
 	    size_t size,
+	    bool is_fast,
 	    unsigned char* dst,
 	    Task_token* final_blocker)
-    : of_(of), offset_(offset), size_(size), dst_(dst),
+    : of_(of), offset_(offset), size_(size), is_fast_(is_fast), dst_(dst),
       final_blocker_(final_blocker)
   { }
 
@@ -258,7 +374,7 @@ class Hash_task : public Task
   {
     const unsigned char* iv =
 	this->of_->get_input_view(this->offset_, this->size_);
-    md5_buffer(reinterpret_cast<const char*>(iv), this->size_, this->dst_);
+    hash_build_id_chunk(iv, this->size_, this->is_fast_, this->dst_);
     this->of_->free_input_view(this->offset_, this->size_, iv);
   }
 
@@ -279,10 +395,63 @@ class Hash_task : public Task
   Output_file* of_;
   const size_t offset_;
   const size_t size_;
+  const bool is_fast_;
   unsigned char* const dst_;
   Task_token* const final_blocker_;
 };
 
+// A Build_id_chunk_task hashes a chunk of the output file as soon as
+// the tasks which write it are done, while other parts of the file
+// are still being written.
+
+class Build_id_chunk_task : public Task
+{
+ public:
+  Build_id_chunk_task(Build_id_chunks* chunks, unsigned int index,
+		      const std::vector<Task_token*>* blockers,
+		      Task_token* output_sections_blocker,
+		      Task_token* final_blocker)
+    : chunks_(chunks), index_(index), blockers_(blockers),
+      output_sections_blocker_(output_sections_blocker),
+      final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->chunks_->hash_early_chunk(this->index_); }
+
+  // Wait for the Write_sections_task and the Relocate_tasks which
+  // write the chunk.
+  Task_token*
+  is_runnable()
+  {
+    if (this->output_sections_blocker_->is_blocked())
+      return this->output_sections_blocker_;
+    for (std::vector<Task_token*>::const_iterator p = this->blockers_->begin();
+	 p != this->blockers_->end();
+	 ++p)
+      if ((*p)->is_blocked())
+	return *p;
+    return NULL;
+  }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Build_id_chunk_task"; }
+
+ private:
+  Build_id_chunks* chunks_;
+  const unsigned int index_;
+  const std::vector<Task_token*>* blockers_;
+  Task_token* output_sections_blocker_;
+  Task_token* final_blocker_;
+};
+
 // Layout::Relaxation_debug_check methods.
 
 // Check that sections and special data are in reset states.
@@ -368,7 +537,8 @@ void
 Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 {
   // See if any of the input definitions violate the One Definition Rule.
-  // TODO: if this is too slow, do this as a task, rather than inline.
+  // With --threads this reads the debug information of several
+  // objects at once.
   this->symtab_->detect_odr_violations(task, this->options_.output_file_name());
 
   Layout* layout = this->layout_;
@@ -409,6 +579,11 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 							     of);
 
       of->resize(file_size);
+
+      // Copy the sections which had to be moved to make room for
+      // larger input sections to their new locations.
+      if (parameters->incremental_update())
+	layout->move_grown_sections(of);
     }
 
   // Queue up the final set of tasks.
@@ -443,6 +618,8 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     dynamic_section_(NULL),
     dynamic_symbol_(NULL),
     dynamic_data_(NULL),
+    dynamic_relocs_(NULL),
+    relr_dyn_section_(NULL),
     eh_frame_section_(NULL),
     eh_frame_data_(NULL),
     added_eh_frame_data_(false),
@@ -463,6 +640,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     resized_signatures_(false),
     have_stabstr_section_(false),
     section_ordering_specified_(false),
+    records_section_writers_(false),
     unique_segment_for_sections_specified_(false),
     incremental_inputs_(NULL),
     record_output_section_data_from_script_(false),
@@ -473,6 +651,12 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     section_segment_map_(),
     input_section_position_(),
     input_section_glob_(),
+    call_graph_names_(),
+    call_graph_edges_(),
+    call_graph_names_not_found_(0),
+    call_graph_edges_used_(0),
+    call_graph_sections_ordered_(0),
+    call_graph_clusters_(0),
     incremental_base_(NULL),
     free_list_(),
     gnu_properties_()
@@ -489,6 +673,18 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
   if (parameters->incremental())
     this->incremental_inputs_ = new Incremental_inputs;
 
+  // Chunked build IDs hash the parts of the output file which are
+  // written by input sections as soon as the objects are relocated.
+  // Incremental updates write into the existing layout, so we don't
+  // know where the objects are written.
+  if (parameters->options().user_set_build_id()
+      && !parameters->incremental())
+    {
+      const char* style = parameters->options().build_id();
+      this->records_section_writers_ = (strcmp(style, "tree") == 0
+					|| strcmp(style, "fast") == 0);
+    }
+
   // The section name pool is worth optimizing in all cases, because
   // it is small, but there are often overlaps due to .rel sections.
   this->namepool_.set_optimize();
@@ -722,6 +918,14 @@ Layout::include_section(Sized_relobj_file<size, big_endian>*, const char* name,
 	      && !is_gdb_debug_section(name + 8))
 	    return false;
 	}
+      if (parameters->options().debug_names()
+	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0
+	  && strcmp(name, ".debug_names") == 0)
+	{
+	  // When building .debug_names, we discard the input
+	  // .debug_names sections, which no longer describe the output.
+	  return false;
+	}
       if (parameters->options().gdb_index()
 	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
 	{
@@ -1622,7 +1826,7 @@ Layout::remove_eh_frame_for_plt(Output_data* plt, const unsigned char* cie_data,
 }
 
 // Scan a .debug_info or .debug_types section, and add summary
-// information to the .gdb_index section.
+// information to the .gdb_index or .debug_names section.
 
 template<int size, bool big_endian>
 void
@@ -1636,7 +1840,23 @@ Layout::add_to_gdb_index(bool is_type_unit,
 {
   if (this->gdb_index_data_ == NULL)
     {
-      Output_section* os = this->choose_output_section(NULL, ".gdb_index",
+      bool debug_names = parameters->options().debug_names();
+
+      // The names in the .debug_names section are stored in the
+      // .debug_str section.
+      Output_section* strings_os = NULL;
+      if (debug_names)
+	{
+	  strings_os = this->choose_output_section(NULL, ".debug_str",
+						   elfcpp::SHT_PROGBITS, 0,
+						   false, ORDER_INVALID,
+						   false, false, false);
+	  if (strings_os == NULL)
+	    return;
+	}
+
+      const char* name = debug_names ? ".debug_names" : ".gdb_index";
+      Output_section* os = this->choose_output_section(NULL, name,
 						       elfcpp::SHT_PROGBITS, 0,
 						       false, ORDER_INVALID,
 						       false, false, false);
@@ -1646,6 +1866,14 @@ Layout::add_to_gdb_index(bool is_type_unit,
       this->gdb_index_data_ = new Gdb_index(os);
       os->add_output_section_data(this->gdb_index_data_);
       os->set_after_input_sections();
+
+      if (debug_names)
+	{
+	  Debug_names_strings* strings =
+	    new Debug_names_strings(this->gdb_index_data_);
+	  strings_os->add_output_section_data(strings);
+	  this->gdb_index_data_->set_debug_names_strings(strings);
+	}
     }
 
   this->gdb_index_data_->scan_debug_info(is_type_unit, object, symbols,
@@ -2945,6 +3173,350 @@ Layout::read_layout_from_file()
     }
 }
 
+// Read the call graph profile from the file specified with
+// --call-graph-ordering-file.  Each line holds the name of a caller,
+// the name of a callee, and a weight, such as the number of samples
+// in which the caller called the callee, separated by white space.
+// Lines beginning with '#' are comments.
+
+void
+Layout::read_call_graph_from_file()
+{
+  const char* filename = parameters->options().call_graph_ordering_file();
+  std::ifstream in;
+  std::string line;
+
+  in.open(filename);
+  if (!in)
+    gold_fatal(_("unable to open --call-graph-ordering-file file %s: %s"),
+	       filename, strerror(errno));
+
+  this->set_section_ordering_specified();
+
+  Unordered_map<std::string, unsigned int> name_indexes;
+  unsigned int lineno = 0;
+  while (std::getline(in, line))
+    {
+      ++lineno;
+
+      // Split the line into at most four fields, so that we can tell
+      // when there are too many.
+      std::vector<std::string> fields;
+      std::string::size_type pos = 0;
+      while (fields.size() < 4)
+	{
+	  pos = line.find_first_not_of(" \t\r", pos);
+	  if (pos == std::string::npos)
+	    break;
+	  std::string::size_type end = line.find_first_of(" \t\r", pos);
+	  fields.push_back(line.substr(pos, end - pos));
+	  pos = end;
+	}
+      if (fields.empty() || fields[0][0] == '#')
+	continue;
+
+      char* end = NULL;
+      unsigned long long weight = 0;
+      if (fields.size() == 3 && fields[2][0] >= '0' && fields[2][0] <= '9')
+	weight = strtoull(fields[2].c_str(), &end, 10);
+      if (end == NULL || *end != '\0')
+	{
+	  gold_error(_("%s:%u: expected a caller, a callee and a weight"),
+		     filename, lineno);
+	  continue;
+	}
+      if (weight == 0)
+	continue;
+
+      unsigned int indexes[2];
+      for (int i = 0; i < 2; ++i)
+	{
+	  unsigned int next_index = this->call_graph_names_.size();
+	  std::pair<Unordered_map<std::string, unsigned int>::iterator, bool>
+	    ins(name_indexes.insert(std::make_pair(fields[i], next_index)));
+	  if (ins.second)
+	    this->call_graph_names_.push_back(fields[i]);
+	  indexes[i] = ins.first->second;
+	}
+      this->call_graph_edges_.push_back(Call_graph_edge(indexes[0],
+							indexes[1],
+							weight));
+    }
+}
+
+// A cluster of input sections for --call-graph-ordering-file.  Each
+// section starts in a cluster of its own, and clusters are merged
+// by appending a callee's cluster to its caller's.
+
+struct Call_graph_cluster
+{
+  Call_graph_cluster(unsigned int index, uint64_t sizea)
+    : next(index), last(index), size(sizea), weight(0), initial_weight(0),
+      best_caller(-1U), best_caller_weight(0)
+  { }
+
+  // The number of calls per byte.
+  double
+  density() const
+  { return static_cast<double>(this->weight) / this->size; }
+
+  // The next section in the cluster.  The sections of a cluster
+  // form a circular list starting at the cluster's leader.
+  unsigned int next;
+  // For a leader, the last section in its cluster.
+  unsigned int last;
+  // The size of the cluster in bytes, or 0 if it has been merged
+  // into another.
+  uint64_t size;
+  // The total weight of the calls into the sections of the cluster.
+  uint64_t weight;
+  // The weight of the calls into this section alone.
+  uint64_t initial_weight;
+  // The section whose calls into this one have the highest weight,
+  // or -1U, and that weight.
+  unsigned int best_caller;
+  uint64_t best_caller_weight;
+};
+
+// Sort clusters from the highest density to the lowest.
+
+class Call_graph_density_compare
+{
+ public:
+  Call_graph_density_compare(const std::vector<Call_graph_cluster>& clusters)
+    : clusters_(clusters)
+  { }
+
+  bool
+  operator()(unsigned int a, unsigned int b) const
+  { return this->clusters_[a].density() > this->clusters_[b].density(); }
+
+ private:
+  const std::vector<Call_graph_cluster>& clusters_;
+};
+
+// Return the leader of the cluster holding section I, flattening the
+// path to it as we go.
+
+static unsigned int
+call_graph_leader(std::vector<unsigned int>* leaders, unsigned int i)
+{
+  while ((*leaders)[i] != i)
+    {
+      (*leaders)[i] = (*leaders)[(*leaders)[i]];
+      i = (*leaders)[i];
+    }
+  return i;
+}
+
+// Do not grow a cluster past this many bytes, so that a cluster
+// spans only a few pages of the instruction TLB.
+const uint64_t call_graph_max_cluster_size = 1024 * 1024;
+
+// Do not merge a cluster into its caller's if that would make the
+// density of the caller's cluster fall by more than this factor.
+const double call_graph_max_density_degradation = 8.0;
+
+// Order the sections named in the call graph profile using the C3
+// heuristic (Ottoni and Maher, "Optimizing Function Placement for
+// Large-Scale Data-Center Applications", CGO 2017).  Visiting the
+// sections from the most frequently called per byte, each is
+// appended to the cluster of its most frequent caller, unless the
+// call is rare or the result too large or too sparse.  The clusters
+// are then placed from the densest.  The sections in each output
+// section which the profile does not name are placed after those it
+// does, in their input order, which separates the hot code from the
+// cold.
+
+void
+Layout::order_sections_by_call_graph(const Task* task, Symbol_table* symtab)
+{
+  const unsigned int no_node = -1U;
+
+  // Find the section defining each name.  Names not defined in a
+  // section of a regular object which is part of the output, such
+  // as names of functions in shared libraries or local symbols, are
+  // ignored.
+  std::vector<Section_id> name_sections(this->call_graph_names_.size(),
+					Section_id(NULL, 0));
+  std::vector<Output_section*> name_output_sections(name_sections.size(),
+						    NULL);
+  for (size_t i = 0; i < this->call_graph_names_.size(); ++i)
+    {
+      Symbol* sym = symtab->lookup(this->call_graph_names_[i].c_str());
+      bool is_ordinary = false;
+      unsigned int shndx = 0;
+      if (sym != NULL
+	  && sym->source() == Symbol::FROM_OBJECT
+	  && !sym->object()->is_dynamic()
+	  && sym->object()->pluginobj() == NULL)
+	shndx = sym->shndx(&is_ordinary);
+      if (!is_ordinary || shndx == elfcpp::SHN_UNDEF)
+	{
+	  ++this->call_graph_names_not_found_;
+	  continue;
+	}
+
+      Relobj* relobj = static_cast<Relobj*>(sym->object());
+      if (parameters->options().icf_enabled()
+	  && symtab->icf()->is_section_folded(relobj, shndx))
+	{
+	  Section_id kept = symtab->icf()->get_folded_section(relobj, shndx);
+	  relobj = kept.first;
+	  shndx = kept.second;
+	}
+      Output_section* os = relobj->output_section(shndx);
+      if (os == NULL)
+	{
+	  ++this->call_graph_names_not_found_;
+	  continue;
+	}
+      name_sections[i] = Section_id(relobj, shndx);
+      name_output_sections[i] = os;
+    }
+
+  // Make a node for each section at either end of an edge.  Sections
+  // in different output sections can not be placed together, so we
+  // drop the edges between them.  Then combine the edges between each
+  // pair of sections.
+  Unordered_map<Section_id, unsigned int, Section_id_hash> section_nodes;
+  std::vector<Section_id> node_sections;
+  std::vector<Output_section*> node_output_sections;
+  std::vector<Call_graph_cluster> clusters;
+  typedef std::pair<std::pair<unsigned int, unsigned int>, uint64_t> Edge;
+  std::vector<Edge> edges;
+  for (std::vector<Call_graph_edge>::const_iterator p =
+	 this->call_graph_edges_.begin();
+       p != this->call_graph_edges_.end();
+       ++p)
+    {
+      Output_section* os = name_output_sections[p->caller];
+      if (os == NULL || os != name_output_sections[p->callee])
+	continue;
+
+      unsigned int names[2] = { p->caller, p->callee };
+      unsigned int nodes[2];
+      for (int i = 0; i < 2; ++i)
+	{
+	  Section_id secid(name_sections[names[i]]);
+	  std::pair<Unordered_map<Section_id, unsigned int,
+				  Section_id_hash>::iterator, bool>
+	    ins(section_nodes.insert(std::make_pair(secid, clusters.size())));
+	  if (ins.second)
+	    {
+	      uint64_t size;
+	      {
+		Task_lock_obj<Object> tlo(task, secid.first);
+		size = secid.first->section_size(secid.second);
+	      }
+	      if (size == 0)
+		size = 1;
+	      clusters.push_back(Call_graph_cluster(clusters.size(), size));
+	      node_sections.push_back(secid);
+	      node_output_sections.push_back(os);
+	    }
+	  nodes[i] = ins.first->second;
+	}
+      edges.push_back(Edge(std::make_pair(nodes[0], nodes[1]), p->weight));
+    }
+  std::sort(edges.begin(), edges.end());
+
+  for (size_t i = 0; i < edges.size(); )
+    {
+      size_t start = i;
+      unsigned int caller = edges[start].first.first;
+      unsigned int callee = edges[start].first.second;
+      uint64_t weight = 0;
+      for (; i < edges.size() && edges[i].first == edges[start].first; ++i)
+	weight += edges[i].second;
+      ++this->call_graph_edges_used_;
+
+      Call_graph_cluster& c(clusters[callee]);
+      c.weight += weight;
+      c.initial_weight += weight;
+      if (caller != callee && weight > c.best_caller_weight)
+	{
+	  c.best_caller = caller;
+	  c.best_caller_weight = weight;
+	}
+    }
+
+  std::vector<unsigned int> leaders(clusters.size());
+  for (size_t i = 0; i < leaders.size(); ++i)
+    leaders[i] = i;
+  std::vector<unsigned int> sorted(leaders);
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   Call_graph_density_compare(clusters));
+
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      Call_graph_cluster& c(clusters[*p]);
+
+      // Only follow a call which makes up at least a tenth of the
+      // calls into the section.
+      if (c.best_caller == no_node
+	  || c.best_caller_weight * 10 <= c.initial_weight)
+	continue;
+
+      unsigned int to = call_graph_leader(&leaders, c.best_caller);
+      if (to == *p)
+	continue;
+      Call_graph_cluster& to_c(clusters[to]);
+      if (to_c.size + c.size > call_graph_max_cluster_size)
+	continue;
+      double density = (static_cast<double>(to_c.weight + c.weight)
+			/ (to_c.size + c.size));
+      if (density < to_c.density() / call_graph_max_density_degradation)
+	continue;
+
+      leaders[*p] = to;
+      clusters[to_c.last].next = *p;
+      clusters[c.last].next = to;
+      to_c.last = c.last;
+      to_c.size += c.size;
+      to_c.weight += c.weight;
+      c.size = 0;
+      c.weight = 0;
+    }
+
+  sorted.clear();
+  for (size_t i = 0; i < clusters.size(); ++i)
+    if (clusters[i].size > 0)
+      sorted.push_back(i);
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   Call_graph_density_compare(clusters));
+  this->call_graph_clusters_ = sorted.size();
+
+  Output_section::Section_layout_order order_map;
+  Unordered_set<Output_section*> output_sections;
+  unsigned int order_index = 0;
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      unsigned int i = *p;
+      do
+	{
+	  order_map[node_sections[i]] = ++order_index;
+	  output_sections.insert(node_output_sections[i]);
+	  i = clusters[i].next;
+	}
+      while (i != *p);
+    }
+  this->call_graph_sections_ordered_ = order_index;
+
+  for (Unordered_set<Output_section*>::const_iterator p =
+	 output_sections.begin();
+       p != output_sections.end();
+       ++p)
+    (*p)->update_section_layout(&order_map, order_index + 1);
+
+  this->call_graph_names_.clear();
+  this->call_graph_edges_.clear();
+}
+
 // Finalize the layout.  When this is called, we have created all the
 // output sections and all the output segments which are based on
 // input sections.  We have several things to do, and we have to do
@@ -3422,6 +3994,8 @@ Layout::create_build_id()
     descsz = 128 / 8;
   else if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
     descsz = 160 / 8;
+  else if (strcmp(style, "fast") == 0)
+    descsz = 64 / 8;
   else if (strcmp(style, "uuid") == 0)
     {
 #ifndef __MINGW32__
@@ -4309,6 +4883,64 @@ Layout::place_orphan_sections_in_script()
 // Count the local symbols in the regular symbol table and the dynamic
 // symbol table, and build the respective string pools.
 
+// A Parallel_job which counts the local symbols of the input objects
+// and adds their names to the symbol name pools.  Each piece handles
+// the objects from one input file, in order, because the members of
+// an archive share a File_read, which only one thread may use at a
+// time.
+
+class Count_local_symbols_job : public Parallel_job
+{
+ public:
+  Count_local_symbols_job(const Task* task, Stringpool* sympool,
+			  Stringpool* dynpool)
+    : task_(task), sympool_(sympool), dynpool_(dynpool), pieces_(),
+      piece_index_()
+  { }
+
+  // Add OBJECT, which is at position ORDER in the list of objects.
+  void
+  add_object(Relobj* object, unsigned int order)
+  {
+    std::pair<Piece_index::iterator, bool> ins =
+      this->piece_index_.insert(std::make_pair(object->input_file(),
+					       this->pieces_.size()));
+    if (ins.second)
+      this->pieces_.push_back(Piece());
+    this->pieces_[ins.first->second].push_back(std::make_pair(object,
+							      order));
+  }
+
+  // Return the number of pieces.
+  unsigned int
+  piece_count() const
+  { return this->pieces_.size(); }
+
+  void
+  run_piece(unsigned int index)
+  {
+    const Piece& piece(this->pieces_[index]);
+    for (Piece::const_iterator p = piece.begin(); p != piece.end(); ++p)
+      {
+	Task_lock_obj<Object> tlo(this->task_, p->first);
+	p->first->count_local_symbols(this->sympool_, this->dynpool_,
+				      p->second);
+      }
+  }
+
+ private:
+  // The objects from one input file, with their positions.
+  typedef std::vector<std::pair<Relobj*, unsigned int> > Piece;
+  // Map from an input file to the index of its piece.
+  typedef Unordered_map<const Input_file*, unsigned int> Piece_index;
+
+  const Task* task_;
+  Stringpool* sympool_;
+  Stringpool* dynpool_;
+  std::vector<Piece> pieces_;
+  Piece_index piece_index_;
+};
+
 void
 Layout::count_local_symbols(const Task* task,
 			    const Input_objects* input_objects)
@@ -4332,12 +4964,35 @@ Layout::count_local_symbols(const Task* task,
   this->sympool_.reserve(symbol_count);
   this->dynpool_.reserve(symbol_count);
 
+  // With threads, count the symbols of several objects at once.  The
+  // objects of an incremental update share the base file, so they
+  // are always done in order.
+  if (Parallel_job::thread_count() > 1
+      && !parameters->incremental_update()
+      && input_objects->number_of_relobjs() > 1)
+    {
+      Count_local_symbols_job job(task, &this->sympool_, &this->dynpool_);
+      unsigned int order = 0;
+      for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+	   p != input_objects->relobj_end();
+	   ++p, ++order)
+	job.add_object(*p, order);
+
+      this->sympool_.begin_concurrent_adds();
+      this->dynpool_.begin_concurrent_adds();
+      job.run(job.piece_count());
+      this->sympool_.end_concurrent_adds();
+      this->dynpool_.end_concurrent_adds();
+      return;
+    }
+
+  unsigned int order = 0;
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
-       ++p)
+       ++p, ++order)
     {
       Task_lock_obj<Object> tlo(task, *p);
-      (*p)->count_local_symbols(&this->sympool_, &this->dynpool_);
+      (*p)->count_local_symbols(&this->sympool_, &this->dynpool_, order);
     }
 }
 
@@ -4572,6 +5227,20 @@ Layout::create_shdrs(const Output_section* shstrtab_section, off_t* poff)
   this->section_headers_ = oshdrs;
 }
 
+// For incremental updates, copy the contents of the sections which
+// were moved to make them larger to their new locations.  This is
+// called before any tasks write to the output file.
+
+void
+Layout::move_grown_sections(Output_file* of)
+{
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    if ((*p)->has_moved_fixed_layout())
+      (*p)->copy_fixed_layout_from_base(of);
+}
+
 // Count the allocated sections.
 
 size_t
@@ -4634,6 +5303,18 @@ Layout::create_dynamic_symtab(const Input_objects* input_objects,
   unsigned int local_symcount = index;
   unsigned int forced_local_count = 0;
 
+  // The GNU C library refuses to load an object with a DT_RELR tag
+  // unless it depends on the GLIBC_ABI_DT_RELR version, which the C
+  // library defines as a symbol.
+  if (this->relr_dyn_section_ != NULL)
+    {
+      Symbol* sym = symtab->lookup("GLIBC_ABI_DT_RELR", NULL);
+      if (sym != NULL && sym->is_from_dynobj())
+	pversions->add_version_need(&this->dynpool_,
+				    static_cast<Dynobj*>(sym->object()),
+				    "GLIBC_ABI_DT_RELR");
+    }
+
   index = symtab->set_dynsym_indexes(index, &forced_local_count,
 				     pdynamic_symbols, &this->dynpool_,
 				     pversions);
@@ -5052,13 +5733,20 @@ Layout::create_interp(const Target* target)
 void
 Layout::add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
 				const Output_data* plt_rel,
-				const Output_data_reloc_generic* dyn_rel,
+				Output_data_reloc_generic* dyn_rel,
 				bool add_debug, bool dynrel_includes_plt)
 {
   Output_data_dynamic* odyn = this->dynamic_data_;
   if (odyn == NULL)
     return;
 
+  if (dyn_rel != NULL && dyn_rel->output_section() != NULL)
+    {
+      this->dynamic_relocs_ = dyn_rel;
+      if (parameters->options().pack_relative_relocs())
+	this->create_relr_section(dyn_rel);
+    }
+
   if (plt_got != NULL && plt_got->output_section() != NULL)
     odyn->add_section_address(elfcpp::DT_PLTGOT, plt_got);
 
@@ -5134,6 +5822,68 @@ Layout::add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
     }
 }
 
+// Move the RELATIVE relocs in DYN_REL which can be packed into a
+// .relr.dyn section, for -z pack-relative-relocs, and add the
+// DT_RELR tags.
+
+void
+Layout::create_relr_section(Output_data_reloc_generic* dyn_rel)
+{
+  unsigned int r_type = parameters->target().relr_reloc_type();
+  if (r_type == -1U)
+    {
+      gold_warning(_("-z pack-relative-relocs is not supported for this "
+		     "target; ignoring"));
+      return;
+    }
+  if (parameters->incremental())
+    {
+      gold_warning(_("-z pack-relative-relocs is not supported with "
+		     "incremental linking; ignoring"));
+      return;
+    }
+  if (this->script_options_->saw_sections_clause())
+    {
+      gold_warning(_("-z pack-relative-relocs is not supported with a "
+		     "SECTIONS clause; ignoring"));
+      return;
+    }
+
+  Output_section_data* relr = dyn_rel->pack_relative_relocs(r_type);
+  if (relr == NULL)
+    return;
+
+  Output_section* os = this->choose_output_section(NULL, ".relr.dyn",
+						   elfcpp::SHT_RELR,
+						   (elfcpp::SHF_ALLOC
+						    | elfcpp::SHF_WRITE),
+						   false, ORDER_RELR_RELOCS,
+						   false, false, false);
+  os->add_output_section_data(relr);
+  this->relr_dyn_section_ = os;
+
+  Output_data_dynamic* odyn = this->dynamic_data_;
+  odyn->add_section_address(elfcpp::DT_RELR, os);
+  odyn->add_section_size(elfcpp::DT_RELRSZ, os);
+  odyn->add_constant(elfcpp::DT_RELRENT, parameters->target().get_size() / 8);
+}
+
+// Queue tasks to sort and write out the dynamic relocs.  This is only
+// worth doing when there are many of them.  Targets which relax
+// sections build lookup maps on demand while finding reloc addresses,
+// so they are written out by do_write.
+
+void
+Layout::queue_dynamic_reloc_tasks(Workqueue* workqueue, Output_file* of,
+				  Task_token* final_blocker)
+{
+  if (this->dynamic_relocs_ == NULL
+      || parameters->incremental()
+      || parameters->target().may_relax())
+    return;
+  this->dynamic_relocs_->queue_write_tasks(workqueue, of, final_blocker);
+}
+
 void
 Layout::add_target_specific_dynamic_tag(elfcpp::DT tag, unsigned int val)
 {
@@ -5812,6 +6562,45 @@ Layout::write_data(const Symbol_table* symtab, Output_file* of) const
     (*p)->write(of);
 }
 
+// Queue tasks to process the contents of the SHF_MERGE input sections
+// whose processing was deferred when they were laid out.
+
+void
+Layout::queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (Section_list::iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->queue_merge_tasks(workqueue, blocker);
+}
+
+// Queue tasks to scan the debug info for the .gdb_index or
+// .debug_names section.
+
+void
+Layout::queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->gdb_index_data_ != NULL)
+    this->gdb_index_data_->queue_scan_tasks(workqueue, blocker);
+}
+
+// Queue tasks to postprocess the Output_sections which require it.
+// This is called after all the input sections have been written, and
+// before the final data sizes of those sections are set.
+
+void
+Layout::queue_postprocessing_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (Section_list::iterator p = this->unattached_section_list_.begin();
+       p != this->unattached_section_list_.end();
+       ++p)
+    {
+      if ((*p)->requires_postprocessing()
+	  && !((*p)->is_offset_valid() && (*p)->is_data_size_valid()))
+	(*p)->queue_postprocessing_tasks(workqueue, blocker);
+    }
+}
+
 // Write out the Output_sections which can only be written after the
 // input sections are complete.
 
@@ -5872,10 +6661,13 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
 
       // If we get here with style == "tree" then the output must be
       // too small for chunking, and we use SHA-1 in that case.
+      // Likewise style == "fast" hashes the whole file with xxHash.
       if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
 	sha1_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
       else if (strcmp(style, "md5") == 0)
 	md5_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+      else if (strcmp(style, "fast") == 0)
+	hash_build_id_chunk(iv, output_file_size, true, ov);
       else
 	gold_unreachable();
 
@@ -5884,9 +6676,12 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
   else
     {
       // Non-overlapping substrings of the output file have been hashed.
-      // Compute SHA-1 hash of the hashes.
-      sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
-		  size_of_hashes, ov);
+      // Compute SHA-1 hash of the hashes, or xxHash for a fast build ID.
+      if (strcmp(parameters->options().build_id(), "fast") == 0)
+	hash_build_id_chunk(array_of_hashes, size_of_hashes, true, ov);
+      else
+	sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
+		    size_of_hashes, ov);
       delete[] array_of_hashes;
     }
 
@@ -5968,6 +6763,18 @@ Layout::print_stats() const
   this->sympool_.print_stats("output symbol name pool");
   this->dynpool_.print_stats("dynamic name pool");
 
+  if (parameters->options().call_graph_ordering_file())
+    {
+      fprintf(stderr, _("%s: call graph names not found: %u\n"),
+	      program_name, this->call_graph_names_not_found_);
+      fprintf(stderr, _("%s: call graph edges used: %u\n"),
+	      program_name, this->call_graph_edges_used_);
+      fprintf(stderr,
+	      _("%s: call graph sections ordered: %u in %u clusters\n"),
+	      program_name, this->call_graph_sections_ordered_,
+	      this->call_graph_clusters_);
+    }
+
   for (Section_list::const_iterator p = this->section_list_.begin();
        p != this->section_list_.end();
        ++p)
@@ -6086,10 +6893,275 @@ Write_after_input_sections_task::run(Workqueue*)
   this->layout_->write_sections_after_input_sections(this->of_);
 }
 
+// Postprocessing_task_runner methods.
+
+// Queue the postprocessing tasks, and the task to write out the
+// sections once they are done.
+
+void
+Postprocessing_task_runner::run(Workqueue* workqueue, const Task*)
+{
+  Task_token* postprocessing_blocker = new Task_token(true);
+  this->layout_->queue_postprocessing_tasks(workqueue,
+					    postprocessing_blocker);
+  workqueue->queue(new Write_after_input_sections_task(this->layout_,
+						       this->of_,
+						       postprocessing_blocker,
+						       this->final_blocker_));
+}
+
+// Build_id_chunks methods.
+
+Build_id_chunks::Build_id_chunks(Output_file* of, size_t chunk_size,
+				 bool is_fast)
+  : of_(of), chunk_size_(chunk_size), hash_size_(is_fast ? 8 : 16),
+    is_fast_(is_fast), early_chunks_(), hashes_(), relocate_blockers_()
+{
+}
+
+Build_id_chunks::~Build_id_chunks()
+{
+  for (Relocate_blockers::iterator p = this->relocate_blockers_.begin();
+       p != this->relocate_blockers_.end();
+       ++p)
+    delete p->second;
+}
+
+// Find the chunks which lie entirely within a run of non-allocated
+// PROGBITS sections, such as the debug sections.  Those are written
+// only by the Write_sections_task and by Relocate_tasks, and we know
+// which objects write where.  Sections which are written after the
+// input sections, or which are compressed, are left to be hashed when
+// the file is complete.
+
+unsigned int
+Build_id_chunks::find_early_chunks(const Layout* layout)
+{
+  if (!layout->records_section_writers()
+      || layout->script_options()->saw_sections_clause())
+    return 0;
+
+  // The file extent of each section with contents, and whether the
+  // chunks which it covers can be hashed early.
+  typedef std::pair<off_t, std::pair<off_t, const Output_section*> > Extent;
+  std::vector<Extent> extents;
+  const Layout::Section_list& sections(layout->section_list());
+  for (Layout::Section_list::const_iterator p = sections.begin();
+       p != sections.end();
+       ++p)
+    {
+      const Output_section* os = *p;
+      if (os->type() == elfcpp::SHT_NOBITS
+	  || !os->is_offset_valid()
+	  || !os->is_data_size_valid()
+	  || os->data_size() == 0)
+	continue;
+      bool is_early = ((os->flags() & elfcpp::SHF_ALLOC) == 0
+		       && os->type() == elfcpp::SHT_PROGBITS
+		       && !os->after_input_sections()
+		       && !os->requires_postprocessing());
+      off_t start = os->offset();
+      extents.push_back(Extent(start,
+			       std::make_pair(start + os->data_size(),
+					      is_early ? os : NULL)));
+    }
+  std::sort(extents.begin(), extents.end());
+
+  const off_t chunk_size = this->chunk_size_;
+  const size_t filesize = this->of_->filesize();
+  this->hashes_.resize(filesize / chunk_size * this->hash_size_);
+
+  // Walk the runs of consecutive early sections, and add each chunk
+  // which fits in a run.  Chunks are indexed by the offset at which
+  // they start.
+  std::vector<int> chunk_map(filesize / chunk_size, -1);
+  std::vector<const Output_section*> early_sections;
+  size_t i = 0;
+  while (i < extents.size())
+    {
+      if (extents[i].second.second == NULL)
+	{
+	  ++i;
+	  continue;
+	}
+      off_t run_start = extents[i].first;
+      off_t run_end = extents[i].second.first;
+      for (; i < extents.size(); ++i)
+	{
+	  const Extent& e(extents[i]);
+	  if (e.second.second == NULL)
+	    {
+	      // Don't let a run skip over a section which is not early.
+	      if (e.first < run_end)
+		run_end = e.first;
+	      break;
+	    }
+	  early_sections.push_back(e.second.second);
+	  run_end = std::max(run_end, e.second.first);
+	}
+      for (off_t c = (run_start + chunk_size - 1) / chunk_size;
+	   (c + 1) * chunk_size <= run_end;
+	   ++c)
+	{
+	  chunk_map[c] = this->early_chunks_.size();
+	  this->early_chunks_.push_back(Early_chunk(c));
+	}
+    }
+
+  // Record the objects which write each early chunk.
+  for (std::vector<const Output_section*>::const_iterator p =
+	 early_sections.begin();
+       p != early_sections.end();
+       ++p)
+    {
+      const Output_section* os = *p;
+      const Output_section::Input_section_writer_list& writers(
+	  os->input_section_writers());
+      for (Output_section::Input_section_writer_list::const_iterator pw =
+	     writers.begin();
+	   pw != writers.end();
+	   ++pw)
+	{
+	  off_t start = os->offset() + pw->start;
+	  off_t end = os->offset() + (pw->end < 0
+				      ? os->data_size()
+				      : pw->end);
+	  Task_token* token = NULL;
+	  for (off_t c = start / chunk_size;
+	       c < static_cast<off_t>(chunk_map.size()) && c * chunk_size < end;
+	       ++c)
+	    {
+	      if (chunk_map[c] < 0)
+		continue;
+	      if (token == NULL)
+		{
+		  Task_token*& t(this->relocate_blockers_[pw->object]);
+		  if (t == NULL)
+		    t = new Task_token(true);
+		  token = t;
+		}
+	      std::vector<Task_token*>& blockers(
+		  this->early_chunks_[chunk_map[c]].blockers);
+	      if (blockers.empty() || blockers.back() != token)
+		blockers.push_back(token);
+	    }
+	}
+    }
+
+  // From now on, count the writes to each chunk, so that we can tell
+  // whether a chunk was written after it was hashed.
+  if (!this->early_chunks_.empty())
+    this->of_->count_chunk_writes(chunk_size);
+
+  return this->early_chunks_.size();
+}
+
+// Return the token for the Relocate_task for OBJECT, blocking it
+// until that task is done.  A token which no Relocate_task unblocks
+// is never blocked, so the chunk tasks do not wait for it.
+
+Task_token*
+Build_id_chunks::relocate_blocker(const Relobj* object)
+{
+  Relocate_blockers::iterator p = this->relocate_blockers_.find(object);
+  if (p == this->relocate_blockers_.end())
+    return NULL;
+  p->second->add_blocker();
+  return p->second;
+}
+
+// Queue a task for each chunk which can be hashed early.
+
+void
+Build_id_chunks::queue_early_tasks(Workqueue* workqueue,
+				   Task_token* output_sections_blocker,
+				   Task_token* final_blocker)
+{
+  for (unsigned int i = 0; i < this->early_chunks_.size(); ++i)
+    workqueue->queue(new Build_id_chunk_task(this, i,
+					     &this->early_chunks_[i].blockers,
+					     output_sections_blocker,
+					     final_blocker));
+}
+
+// Hash early chunk I.  We note the number of writes to the chunk
+// before reading it, so that any write which lands while or after we
+// hash it makes us hash it again.
+
+void
+Build_id_chunks::hash_early_chunk(unsigned int i)
+{
+  Early_chunk* chunk = &this->early_chunks_[i];
+  off_t offset = chunk->index * this->chunk_size_;
+  chunk->write_count = this->of_->chunk_write_count(offset);
+  const unsigned char* iv = this->of_->get_input_view(offset,
+						      this->chunk_size_);
+  hash_build_id_chunk(iv, this->chunk_size_, this->is_fast_,
+		      &this->hashes_[chunk->index * this->hash_size_]);
+  this->of_->free_input_view(offset, this->chunk_size_, iv);
+  chunk->is_hashed = true;
+}
+
+// Queue tasks to hash the remaining chunks of the complete file.
+
+unsigned char*
+Build_id_chunks::queue_remaining_tasks(Workqueue* workqueue, size_t filesize,
+				       Task_token* blocker,
+				       size_t* size_of_hashes)
+{
+  const size_t chunk_size = this->chunk_size_;
+  const size_t hash_size = this->hash_size_;
+  const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
+  *size_of_hashes = num_hashes * hash_size;
+  unsigned char* array_of_hashes = new unsigned char[*size_of_hashes];
+
+  // Use the early hash of each chunk which was not written again.
+  std::vector<bool> is_hashed(num_hashes, false);
+  for (std::vector<Early_chunk>::const_iterator p =
+	 this->early_chunks_.begin();
+       p != this->early_chunks_.end();
+       ++p)
+    {
+      gold_assert(p->index < num_hashes);
+      if (p->is_hashed
+	  && p->write_count == this->of_->chunk_write_count(p->index
+							    * chunk_size))
+	{
+	  memcpy(array_of_hashes + p->index * hash_size,
+		 &this->hashes_[p->index * hash_size], hash_size);
+	  is_hashed[p->index] = true;
+	}
+    }
+
+  size_t num_remaining = std::count(is_hashed.begin(), is_hashed.end(), false);
+  if (parameters->options().stats())
+    fprintf(stderr, _("%s: build ID chunks hashed early: %zu of %zu\n"),
+	    program_name, num_hashes - num_remaining, num_hashes);
+
+  blocker->add_blockers(num_remaining);
+  unsigned char* dst = array_of_hashes;
+  for (size_t i = 0, src_offset = 0; i < num_hashes;
+       i++, dst += hash_size, src_offset += chunk_size)
+    {
+      if (is_hashed[i])
+	continue;
+      size_t size = std::min(chunk_size, filesize - src_offset);
+      workqueue->queue(new Hash_task(this->of_,
+				     src_offset,
+				     size,
+				     this->is_fast_,
+				     dst,
+				     blocker));
+    }
+
+  return array_of_hashes;
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
-// We compute a checksum over the entire file because that is simplest.
+// A "fast" build ID is a tree which uses xxHash for both steps.  We
+// compute a checksum over the entire file because that is simplest.
 
 void
 Build_id_task_runner::run(Workqueue* workqueue, const Task*)
@@ -6102,31 +7174,27 @@ Build_id_task_runner::run(Workqueue* workqueue, const Task*)
   unsigned char* array_of_hashes = NULL;
   size_t size_of_hashes = 0;
 
-  if (strcmp(this->options_->build_id(), "tree") == 0
-      && this->options_->build_id_chunk_size_for_treehash() > 0
+  if (this->options_->build_id_chunk_size_for_treehash() > 0
       && filesize > 0
       && (filesize >= this->options_->build_id_min_file_size_for_treehash()))
     {
-      static const size_t MD5_OUTPUT_SIZE_IN_BYTES = 16;
-      const size_t chunk_size =
-	  this->options_->build_id_chunk_size_for_treehash();
-      const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
-      post_hash_tasks_blocker->add_blockers(num_hashes);
-      size_of_hashes = num_hashes * MD5_OUTPUT_SIZE_IN_BYTES;
-      array_of_hashes = new unsigned char[size_of_hashes];
-      unsigned char *dst = array_of_hashes;
-      for (size_t i = 0, src_offset = 0; i < num_hashes;
-	   i++, dst += MD5_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
+      if (this->chunks_ == NULL)
 	{
-	  size_t size = std::min(chunk_size, filesize - src_offset);
-	  workqueue->queue(new Hash_task(of,
-					 src_offset,
-					 size,
-					 dst,
-					 post_hash_tasks_blocker));
+	  bool is_fast = strcmp(this->options_->build_id(), "fast") == 0;
+	  this->chunks_ = new Build_id_chunks(
+	      of, this->options_->build_id_chunk_size_for_treehash(), is_fast);
 	}
+      array_of_hashes =
+	this->chunks_->queue_remaining_tasks(workqueue, filesize,
+					     post_hash_tasks_blocker,
+					     &size_of_hashes);
     }
 
+  // The early chunk tasks are done, and the remaining ones only refer
+  // to the output file.
+  delete this->chunks_;
+  this->chunks_ = NULL;
+
   // Queue the final task to write the build id and close the output file.
   workqueue->queue(new Task_function(new Close_task_runner(this->options_,
 							   layout,
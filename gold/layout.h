@@ -102,6 +102,11 @@ class Free_list
   set_min_hole_size(off_t min_hole)
   { this->min_hole_ = min_hole; }
 
+  // Extend the region to length LEN, adding the new space to the
+  // free list.
+  void
+  extend(off_t len);
+
   // Remove a chunk from the free list.
   void
   remove(off_t start, off_t end);
@@ -479,6 +484,11 @@ enum Output_section_order
   // segment.
   ORDER_RW_NOTE,
 
+  // The packed relative relocs for -z pack-relative-relocs.  These
+  // come after the sections which they relocate, since their size
+  // depends on the addresses.
+  ORDER_RELR_RELOCS,
+
   // The small data sections must be at the end of the data sections,
   // so that they can be adjacent to the small BSS sections.
   ORDER_SMALL_DATA,
@@ -585,6 +595,14 @@ class Layout
   set_section_ordering_specified()
   { this->section_ordering_specified_ = true; }
 
+  // Whether Output_sections should record which objects write their
+  // input sections.  This is true for --build-id=tree and
+  // --build-id=fast, which hash parts of the output file as soon as
+  // the objects which write them are done.
+  bool
+  records_section_writers() const
+  { return this->records_section_writers_; }
+
   bool
   is_unique_segment_for_sections_specified() const
   { return this->unique_segment_for_sections_specified_; }
@@ -599,6 +617,11 @@ class Layout
   allocate(off_t len, uint64_t align, off_t minoff)
   { return this->free_list_.allocate(len, align, minoff); }
 
+  // For incremental updates, copy the contents of the sections which
+  // were moved to make them larger to their new locations.
+  void
+  move_grown_sections(Output_file* of);
+
   unsigned int
   find_section_order_index(const std::string&);
 
@@ -607,6 +630,18 @@ class Layout
   void
   read_layout_from_file();
 
+  // Read the call graph profile from the file specified with
+  // --call-graph-ordering-file.
+  void
+  read_call_graph_from_file();
+
+  // Order the input sections which the call graph profile names so
+  // that callers are placed near their most frequent callees, ahead
+  // of the sections which the profile does not mention.  This is
+  // called once all input sections have been laid out.
+  void
+  order_sections_by_call_graph(const Task*, Symbol_table*);
+
   // Layout an input reloc section when doing a relocatable link.  The
   // section is RELOC_SHNDX in OBJECT, with data in SHDR.
   // DATA_SECTION is the reloc section to which it refers.  RR is the
@@ -674,7 +709,7 @@ class Layout
 			  size_t fde_length);
 
   // Scan a .debug_info or .debug_types section, and add summary
-  // information to the .gdb_index section.
+  // information to the .gdb_index or .debug_names section.
   template<int size, bool big_endian>
   void
   add_to_gdb_index(bool is_type_unit,
@@ -894,6 +929,30 @@ class Layout
   void
   write_sections_after_input_sections(Output_file* of);
 
+  // Queue tasks to process the contents of SHF_MERGE input sections
+  // whose processing was deferred.  Each chain of tasks holds a
+  // blocker on BLOCKER.
+  void
+  queue_merge_tasks(Workqueue* workqueue, Task_token* blocker);
+
+  // Queue tasks to scan the .debug_info and .debug_types sections for
+  // the .gdb_index or .debug_names section.  The last task holds a
+  // blocker on BLOCKER.
+  void
+  queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker);
+
+  // Queue tasks to postprocess the contents of the sections which
+  // require postprocessing, such as compressed debug sections.  Each
+  // task holds a blocker on BLOCKER.
+  void
+  queue_postprocessing_tasks(Workqueue* workqueue, Task_token* blocker);
+
+  // Queue tasks to sort and write out the dynamic relocs in parallel.
+  // Each task holds a blocker on FINAL_BLOCKER.
+  void
+  queue_dynamic_reloc_tasks(Workqueue* workqueue, Output_file* of,
+			    Task_token* final_blocker);
+
   // Return an output section named NAME, or NULL if there is none.
   Output_section*
   find_output_section(const char* name) const;
@@ -938,7 +997,7 @@ class Layout
   void
   add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
 			  const Output_data* plt_rel,
-			  const Output_data_reloc_generic* dyn_rel,
+			  Output_data_reloc_generic* dyn_rel,
 			  bool add_debug, bool dynrel_includes_plt);
 
   // Add a target-specific dynamic tag with constant value.
@@ -1075,6 +1134,20 @@ class Layout
   };
   typedef std::vector<Group_signature> Group_signatures;
 
+  // An edge in the --call-graph-ordering-file: CALLER and CALLEE are
+  // indexes into call_graph_names_.
+  struct Call_graph_edge
+  {
+    unsigned int caller;
+    unsigned int callee;
+    uint64_t weight;
+
+    Call_graph_edge(unsigned int callera, unsigned int calleea,
+		    uint64_t weighta)
+      : caller(callera), callee(calleea), weight(weighta)
+    { }
+  };
+
   // Create a note section, filling in the header.
   Output_section*
   create_note(const char* name, int note_type, const char* section_name,
@@ -1153,6 +1226,10 @@ class Layout
   void
   create_interp(const Target* target);
 
+  // Create the .relr.dyn section for -z pack-relative-relocs.
+  void
+  create_relr_section(Output_data_reloc_generic* dyn_rel);
+
   // Create the version sections.
   void
   create_version_sections(const Versions*,
@@ -1430,6 +1507,10 @@ class Layout
   Symbol* dynamic_symbol_;
   // The dynamic data which goes into dynamic_section_.
   Output_data_dynamic* dynamic_data_;
+  // The dynamic reloc section passed to add_target_dynamic_tags.
+  Output_data_reloc_generic* dynamic_relocs_;
+  // The .relr.dyn section for -z pack-relative-relocs, if there is one.
+  Output_section* relr_dyn_section_;
   // The exception frame output section if there is one.
   Output_section* eh_frame_section_;
   // The exception frame data for eh_frame_section_.
@@ -1438,7 +1519,7 @@ class Layout
   bool added_eh_frame_data_;
   // The exception frame header output section if there is one.
   Output_section* eh_frame_hdr_section_;
-  // The data for the .gdb_index section.
+  // The data for the .gdb_index or .debug_names section.
   Gdb_index* gdb_index_data_;
   // The space for the build ID checksum if there is one.
   Output_section_data* build_id_note_;
@@ -1474,6 +1555,8 @@ class Layout
   // True if the input sections in the output sections should be sorted
   // as specified in a section ordering file.
   bool section_ordering_specified_;
+  // True if Output_sections should record which objects write them.
+  bool records_section_writers_;
   // True if some input sections need to be mapped to a unique segment,
   // after being mapped to a unique Output_section.
   bool unique_segment_for_sections_specified_;
@@ -1500,6 +1583,15 @@ class Layout
   Unordered_map<std::string, unsigned int> input_section_position_;
   // Vector of glob only patterns in the section_ordering file.
   std::vector<std::string> input_section_glob_;
+  // The distinct function names in the --call-graph-ordering-file.
+  std::vector<std::string> call_graph_names_;
+  // The edges in the --call-graph-ordering-file.
+  std::vector<Call_graph_edge> call_graph_edges_;
+  // Statistics for --call-graph-ordering-file, printed with --stats.
+  unsigned int call_graph_names_not_found_;
+  unsigned int call_graph_edges_used_;
+  unsigned int call_graph_sections_ordered_;
+  unsigned int call_graph_clusters_;
   // For incremental links, the base file to be modified.
   Incremental_binary* incremental_base_;
   // For incremental links, a list of free space within the file.
@@ -1660,18 +1752,129 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task function handles postprocessing the sections which
+// require it, such as compressing debug sections.  It queues a task
+// for each part of the work which can be done in parallel, and then
+// queues a Write_after_input_sections_task to run when they are
+// complete.
+
+class Postprocessing_task_runner : public Task_function_runner
+{
+ public:
+  Postprocessing_task_runner(Layout* layout, Output_file* of,
+			     Task_token* final_blocker)
+    : layout_(layout), of_(of), final_blocker_(final_blocker)
+  { }
+
+  // Run the operation.
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  Layout* layout_;
+  Output_file* of_;
+  Task_token* final_blocker_;
+};
+
+// This class holds the hashes of the chunks of the output file for
+// --build-id=tree and --build-id=fast.  Chunks which lie entirely in
+// non-allocated sections are only written by the Write_sections_task
+// and by the Relocate_tasks of the objects which have input sections
+// there, so they are hashed as soon as those tasks are done, while
+// the rest of the file is still being written.  Build_id_task_runner
+// hashes the other chunks once the file is complete, along with any
+// chunk which was written again after it was hashed.
+
+class Build_id_chunks
+{
+ public:
+  Build_id_chunks(Output_file* of, size_t chunk_size, bool is_fast);
+
+  ~Build_id_chunks();
+
+  // Find the chunks of the output file, as laid out by LAYOUT, which
+  // can be hashed before the file is complete.  Return the number of
+  // tasks queue_early_tasks will queue.  This must be called before
+  // any task writes to the output file.
+  unsigned int
+  find_early_chunks(const Layout* layout);
+
+  // Return the token which the Relocate_task for OBJECT must unblock
+  // when it is done, or NULL if no chunk is waiting for it.  This must
+  // be called before queue_early_tasks.
+  Task_token*
+  relocate_blocker(const Relobj* object);
+
+  // Queue the tasks which hash the chunks found by find_early_chunks.
+  // Each one waits for OUTPUT_SECTIONS_BLOCKER and for the
+  // Relocate_tasks which write its chunk, and unblocks FINAL_BLOCKER.
+  void
+  queue_early_tasks(Workqueue*, Task_token* output_sections_blocker,
+		    Task_token* final_blocker);
+
+  // Hash early chunk I.  This is called by the tasks queued by
+  // queue_early_tasks.
+  void
+  hash_early_chunk(unsigned int i);
+
+  // Once the output file of size FILESIZE is complete, queue tasks to
+  // hash each chunk which has not been hashed yet or which was written
+  // again after it was hashed.  The tasks unblock BLOCKER.  Return
+  // the array of chunk hashes, which the caller must delete[], and
+  // set *SIZE_OF_HASHES to its size.
+  unsigned char*
+  queue_remaining_tasks(Workqueue*, size_t filesize, Task_token* blocker,
+			size_t* size_of_hashes);
+
+ private:
+  // A chunk which can be hashed before the output file is complete.
+  struct Early_chunk
+  {
+    Early_chunk(size_t a_index)
+      : index(a_index), blockers(), write_count(0), is_hashed(false)
+    { }
+
+    // The index of the chunk in the file.
+    size_t index;
+    // Tokens of the Relocate_tasks which write the chunk.
+    std::vector<Task_token*> blockers;
+    // The number of writes to the chunk when it was hashed.
+    unsigned int write_count;
+    // Whether the chunk has been hashed.
+    bool is_hashed;
+  };
+
+  typedef Unordered_map<const Relobj*, Task_token*> Relocate_blockers;
+
+  // The output file.
+  Output_file* of_;
+  // The size of each chunk.
+  size_t chunk_size_;
+  // The size of the hash of each chunk.
+  size_t hash_size_;
+  // Whether we are computing --build-id=fast.
+  bool is_fast_;
+  // The chunks which can be hashed early.
+  std::vector<Early_chunk> early_chunks_;
+  // The hashes of the early chunks, indexed by chunk index.
+  std::vector<unsigned char> hashes_;
+  // A token for each object which writes an early chunk.
+  Relocate_blockers relocate_blockers_;
+};
+
 // This task function handles computation of the build id.
-// When using --build-id=tree, it schedules the tasks that
-// compute the hashes for each chunk of the file. This task
-// cannot run until we have finalized the size of the output
-// file, after the completion of Write_after_input_sections_task.
+// When using --build-id=tree or --build-id=fast, it schedules the
+// tasks that compute the hashes for each chunk of the file which has
+// not already been hashed.  This task cannot run until we have
+// finalized the size of the output file, after the completion of
+// Write_after_input_sections_task.
 
 class Build_id_task_runner : public Task_function_runner
 {
  public:
   Build_id_task_runner(const General_options* options, const Layout* layout,
-		       Output_file* of)
-    : options_(options), layout_(layout), of_(of)
+		       Output_file* of, Build_id_chunks* chunks)
+    : options_(options), layout_(layout), of_(of), chunks_(chunks)
   { }
 
   // Run the operation.
@@ -1682,6 +1885,9 @@ class Build_id_task_runner : public Task_function_runner
   const General_options* options_;
   const Layout* layout_;
   Output_file* of_;
+  // The chunks hashed while the file was written, or NULL.  This
+  // is deleted by run.
+  Build_id_chunks* chunks_;
 };
 
 // This task function handles closing the file.
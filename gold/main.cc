@@ -41,8 +41,10 @@
 #include "workqueue.h"
 #include "object.h"
 #include "archive.h"
+#include "dynobj.h"
 #include "symtab.h"
 #include "layout.h"
+#include "reloc.h"
 #include "plugin.h"
 #include "gc.h"
 #include "icf.h"
@@ -235,6 +237,9 @@ main(int argc, char** argv)
   if (parameters->options().section_ordering_file())
     layout.read_layout_from_file();
 
+  if (parameters->options().call_graph_ordering_file())
+    layout.read_call_graph_from_file();
+
   // Load plugin libraries.
   if (command_line.options().has_plugins())
     command_line.options().plugins()->load_plugins(&layout);
@@ -251,6 +256,9 @@ main(int argc, char** argv)
   // Run the main task processing loop.
   workqueue.process(0);
 
+  if (command_line.options().trace_file() != NULL)
+    workqueue.write_trace(command_line.options().trace_file());
+
   if (command_line.options().print_output_format())
     print_output_format();
 
@@ -290,17 +298,34 @@ main(int argc, char** argv)
               elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
               elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
 
+      static const char* const pass_names[] = { "initial", "middle", "final" };
+      for (int i = 0; i < 3; ++i)
+	{
+	  elapsed = timer.get_pass_time(i);
+	  fprintf(stderr,
+		  _("%s: %s tasks I/O wait: %ld.%06ld "
+		    "major page faults: %ld\n"),
+		  program_name, pass_names[i],
+		  elapsed.io_wait / 1000, (elapsed.io_wait % 1000) * 1000,
+		  elapsed.major_faults);
+	}
+
 #ifdef HAVE_MALLINFO
       struct mallinfo m = mallinfo();
       fprintf(stderr, _("%s: total space allocated by malloc: %lld bytes\n"),
 	      program_name, static_cast<long long>(m.arena));
 #endif
+      workqueue.print_stats();
       File_read::print_stats();
+      Relocate_task::print_stats();
       Archive::print_stats();
       Lib_group::print_stats();
+      Dynobj::print_stats();
       fprintf(stderr, _("%s: output file size: %lld bytes\n"),
 	      program_name, static_cast<long long>(layout.output_file_size()));
       symtab.print_stats();
+      gc.print_stats();
+      icf.print_stats();
       layout.print_stats();
       Gdb_index::print_stats();
       Free_list::print_stats();
@@ -25,6 +25,9 @@
 #include <cstdlib>
 #include <algorithm>
 
+#include "parameters.h"
+#include "options.h"
+#include "workqueue.h"
 #include "merge.h"
 #include "compressed_output.h"
 
@@ -170,6 +173,25 @@ Object_merge_map::get_output_offset(unsigned int shndx,
   return true;
 }
 
+// Sort the mappings for all input sections.
+
+void
+Object_merge_map::sort_mappings()
+{
+  for (Section_merge_maps::iterator p = this->section_merge_maps_.begin();
+       p != this->section_merge_maps_.end();
+       ++p)
+    {
+      Input_merge_map* map = p->second;
+      if (!map->sorted)
+	{
+	  std::sort(map->entries.begin(), map->entries.end(),
+		    Input_merge_compare());
+	  map->sorted = true;
+	}
+    }
+}
+
 // Return whether this is the merge map for section SHNDX.
 
 const Output_section_data*
@@ -471,6 +493,34 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   Merged_strings_list* merged_strings_list =
       new Merged_strings_list(object, shndx);
   this->merged_strings_lists_.push_back(merged_strings_list);
+
+  // When using threads, defer scanning the strings, so that the
+  // sections can be scanned in parallel by the tasks queued by
+  // do_queue_merge_tasks.  The strings of all sections are then added
+  // in input order.  The decompressed contents of a compressed
+  // section are kept until then, since a buffer cached by the object
+  // is discarded at the end of Add_symbols.
+  if (parameters->options().threads())
+    {
+      merged_strings_list->is_added = false;
+
+      if (is_new)
+	merged_strings_list->contents = pdata;
+      else if (object->section_is_compressed(shndx, NULL))
+	{
+	  unsigned char* copy = new unsigned char[sec_len];
+	  memcpy(copy, pdata, sec_len);
+	  merged_strings_list->contents = copy;
+	}
+      merged_strings_list->contents_size = sec_len;
+
+      // For script processing, we keep the input sections.
+      if (this->keeps_input_sections())
+	record_input_section(object, shndx);
+
+      return true;
+    }
+
   Merged_strings& merged_strings = merged_strings_list->merged_strings;
 
   // Count the number of non-null strings in the section and size the list.
@@ -538,6 +588,319 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   return true;
 }
 
+// A Task to scan the strings of a mergeable string input section
+// whose processing was deferred.  These tasks may run in parallel.
+
+template<typename Char_type>
+class Merge_string_scan_task : public Task
+{
+ public:
+  Merge_string_scan_task(Output_merge_string<Char_type>* pomb,
+			 unsigned int index, Relobj* object,
+			 Task_token* next_blocker)
+    : pomb_(pomb), index_(index), object_(object),
+      next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->next_blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->pomb_->scan_input_section(this->index_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Merge_string_scan_task " + this->object_->name(); }
+
+ private:
+  Output_merge_string<Char_type>* pomb_;
+  unsigned int index_;
+  Relobj* object_;
+  Task_token* next_blocker_;
+};
+
+// A Task to add the strings of a mergeable string input section to
+// the Stringpool after they have been scanned.  These tasks run in
+// input order, so that the output does not depend on the number of
+// threads.  SCAN_BLOCKER is the blocker for the scan task, and
+// THIS_BLOCKER is the blocker for the previous input section.  Both
+// are deleted by this task.
+
+template<typename Char_type>
+class Merge_string_add_task : public Task
+{
+ public:
+  Merge_string_add_task(Output_merge_string<Char_type>* pomb,
+			unsigned int index, Relobj* object,
+			Task_token* scan_blocker, Task_token* this_blocker,
+			Task_token* next_blocker)
+    : pomb_(pomb), index_(index), object_(object),
+      scan_blocker_(scan_blocker), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Merge_string_add_task()
+  {
+    delete this->scan_blocker_;
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+  }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->scan_blocker_->is_blocked())
+      return this->scan_blocker_;
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->next_blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->pomb_->add_input_strings(this->index_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Merge_string_add_task " + this->object_->name(); }
+
+ private:
+  Output_merge_string<Char_type>* pomb_;
+  unsigned int index_;
+  Relobj* object_;
+  Task_token* scan_blocker_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Queue a scan task and an add task for each input section whose
+// processing was deferred.  The add tasks form a chain, and the last
+// one holds a blocker on BLOCKER.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_queue_merge_tasks(Workqueue* workqueue,
+						      Task_token* blocker)
+{
+  std::vector<unsigned int> deferred;
+  for (unsigned int i = 0; i < this->merged_strings_lists_.size(); ++i)
+    if (!this->merged_strings_lists_[i]->is_added)
+      deferred.push_back(i);
+  if (deferred.empty())
+    return;
+
+  workqueue->add_blocker(blocker);
+
+  Task_token* this_blocker = NULL;
+  for (unsigned int i = 0; i < deferred.size(); ++i)
+    {
+      unsigned int index = deferred[i];
+      Relobj* object = this->merged_strings_lists_[index]->object;
+
+      Task_token* scan_blocker = new Task_token(true);
+      scan_blocker->add_blocker();
+      workqueue->queue(new Merge_string_scan_task<Char_type>(this, index,
+							      object,
+							      scan_blocker));
+
+      Task_token* next_blocker;
+      if (i + 1 == deferred.size())
+	next_blocker = blocker;
+      else
+	{
+	  next_blocker = new Task_token(true);
+	  next_blocker->add_blocker();
+	}
+      workqueue->queue(new Merge_string_add_task<Char_type>(this, index,
+							     object,
+							     scan_blocker,
+							     this_blocker,
+							     next_blocker));
+      this_blocker = next_blocker;
+    }
+}
+
+// Return the contents of a deferred input section.  These are the
+// contents kept by do_add_input_section if the section is compressed,
+// or else a view of the section in the object.
+
+template<typename Char_type>
+const unsigned char*
+Output_merge_string<Char_type>::deferred_section_contents(
+    const Merged_strings_list* merged_strings_list,
+    section_size_type* plen)
+{
+  if (merged_strings_list->contents != NULL)
+    {
+      *plen = merged_strings_list->contents_size;
+      return merged_strings_list->contents;
+    }
+
+  bool is_new;
+  const unsigned char* pdata =
+    merged_strings_list->object->decompressed_section_contents(
+	merged_strings_list->shndx, plen, &is_new);
+  gold_assert(!is_new);
+  return pdata;
+}
+
+// Scan the strings of a deferred input section, recording the offset
+// and hash code of each one.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::scan_input_section(unsigned int index)
+{
+  Merged_strings_list* merged_strings_list =
+    this->merged_strings_lists_[index];
+  gold_assert(!merged_strings_list->is_added);
+
+  section_size_type sec_len;
+  const unsigned char* pdata =
+    this->deferred_section_contents(merged_strings_list, &sec_len);
+
+  const Char_type* p = reinterpret_cast<const Char_type*>(pdata);
+  const Char_type* pend = p + sec_len / sizeof(Char_type);
+  const Char_type* pend0 = pend;
+  while (pend0 > p && pend0[-1] != 0)
+    --pend0;
+
+  // Count the number of strings in the section and size the lists.
+  size_t count = 0;
+  const Char_type* pt = p;
+  while (pt < pend)
+    {
+      size_t len = pt < pend0 ? string_length(pt) : pend - pt;
+      ++count;
+      pt += len + 1;
+    }
+
+  Merged_strings& merged_strings = merged_strings_list->merged_strings;
+  std::vector<size_t>& hash_codes = merged_strings_list->hash_codes;
+  merged_strings.reserve(count + 1);
+  hash_codes.reserve(count);
+
+  // The index I is in bytes, not characters.
+  section_size_type i = 0;
+  while (p < pend)
+    {
+      size_t len = p < pend0 ? string_length(p) : pend - p;
+      merged_strings.push_back(Merged_string(i, 0));
+      hash_codes.push_back(Stringpool_template<Char_type>::hash_string(p,
+								       len));
+      p += len + 1;
+      i += (len + 1) * sizeof(Char_type);
+    }
+
+  // Record the last offset in the input section so that we can
+  // compute the length of the last string.
+  merged_strings.push_back(Merged_string(i, 0));
+}
+
+// Add the strings of a scanned input section to the Stringpool.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::add_input_strings(unsigned int index)
+{
+  Merged_strings_list* merged_strings_list =
+    this->merged_strings_lists_[index];
+  gold_assert(!merged_strings_list->is_added);
+
+  Relobj* object = merged_strings_list->object;
+  unsigned int shndx = merged_strings_list->shndx;
+  section_size_type sec_len;
+  const unsigned char* pdata =
+    this->deferred_section_contents(merged_strings_list, &sec_len);
+  const Char_type* pstart = reinterpret_cast<const Char_type*>(pdata);
+
+  // We assume here that the beginning of the section is correctly
+  // aligned, so each string within the section must retain the same
+  // modulo.
+  uintptr_t init_align_modulo = (reinterpret_cast<uintptr_t>(pdata)
+				 & (this->addralign() - 1));
+  bool has_misaligned_strings = false;
+
+  Merged_strings& merged_strings = merged_strings_list->merged_strings;
+  const std::vector<size_t>& hash_codes = merged_strings_list->hash_codes;
+  gold_assert(merged_strings.size() == hash_codes.size() + 1);
+  size_t count = 0;
+  for (size_t j = 0; j < hash_codes.size(); ++j)
+    {
+      Merged_string& ms(merged_strings[j]);
+      const Char_type* p = pstart + ms.offset / sizeof(Char_type);
+      size_t len = ((merged_strings[j + 1].offset - ms.offset)
+		    / sizeof(Char_type)
+		    - 1);
+
+      // Within merge input section each string must be aligned.
+      if (len != 0)
+	{
+	  ++count;
+	  if ((reinterpret_cast<uintptr_t>(p) & (this->addralign() - 1))
+	      != init_align_modulo)
+	    has_misaligned_strings = true;
+	}
+
+      this->stringpool_.add_prehashed(p, len, hash_codes[j], true,
+				      &ms.stringpool_key);
+    }
+
+  this->input_count_ += count;
+  this->input_size_ += merged_strings.back().offset;
+
+  if (has_misaligned_strings)
+    gold_warning(_("%s: section %s contains incorrectly aligned strings;"
+		   " the alignment of those strings won't be preserved"),
+		 object->name().c_str(),
+		 object->section_name(shndx).c_str());
+
+  // Free the hash codes and contents, which we no longer need.
+  std::vector<size_t>().swap(merged_strings_list->hash_codes);
+  if (merged_strings_list->contents != NULL)
+    {
+      delete[] merged_strings_list->contents;
+      merged_strings_list->contents = NULL;
+    }
+  merged_strings_list->is_added = true;
+}
+
 // Finalize the mappings from the input sections to the output
 // section, and return the final data size.
 
@@ -545,6 +908,20 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
+  // Add the strings of any deferred input sections which were not
+  // handled by tasks queued by do_queue_merge_tasks.
+  for (unsigned int i = 0; i < this->merged_strings_lists_.size(); ++i)
+    {
+      if (!this->merged_strings_lists_[i]->is_added)
+	{
+	  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+	  Task_lock_obj<Object> tl(dummy_task,
+				   this->merged_strings_lists_[i]->object);
+	  this->scan_input_section(i);
+	  this->add_input_strings(i);
+	}
+    }
+
   this->stringpool_.set_string_offsets();
 
   for (typename Merged_strings_lists::const_iterator l =
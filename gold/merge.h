@@ -72,6 +72,12 @@ class Object_merge_map
   const Output_section_data*
   find_merge_section(unsigned int shndx) const;
 
+  // Sort the mappings of every input section now, rather than on the
+  // first call to get_output_offset, so that several threads may
+  // call get_output_offset at once.
+  void
+  sort_mappings();
+
   // Initialize an mapping from input offsets to output addresses for
   // section SHNDX.  STARTING_ADDRESS is the output address of the
   // merged section.
@@ -201,6 +207,13 @@ class Output_merge_base : public Output_section_data
   set_keeps_input_sections()
   { this->do_set_keeps_input_sections(); }
 
+  // Queue tasks to process the contents of input sections whose
+  // processing was deferred when they were added.  The tasks hold a
+  // blocker on BLOCKER until they are complete.
+  void
+  queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+  { this->do_queue_merge_tasks(workqueue, blocker); }
+
   // Return the object of the first merged input section.  This used
   // for script processing.  This is NULL if merge section is empty.
   Relobj*
@@ -253,6 +266,11 @@ class Output_merge_base : public Output_section_data
   do_set_keeps_input_sections()
   { this->keeps_input_sections_ = true; }
 
+  // This may be overridden by the child class.
+  virtual void
+  do_queue_merge_tasks(Workqueue*, Task_token*)
+  { }
+
   // Record the merged input section for script processing.
   void
   record_input_section(Relobj* relobj, unsigned int shndx);
@@ -407,11 +425,30 @@ class Output_merge_string : public Output_merge_base
     this->stringpool_.set_no_zero_null();
   }
 
+  // Scan the strings of deferred input section INDEX, recording their
+  // offsets and hash codes.  This is called by a task which holds the
+  // lock on the object, and may run in parallel for different input
+  // sections.
+  void
+  scan_input_section(unsigned int index);
+
+  // Add the strings of deferred input section INDEX, which has been
+  // scanned, to the Stringpool.  This is called by a task which holds
+  // the lock on the object.  The input sections must be added in
+  // order.
+  void
+  add_input_strings(unsigned int index);
+
  protected:
   // Add an input section.
   bool
   do_add_input_section(Relobj* object, unsigned int shndx);
 
+  // Queue tasks to scan and add the strings of deferred input
+  // sections.
+  void
+  do_queue_merge_tasks(Workqueue*, Task_token*);
+
   // Do all the final processing after the input sections are read in.
   // Returns the final data size.
   section_size_type
@@ -490,12 +527,31 @@ class Output_merge_string : public Output_merge_base
     unsigned int shndx;
     // The list of merged strings.
     Merged_strings merged_strings;
+    // The hash codes of the strings, set by scan_input_section and
+    // freed by add_input_strings.
+    std::vector<size_t> hash_codes;
+    // The decompressed contents of a compressed input section whose
+    // processing was deferred, and their size.  These are kept from
+    // do_add_input_section, so that the section is only decompressed
+    // once, and are freed by add_input_strings.
+    const unsigned char* contents;
+    section_size_type contents_size;
+    // Whether the strings have been added to the Stringpool.  This is
+    // false if processing the input section was deferred.
+    bool is_added;
 
     Merged_strings_list(Relobj* objecta, unsigned int shndxa)
-      : object(objecta), shndx(shndxa), merged_strings()
+      : object(objecta), shndx(shndxa), merged_strings(), hash_codes(),
+	contents(NULL), contents_size(0), is_added(true)
     { }
   };
 
+  // Return the contents of the deferred input section in
+  // MERGED_STRINGS_LIST, and set *PLEN to their size.
+  const unsigned char*
+  deferred_section_contents(const Merged_strings_list* merged_strings_list,
+			    section_size_type* plen);
+
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
   // As we see the strings, we add them to a Stringpool.
@@ -1881,7 +1881,7 @@ class Mips_relobj : public Sized_relobj_file<size, big_endian>
   // Count the local symbols.
   void
   do_count_local_symbols(Stringpool_template<char>*,
-                         Stringpool_template<char>*);
+                         Stringpool_template<char>*, unsigned int);
 
   // Read the symbol information.
   void
@@ -2454,6 +2454,15 @@ class Mips_output_data_reloc : public Output_data_reloc<sh_type, dynamic,
         big_endian> Writer;
     this->template do_write_generic<Writer>(of);
   }
+
+  // Write out a range of relocs.
+  void
+  write_reloc_range(Output_file* of, size_t begin, size_t end)
+  {
+    typedef Mips_output_reloc_writer<sh_type, dynamic, size,
+        big_endian> Writer;
+    this->template write_reloc_range_generic<Writer>(of, begin, end);
+  }
 };
 
 
@@ -6754,10 +6763,12 @@ template<int size, bool big_endian>
 void
 Mips_relobj<size, big_endian>::do_count_local_symbols(
     Stringpool_template<char>* pool,
-    Stringpool_template<char>* dynpool)
+    Stringpool_template<char>* dynpool,
+    unsigned int order)
 {
   // Ask parent to count the local symbols.
-  Sized_relobj_file<size, big_endian>::do_count_local_symbols(pool, dynpool);
+  Sized_relobj_file<size, big_endian>::do_count_local_symbols(pool, dynpool,
+							      order);
   const unsigned int loccount = this->local_symbol_count();
   if (loccount == 0)
     return;
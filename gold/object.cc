@@ -42,6 +42,7 @@
 #include "compressed_output.h"
 #include "incremental.h"
 #include "merge.h"
+#include "ehframe.h"
 
 namespace gold
 {
@@ -67,6 +68,8 @@ Read_symbols_data::~Read_symbols_data()
     delete this->verdef;
   if (this->verneed != NULL)
     delete this->verneed;
+  if (this->prepared_symbols != NULL)
+    delete this->prepared_symbols;
 }
 
 // Class Xindex.
@@ -306,6 +309,13 @@ Relobj::find_merge_section(unsigned int shndx) const {
   return object_merge_map->find_merge_section(shndx);
 }
 
+void
+Relobj::sort_merge_mappings()
+{
+  if (this->object_merge_map_ != NULL)
+    this->object_merge_map_->sort_mappings();
+}
+
 // To copy the symbols data read from the file to a local data structure.
 // This function is called from do_layout only while doing garbage
 // collection.
@@ -479,6 +489,7 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
     is_deferred_layout_(false),
     deferred_layout_(),
     deferred_layout_relocs_(),
+    parsed_eh_frames_(),
     output_views_(NULL)
 {
   this->e_type_ = ehdr.get_e_type();
@@ -487,6 +498,11 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
 template<int size, bool big_endian>
 Sized_relobj_file<size, big_endian>::~Sized_relobj_file()
 {
+  for (typename std::vector<Parsed_eh_frame*>::iterator p =
+	 this->parsed_eh_frames_.begin();
+       p != this->parsed_eh_frames_.end();
+       ++p)
+    delete *p;
 }
 
 // Set up an object file based on the file header.  This sets up the
@@ -681,12 +697,12 @@ need_decompressed_section(const char* name)
       // We will need .zdebug_str if this is not an incremental link
       // (i.e., we are processing string merge sections) or if we need
       // to build a gdb index.
-      if ((!parameters->incremental() || parameters->options().gdb_index())
+      if ((!parameters->incremental() || parameters->options().debug_index())
 	  && strcmp(name, "str") == 0)
 	return true;
 
       // We will need these other sections when building a gdb index.
-      if (parameters->options().gdb_index()
+      if (parameters->options().debug_index()
 	  && (strcmp(name, "info") == 0
 	      || strcmp(name, "types") == 0
 	      || strcmp(name, "pubnames") == 0
@@ -702,7 +718,7 @@ need_decompressed_section(const char* name)
   // Otherwise, we would decompress the section twice: once for
   // string merge processing, and once for building the gdb index.
   if (!parameters->incremental()
-      && parameters->options().gdb_index()
+      && parameters->options().debug_index()
       && strcmp(name, "str") == 0)
     return true;
 
@@ -814,7 +830,7 @@ Sized_relobj_file<size, big_endian>::do_find_special_sections(
 
   return (this->has_eh_frame_
 	  || (!parameters->options().relocatable()
-	      && parameters->options().gdb_index()
+	      && parameters->options().debug_index()
 	      && (memmem(names, sd->section_names_size, "debug_info", 11) != NULL
 		  || memmem(names, sd->section_names_size,
 			    "debug_types", 12) != NULL)));
@@ -842,6 +858,13 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
 
   this->find_symtab(pshdrs);
 
+  if (parameters->options().readahead())
+    {
+      const char* names =
+	reinterpret_cast<const char*>(sd->section_names->data());
+      this->queue_readahead(pshdrs, names, sd->section_names_size);
+    }
+
   bool need_local_symbols = this->do_find_special_sections(sd);
 
   sd->symbols = NULL;
@@ -919,6 +942,227 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
     convert_to_section_size_type(strtabshdr.get_sh_size());
 }
 
+// Return whether we expect to read the contents of a section.  This is
+// only used as a hint, so it does not need to match the decisions that
+// Layout makes exactly.
+
+template<int size, bool big_endian>
+bool
+Sized_relobj_file<size, big_endian>::will_read_section_contents(
+    const typename This::Shdr& shdr,
+    const char* name)
+{
+  if (shdr.get_sh_type() == elfcpp::SHT_NOBITS || shdr.get_sh_size() == 0)
+    return false;
+  if ((shdr.get_sh_flags() & elfcpp::SHF_ALLOC) != 0)
+    return true;
+  if (parameters->options().strip_debug()
+      && Layout::is_debug_info_section(name))
+    return false;
+  if (parameters->options().strip_lto_sections()
+      && !parameters->options().relocatable()
+      && is_prefix_of(".gnu.lto_", name))
+    return false;
+  return true;
+}
+
+// Tell the system which parts of the file we will read, so that it can
+// read them while we do other work.  The symbols are read right away
+// by the Read_symbols task, the relocations by the Scan_relocs task,
+// and the section contents by the Relocate_task.  Without this the
+// later tasks would wait for each page as they reach it, which is slow
+// when the file is not in the page cache or is on a network file
+// system.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::queue_readahead(
+    const unsigned char* pshdrs,
+    const char* names,
+    section_size_type names_size)
+{
+  const unsigned int shnum = this->shnum();
+  File_read::Readahead ra;
+  ra.reserve(shnum);
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      if (shdr.get_sh_name() >= names_size)
+	continue;
+      const char* name = names + shdr.get_sh_name();
+
+      bool want;
+      switch (shdr.get_sh_type())
+	{
+	case elfcpp::SHT_SYMTAB:
+	case elfcpp::SHT_SYMTAB_SHNDX:
+	case elfcpp::SHT_GROUP:
+	  want = true;
+	  break;
+
+	case elfcpp::SHT_STRTAB:
+	  // The section names have already been read.
+	  want = i != this->elf_file_.shstrndx();
+	  break;
+
+	case elfcpp::SHT_REL:
+	case elfcpp::SHT_RELA:
+	  {
+	    // Only read the relocations for a section we will read.
+	    unsigned int reloc_shndx = this->adjust_shndx(shdr.get_sh_info());
+	    if (reloc_shndx == 0 || reloc_shndx >= shnum)
+	      want = false;
+	    else
+	      {
+		typename This::Shdr reloc_shdr(pshdrs
+					       + reloc_shndx * This::shdr_size);
+		want = (reloc_shdr.get_sh_name() < names_size
+			&& This::will_read_section_contents(
+			     reloc_shdr,
+			     names + reloc_shdr.get_sh_name()));
+	      }
+	  }
+	  break;
+
+	default:
+	  want = This::will_read_section_contents(shdr, name);
+	  break;
+	}
+
+      if (want && shdr.get_sh_size() > 0)
+	ra.push_back(File_read::Readahead_entry(
+		       shdr.get_sh_offset(),
+		       convert_to_section_size_type(shdr.get_sh_size())));
+    }
+
+  this->input_file()->file().readahead(this->offset(), &ra);
+}
+
+// Compute the information about the external symbol names which does
+// not depend on the symbol table.  This is called from the
+// Read_symbols task when running multi-threaded, so that the
+// Add_symbols task, which must run in order, has less to do.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_prepare_symbols(
+    const Symbol_table* symtab,
+    Read_symbols_data* sd)
+{
+  if (sd->symbols == NULL || sd->prepared_symbols != NULL)
+    return;
+
+  const int sym_size = This::sym_size;
+  size_t symcount = ((sd->symbols_size - sd->external_symbols_offset)
+		     / sym_size);
+  const unsigned char* p = sd->symbols->data() + sd->external_symbols_offset;
+  const char* sym_names =
+    reinterpret_cast<const char*>(sd->symbol_names->data());
+
+  Prepared_symbols* prepared = new Prepared_symbols(symcount);
+  for (size_t i = 0; i < symcount; ++i, p += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(p);
+      unsigned int st_name = sym.get_st_name();
+      // Bad names are reported by Symbol_table::add_from_relobj.
+      if (st_name >= sd->symbol_names_size)
+	continue;
+      Prepared_symbol* ps = &(*prepared)[i];
+      Symbol_table::prepare_symbol_name(sym_names + st_name, ps);
+      if (sym.get_st_shndx() != elfcpp::SHN_UNDEF)
+	symtab->prepare_symbol_version(sym_names + st_name, ps);
+    }
+
+  sd->prepared_symbols = prepared;
+}
+
+// Parse the .eh_frame sections.  This is called from the Read_symbols
+// task when running multi-threaded, so that the Layout task, which
+// adds the .eh_frame sections one at a time, only has to merge the
+// CIEs.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_prepare_eh_frame(
+    Read_symbols_data* sd)
+{
+  if (!this->has_eh_frame_
+      || sd->symbols == NULL
+      || parameters->options().relocatable()
+      || parameters->incremental())
+    return;
+
+  const unsigned int shnum = this->shnum();
+  const unsigned char* const shdrs = sd->section_headers->data();
+  const char* const names =
+    reinterpret_cast<const char*>(sd->section_names->data());
+
+  const unsigned char* pshdrs = shdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, pshdrs += This::shdr_size)
+    {
+      typename This::Shdr shdr(pshdrs);
+      if (shdr.get_sh_name() >= sd->section_names_size
+	  || !this->check_eh_frame_flags(&shdr)
+	  || strcmp(names + shdr.get_sh_name(), ".eh_frame") != 0)
+	continue;
+
+      // Find the reloc section, the same way as do_layout.  Errors
+      // are reported there.
+      unsigned int reloc_shndx = 0;
+      unsigned int reloc_type = elfcpp::SHT_NULL;
+      const unsigned char* prshdrs = shdrs + This::shdr_size;
+      for (unsigned int j = 1; j < shnum; ++j, prshdrs += This::shdr_size)
+	{
+	  typename This::Shdr rshdr(prshdrs);
+	  unsigned int sh_type = rshdr.get_sh_type();
+	  if ((sh_type == elfcpp::SHT_REL || sh_type == elfcpp::SHT_RELA)
+	      && this->adjust_shndx(rshdr.get_sh_info()) == i)
+	    {
+	      if (reloc_shndx != 0)
+		reloc_shndx = -1U;
+	      else
+		{
+		  reloc_shndx = j;
+		  reloc_type = sh_type;
+		}
+	    }
+	}
+
+      Parsed_eh_frame* parsed =
+	Eh_frame::parse_ehframe_input_section(this,
+					      sd->symbols->data(),
+					      sd->symbols_size,
+					      sd->symbol_names->data(),
+					      sd->symbol_names_size,
+					      i, reloc_shndx, reloc_type);
+      this->parsed_eh_frames_.push_back(parsed);
+    }
+}
+
+// Return the result of parsing the .eh_frame section SHNDX, if
+// prepare_eh_frame parsed it.
+
+template<int size, bool big_endian>
+Parsed_eh_frame*
+Sized_relobj_file<size, big_endian>::release_parsed_eh_frame(
+    unsigned int shndx)
+{
+  for (typename std::vector<Parsed_eh_frame*>::iterator p =
+	 this->parsed_eh_frames_.begin();
+       p != this->parsed_eh_frames_.end();
+       ++p)
+    {
+      if ((*p)->shndx() == shndx)
+	{
+	  Parsed_eh_frame* ret = *p;
+	  this->parsed_eh_frames_.erase(p);
+	  return ret;
+	}
+    }
+  return NULL;
+}
+
 // Return the section index of symbol SYM.  Set *VALUE to its value in
 // the object file.  Set *IS_ORDINARY if this is an ordinary section
 // index, not a special code between SHN_LORESERVE and SHN_HIRESERVE.
@@ -1272,6 +1516,11 @@ Sized_relobj_file<size, big_endian>::layout_eh_frame_section(
   this->output_sections()[shndx] = os;
   if (os == NULL || offset == -1)
     this->section_offsets()[shndx] = invalid_address;
+
+  // If the section was discarded, we no longer need the result of
+  // parsing it.
+  if (os == NULL)
+    delete this->release_parsed_eh_frame(shndx);
   else
     this->section_offsets()[shndx] = convert_types<Address, off_t>(offset);
 
@@ -1852,7 +2101,7 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
 	  // processing of .debug_info and .debug_types sections after all
 	  // the other sections for the same reason as above.
 	  if (!relocatable
-	      && parameters->options().gdb_index()
+	      && parameters->options().debug_index()
 	      && !(shdr.get_sh_flags() & elfcpp::SHF_ALLOC))
 	    {
 	      if (strcmp(name, ".debug_info") == 0
@@ -2106,6 +2355,7 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
 			  sym_names, sd->symbol_names_size,
+			  sd->prepared_symbols,
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -2113,6 +2363,11 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
   sd->symbols = NULL;
   delete sd->symbol_names;
   sd->symbol_names = NULL;
+  if (sd->prepared_symbols != NULL)
+    {
+      delete sd->prepared_symbols;
+      sd->prepared_symbols = NULL;
+    }
 }
 
 // Find out if this object, that is a member of a lib group, should be included
@@ -2232,14 +2487,17 @@ Sized_relobj_file<size, big_endian>::set_local_plt_offset(
 
 // First pass over the local symbols.  Here we add their names to
 // *POOL and *DYNPOOL, and we store the symbol value in
-// THIS->LOCAL_VALUES_.  This function is always called from a
-// singleton thread.  This is followed by a call to
-// finalize_local_symbols.
+// THIS->LOCAL_VALUES_.  This may be called for several objects at
+// once in different threads; the names are added with
+// Stringpool::add_ordered, ordered by ORDER and then by symbol index.
+// This is followed by a call to finalize_local_symbols.
 
 template<int size, bool big_endian>
 void
-Sized_relobj_file<size, big_endian>::do_count_local_symbols(Stringpool* pool,
-							    Stringpool* dynpool)
+Sized_relobj_file<size, big_endian>::do_count_local_symbols(
+    Stringpool* pool,
+    Stringpool* dynpool,
+    unsigned int order)
 {
   gold_assert(this->symtab_shndx_ != -1U);
   if (this->symtab_shndx_ == 0)
@@ -2284,6 +2542,7 @@ Sized_relobj_file<size, big_endian>::do_count_local_symbols(Stringpool* pool,
   bool discard_all = parameters->options().discard_all();
   bool discard_locals = parameters->options().discard_locals();
   bool discard_sec_merge = parameters->options().discard_sec_merge();
+  const uint64_t order_base = static_cast<uint64_t>(order) << 32;
   for (unsigned int i = 1; i < loccount; ++i, psyms += sym_size)
     {
       elfcpp::Sym<size, big_endian> sym(psyms);
@@ -2342,7 +2601,7 @@ Sized_relobj_file<size, big_endian>::do_count_local_symbols(Stringpool* pool,
       // If needed, add the symbol to the dynamic symbol table string pool.
       if (lv.needs_output_dynsym_entry())
 	{
-	  dynpool->add(name, true, NULL);
+	  dynpool->add_ordered(name, order_base | i);
 	  ++dyncount;
 	}
 
@@ -2388,7 +2647,7 @@ Sized_relobj_file<size, big_endian>::do_count_local_symbols(Stringpool* pool,
 	}
 
       // Add the symbol to the symbol table string pool.
-      pool->add(name, true, NULL);
+      pool->add_ordered(name, order_base | i);
       ++count;
     }
 
@@ -48,19 +48,50 @@ class Output_symtab_xindex;
 class Pluginobj;
 class Dynobj;
 class Object_merge_map;
+class Parsed_eh_frame;
 class Relocatable_relocs;
 struct Symbols_data;
 
 template<typename Stringpool_char>
 class Stringpool_template;
 
+// Information about the name of a global symbol which does not depend
+// on the contents of the symbol table.  When running multi-threaded,
+// this is computed by the Read_symbols task, which runs in parallel
+// with other Read_symbols tasks, so that there is less work to do in
+// the Add_symbols task, which must run in input order.
+
+struct Prepared_symbol
+{
+  // The length of the name, not including any version.
+  size_t name_length;
+  // The hash code of the name, from Stringpool::hash_string.
+  size_t name_hash;
+  // The version in the name, or NULL.  This points into the symbol
+  // names.
+  const char* version;
+  // Whether the version is the default version.
+  bool is_default_version;
+  // Whether the name has been looked up in the version script.  This
+  // is done for defined symbols with no version in the name.
+  bool version_script_checked;
+  // If it has been looked up, whether the version script matched the
+  // name, and if so whether the symbol is global and its version.
+  bool version_script_matched;
+  bool version_script_is_global;
+  const std::string* version_script_version;
+};
+
+typedef std::vector<Prepared_symbol> Prepared_symbols;
+
 // Data to pass from read_symbols() to add_symbols().
 
 struct Read_symbols_data
 {
   Read_symbols_data()
     : section_headers(NULL), section_names(NULL), symbols(NULL),
-      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL)
+      symbol_names(NULL), prepared_symbols(NULL), versym(NULL),
+      verdef(NULL), verneed(NULL)
   { }
 
   ~Read_symbols_data();
@@ -83,6 +114,9 @@ struct Read_symbols_data
   File_view* symbol_names;
   // Size of symbol name data in bytes.
   section_size_type symbol_names_size;
+  // Information about the names of the external symbols, or NULL if
+  // it has not been computed.
+  Prepared_symbols* prepared_symbols;
 
   // Version information.  This is only used on dynamic objects.
   // Version symbol data (from SHT_GNU_versym section).
@@ -645,6 +679,20 @@ class Object
   read_symbols(Read_symbols_data* sd)
   { return this->do_read_symbols(sd); }
 
+  // Compute the information about the global symbol names read by
+  // read_symbols which does not depend on the symbol table.  This is
+  // optional, and may be run in parallel with other objects.
+  void
+  prepare_symbols(const Symbol_table* symtab, Read_symbols_data* sd)
+  { this->do_prepare_symbols(symtab, sd); }
+
+  // Parse the exception frame sections read by read_symbols, so that
+  // laying them out has less to do.  This is optional, and may be run
+  // in parallel with other objects.
+  void
+  prepare_eh_frame(Read_symbols_data* sd)
+  { this->do_prepare_eh_frame(sd); }
+
   // Pass sections which should be included in the link to the Layout
   // object, and record where the sections go in the output file.
   void
@@ -881,6 +929,18 @@ class Object
   virtual void
   do_read_symbols(Read_symbols_data*) = 0;
 
+  // Prepare the global symbol names--implemented by child class if
+  // it is useful.
+  virtual void
+  do_prepare_symbols(const Symbol_table*, Read_symbols_data*)
+  { }
+
+  // Parse the exception frame sections--implemented by child class if
+  // it is useful.
+  virtual void
+  do_prepare_eh_frame(Read_symbols_data*)
+  { }
+
   // Lay out sections--implemented by child class.
   virtual void
   do_layout(Symbol_table*, Layout*, Read_symbols_data*) = 0;
@@ -1233,11 +1293,15 @@ class Relobj : public Object
 
   // Initial local symbol processing: count the number of local symbols
   // in the output symbol table and dynamic symbol table; add local symbol
-  // names to *POOL and *DYNPOOL.
+  // names to *POOL and *DYNPOOL.  ORDER is the position of this object
+  // in the list of input objects; it is used to add the names with
+  // Stringpool::add_ordered, since the names of several objects may
+  // be added at once.
   void
   count_local_symbols(Stringpool_template<char>* pool,
-                      Stringpool_template<char>* dynpool)
-  { return this->do_count_local_symbols(pool, dynpool); }
+                      Stringpool_template<char>* dynpool,
+                      unsigned int order)
+  { return this->do_count_local_symbols(pool, dynpool, order); }
 
   // Set the values of the local symbols, set the output symbol table
   // indexes for the local variables, and set the offset where local
@@ -1334,6 +1398,11 @@ class Relobj : public Object
   const Output_section_data*
   find_merge_section(unsigned int shndx) const;
 
+  // Get the merge mappings ready to be looked up from several threads
+  // at once.
+  void
+  sort_merge_mappings();
+
   // Record the relocatable reloc info for an input reloc section.
   void
   set_relocatable_relocs(unsigned int reloc_shndx, Relocatable_relocs* rr)
@@ -1437,7 +1506,7 @@ class Relobj : public Object
   // Count local symbols--implemented by child class.
   virtual void
   do_count_local_symbols(Stringpool_template<char>*,
-			 Stringpool_template<char>*) = 0;
+			 Stringpool_template<char>*, unsigned int) = 0;
 
   // Finalize the local symbols.  Set the output symbol table indexes
   // for the local variables, and set the offset where local symbol
@@ -2337,6 +2406,12 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   bool is_deferred_layout() const
   { return this->is_deferred_layout_; }
 
+  // Return the result of parsing the .eh_frame section SHNDX in
+  // prepare_eh_frame, or NULL if it was not parsed.  The caller takes
+  // ownership.
+  Parsed_eh_frame*
+  release_parsed_eh_frame(unsigned int shndx);
+
  protected:
   typedef typename Sized_relobj<size, big_endian>::Output_sections
       Output_sections;
@@ -2354,6 +2429,14 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   base_read_symbols(Read_symbols_data*);
 
+  // Prepare the global symbol names.
+  void
+  do_prepare_symbols(const Symbol_table*, Read_symbols_data*);
+
+  // Parse the .eh_frame sections.
+  void
+  do_prepare_eh_frame(Read_symbols_data*);
+
   // Return the value of a local symbol.
   uint64_t
   do_local_symbol_value(unsigned int symndx, uint64_t addend) const
@@ -2425,7 +2508,7 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   // Count the local symbols.
   void
   do_count_local_symbols(Stringpool_template<char>*,
-                            Stringpool_template<char>*);
+			 Stringpool_template<char>*, unsigned int);
 
   // Finalize the local symbols.
   unsigned int
@@ -2580,6 +2663,17 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
 			 Views* pviews, unsigned int start_shndx,
 			 unsigned int end_shndx);
 
+  // Like relocate_section_range, but with --threads split the range
+  // into pieces which are relocated by any idle workqueue threads, if
+  // this object has enough relocations for that to be worth while.
+  void
+  relocate_section_range_in_pieces(const Symbol_table* symtab,
+				   const Layout* layout,
+				   const unsigned char* pshdrs,
+				   Output_file* of, Views* pviews,
+				   unsigned int start_shndx,
+				   unsigned int end_shndx);
+
   // Adjust this local symbol value.  Return false if the symbol
   // should be discarded from the output file.
   virtual bool
@@ -2604,6 +2698,9 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   typedef elfcpp::Shdr<size, big_endian> Shdr;
   typedef elfcpp::Shdr_write<size, big_endian> Shdr_write;
 
+  // Runs the pieces for relocate_section_range_in_pieces.
+  class Relocate_range_job;
+
   // To keep track of discarded comdat sections, we need to map a member
   // section index to the object and section index of the corresponding
   // kept section.
@@ -2626,6 +2723,18 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   find_symtab(const unsigned char* pshdrs);
 
+  // Ask the system to start reading the parts of the file which later
+  // passes will need, given the section headers and names.
+  void
+  queue_readahead(const unsigned char* pshdrs, const char* names,
+		  section_size_type names_size);
+
+  // Return whether the contents of the section with header SHDR and
+  // name NAME will be read during the link.
+  static bool
+  will_read_section_contents(const typename This::Shdr& shdr,
+			     const char* name);
+
   // Return whether SHDR has the right flags for a GNU style exception
   // frame section.
   bool
@@ -2876,6 +2985,9 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   std::vector<Deferred_layout> deferred_layout_;
   // The list of relocation sections whose layout was deferred.
   std::vector<Deferred_layout> deferred_layout_relocs_;
+  // The .eh_frame sections parsed by prepare_eh_frame, which have not
+  // yet been laid out.
+  std::vector<Parsed_eh_frame*> parsed_eh_frames_;
   // Pointer to the list of output views; valid only during do_relocate().
   const Views* output_views_;
 };
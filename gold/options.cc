@@ -1213,6 +1213,13 @@ General_options::finalize()
 	       program_name);
 #endif
 
+#ifndef HAVE_ZSTD
+  if (strcmp(this->compress_debug_sections(), "zstd") == 0)
+    gold_fatal(_("cannot use --compress-debug-sections=zstd: "
+		 "%s was compiled without zstd support"),
+	       program_name);
+#endif
+
   std::string libpath;
   if (this->user_set_Y())
     {
@@ -1329,6 +1336,13 @@ General_options::finalize()
 		 "[0.0, 1.0)"),
 	       this->hash_bucket_empty_fraction());
 
+  if (this->gdb_index() && this->debug_names())
+    gold_fatal(_("--gdb-index and --debug-names are incompatible"));
+
+  if (this->section_ordering_file() && this->call_graph_ordering_file())
+    gold_fatal(_("--section-ordering-file and --call-graph-ordering-file "
+		 "are incompatible"));
+
   if (this->implicit_incremental_ && this->incremental_mode_ == INCREMENTAL_OFF)
     gold_fatal(_("Options --incremental-changed, --incremental-unchanged, "
 		 "--incremental-unknown require the use of --incremental"));
@@ -1360,6 +1374,11 @@ General_options::finalize()
 	  gold_warning(_("ignoring --icf for an incremental link"));
 	  this->set_icf_status(ICF_NONE);
 	}
+      if (this->debug_names())
+	{
+	  gold_warning(_("ignoring --debug-names for an incremental link"));
+	  this->set_debug_names(false);
+	}
       if (strcmp(this->compress_debug_sections(), "none") != 0)
 	{
 	  gold_warning(_("ignoring --compress-debug-sections for an "
@@ -702,6 +702,10 @@ class General_options
 	      N_("Use DT_NEEDED only for shared libraries that are used"),
 	      N_("Use DT_NEEDED for all shared libraries"));
 
+  DEFINE_string(archive_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Cache the symbol tables of archives in DIRECTORY"),
+		N_("DIRECTORY"));
+
   DEFINE_enum(assert, options::ONE_DASH, '\0', NULL,
 	      N_("Ignored"), N_("[ignored]"),
 	      {"definitions", "nodefinitions", "nosymbolic", "pure-text"});
@@ -724,12 +728,14 @@ class General_options
 
   DEFINE_uint64(build_id_chunk_size_for_treehash,
 		options::TWO_DASHES, '\0', 2 << 20,
-		N_("Chunk size for '--build-id=tree'"), N_("SIZE"));
+		N_("Chunk size for '--build-id=tree' and '--build-id=fast'"),
+		N_("SIZE"));
 
   DEFINE_uint64(build_id_min_file_size_for_treehash, options::TWO_DASHES,
 		'\0', 40 << 20,
-		N_("Minimum output file size for '--build-id=tree' to work"
-		   " differently than '--build-id=sha1'"), N_("SIZE"));
+		N_("Minimum output file size for '--build-id=tree' and"
+		   " '--build-id=fast' to hash the file in chunks"),
+		N_("SIZE"));
 
   DEFINE_bool(Bdynamic, options::ONE_DASH, '\0', true,
 	      N_("-l searches for shared libraries"), NULL);
@@ -761,8 +767,8 @@ class General_options
 
   DEFINE_enum(compress_debug_sections, options::TWO_DASHES, '\0', "none",
 	      N_("Compress .debug_* sections in the output file"),
-	      ("[none,zlib,zlib-gnu,zlib-gabi]"),
-	      {"none", "zlib", "zlib-gnu", "zlib-gabi"});
+	      ("[none,zlib,zlib-gnu,zlib-gabi,zstd]"),
+	      {"none", "zlib", "zlib-gnu", "zlib-gabi", "zstd"});
 
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
@@ -790,6 +796,11 @@ class General_options
 		N_("Turn on debugging"),
 		N_("[all,files,script,task][,...]"));
 
+  DEFINE_bool(debug_names, options::TWO_DASHES, '\0', false,
+	      N_("Generate DWARF 5 .debug_names section instead of "
+		 ".gdb_index"),
+	      N_("Do not generate .debug_names section"));
+
   DEFINE_special(defsym, options::TWO_DASHES, '\0',
 		 N_("Define a symbol"), N_("SYMBOL=EXPRESSION"));
 
@@ -929,6 +940,10 @@ class General_options
 		N_("Min fraction of empty buckets in dynamic hash"),
 		N_("FRACTION"));
 
+  DEFINE_bool(hash_optimize, options::TWO_DASHES, '\0', false,
+	      N_("Size dynamic hash tables for faster symbol lookup"),
+	      N_("Use the default dynamic hash table sizes (default)"));
+
   DEFINE_enum(hash_style, options::TWO_DASHES, '\0', DEFAULT_HASH_STYLE,
 	      N_("Dynamic hash style"), N_("[sysv,gnu,both]"),
 	      {"sysv", "gnu", "both"});
@@ -1173,6 +1188,10 @@ class General_options
   DEFINE_bool(relocatable, options::EXACTLY_ONE_DASH, 'r', false,
 	      N_("Generate relocatable output"), NULL);
 
+  DEFINE_bool(readahead, options::TWO_DASHES, '\0', true,
+	      N_("Start reading input file sections before they are needed"),
+	      N_("Read input file sections only when they are needed"));
+
   DEFINE_bool(relax, options::TWO_DASHES, '\0', false,
 	      N_("Relax branches on certain targets"),
 	      N_("Do not relax branches"));
@@ -1218,6 +1237,11 @@ class General_options
   DEFINE_string(section_ordering_file, options::TWO_DASHES, '\0', NULL,
 		N_("Layout sections in the order specified"),
 		N_("FILENAME"));
+  DEFINE_string(call_graph_ordering_file, options::TWO_DASHES, '\0', NULL,
+		N_("Layout functions to place callers near callees, "
+		   "using the caller, callee and weight on each line "
+		   "of FILENAME"),
+		N_("FILENAME"));
 
   DEFINE_special(section_start, options::TWO_DASHES, '\0',
 		 N_("Set address of section"), N_("SECTION=ADDRESS"));
@@ -1420,6 +1444,11 @@ class General_options
   DEFINE_set(trace_symbol, options::TWO_DASHES, 'y',
 	     N_("Trace references to symbol"), N_("SYMBOL"));
 
+  DEFINE_string(trace_file, options::TWO_DASHES, '\0', NULL,
+		N_("Write a timeline of the linker's tasks to FILE "
+		   "in Chrome trace event format"),
+		N_("FILE"));
+
   DEFINE_bool(undefined_version, options::TWO_DASHES, '\0', true,
 	      N_("Allow unused version in script"),
 	      N_("Do not allow unused version in script"));
@@ -1495,6 +1524,9 @@ class General_options
   DEFINE_bool(origin, options::DASH_Z, '\0', false,
 	      N_("Mark DSO to indicate that needs immediate $ORIGIN "
 		 "processing at runtime"), NULL);
+  DEFINE_bool(pack_relative_relocs, options::DASH_Z, '\0', false,
+	      N_("Pack relative relocations into a .relr.dyn section"),
+	      N_("Do not pack relative relocations (default)"));
   DEFINE_bool(relro, options::DASH_Z, '\0', DEFAULT_LD_Z_RELRO,
 	      N_("Where possible mark variables read-only after relocation"),
 	      N_("Don't mark variables read-only after relocation"));
@@ -1609,6 +1641,12 @@ class General_options
   icf_enabled() const
   { return this->icf_status_ != ICF_NONE; }
 
+  // Return true if we are building a symbol index for the debugger,
+  // either .gdb_index or .debug_names.
+  bool
+  debug_index() const
+  { return this->gdb_index() || this->debug_names(); }
+
   bool
   icf_safe_folding() const
   { return this->icf_status_ == ICF_SAFE; }
@@ -1697,6 +1735,17 @@ class General_options
   any_section_start() const
   { return !this->section_starts_.empty(); }
 
+  // Set the --threads, --thread-count and --stats options.  This is
+  // for programs other than the linker which use libgold and parse
+  // their own command line, such as dwp.
+  void
+  set_thread_options(bool threads, int thread_count, bool stats)
+  {
+    this->set_threads(threads);
+    this->set_thread_count(thread_count);
+    this->set_stats(stats);
+  }
+
   enum Fix_v4bx
   {
     // Leave original instruction.
@@ -43,6 +43,7 @@
 #include "reloc.h"
 #include "merge.h"
 #include "descriptors.h"
+#include "gold-threads.h"
 #include "layout.h"
 #include "output.h"
 
@@ -1105,6 +1106,56 @@ Output_reloc<elfcpp::SHT_REL, dynamic, size, big_endian>::get_address() const
   return address;
 }
 
+// Return whether this is a RELATIVE reloc of type R_TYPE which may be
+// packed into a .relr.dyn section.  That section can only hold word
+// aligned addresses in sections which are laid out before it, since
+// its size depends on the addresses.  This is called before the
+// sections are laid out, so we require the offset to be aligned in an
+// output section which is aligned.  A reloc against a PLT entry is
+// excluded, since its addend is not what is written to the section.
+
+template<bool dynamic, int size, bool big_endian>
+bool
+Output_reloc<elfcpp::SHT_REL, dynamic, size, big_endian>::is_packable_relative(
+    unsigned int r_type) const
+{
+  if (!this->is_relative_
+      || this->type_ != r_type
+      || this->use_plt_offset_
+      || this->local_sym_index_ == TARGET_CODE)
+    return false;
+
+  const Address word_size = size / 8;
+  const Output_section* os;
+  Address offset = this->address_;
+  if (this->shndx_ != INVALID_CODE)
+    {
+      Sized_relobj<size, big_endian>* relobj = this->u2_.relobj;
+      Address off = relobj->get_output_section_offset(this->shndx_);
+      if (off == invalid_address)
+	return false;
+      offset += off;
+      os = relobj->output_section(this->shndx_);
+    }
+  else
+    {
+      const Output_data* od = this->u2_.od;
+      if (od == NULL)
+	return false;
+      if (!od->is_section())
+	{
+	  if (od->addralign() < word_size)
+	    return false;
+	}
+      os = od->output_section();
+    }
+
+  return (os != NULL
+	  && os->addralign() >= word_size
+	  && offset % word_size == 0
+	  && os->order() < ORDER_RELR_RELOCS);
+}
+
 // Write out the offset and info fields of a Rel or Rela relocation
 // entry.
 
@@ -1288,6 +1339,362 @@ Output_data_reloc_base<sh_type, dynamic, size, big_endian>::do_write(
   this->do_write_generic<Writer>(of);
 }
 
+// Move the RELATIVE relocs of type R_TYPE which can be packed into a
+// new .relr.dyn section.  This is called by the target when it
+// finalizes the sections, before the sections are laid out.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+Output_section_data*
+Output_data_reloc_base<sh_type, dynamic, size, big_endian>
+    ::pack_relative_relocs(unsigned int r_type)
+{
+  gold_assert(dynamic);
+  Output_data_relr<sh_type, dynamic, size, big_endian>* relr = NULL;
+  typename Relocs::iterator out = this->relocs_.begin();
+  for (typename Relocs::const_iterator p = this->relocs_.begin();
+       p != this->relocs_.end();
+       ++p)
+    {
+      if (p->is_packable_relative(r_type))
+	{
+	  if (relr == NULL)
+	    relr = new Output_data_relr<sh_type, dynamic, size, big_endian>();
+	  relr->add(*p);
+	}
+      else
+	{
+	  *out = *p;
+	  ++out;
+	}
+    }
+  if (relr == NULL)
+    return NULL;
+
+  this->relocs_.erase(out, this->relocs_.end());
+  this->set_current_data_size(this->relocs_.size() * reloc_size);
+  this->reduce_relative_reloc_count(relr->reloc_count());
+  return relr;
+}
+
+// Sort the relocs from BEGIN to END, or merge the sorted relocs from
+// BEGIN to MIDDLE and MIDDLE to END.  This is called by the tasks
+// queued by queue_write_tasks, for different ranges at the same time.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_reloc_base<sh_type, dynamic, size, big_endian>
+    ::sort_reloc_range(size_t begin, size_t middle, size_t end)
+{
+  gold_assert(begin <= middle && middle <= end
+	      && end <= this->relocs_.size());
+  typename Relocs::iterator pb = this->relocs_.begin() + begin;
+  typename Relocs::iterator pe = this->relocs_.begin() + end;
+  if (middle == begin)
+    std::sort(pb, pe, Sort_relocs_comparison());
+  else
+    std::inplace_merge(pb, this->relocs_.begin() + middle, pe,
+		       Sort_relocs_comparison());
+}
+
+// Write out the relocs from BEGIN to END.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_reloc_base<sh_type, dynamic, size, big_endian>
+    ::write_reloc_range(Output_file* of, size_t begin, size_t end)
+{
+  typedef Output_reloc_writer<sh_type, dynamic, size, big_endian> Writer;
+  this->template write_reloc_range_generic<Writer>(of, begin, end);
+}
+
+// A task to sort or merge one range of dynamic relocs.
+
+class Sort_relocs_task : public Task
+{
+ public:
+  Sort_relocs_task(Output_data_reloc_generic* relocs, size_t begin,
+		   size_t middle, size_t end, Task_token* blocker)
+    : relocs_(relocs), begin_(begin), middle_(middle), end_(end),
+      blocker_(blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->relocs_->sort_reloc_range(this->begin_, this->middle_, this->end_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  std::string
+  get_name() const
+  { return "Sort_relocs_task"; }
+
+ private:
+  Output_data_reloc_generic* relocs_;
+  size_t begin_;
+  size_t middle_;
+  size_t end_;
+  Task_token* blocker_;
+};
+
+// A task to write out one range of dynamic relocs.
+
+class Write_relocs_task : public Task
+{
+ public:
+  Write_relocs_task(Output_data_reloc_generic* relocs, Output_file* of,
+		    size_t begin, size_t end, Task_token* final_blocker)
+    : relocs_(relocs), of_(of), begin_(begin), end_(end),
+      final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->relocs_->write_reloc_range(this->of_, this->begin_, this->end_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Write_relocs_task"; }
+
+ private:
+  Output_data_reloc_generic* relocs_;
+  Output_file* of_;
+  size_t begin_;
+  size_t end_;
+  Task_token* final_blocker_;
+};
+
+// A task which waits until the sorted runs of WIDTH relocs are ready.
+// If there is more than one run, it queues tasks to merge pairs of
+// runs, and another of these tasks to wait for them.  Otherwise it
+// queues tasks to write out the relocs.  Merging in rounds means that
+// the only work which is not done in parallel is the last merge.
+
+class Merge_relocs_task : public Task
+{
+ public:
+  Merge_relocs_task(Output_data_reloc_generic* relocs, Output_file* of,
+		    size_t width, Task_token* this_blocker,
+		    Task_token* final_blocker)
+    : relocs_(relocs), of_(of), width_(width), this_blocker_(this_blocker),
+      final_blocker_(final_blocker)
+  { }
+
+  ~Merge_relocs_task()
+  { delete this->this_blocker_; }
+
+  void
+  run(Workqueue*);
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Merge_relocs_task"; }
+
+ private:
+  Output_data_reloc_generic* relocs_;
+  Output_file* of_;
+  size_t width_;
+  Task_token* this_blocker_;
+  Task_token* final_blocker_;
+};
+
+void
+Merge_relocs_task::run(Workqueue* workqueue)
+{
+  const size_t count = this->relocs_->reloc_count();
+  const size_t chunk = Output_data_reloc_generic::reloc_task_chunk_size;
+  if (this->width_ >= count)
+    {
+      for (size_t begin = 0; begin < count; begin += chunk)
+	{
+	  size_t end = std::min(begin + chunk, count);
+	  workqueue->add_blocker(this->final_blocker_);
+	  workqueue->queue(new Write_relocs_task(this->relocs_, this->of_,
+						 begin, end,
+						 this->final_blocker_));
+	}
+      return;
+    }
+
+  Task_token* next_blocker = new Task_token(true);
+  for (size_t begin = 0; begin + this->width_ < count;
+       begin += 2 * this->width_)
+    {
+      size_t end = std::min(begin + 2 * this->width_, count);
+      workqueue->add_blocker(next_blocker);
+      workqueue->queue(new Sort_relocs_task(this->relocs_, begin,
+					    begin + this->width_, end,
+					    next_blocker));
+    }
+  workqueue->add_blocker(this->final_blocker_);
+  workqueue->queue(new Merge_relocs_task(this->relocs_, this->of_,
+					 2 * this->width_, next_blocker,
+					 this->final_blocker_));
+}
+
+// Class Output_data_reloc_generic.
+
+// Queue tasks to sort and write out the relocs.  The relocs are
+// sorted in chunks of a fixed size, and then merged, so that the
+// result does not depend on the number of threads.  This is only
+// called after the sections are laid out, when the sort keys and the
+// reloc contents are known.
+
+bool
+Output_data_reloc_generic::queue_write_tasks(Workqueue* workqueue,
+					     Output_file* of,
+					     Task_token* final_blocker)
+{
+  const size_t count = this->reloc_count();
+  const size_t chunk = reloc_task_chunk_size;
+  if (count <= chunk)
+    return false;
+
+  this->written_by_tasks_ = true;
+
+  Task_token* sort_blocker = new Task_token(true);
+  size_t width = count;
+  if (this->sort_relocs_)
+    {
+      for (size_t begin = 0; begin < count; begin += chunk)
+	{
+	  workqueue->add_blocker(sort_blocker);
+	  workqueue->queue(new Sort_relocs_task(this, begin, begin,
+						std::min(begin + chunk,
+							 count),
+						sort_blocker));
+	}
+      width = chunk;
+    }
+  workqueue->add_blocker(final_blocker);
+  workqueue->queue(new Merge_relocs_task(this, of, width, sort_blocker,
+					 final_blocker));
+  return true;
+}
+
+// Class Output_data_relr.
+
+// Sort the addresses of the relocs and encode them.  The sections
+// which they relocate have been given their addresses.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_relr<sh_type, dynamic, size, big_endian>::set_final_data_size()
+{
+  const Address word_size = size / 8;
+  // The number of words covered by a bitmap.
+  const Address bitmap_words = size - 1;
+
+  std::vector<Address> addresses;
+  addresses.reserve(this->relocs_.size());
+  for (typename std::vector<Output_reloc_type>::const_iterator p =
+	 this->relocs_.begin();
+       p != this->relocs_.end();
+       ++p)
+    {
+      Address address = p->get_address();
+      if (address % word_size != 0)
+	gold_error(_("cannot pack relative relocation at unaligned "
+		     "address 0x%llx; link without -z pack-relative-relocs"),
+		   static_cast<unsigned long long>(address));
+      addresses.push_back(address);
+    }
+  std::sort(addresses.begin(), addresses.end());
+  addresses.erase(std::unique(addresses.begin(), addresses.end()),
+		  addresses.end());
+
+  this->entries_.clear();
+  typename std::vector<Address>::const_iterator p = addresses.begin();
+  while (p != addresses.end())
+    {
+      // An address entry, which relocates the word at that address.
+      this->entries_.push_back(*p);
+      Address base = *p + word_size;
+      ++p;
+
+      // Bitmap entries for the words which follow.
+      while (true)
+	{
+	  Address bitmap = 0;
+	  while (p != addresses.end()
+		 && *p - base < bitmap_words * word_size)
+	    {
+	      bitmap |= static_cast<Address>(1) << ((*p - base) / word_size);
+	      ++p;
+	    }
+	  if (bitmap == 0)
+	    break;
+	  this->entries_.push_back((bitmap << 1) | 1);
+	  base += bitmap_words * word_size;
+	}
+    }
+
+  this->set_data_size(this->entries_.size() * word_size);
+}
+
+// Write out the packed relocs.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_relr<sh_type, dynamic, size, big_endian>::do_write(Output_file* of)
+{
+  const off_t off = this->offset();
+  const section_size_type oview_size =
+    convert_to_section_size_type(this->data_size());
+  unsigned char* const oview = of->get_output_view(off, oview_size);
+
+  unsigned char* pov = oview;
+  for (typename std::vector<Address>::const_iterator p =
+	 this->entries_.begin();
+       p != this->entries_.end();
+       ++p)
+    {
+      elfcpp::Swap<size, big_endian>::writeval(pov, *p);
+      pov += size / 8;
+    }
+  gold_assert(static_cast<section_size_type>(pov - oview) == oview_size);
+
+  of->write_output_view(off, oview_size, oview);
+}
+
+// Set the entry size of the output section.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_relr<sh_type, dynamic, size, big_endian>
+    ::do_adjust_output_section(Output_section* os)
+{
+  os->set_entsize(size / 8);
+}
+
 // Class Output_relocatable_relocs.
 
 template<int sh_type, int size, bool big_endian>
@@ -2361,6 +2768,7 @@ Output_section::Output_section(const char* name, elfcpp::Elf_Word type,
     symtab_index_(0),
     dynsym_index_(0),
     input_sections_(),
+    input_section_writers_(),
     first_input_offset_(0),
     fills_(),
     postprocessing_buffer_(NULL),
@@ -2396,6 +2804,8 @@ Output_section::Output_section(const char* name, elfcpp::Elf_Word type,
     free_list_(),
     free_space_fill_(NULL),
     patch_space_(0),
+    fixed_layout_base_offset_(-1),
+    fixed_layout_base_size_(0),
     reloc_section_(NULL)
 {
   // An unallocated section has no address.  Forcing this means that
@@ -2492,6 +2902,12 @@ Output_section::add_input_section(Layout* layout,
       if (this->add_merge_input_section(object, shndx, sh_flags, entsize,
 					addralign, keeps_input_sections))
 	{
+	  // Relocating an object with a merged section rewrites the
+	  // whole output section.
+	  if ((sh_flags & elfcpp::SHF_ALLOC) == 0
+	      && layout->records_section_writers())
+	    this->add_input_section_writer(object, 0, -1);
+
 	  // Tell the relocation routines that they need to call the
 	  // output_offset method to determine the final address.
 	  return -1;
@@ -2510,6 +2926,13 @@ Output_section::add_input_section(Layout* layout,
       // For incremental updates, find a chunk of unused space in the section.
       offset_in_section = this->free_list_.allocate(input_section_size,
 						    addralign, 0);
+      // An unallocated section can be moved to make more room.
+      if (offset_in_section == -1
+	  && (this->flags_ & elfcpp::SHF_ALLOC) == 0
+	  && this->type_ != elfcpp::SHT_NOBITS
+	  && this->input_sections_.empty())
+	offset_in_section = this->grow_fixed_layout(input_section_size,
+						    addralign);
       if (offset_in_section == -1)
 	gold_fallback(_("out of patch space in section %s; "
 			"relink with --incremental-full"),
@@ -2517,6 +2940,14 @@ Output_section::add_input_section(Layout* layout,
       return offset_in_section;
     }
 
+  // An incremental update can't add an allocated section which is
+  // not in the base file, because the segments have no room for it.
+  if (parameters->incremental_update()
+      && (this->flags_ & elfcpp::SHF_ALLOC) != 0)
+    gold_fallback(_("%s: section %s is not in the base file; "
+		    "relink with --incremental-full"),
+		  object->name().c_str(), this->name());
+
   offset_in_section = this->current_data_size_for_child();
   off_t aligned_offset_in_section = align_address(offset_in_section,
 						  addralign);
@@ -2590,6 +3021,15 @@ Output_section::add_input_section(Layout* layout,
       this->input_sections_.push_back(isecn);
     }
 
+  // Remember which object writes this part of the section, so that
+  // a chunked build ID can hash it once that object is relocated.
+  if ((sh_flags & elfcpp::SHF_ALLOC) == 0
+      && input_section_size > 0
+      && layout->records_section_writers())
+    this->add_input_section_writer(object, aligned_offset_in_section,
+				   (aligned_offset_in_section
+				    + input_section_size));
+
   return aligned_offset_in_section;
 }
 
@@ -2609,7 +3049,7 @@ Output_section::add_output_section_data(Output_section_data* posd)
 	  // For incremental updates, find a chunk of unused space.
 	  offset_in_section = this->free_list_.allocate(posd->data_size(),
 							posd->addralign(), 0);
-	  if (offset_in_section == -1)
+	  if (offset_in_section == -1 || this->has_moved_fixed_layout())
 	    gold_fallback(_("out of patch space in section %s; "
 			    "relink with --incremental-full"),
 			  this->name());
@@ -2789,6 +3229,20 @@ Output_section::add_merge_input_section(Relobj* object, unsigned int shndx,
     }
 }
 
+// Queue tasks to process the contents of the merge sections.
+
+void
+Output_section::queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (Input_section_list::iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    {
+      if (p->is_merge_section())
+	p->output_merge_base()->queue_merge_tasks(workqueue, blocker);
+    }
+}
+
 // Build a relaxation map to speed up relaxation of existing input sections.
 // Look up to the first LIMIT elements in INPUT_SECTIONS.
 
@@ -2896,6 +3350,25 @@ Output_section::convert_input_sections_to_relaxed_sections(
       }
 }
 
+// Record that OBJECT writes the part of this section from START to
+// END when it is relocated.  An END of -1 means the whole section.
+
+void
+Output_section::add_input_section_writer(Relobj* object, off_t start,
+					 off_t end)
+{
+  if (!this->input_section_writers_.empty()
+      && this->input_section_writers_.back().object == object)
+    {
+      Input_section_writer& w(this->input_section_writers_.back());
+      w.start = std::min(w.start, start);
+      w.end = (w.end < 0 || end < 0) ? -1 : std::max(w.end, end);
+    }
+  else
+    this->input_section_writers_.push_back(Input_section_writer(object, start,
+								end));
+}
+
 // Update the output section flags based on input section flags.
 
 void
@@ -3136,6 +3609,27 @@ Output_section::find_starting_output_address(const Relobj* object,
   return false;
 }
 
+// Return the offset of POSD within this section.  We compute it the
+// same way as create_postprocessing_buffer, since the address of
+// POSD is not set if this section requires postprocessing.
+
+off_t
+Output_section::output_section_data_offset(
+    const Output_section_data* posd) const
+{
+  off_t off = this->first_input_offset_;
+  for (Input_section_list::const_iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    {
+      off = align_address(off, p->addralign());
+      if (!p->is_input_section() && p->output_section_data() == posd)
+	return off;
+      off += p->data_size();
+    }
+  gold_unreachable();
+}
+
 // Update the data size of an Output_section.
 
 void
@@ -3585,7 +4079,8 @@ Output_section::Input_section_sort_section_name_compare
 
 void
 Output_section::update_section_layout(
-  const Section_layout_order* order_map)
+  const Section_layout_order* order_map,
+  unsigned int unordered_index)
 {
   for (Input_section_list::iterator p = this->input_sections_.begin();
        p != this->input_sections_.end();
@@ -3600,9 +4095,9 @@ Output_section::update_section_layout(
 	  unsigned int shndx = p->shndx();
 	  Section_layout_order::const_iterator it
 	    = order_map->find(Section_id(obj, shndx));
-	  if (it == order_map->end())
-	    continue;
-	  unsigned int section_order_index = it->second;
+	  unsigned int section_order_index = (it == order_map->end()
+					      ? unordered_index
+					      : it->second);
 	  if (section_order_index != 0)
 	    {
 	      p->set_section_order_index(section_order_index);
@@ -4102,6 +4597,70 @@ Output_section::allocate(off_t len, uint64_t addralign)
   return this->free_list_.allocate(len, addralign, 0);
 }
 
+// Grow an unallocated section with a fixed layout which has run out
+// of free space, and allocate LEN bytes with alignment ADDRALIGN from
+// it.  The existing contents stay where they are in the section, so
+// the input sections from unchanged files keep their offsets, but the
+// section is given a new file offset by Layout::set_section_offsets.
+// As in a full incremental link, some patch space is added for later
+// updates.  Used for incremental update links.
+
+off_t
+Output_section::grow_fixed_layout(off_t len, uint64_t addralign)
+{
+  gold_assert(this->has_fixed_layout_
+	      && (this->flags_ & elfcpp::SHF_ALLOC) == 0
+	      && this->input_sections_.empty());
+
+  off_t old_size = this->current_data_size_for_child();
+  off_t new_size = align_address(old_size, addralign) + len;
+  double pct = parameters->options().incremental_patch();
+  off_t extra = static_cast<off_t>(new_size * pct);
+  if (this->free_space_fill_ != NULL)
+    {
+      off_t min_hole = this->free_space_fill_->minimum_hole_size();
+      if (min_hole > extra)
+	extra = min_hole;
+    }
+  new_size = align_address(new_size + extra, this->addralign_);
+
+  if (!this->has_moved_fixed_layout())
+    {
+      this->fixed_layout_base_offset_ = this->offset();
+      this->fixed_layout_base_size_ = old_size;
+      this->reset_address_and_file_offset();
+    }
+
+  gold_debug(DEBUG_INCREMENTAL,
+	     "grow_fixed_layout: %08lx -> %08lx: section %s",
+	     static_cast<long>(old_size), static_cast<long>(new_size),
+	     this->name());
+
+  this->set_current_data_size(new_size);
+  this->free_list_.extend(new_size);
+  return this->free_list_.allocate(len, addralign, 0);
+}
+
+// Copy the contents of a section moved by grow_fixed_layout from its
+// location in the base file.  This must be done before anything else
+// is written to the section.  The old location is not reused during
+// this link, so the copy does not overlap anything.
+
+void
+Output_section::copy_fixed_layout_from_base(Output_file* of)
+{
+  gold_assert(this->has_moved_fixed_layout());
+  off_t size = this->fixed_layout_base_size_;
+  if (size == 0)
+    return;
+  const unsigned char* old_view =
+    of->get_input_view(this->fixed_layout_base_offset_, size);
+  unsigned char* view = of->get_output_view(this->offset(), size);
+  memcpy(view, old_view, size);
+  of->write_output_view(this->offset(), size, view);
+  of->free_input_view(this->fixed_layout_base_offset_, size, old_view);
+}
+
 // Output segment methods.
 
 Output_segment::Output_segment(elfcpp::Elf_Word type, elfcpp::Elf_Word flags)
@@ -4985,7 +5544,10 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    chunk_size_(0),
+    chunk_writes_(),
+    chunk_lock_(NULL)
 {
 }
 
@@ -5288,6 +5850,43 @@ Output_file::unmap()
   this->base_ = NULL;
 }
 
+// Start counting writes to each chunk of the file.
+
+void
+Output_file::count_chunk_writes(size_t chunk_size)
+{
+  gold_assert(chunk_size > 0 && this->chunk_size_ == 0);
+  this->chunk_size_ = chunk_size;
+  this->chunk_writes_.resize((this->file_size_ + chunk_size - 1) / chunk_size);
+  this->chunk_lock_ = new Lock();
+}
+
+// Count a finished write to the chunks covering SIZE bytes at START.
+
+void
+Output_file::record_chunk_write(off_t start, size_t size)
+{
+  if (size == 0)
+    return;
+  size_t first = start / this->chunk_size_;
+  size_t last = (start + size - 1) / this->chunk_size_;
+  Hold_lock hl(*this->chunk_lock_);
+  last = std::min(last + 1, this->chunk_writes_.size());
+  for (size_t i = first; i < last; ++i)
+    ++this->chunk_writes_[i];
+}
+
+// Return the number of finished writes to the chunk at OFFSET.
+
+unsigned int
+Output_file::chunk_write_count(off_t offset)
+{
+  gold_assert(this->chunk_size_ != 0);
+  size_t i = offset / this->chunk_size_;
+  Hold_lock hl(*this->chunk_lock_);
+  return i < this->chunk_writes_.size() ? this->chunk_writes_[i] : 0;
+}
+
 // Close the output file.
 
 void
@@ -5322,6 +5921,14 @@ Output_file::close()
     if (::close(this->o_) < 0)
       gold_error(_("%s: close: %s"), this->name_, strerror(errno));
   this->o_ = -1;
+
+  if (this->chunk_lock_ != NULL)
+    {
+      delete this->chunk_lock_;
+      this->chunk_lock_ = NULL;
+      this->chunk_size_ = 0;
+      this->chunk_writes_.clear();
+    }
 }
 
 // Instantiate the templates we need.  We could use the configure
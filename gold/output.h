@@ -36,6 +36,7 @@ namespace gold
 {
 
 class General_options;
+class Lock;
 class Object;
 class Symbol;
 class Output_merge_base;
@@ -94,13 +95,30 @@ class Output_file
   filename()
   { return this->name_; }
 
+  // Start counting the writes to each CHUNK_SIZE byte chunk of the
+  // file.  This lets a caller which hashes chunks of the file while
+  // other tasks are still writing it find out afterward whether a
+  // chunk was written again.  This method is thread-unsafe.
+  void
+  count_chunk_writes(size_t chunk_size);
+
+  // Return the number of writes which have finished for the chunk
+  // starting at OFFSET.  Chunks past the size of the file when
+  // count_chunk_writes was called are not counted.
+  unsigned int
+  chunk_write_count(off_t offset);
+
   // We currently always use mmap which makes the view handling quite
   // simple.  In the future we may support other approaches.
 
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    memcpy(this->base_ + offset, data, len);
+    if (this->chunk_size_ != 0)
+      this->record_chunk_write(offset, len);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
   // the file and the size.
@@ -115,8 +133,11 @@ class Output_file
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t start, size_t size, unsigned char*)
+  {
+    if (this->chunk_size_ != 0)
+      this->record_chunk_write(start, size);
+  }
 
   // Get a read/write buffer.  This is used when we want to write part
   // of the file, read it in, and write it again.
@@ -126,8 +147,11 @@ class Output_file
 
   // Write a read/write buffer back to the file.
   void
-  write_input_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_input_output_view(off_t start, size_t size, unsigned char*)
+  {
+    if (this->chunk_size_ != 0)
+      this->record_chunk_write(start, size);
+  }
 
   // Get a read buffer.  This is used when we just want to read part
   // of the file back it in.
@@ -158,6 +182,10 @@ class Output_file
   void
   unmap();
 
+  // Count a finished write of SIZE bytes at START.
+  void
+  record_chunk_write(off_t start, size_t size);
+
   // File name.
   const char* name_;
   // File descriptor.
@@ -172,6 +200,13 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // Size of the chunks whose writes are counted, or 0 if we are not
+  // counting writes.
+  size_t chunk_size_;
+  // Number of finished writes for each chunk.
+  std::vector<unsigned int> chunk_writes_;
+  // Lock for chunk_writes_.
+  Lock* chunk_lock_;
 };
 
 // An abtract class for data which has to go into the output file.
@@ -1283,6 +1318,11 @@ class Output_reloc<elfcpp::SHT_REL, dynamic, size, big_endian>
   Address
   get_address() const;
 
+  // Return whether this is a RELATIVE reloc of type R_TYPE which may
+  // be packed into a .relr.dyn section.
+  bool
+  is_packable_relative(unsigned int r_type) const;
+
  private:
   // Record that we need a dynamic symbol index.
   void
@@ -1478,6 +1518,18 @@ class Output_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
   void
   write(unsigned char* pov) const;
 
+  // Return the output address.
+  Address
+  get_address() const
+  { return this->rel_.get_address(); }
+
+  // Return whether this is a RELATIVE reloc of type R_TYPE which may
+  // be packed into a .relr.dyn section.  The addend must be the value
+  // which the target writes into the section contents.
+  bool
+  is_packable_relative(unsigned int r_type) const
+  { return this->rel_.is_packable_relative(r_type); }
+
   // Return whether this reloc should be sorted before the argument
   // when sorting dynamic relocs.
   bool
@@ -1509,9 +1561,15 @@ class Output_data_reloc_generic : public Output_section_data_build
  public:
   Output_data_reloc_generic(int size, bool sort_relocs)
     : Output_section_data_build(Output_data::default_alignment_for_size(size)),
-      relative_reloc_count_(0), sort_relocs_(sort_relocs)
+      relative_reloc_count_(0), sort_relocs_(sort_relocs),
+      written_by_tasks_(false)
   { }
 
+  // The number of relocs sorted or written by each task queued by
+  // queue_write_tasks.  This does not depend on the number of threads,
+  // so that the output does not either.
+  static const size_t reloc_task_chunk_size = 0x10000;
+
   // Return the number of relative relocs in this section.
   size_t
   relative_reloc_count() const
@@ -1571,12 +1629,53 @@ class Output_data_reloc_generic : public Output_section_data_build
 			     unsigned int shndx, uint64_t address,
 			     uint64_t addend) = 0;
 
+  // Move the RELATIVE relocs of type R_TYPE which can be packed into
+  // a new .relr.dyn section, and return that section.  Return NULL if
+  // there are none.
+  virtual Output_section_data*
+  pack_relative_relocs(unsigned int r_type) = 0;
+
+  // Queue tasks to sort and write out the relocs in parallel, rather
+  // than doing it in do_write.  The tasks hold FINAL_BLOCKER until
+  // they are done.  This returns false if there are too few relocs to
+  // be worth it.
+  bool
+  queue_write_tasks(Workqueue*, Output_file*, Task_token* final_blocker);
+
+  // Return the number of relocs.
+  virtual size_t
+  reloc_count() const = 0;
+
+  // Sort the relocs from BEGIN to END.  If MIDDLE is not BEGIN, the
+  // relocs from BEGIN to MIDDLE and from MIDDLE to END are already
+  // sorted, and are merged.
+  virtual void
+  sort_reloc_range(size_t begin, size_t middle, size_t end) = 0;
+
+  // Write out the relocs from BEGIN to END.
+  virtual void
+  write_reloc_range(Output_file*, size_t begin, size_t end) = 0;
+
  protected:
   // Note that we've added another relative reloc.
   void
   bump_relative_reloc_count()
   { ++this->relative_reloc_count_; }
 
+  // Note that COUNT relative relocs have been moved elsewhere.
+  void
+  reduce_relative_reloc_count(size_t count)
+  {
+    gold_assert(count <= this->relative_reloc_count_);
+    this->relative_reloc_count_ -= count;
+  }
+
+  // Whether the relocs are written by the tasks queued by
+  // queue_write_tasks.
+  bool
+  written_by_tasks() const
+  { return this->written_by_tasks_; }
+
  private:
   // The number of relative relocs added to this section.  This is to
   // support DT_RELCOUNT.
@@ -1584,6 +1683,8 @@ class Output_data_reloc_generic : public Output_section_data_build
   // Whether to sort the relocations when writing them out, to make
   // the dynamic linker more efficient.
   bool sort_relocs_;
+  // Whether queue_write_tasks has queued tasks to write the relocs.
+  bool written_by_tasks_;
 };
 
 // Output_data_reloc is used to manage a section containing relocs.
@@ -1618,9 +1719,8 @@ class Output_data_reloc_base : public Output_data_reloc_generic
   void
   do_write_generic(Output_file* of)
   {
-    const off_t off = this->offset();
-    const off_t oview_size = this->data_size();
-    unsigned char* const oview = of->get_output_view(off, oview_size);
+    if (this->written_by_tasks())
+      return;
 
     if (this->sort_relocs())
       {
@@ -1629,21 +1729,34 @@ class Output_data_reloc_base : public Output_data_reloc_generic
 		  Sort_relocs_comparison());
       }
 
+    gold_assert(this->relocs_.size() * reloc_size
+		== static_cast<size_t>(this->data_size()));
+    this->template write_reloc_range_generic<Output_reloc_writer>(
+	of, 0, this->relocs_.size());
+
+    // We no longer need the relocation entries.
+    this->relocs_.clear();
+  }
+
+  // Generic implementation of write_reloc_range.
+  template<class Output_reloc_writer>
+  void
+  write_reloc_range_generic(Output_file* of, size_t begin, size_t end)
+  {
+    const off_t off = this->offset() + begin * reloc_size;
+    const off_t oview_size = (end - begin) * reloc_size;
+    unsigned char* const oview = of->get_output_view(off, oview_size);
+
     unsigned char* pov = oview;
-    for (typename Relocs::const_iterator p = this->relocs_.begin();
-	 p != this->relocs_.end();
+    for (typename Relocs::const_iterator p = this->relocs_.begin() + begin;
+	 p != this->relocs_.begin() + end;
 	 ++p)
       {
 	Output_reloc_writer::write(p, pov);
 	pov += reloc_size;
       }
 
-    gold_assert(pov - oview == oview_size);
-
     of->write_output_view(off, oview_size, oview);
-
-    // We no longer need the relocation entries.
-    this->relocs_.clear();
   }
 
   // Set the entry size and the link.
@@ -1660,6 +1773,23 @@ class Output_data_reloc_base : public Output_data_reloc_generic
 				: _("** relocs")));
   }
 
+  // Move the packable relative relocs to a .relr.dyn section.
+  Output_section_data*
+  pack_relative_relocs(unsigned int r_type);
+
+  // Return the number of relocs.
+  size_t
+  reloc_count() const
+  { return this->relocs_.size(); }
+
+  // Sort or merge a range of relocs.
+  void
+  sort_reloc_range(size_t begin, size_t middle, size_t end);
+
+  // Write out a range of relocs.
+  void
+  write_reloc_range(Output_file*, size_t begin, size_t end);
+
   // Add a relocation entry.
   void
   add(Output_data* od, const Output_reloc_type& reloc)
@@ -2344,6 +2474,61 @@ class Output_data_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
   }
 };
 
+// Output_data_relr holds the RELATIVE relocs which are packed into a
+// .relr.dyn section for -z pack-relative-relocs.  The section is a
+// list of words.  An even word is the address of a location to
+// relocate.  An odd word is a bitmap of the locations to relocate
+// among the next 8 * SIZE / 8 - 1 words, starting after the last
+// address.  The size depends on the addresses, so this section must
+// be laid out after the sections which it relocates.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+class Output_data_relr : public Output_section_data
+{
+ public:
+  typedef Output_reloc<sh_type, dynamic, size, big_endian> Output_reloc_type;
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  Output_data_relr()
+    : Output_section_data(Output_data::default_alignment_for_size(size)),
+      relocs_(), entries_()
+  { }
+
+  // Add a reloc.
+  void
+  add(const Output_reloc_type& reloc)
+  { this->relocs_.push_back(reloc); }
+
+  // Return the number of relocs.
+  size_t
+  reloc_count() const
+  { return this->relocs_.size(); }
+
+ protected:
+  // Encode the addresses of the relocs.
+  void
+  set_final_data_size();
+
+  // Write out the data.
+  void
+  do_write(Output_file*);
+
+  // Set the entry size.
+  void
+  do_adjust_output_section(Output_section* os);
+
+  // Write to a map file.
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** packed relative relocs")); }
+
+ private:
+  // The relocs.
+  std::vector<Output_reloc_type> relocs_;
+  // The encoded section contents.
+  std::vector<Address> entries_;
+};
+
 // Output_relocatable_relocs represents a relocation section in a
 // relocatable link.  The actual data is written out in the target
 // hook relocate_relocs.  This just saves space for it.
@@ -3297,8 +3482,12 @@ class Output_section : public Output_data
 
   typedef std::map<Section_id, unsigned int> Section_layout_order;
 
+  // Set the order index of each input section found in ORDER_MAP.
+  // Input sections which are not found are given UNORDERED_INDEX; 0
+  // leaves them in input order ahead of the others.
   void
-  update_section_layout(const Section_layout_order* order_map);
+  update_section_layout(const Section_layout_order* order_map,
+			unsigned int unordered_index);
 
   // Update the output section flags based on input section flags.
   void
@@ -3647,6 +3836,19 @@ class Output_section : public Output_data
   postprocessing_buffer_size() const
   { return this->current_data_size_for_child(); }
 
+  // Queue tasks to process the contents of the SHF_MERGE input
+  // sections whose processing was deferred.  Each chain of tasks holds
+  // a blocker on BLOCKER.
+  void
+  queue_merge_tasks(Workqueue* workqueue, Task_token* blocker);
+
+  // If a section requires postprocessing, queue any tasks which can
+  // postprocess the contents in parallel before the final data size
+  // is set.  Each task should hold a blocker on BLOCKER.
+  void
+  queue_postprocessing_tasks(Workqueue* workqueue, Task_token* blocker)
+  { this->do_queue_postprocessing_tasks(workqueue, blocker); }
+
   // Modify the section name.  This is only permitted for an
   // unallocated section, and only before the size has been finalized.
   // Otherwise the name will not get into Layout::namepool_.
@@ -3685,6 +3887,12 @@ class Output_section : public Output_data
   find_starting_output_address(const Relobj* object, unsigned int shndx,
 			       uint64_t* addr) const;
 
+  // Return the offset within this section of POSD, which was added by
+  // add_output_section_data.  This may be called once the data sizes
+  // are final, even if the section requires postprocessing.
+  off_t
+  output_section_data_offset(const Output_section_data* posd) const;
+
   // Record that this output section was found in the SECTIONS clause
   // of a linker script.
   void
@@ -4125,6 +4333,42 @@ class Output_section : public Output_data
   off_t
   allocate(off_t len, uint64_t addralign);
 
+  // Grow an unallocated section with a fixed layout which has run out
+  // of free space, and allocate LEN bytes from it.  The section is
+  // moved to a new file offset.  Used for incremental update links.
+  off_t
+  grow_fixed_layout(off_t len, uint64_t addralign);
+
+  // Return TRUE if the section was moved by grow_fixed_layout.
+  bool
+  has_moved_fixed_layout() const
+  { return this->fixed_layout_base_offset_ != -1; }
+
+  // Return the file offset of the section in the base file of an
+  // incremental update link.
+  off_t
+  fixed_layout_base_offset() const
+  {
+    return (this->has_moved_fixed_layout()
+	    ? this->fixed_layout_base_offset_
+	    : this->offset());
+  }
+
+  // Return the size of the section in the base file of an
+  // incremental update link.
+  off_t
+  fixed_layout_base_size() const
+  {
+    return (this->has_moved_fixed_layout()
+	    ? this->fixed_layout_base_size_
+	    : this->data_size());
+  }
+
+  // Copy the contents of a section moved by grow_fixed_layout from its
+  // location in the base file.
+  void
+  copy_fixed_layout_from_base(Output_file* of);
+
   typedef std::vector<Input_section> Input_section_list;
 
   // Allow access to the input sections.
@@ -4136,6 +4380,30 @@ class Output_section : public Output_data
   input_sections()
   { return this->input_sections_; }
 
+  // An object which writes part of this section when it is relocated.
+  // START and END are offsets within the section; an END of -1 means
+  // the whole section.  Consecutive input sections from the same
+  // object are recorded as a single writer.
+  struct Input_section_writer
+  {
+    Input_section_writer(Relobj* a_object, off_t a_start, off_t a_end)
+      : object(a_object), start(a_start), end(a_end)
+    { }
+
+    Relobj* object;
+    off_t start;
+    off_t end;
+  };
+
+  typedef std::vector<Input_section_writer> Input_section_writer_list;
+
+  // Return the objects which write this section.  This is only
+  // recorded for non-allocated sections when
+  // Layout::records_section_writers is true.
+  const Input_section_writer_list&
+  input_section_writers() const
+  { return this->input_section_writers_; }
+
   // For -r and --emit-relocs, we need to keep track of the associated
   // relocation section.
   Output_section*
@@ -4186,6 +4454,12 @@ class Output_section : public Output_data
   virtual void
   set_final_data_size();
 
+  // Queue tasks to postprocess the section contents.  By default
+  // there are none.
+  virtual void
+  do_queue_postprocessing_tasks(Workqueue*, Task_token*)
+  { }
+
   // Reset the address and file offset.
   void
   do_reset_address_and_file_offset();
@@ -4455,6 +4729,11 @@ class Output_section : public Output_data
   void
   add_output_section_data(Input_section*);
 
+  // Record that OBJECT writes the part of this section from START to
+  // END when it is relocated.
+  void
+  add_input_section_writer(Relobj* object, off_t start, off_t end);
+
   // Add an SHF_MERGE input section.  Returns true if the section was
   // handled.  If KEEPS_INPUT_SECTIONS is true, the output merge section
   // stores information about the merged input sections.
@@ -4541,6 +4820,8 @@ class Output_section : public Output_data
   // The input sections.  This will be empty in cases where we don't
   // need to keep track of them.
   Input_section_list input_sections_;
+  // The objects which write this section, if we are recording them.
+  Input_section_writer_list input_section_writers_;
   // The offset of the first entry in input_sections_.
   off_t first_input_offset_;
   // The fill data.  This is separate from input_sections_ because we
@@ -4633,6 +4914,10 @@ class Output_section : public Output_data
   Output_fill* free_space_fill_;
   // Amount added as patch space for incremental linking.
   off_t patch_space_;
+  // For a section moved by grow_fixed_layout, the file offset and
+  // size of the section in the base file; otherwise -1 and 0.
+  off_t fixed_layout_base_offset_;
+  off_t fixed_layout_base_size_;
   // Associated relocation section, when emitting relocations.
   Output_section* reloc_section_;
 };
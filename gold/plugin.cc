@@ -178,6 +178,9 @@ register_new_input(ld_plugin_new_input_handler handler);
 static enum ld_plugin_status
 get_wrap_symbols(uint64_t *num_symbols, const char ***wrap_symbol_list);
 
+static enum ld_plugin_status
+allow_concurrent_claim_file(void);
+
 };
 
 #endif // ENABLE_PLUGINS
@@ -223,7 +226,7 @@ Plugin::load()
   sscanf(ver, "%d.%d", &major, &minor);
 
   // Allocate and populate a transfer vector.
-  const int tv_fixed_size = 31;
+  const int tv_fixed_size = 32;
 
   int tv_size = this->args_.size() + tv_fixed_size;
   ld_plugin_tv* tv = new ld_plugin_tv[tv_size];
@@ -365,6 +368,10 @@ Plugin::load()
   tv[i].tv_tag = LDPT_GET_WRAP_SYMBOLS;
   tv[i].tv_u.tv_get_wrap_symbols = get_wrap_symbols;
 
+  ++i;
+  tv[i].tv_tag = LDPT_ALLOW_CONCURRENT_CLAIM_FILE;
+  tv[i].tv_u.tv_allow_concurrent_claim_file = allow_concurrent_claim_file;
+
   ++i;
   tv[i].tv_tag = LDPT_NULL;
   tv[i].tv_u.tv_val = 0;
@@ -697,6 +704,7 @@ Plugin_manager::~Plugin_manager()
     delete *obj;
   this->objects_.clear();
   delete this->lock_;
+  delete this->objects_lock_;
   delete this->recorder_;
 }
 
@@ -717,9 +725,60 @@ Plugin_manager::load_plugins(Layout* layout)
        this->current_ != this->plugins_.end();
        ++this->current_)
     (*this->current_)->load();
+
+  if (parameters->options().threads())
+    this->objects_lock_ = new Lock();
+}
+
+// Return whether the claim_file and new_input handlers of all the
+// plugins which will be called may be run by several threads at once.
+// Before the replacement phase only the claim_file handlers are
+// called; after it only the new_input handlers are.
+
+bool
+Plugin_manager::concurrent_claims_ok() const
+{
+  for (Plugin_list::const_iterator p = this->plugins_.begin();
+       p != this->plugins_.end();
+       ++p)
+    {
+      if ((*p)->concurrent_claim_file())
+	continue;
+      if (!this->in_replacement_phase_ || (*p)->has_new_input_handler())
+	return false;
+    }
+  return true;
+}
+
+// Return the file being claimed with handle HANDLE.  The caller must
+// hold objects_lock_.
+
+const Plugin_manager::Claim*
+Plugin_manager::find_claim(unsigned int handle) const
+{
+  Claim_map::const_iterator p = this->claims_.find(handle);
+  if (p == this->claims_.end())
+    return NULL;
+  return p->second;
+}
+
+// Return whether the claim_file handler of the plugins is being
+// called for the file with handle HANDLE.
+
+bool
+Plugin_manager::in_claim_file_handler(const void* handle)
+{
+  unsigned int h =
+    static_cast<unsigned int>(reinterpret_cast<intptr_t>(handle));
+  Hold_optional_lock hl(this->objects_lock_);
+  return this->find_claim(h) != NULL;
 }
 
 // Call the plugin claim-file handlers in turn to see if any claim the file.
+// If all the plugins allow it, this may be called by several
+// Read_symbols tasks at once; each call gets its own handle, and the
+// state of the claim is kept in a Claim on the stack so that the
+// plugin callbacks can find it from the handle.
 
 Pluginobj*
 Plugin_manager::claim_file(Input_file* input_file, off_t offset,
@@ -728,64 +787,74 @@ Plugin_manager::claim_file(Input_file* input_file, off_t offset,
   bool lock_initialized = this->initialize_lock_.initialize();
 
   gold_assert(lock_initialized);
-  Hold_lock hl(*this->lock_);
-
-  unsigned int handle = this->objects_.size();
-  this->input_file_ = input_file;
-  this->plugin_input_file_.name = input_file->filename().c_str();
-  this->plugin_input_file_.fd = input_file->file().descriptor();
-  this->plugin_input_file_.offset = offset;
-  this->plugin_input_file_.filesize = filesize;
-  this->plugin_input_file_.handle = reinterpret_cast<void*>(handle);
-  if (elf_object != NULL)
+  Hold_optional_lock hl(this->concurrent_claims_ok() ? NULL : this->lock_);
+
+  Claim claim;
+  claim.input_file = input_file;
+  claim.plugin_input_file.name = input_file->filename().c_str();
+  claim.plugin_input_file.fd = input_file->file().descriptor();
+  claim.plugin_input_file.offset = offset;
+  claim.plugin_input_file.filesize = filesize;
+
+  // Reserve a handle for the file.  The slot holds ELF_OBJECT, if
+  // any, until a plugin claims the file.
+  unsigned int handle;
+  {
+    Hold_optional_lock hol(this->objects_lock_);
+    handle = this->objects_.size();
     this->objects_.push_back(elf_object);
-  this->in_claim_file_handler_ = true;
+    this->claims_[handle] = &claim;
+  }
+  claim.plugin_input_file.handle = reinterpret_cast<void*>(handle);
 
-  for (this->current_ = this->plugins_.begin();
-       this->current_ != this->plugins_.end();
-       ++this->current_)
+  Pluginobj* ret = NULL;
+  for (Plugin_list::iterator p = this->plugins_.begin();
+       p != this->plugins_.end();
+       ++p)
     {
       // If we aren't yet in replacement phase, allow plugins to claim input
       // files, otherwise notify the plugin of the new input file, if needed.
       if (!this->in_replacement_phase_)
         {
-          if ((*this->current_)->claim_file(&this->plugin_input_file_))
+          if ((*p)->claim_file(&claim.plugin_input_file))
             {
-              this->any_claimed_ = true;
-              this->in_claim_file_handler_ = false;
-
-	      if (this->recorder_ != NULL)
-		{
-		  const std::string& objname = (elf_object == NULL
-						? input_file->filename()
-						: elf_object->name());
-		  this->recorder_->claimed_file(objname,
-						offset, filesize,
-						(*this->current_)->filename());
-		}
-
-              if (this->objects_.size() > handle
-                  && this->objects_[handle]->pluginobj() != NULL)
-                return this->objects_[handle]->pluginobj();
+	      {
+		Hold_optional_lock hol(this->objects_lock_);
+		this->any_claimed_ = true;
+		if (this->recorder_ != NULL)
+		  {
+		    const std::string& objname = (elf_object == NULL
+						  ? input_file->filename()
+						  : elf_object->name());
+		    this->recorder_->claimed_file(objname,
+						  offset, filesize,
+						  (*p)->filename());
+		  }
+		Object* obj = this->objects_[handle];
+		if (obj != NULL)
+		  ret = obj->pluginobj();
+	      }
 
               // If the plugin claimed the file but did not call the
               // add_symbols callback, we need to create the Pluginobj now.
-              Pluginobj* obj = this->make_plugin_object(handle);
-              return obj;
+              if (ret == NULL)
+                ret = this->make_plugin_object(handle);
+              break;
             }
         }
       else
         {
-          (*this->current_)->new_input(&this->plugin_input_file_);
+          (*p)->new_input(&claim.plugin_input_file);
         }
     }
 
-  this->in_claim_file_handler_ = false;
+  Hold_optional_lock hol(this->objects_lock_);
+  this->claims_.erase(handle);
 
-  if (this->recorder_ != NULL)
+  if (ret == NULL && this->recorder_ != NULL)
     this->recorder_->unclaimed_file(input_file->filename(), offset, filesize);
 
-  return NULL;
+  return ret;
 }
 
 // Save an archive.  This is used so that a plugin can add a file
@@ -796,7 +865,7 @@ Plugin_manager::claim_file(Input_file* input_file, off_t offset,
 void
 Plugin_manager::save_archive(Archive* archive)
 {
-  if (this->in_replacement_phase_ || !this->any_claimed_)
+  if (this->in_replacement_phase_ || !this->any_claimed())
     delete archive;
   else
     this->rescannable_.push_back(Rescannable(archive));
@@ -807,7 +876,7 @@ Plugin_manager::save_archive(Archive* archive)
 void
 Plugin_manager::save_input_group(Input_group* input_group)
 {
-  if (this->in_replacement_phase_ || !this->any_claimed_)
+  if (this->in_replacement_phase_ || !this->any_claimed())
     delete input_group;
   else
     this->rescannable_.push_back(Rescannable(input_group));
@@ -1026,30 +1095,31 @@ Plugin_manager::cleanup()
 Pluginobj*
 Plugin_manager::make_plugin_object(unsigned int handle)
 {
-  // Make sure we aren't asked to make an object for the same handle twice.
-  if (this->objects_.size() != handle
-      && this->objects_[handle]->pluginobj() != NULL)
-    return NULL;
-
-  const std::string* filename = &this->input_file_->filename();
+  Hold_optional_lock hl(this->objects_lock_);
 
-  // If the elf object for this file was pushed into the objects_ vector,
-  // use its filename, then delete it to make room for the Pluginobj as
-  // this file is claimed.
-  if (this->objects_.size() != handle)
-    {
-      filename = &this->objects_.back()->name();
-      this->objects_.pop_back();
-    }
+  // The add_symbols API may only be called for a file being claimed.
+  const Claim* claim = this->find_claim(handle);
+  if (claim == NULL)
+    return NULL;
 
-  Pluginobj* obj = make_sized_plugin_object(*filename,
-					    this->input_file_,
-                                            this->plugin_input_file_.offset,
-                                            this->plugin_input_file_.filesize);
+  // Make sure we aren't asked to make an object for the same handle twice.
+  Object* elf_object = this->objects_[handle];
+  if (elf_object != NULL && elf_object->pluginobj() != NULL)
+    return NULL;
 
+  // If the elf object for this file was stored in the objects_ vector,
+  // use its filename, then replace it with the Pluginobj as this file
+  // is claimed.
+  const std::string& filename = (elf_object != NULL
+				 ? elf_object->name()
+				 : claim->input_file->filename());
 
+  Pluginobj* obj = make_sized_plugin_object(filename,
+					    claim->input_file,
+                                            claim->plugin_input_file.offset,
+                                            claim->plugin_input_file.filesize);
 
-  this->objects_.push_back(obj);
+  this->objects_[handle] = obj;
   return obj;
 }
 
@@ -1110,18 +1180,22 @@ Plugin_manager::get_elf_object(const void* handle)
 ld_plugin_status
 Plugin_manager::get_view(unsigned int handle, const void **viewp)
 {
-  off_t offset;
-  size_t filesize;
-  Input_file *input_file;
-  if (this->in_claim_file_handler_)
-    {
-      // We are being called from the claim_file hook.
-      const struct ld_plugin_input_file &f = this->plugin_input_file_;
-      offset = f.offset;
-      filesize = f.filesize;
-      input_file = this->input_file_;
-    }
-  else
+  off_t offset = 0;
+  size_t filesize = 0;
+  Input_file *input_file = NULL;
+  {
+    Hold_optional_lock hl(this->objects_lock_);
+    const Claim* claim = this->find_claim(handle);
+    if (claim != NULL)
+      {
+	// We are being called from the claim_file hook.
+	const struct ld_plugin_input_file &f = claim->plugin_input_file;
+	offset = f.offset;
+	filesize = f.filesize;
+	input_file = claim->input_file;
+      }
+  }
+  if (input_file == NULL)
     {
       // An already claimed file.
       if (this->object(handle) == NULL)
@@ -1966,7 +2040,7 @@ get_input_section_count(const void* handle, unsigned int* count)
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(handle))
     return LDPS_ERR;
 
   Object* obj = parameters->options().plugins()->get_elf_object(handle);
@@ -1988,11 +2062,11 @@ get_input_section_type(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  Plugin_manager* plugins = parameters->options().plugins();
+  if (!plugins->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
-  Object* obj
-    = parameters->options().plugins()->get_elf_object(section.handle); 
+  Object* obj = plugins->get_elf_object(section.handle);
 
   if (obj == NULL)
     return LDPS_BAD_HANDLE;
@@ -2011,11 +2085,11 @@ get_input_section_name(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  Plugin_manager* plugins = parameters->options().plugins();
+  if (!plugins->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
-  Object* obj
-    = parameters->options().plugins()->get_elf_object(section.handle); 
+  Object* obj = plugins->get_elf_object(section.handle);
 
   if (obj == NULL)
     return LDPS_BAD_HANDLE;
@@ -2040,11 +2114,11 @@ get_input_section_contents(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  Plugin_manager* plugins = parameters->options().plugins();
+  if (!plugins->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
-  Object* obj
-    = parameters->options().plugins()->get_elf_object(section.handle); 
+  Object* obj = plugins->get_elf_object(section.handle);
 
   if (obj == NULL)
     return LDPS_BAD_HANDLE;
@@ -2069,11 +2143,11 @@ get_input_section_alignment(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  Plugin_manager* plugins = parameters->options().plugins();
+  if (!plugins->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
-  Object* obj
-    = parameters->options().plugins()->get_elf_object(section.handle);
+  Object* obj = plugins->get_elf_object(section.handle);
 
   if (obj == NULL)
     return LDPS_BAD_HANDLE;
@@ -2092,11 +2166,11 @@ get_input_section_size(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  Plugin_manager* plugins = parameters->options().plugins();
+  if (!plugins->in_claim_file_handler(section.handle))
     return LDPS_ERR;
 
-  Object* obj
-    = parameters->options().plugins()->get_elf_object(section.handle);
+  Object* obj = plugins->get_elf_object(section.handle);
 
   if (obj == NULL)
     return LDPS_BAD_HANDLE;
@@ -2105,6 +2179,16 @@ get_input_section_size(const struct ld_plugin_section section,
   return LDPS_OK;
 }
 
+// Declare that the claim_file and new_input handlers of the plugin
+// being loaded may be called by several threads at once.
+
+static enum ld_plugin_status
+allow_concurrent_claim_file(void)
+{
+  gold_assert(parameters->options().has_plugins());
+  return parameters->options().plugins()->set_concurrent_claim_file();
+}
+
 static enum ld_plugin_status
 get_wrap_symbols(uint64_t *count, const char ***wrap_symbols)
 {
@@ -62,7 +62,8 @@ class Plugin
       all_symbols_read_handler_(NULL),
       cleanup_handler_(NULL),
       new_input_handler_(NULL),
-      cleanup_done_(false)
+      cleanup_done_(false),
+      concurrent_claim_file_(false)
   { }
 
   ~Plugin()
@@ -108,6 +109,23 @@ class Plugin
   set_new_input_handler(ld_plugin_new_input_handler handler)
   { this->new_input_handler_ = handler; }
 
+  // Return whether the plugin has a new_input handler.
+  bool
+  has_new_input_handler() const
+  { return this->new_input_handler_ != NULL; }
+
+  // Record that the claim_file and new_input handlers may be called
+  // from several threads at once.
+  void
+  set_concurrent_claim_file()
+  { this->concurrent_claim_file_ = true; }
+
+  // Return whether the claim_file and new_input handlers may be
+  // called from several threads at once.
+  bool
+  concurrent_claim_file() const
+  { return this->concurrent_claim_file_; }
+
   // Add an argument
   void
   add_option(const char* arg)
@@ -136,6 +154,8 @@ class Plugin
   ld_plugin_new_input_handler new_input_handler_;
   // TRUE if the cleanup handlers have been called.
   bool cleanup_done_;
+  // TRUE if the plugin called allow_concurrent_claim_file.
+  bool concurrent_claim_file_;
 };
 
 // A manager class for plugins.
@@ -144,14 +164,13 @@ class Plugin_manager
 {
  public:
   Plugin_manager(const General_options& options)
-    : plugins_(), objects_(), deferred_layout_objects_(), input_file_(NULL),
-      plugin_input_file_(), rescannable_(), undefined_symbols_(),
+    : plugins_(), objects_(), deferred_layout_objects_(), claims_(),
+      rescannable_(), undefined_symbols_(),
       any_claimed_(false), in_replacement_phase_(false), any_added_(false),
-      in_claim_file_handler_(false),
       options_(options), workqueue_(NULL), task_(NULL), input_objects_(NULL),
       symtab_(NULL), layout_(NULL), dirpath_(NULL), mapfile_(NULL),
       this_blocker_(NULL), extra_search_path_(), lock_(NULL),
-      initialize_lock_(&lock_), defsym_defines_set_(),
+      initialize_lock_(&lock_), objects_lock_(NULL), defsym_defines_set_(),
       recorder_(NULL)
   { this->current_ = plugins_.end(); }
 
@@ -191,10 +210,10 @@ class Plugin_manager
   Object*
   get_elf_object(const void* handle);
 
-  // True if the claim_file handler of the plugins is being called.
+  // True if the claim_file handler of the plugins is being called for
+  // the file with handle HANDLE.
   bool
-  in_claim_file_handler()
-  { return in_claim_file_handler_; }
+  in_claim_file_handler(const void* handle);
 
   // Let the plugin manager save an archive for later rescanning.
   // This takes ownership of the Archive pointer.
@@ -258,6 +277,18 @@ class Plugin_manager
     (*this->current_)->set_cleanup_handler(handler);
   }
 
+  // Record that the claim_file and new_input handlers of the current
+  // plugin may be called from several threads at once.  This is only
+  // valid while loading the plugin.
+  ld_plugin_status
+  set_concurrent_claim_file()
+  {
+    if (this->current_ == plugins_.end())
+      return LDPS_ERR;
+    (*this->current_)->set_concurrent_claim_file();
+    return LDPS_OK;
+  }
+
   // Make a new Pluginobj object.  This is called when the plugin calls
   // the add_symbols API.
   Pluginobj*
@@ -267,6 +298,7 @@ class Plugin_manager
   Object*
   object(unsigned int handle) const
   {
+    Hold_optional_lock hl(this->objects_lock_);
     if (handle >= this->objects_.size())
       return NULL;
     return this->objects_[handle];
@@ -276,7 +308,7 @@ class Plugin_manager
   // and we are still in the initial input phase.
   bool
   should_defer_layout() const
-  { return this->any_claimed_ && !this->in_replacement_phase_; }
+  { return this->any_claimed() && !this->in_replacement_phase_; }
 
   // Add a regular object to the deferred layout list.  These are
   // objects whose layout has been deferred until after the
@@ -327,6 +359,15 @@ class Plugin_manager
   { return this->recorder_; }
 
  private:
+  // Return whether any input files have been claimed.  Files may be
+  // claimed by several threads at once.
+  bool
+  any_claimed() const
+  {
+    Hold_optional_lock hl(this->objects_lock_);
+    return this->any_claimed_;
+  }
+
   Plugin_manager(const Plugin_manager&);
   Plugin_manager& operator=(const Plugin_manager&);
 
@@ -353,8 +394,16 @@ class Plugin_manager
     { this->u.input_group = input_group; }
   };
 
+  // A file being offered to the plugins by claim_file.
+  struct Claim
+  {
+    Input_file* input_file;
+    struct ld_plugin_input_file plugin_input_file;
+  };
+
   typedef std::list<Plugin*> Plugin_list;
   typedef std::vector<Object*> Object_list;
+  typedef Unordered_map<unsigned int, const Claim*> Claim_map;
   typedef std::vector<Relobj*> Deferred_layout_list;
   typedef std::vector<Rescannable> Rescannable_list;
   typedef std::vector<Symbol*> Undefined_symbol_list;
@@ -367,6 +416,17 @@ class Plugin_manager
   bool
   rescannable_defines(size_t i, Symbol* sym);
 
+  // Return the file being claimed with handle HANDLE, or NULL if
+  // there is none.
+  const Claim*
+  find_claim(unsigned int handle) const;
+
+  // Return whether the claim_file and new_input handlers of all the
+  // plugins which will be called may be run by several threads at
+  // once.
+  bool
+  concurrent_claims_ok() const;
+
   // The list of plugin libraries.
   Plugin_list plugins_;
   // A pointer to the current plugin.  Used while loading plugins.
@@ -379,9 +439,10 @@ class Plugin_manager
   // The list of regular objects whose layout has been deferred.
   Deferred_layout_list deferred_layout_objects_;
 
-  // The file currently up for claim by the plugins.
-  Input_file* input_file_;
-  struct ld_plugin_input_file plugin_input_file_;
+  // The files currently up for claim by the plugins, indexed by
+  // handle.  There may be more than one if the plugins allow
+  // concurrent claims.
+  Claim_map claims_;
 
   // A list of archives and input groups being saved for possible
   // later rescanning.
@@ -401,9 +462,6 @@ class Plugin_manager
   // Whether any input files or libraries were added by a plugin.
   bool any_added_;
 
-  // Set to true when the claim_file handler of a plugin is called.
-  bool in_claim_file_handler_;
-
   const General_options& options_;
   Workqueue* workqueue_;
   Task* task_;
@@ -417,8 +475,13 @@ class Plugin_manager
   // An extra directory to search for the libraries passed by
   // add_input_library.
   std::string extra_search_path_;
+  // Serializes calls to the claim_file and new_input handlers of
+  // plugins which do not allow concurrent claims.
   Lock* lock_;
   Initialize_lock initialize_lock_;
+  // Controls access to objects_, claims_, any_claimed_ and recorder_
+  // while files are being claimed.
+  Lock* objects_lock_;
 
   // Keep track of all symbols defined by defsym.
   typedef Unordered_set<std::string> Defsym_defines_set;
@@ -400,6 +400,15 @@ Read_symbols::do_read_symbols(Workqueue* workqueue)
       Read_symbols_data* sd = new Read_symbols_data;
       elf_obj->read_symbols(sd);
 
+      // When running multi-threaded, do as much of the work of adding
+      // the symbols as we can here, since the Add_symbols tasks must
+      // run one at a time.
+      if (parameters->options().threads())
+	{
+	  elf_obj->prepare_symbols(this->symtab_, sd);
+	  elf_obj->prepare_eh_frame(sd);
+	}
+
       // Opening the file locked it, so now we need to unlock it.  We
       // need to unlock it before queuing the Add_symbols task,
       // because the workqueue doesn't know about our lock on the
@@ -35,6 +35,7 @@
 #include "icf.h"
 #include "compressed_output.h"
 #include "incremental.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -217,14 +218,16 @@ Relocate_task::is_runnable()
 }
 
 // We want to lock the file while we run.  We want to unblock
-// INPUT_SECTIONS_BLOCKER and FINAL_BLOCKER when we are done.
-// INPUT_SECTIONS_BLOCKER may be NULL.
+// INPUT_SECTIONS_BLOCKER, BUILD_ID_BLOCKER and FINAL_BLOCKER when we
+// are done.  INPUT_SECTIONS_BLOCKER and BUILD_ID_BLOCKER may be NULL.
 
 void
 Relocate_task::locks(Task_locker* tl)
 {
   if (this->input_sections_blocker_ != NULL)
     tl->add(this, this->input_sections_blocker_);
+  if (this->build_id_blocker_ != NULL)
+    tl->add(this, this->build_id_blocker_);
   tl->add(this, this->final_blocker_);
   Task_token* token = this->object_->token();
   if (token != NULL)
@@ -236,12 +239,20 @@ Relocate_task::locks(Task_locker* tl)
 void
 Relocate_task::run(Workqueue*)
 {
+  uint64_t start_usec = 0;
+  if (parameters->options().stats())
+    start_usec = Timer::wall_time_usec();
+
   this->object_->relocate(this->symtab_, this->layout_, this->of_);
 
   // This is normally the last thing we will do with an object, so
   // uncache all views.
   this->object_->clear_view_cache_marks();
 
+  if (parameters->options().stats())
+    Relocate_task::record_time(this->object_, start_usec,
+			       Timer::wall_time_usec());
+
   this->object_->release();
 }
 
@@ -253,6 +264,106 @@ Relocate_task::get_name() const
   return "Relocate_task " + this->object_->name();
 }
 
+// A lock for the Relocate_task statistics.
+static Lock* relocate_stats_lock = NULL;
+static Initialize_lock relocate_stats_initialize_lock(&relocate_stats_lock);
+
+// The Relocate_task statistics.
+unsigned int Relocate_task::total_tasks;
+unsigned int Relocate_task::split_objects;
+unsigned int Relocate_task::split_pieces;
+uint64_t Relocate_task::total_usec;
+uint64_t Relocate_task::first_start_usec;
+uint64_t Relocate_task::last_start_usec;
+uint64_t Relocate_task::last_end_usec;
+uint64_t Relocate_task::next_to_last_end_usec;
+uint64_t Relocate_task::longest_usec;
+std::string Relocate_task::longest_name;
+
+// Record the time taken to relocate an object.
+
+void
+Relocate_task::record_time(const Relobj* object, uint64_t start_usec,
+			   uint64_t end_usec)
+{
+  relocate_stats_initialize_lock.initialize();
+  Hold_optional_lock hl(relocate_stats_lock);
+
+  uint64_t usec = end_usec - start_usec;
+  if (Relocate_task::total_tasks == 0
+      || start_usec < Relocate_task::first_start_usec)
+    Relocate_task::first_start_usec = start_usec;
+  ++Relocate_task::total_tasks;
+  Relocate_task::total_usec += usec;
+
+  if (end_usec >= Relocate_task::last_end_usec)
+    {
+      Relocate_task::next_to_last_end_usec = Relocate_task::last_end_usec;
+      Relocate_task::last_start_usec = start_usec;
+      Relocate_task::last_end_usec = end_usec;
+    }
+  else if (end_usec > Relocate_task::next_to_last_end_usec)
+    Relocate_task::next_to_last_end_usec = end_usec;
+
+  if (usec >= Relocate_task::longest_usec)
+    {
+      Relocate_task::longest_usec = usec;
+      Relocate_task::longest_name = object->name();
+    }
+}
+
+// Record that an object's relocations were split into pieces.
+
+void
+Relocate_task::record_split(unsigned int pieces)
+{
+  if (!parameters->options().stats())
+    return;
+
+  relocate_stats_initialize_lock.initialize();
+  Hold_optional_lock hl(relocate_stats_lock);
+  ++Relocate_task::split_objects;
+  Relocate_task::split_pieces += pieces;
+}
+
+// Print the relocation statistics.  The tail is the time at the end
+// of the pass when the last task was running on its own.
+
+void
+Relocate_task::print_stats()
+{
+  if (Relocate_task::total_tasks == 0)
+    return;
+
+  uint64_t pass_usec = (Relocate_task::last_end_usec
+			- Relocate_task::first_start_usec);
+  uint64_t tail_usec = (Relocate_task::last_end_usec
+			- std::max(Relocate_task::next_to_last_end_usec,
+				   Relocate_task::last_start_usec));
+
+  fprintf(stderr, _("%s: relocate tasks: %u; split objects: %u; "
+		    "pieces: %u\n"),
+	  program_name, Relocate_task::total_tasks,
+	  Relocate_task::split_objects, Relocate_task::split_pieces);
+  fprintf(stderr, _("%s: relocate task time: %llu.%06llu; "
+		    "relocate pass time: %llu.%06llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(Relocate_task::total_usec / 1000000),
+	  static_cast<unsigned long long>(Relocate_task::total_usec % 1000000),
+	  static_cast<unsigned long long>(pass_usec / 1000000),
+	  static_cast<unsigned long long>(pass_usec % 1000000));
+  const uint64_t longest_usec = Relocate_task::longest_usec;
+  fprintf(stderr, _("%s: longest relocate task: %llu.%06llu (%s)\n"),
+	  program_name,
+	  static_cast<unsigned long long>(longest_usec / 1000000),
+	  static_cast<unsigned long long>(longest_usec % 1000000),
+	  Relocate_task::longest_name.c_str());
+  fprintf(stderr, _("%s: relocate pass tail time: %llu.%06llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(tail_usec / 1000000),
+	  static_cast<unsigned long long>(tail_usec % 1000000));
+}
+
 // Read the relocs and local symbols from the object file and store
 // the information in RD.
 
@@ -871,8 +982,8 @@ Sized_relobj_file<size, big_endian>::do_relocate_sections(
     Output_file* of,
     Views* pviews)
 {
-  this->relocate_section_range(symtab, layout, pshdrs, of, pviews,
-			       1, this->shnum() - 1);
+  this->relocate_section_range_in_pieces(symtab, layout, pshdrs, of, pviews,
+					 1, this->shnum() - 1);
 }
 
 // Relocate section data for the range of sections START_SHNDX through
@@ -1024,6 +1135,150 @@ Sized_relobj_file<size, big_endian>::relocate_section_range(
     }
 }
 
+// An object's relocations are only split into pieces if its reloc
+// sections hold at least this many bytes, and each piece gets at
+// least this many bytes.
+
+static const off_t relocate_split_min_bytes = 1024 * 1024;
+static const off_t relocate_piece_min_bytes = 128 * 1024;
+
+// The job used by relocate_section_range_in_pieces.  Piece I
+// relocates sections STARTS[I] through ENDS[I].  The section headers
+// and views were set up by the caller and are only read here; each
+// piece writes to the views of different sections.
+
+template<int size, bool big_endian>
+class Sized_relobj_file<size, big_endian>::Relocate_range_job
+  : public Parallel_job
+{
+ public:
+  Relocate_range_job(Sized_relobj_file<size, big_endian>* object,
+		     const Symbol_table* symtab, const Layout* layout,
+		     const unsigned char* pshdrs, Output_file* of,
+		     Views* pviews, const std::vector<unsigned int>& starts,
+		     const std::vector<unsigned int>& ends)
+    : object_(object), symtab_(symtab), layout_(layout), pshdrs_(pshdrs),
+      of_(of), pviews_(pviews), starts_(starts), ends_(ends)
+  { }
+
+  void
+  run_piece(unsigned int index)
+  {
+    this->object_->relocate_section_range(this->symtab_, this->layout_,
+					  this->pshdrs_, this->of_,
+					  this->pviews_, this->starts_[index],
+					  this->ends_[index]);
+  }
+
+ private:
+  Sized_relobj_file<size, big_endian>* object_;
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+  const unsigned char* pshdrs_;
+  Output_file* of_;
+  Views* pviews_;
+  const std::vector<unsigned int>& starts_;
+  const std::vector<unsigned int>& ends_;
+};
+
+// Relocate section data for the range of sections START_SHNDX
+// through END_SHNDX, splitting the work with any idle workqueue
+// threads if this is a large object.  One huge object would otherwise
+// keep a single thread busy at the end of the relocation pass while
+// the other threads have nothing to do.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::relocate_section_range_in_pieces(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const unsigned char* pshdrs,
+    Output_file* of,
+    Views* pviews,
+    unsigned int start_shndx,
+    unsigned int end_shndx)
+{
+  // Incremental links write the relocs for all sections to a shared
+  // view as they go, and relocatable links are rarely large enough
+  // to matter.
+  unsigned int thread_count = Parallel_job::thread_count();
+  if (thread_count <= 1
+      || end_shndx <= start_shndx
+      || parameters->options().relocatable()
+      || parameters->incremental())
+    {
+      this->relocate_section_range(symtab, layout, pshdrs, of, pviews,
+				   start_shndx, end_shndx);
+      return;
+    }
+
+  off_t total_bytes = 0;
+  const unsigned char* p = pshdrs + start_shndx * This::shdr_size;
+  for (unsigned int i = start_shndx; i <= end_shndx; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if (sh_type == elfcpp::SHT_REL || sh_type == elfcpp::SHT_RELA)
+	total_bytes += shdr.get_sh_size();
+    }
+
+  if (total_bytes < relocate_split_min_bytes)
+    {
+      this->relocate_section_range(symtab, layout, pshdrs, of, pviews,
+				   start_shndx, end_shndx);
+      return;
+    }
+
+  // Make a few pieces per thread, so that a piece with a single
+  // large reloc section does not leave the other threads idle.  The
+  // pieces run as workqueue tasks, so this never uses more threads
+  // than --thread-count-final allows.
+  off_t piece_bytes = std::max(total_bytes / (thread_count * 4),
+			       relocate_piece_min_bytes);
+  std::vector<unsigned int> starts;
+  std::vector<unsigned int> ends;
+  off_t bytes = 0;
+  unsigned int piece_start = start_shndx;
+  p = pshdrs + start_shndx * This::shdr_size;
+  for (unsigned int i = start_shndx; i <= end_shndx; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if (sh_type == elfcpp::SHT_REL || sh_type == elfcpp::SHT_RELA)
+	bytes += shdr.get_sh_size();
+      if (bytes >= piece_bytes || i == end_shndx)
+	{
+	  starts.push_back(piece_start);
+	  ends.push_back(i);
+	  piece_start = i + 1;
+	  bytes = 0;
+	}
+    }
+
+  if (starts.size() == 1)
+    {
+      this->relocate_section_range(symtab, layout, pshdrs, of, pviews,
+				   start_shndx, end_shndx);
+      return;
+    }
+
+  // Lookups in the merge maps sort them on first use, and the pieces
+  // share the File_read of this object, so both need to be made safe
+  // for several threads first.
+  this->sort_merge_mappings();
+  Lock view_lock;
+  File_read& file(this->input_file()->file());
+  file.set_view_lock(&view_lock);
+
+  Relocate_range_job job(this, symtab, layout, pshdrs, of, pviews,
+			 starts, ends);
+  job.run(starts.size());
+
+  file.set_view_lock(NULL);
+
+  Relocate_task::record_split(starts.size());
+}
+
 // Return the output view for section SHNDX.
 
 template<int size, bool big_endian>
@@ -1608,6 +1863,30 @@ Track_relocs<size, big_endian>::advance(off_t offset)
   return ret;
 }
 
+// Move to the first reloc whose r_offset is greater than or equal to
+// OFFSET, using a binary search.
+
+template<int size, bool big_endian>
+void
+Track_relocs<size, big_endian>::seek(off_t offset)
+{
+  if (this->len_ == 0)
+    return;
+  section_size_type lo = 0;
+  section_size_type hi = this->len_ / this->reloc_size_;
+  while (lo < hi)
+    {
+      section_size_type mid = lo + (hi - lo) / 2;
+      elfcpp::Rel<size, big_endian> rel(this->prelocs_
+					+ mid * this->reloc_size_);
+      if (static_cast<off_t>(rel.get_r_offset()) < offset)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  this->pos_ = lo * this->reloc_size_;
+}
+
 // Instantiate the templates we need.
 
 #ifdef HAVE_TARGET_32_LITTLE
@@ -1750,6 +2029,16 @@ Sized_relobj_file<32, false>::relocate_section_range(
     Views* pviews,
     unsigned int start_shndx,
     unsigned int end_shndx);
+template
+void
+Sized_relobj_file<32, false>::relocate_section_range_in_pieces(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const unsigned char* pshdrs,
+    Output_file* of,
+    Views* pviews,
+    unsigned int start_shndx,
+    unsigned int end_shndx);
 
 template
 unsigned char*
@@ -1778,6 +2067,16 @@ Sized_relobj_file<32, true>::relocate_section_range(
     Views* pviews,
     unsigned int start_shndx,
     unsigned int end_shndx);
+template
+void
+Sized_relobj_file<32, true>::relocate_section_range_in_pieces(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const unsigned char* pshdrs,
+    Output_file* of,
+    Views* pviews,
+    unsigned int start_shndx,
+    unsigned int end_shndx);
 
 template
 unsigned char*
@@ -1806,6 +2105,16 @@ Sized_relobj_file<64, false>::relocate_section_range(
     Views* pviews,
     unsigned int start_shndx,
     unsigned int end_shndx);
+template
+void
+Sized_relobj_file<64, false>::relocate_section_range_in_pieces(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const unsigned char* pshdrs,
+    Output_file* of,
+    Views* pviews,
+    unsigned int start_shndx,
+    unsigned int end_shndx);
 
 template
 unsigned char*
@@ -1834,6 +2143,16 @@ Sized_relobj_file<64, true>::relocate_section_range(
     Views* pviews,
     unsigned int start_shndx,
     unsigned int end_shndx);
+template
+void
+Sized_relobj_file<64, true>::relocate_section_range_in_pieces(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const unsigned char* pshdrs,
+    Output_file* of,
+    Views* pviews,
+    unsigned int start_shndx,
+    unsigned int end_shndx);
 
 template
 unsigned char*
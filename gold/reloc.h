@@ -183,11 +183,12 @@ class Relocate_task : public Task
   Relocate_task(const Symbol_table* symtab, const Layout* layout,
 		Relobj* object, Output_file* of,
 		Task_token* input_sections_blocker,
-		Task_token* output_sections_blocker, Task_token* final_blocker)
+		Task_token* output_sections_blocker, Task_token* final_blocker,
+		Task_token* build_id_blocker)
     : symtab_(symtab), layout_(layout), object_(object), of_(of),
       input_sections_blocker_(input_sections_blocker),
       output_sections_blocker_(output_sections_blocker),
-      final_blocker_(final_blocker)
+      final_blocker_(final_blocker), build_id_blocker_(build_id_blocker)
   { }
 
   // The standard Task methods.
@@ -204,7 +205,40 @@ class Relocate_task : public Task
   std::string
   get_name() const;
 
+  // Record that an object's relocations were split into PIECES
+  // pieces run by several threads.
+  static void
+  record_split(unsigned int pieces);
+
+  // Print statistics about the relocation pass to stderr.
+  static void
+  print_stats();
+
  private:
+  // Record the wall time taken to relocate OBJECT, for --stats.
+  static void
+  record_time(const Relobj* object, uint64_t start_usec, uint64_t end_usec);
+
+  // Statistics, only gathered with --stats.
+  // The number of tasks which have run.
+  static unsigned int total_tasks;
+  // The number of objects whose relocations were split into pieces.
+  static unsigned int split_objects;
+  // The total number of pieces for those objects.
+  static unsigned int split_pieces;
+  // The sum of the wall times of all the tasks.
+  static uint64_t total_usec;
+  // When the first task started.
+  static uint64_t first_start_usec;
+  // When the last task to finish started, when it finished, and when
+  // the one before it finished.
+  static uint64_t last_start_usec;
+  static uint64_t last_end_usec;
+  static uint64_t next_to_last_end_usec;
+  // The wall time of the slowest task, and the object it relocated.
+  static uint64_t longest_usec;
+  static std::string longest_name;
+
   const Symbol_table* symtab_;
   const Layout* layout_;
   Relobj* object_;
@@ -212,6 +246,9 @@ class Relocate_task : public Task
   Task_token* input_sections_blocker_;
   Task_token* output_sections_blocker_;
   Task_token* final_blocker_;
+  // Unblocked for the chunks of a build ID which this object writes;
+  // may be NULL.
+  Task_token* build_id_blocker_;
 };
 
 // During a relocatable link, this class records how relocations
@@ -1175,6 +1212,12 @@ class Track_relocs
   int
   advance(off_t offset);
 
+  // Move to the first reloc which applies at or after OFFSET within
+  // the data section, in either direction.  This assumes that the
+  // relocs are sorted by offset.
+  void
+  seek(off_t offset);
+
   // Checkpoint the current position in the reloc section.
   section_size_type
   checkpoint() const
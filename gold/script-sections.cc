@@ -635,6 +635,12 @@ class Sections_element
 		      Script_sections::Section_type*, bool*, bool)
   { return NULL; }
 
+  // Add the input section specs to INDEX.  The only real
+  // implementation is in Output_section_definition.
+  virtual void
+  index_input_sections(Input_section_index*)
+  { }
+
   // Initialize OSP with an output section.
   virtual void
   orphan_section_init(Orphan_section_placement*,
@@ -853,6 +859,12 @@ class Output_section_element
   match_name(const char*, const char*, bool *) const
   { return false; }
 
+  // Add this element to INDEX as part of the output section POSD.
+  // The only real implementation is in Output_section_element_input.
+  virtual void
+  index_input_sections(Input_section_index*, Output_section_definition*)
+  { }
+
   // Set section addresses.  This includes applying assignments if the
   // expression is an absolute value.
   virtual void
@@ -1293,6 +1305,11 @@ class Output_section_element_input : public Output_section_element
   bool
   match_name(const char* file_name, const char* section_name, bool* keep) const;
 
+  // Add this input section spec to INDEX.
+  void
+  index_input_sections(Input_section_index* index,
+		       Output_section_definition* posd);
+
   // Set the section address.
   void
   set_section_addresses(Symbol_table* symtab, Layout* layout, Output_section*,
@@ -1474,6 +1491,232 @@ Output_section_element_input::match_name(const char* file_name,
   return false;
 }
 
+// An index of the input section specs in a SECTIONS clause, used to
+// find the first spec which matches an input section without trying
+// every spec in turn.  The specs are numbered in script order.  Each
+// is filed under every literal section name pattern it has, under
+// the prefix of every pattern which is a literal string followed by
+// a single '*', and otherwise on a general list.  Within each of
+// those, specs with a literal file name pattern are filed by that
+// name.  Looking up an input section finds the candidate specs in
+// order, and checks each with match_name until one matches, so the
+// result is the same as checking every spec.
+
+class Input_section_index
+{
+ public:
+  Input_section_index()
+    : specs_(), names_(), prefixes_(), others_()
+  { }
+
+  // Start adding the spec ELEMENT, which is in the output section
+  // POSD.
+  void
+  add_spec(const Output_section_element_input* element,
+	   Output_section_definition* posd)
+  { this->specs_.push_back(Spec(element, posd)); }
+
+  // File the spec being added, whose file name pattern is
+  // FILE_PATTERN, under SECTION_PATTERN.  SECTION_PATTERN is NULL if
+  // the spec matches all section names.
+  void
+  add_pattern(const std::string& file_pattern, bool file_is_wildcard,
+	      const char* section_pattern, bool section_is_wildcard);
+
+  // Return the output section of the first spec which matches
+  // FILE_NAME and SECTION_NAME, and set *KEEP from that spec.  Return
+  // NULL if no spec matches.
+  Output_section_definition*
+  find(const char* file_name, const char* section_name, bool* keep) const;
+
+ private:
+  struct Spec
+  {
+    Spec(const Output_section_element_input* elementa,
+	 Output_section_definition* posda)
+      : element(elementa), posd(posda)
+    { }
+
+    const Output_section_element_input* element;
+    Output_section_definition* posd;
+  };
+
+  // A list of spec numbers in increasing order.
+  typedef std::vector<unsigned int> Spec_list;
+
+  // The specs filed under one section name key.
+  struct Bucket
+  {
+    // Specs with a literal file name pattern, by that name.
+    Unordered_map<std::string, Spec_list> by_file;
+    // Specs whose file name pattern is empty or a wildcard.
+    Spec_list any_file;
+  };
+
+  typedef Unordered_map<std::string, Bucket> Buckets;
+
+  static void
+  add_to_list(Spec_list* list, unsigned int spec)
+  {
+    if (list->empty() || list->back() != spec)
+      list->push_back(spec);
+  }
+
+  static void
+  add_to_bucket(Bucket* bucket, const std::string& file_pattern,
+		bool file_is_wildcard, unsigned int spec)
+  {
+    if (file_pattern.empty() || file_is_wildcard)
+      add_to_list(&bucket->any_file, spec);
+    else
+      add_to_list(&bucket->by_file[file_pattern], spec);
+  }
+
+  void
+  find_in_list(const Spec_list&, const char* file_name,
+	       const char* section_name, unsigned int* best, bool* keep) const;
+
+  void
+  find_in_bucket(const Bucket&, const char* file_name,
+		 const char* section_name, unsigned int* best,
+		 bool* keep) const;
+
+  // The specs, in script order.
+  std::vector<Spec> specs_;
+  // Specs filed by literal section names.
+  Buckets names_;
+  // Specs filed by the prefix of a prefix pattern, keyed first by the
+  // length of the prefix.
+  std::map<size_t, Buckets> prefixes_;
+  // Specs which match all section names or which have other
+  // wildcard patterns.
+  Bucket others_;
+};
+
+void
+Input_section_index::add_pattern(const std::string& file_pattern,
+				 bool file_is_wildcard,
+				 const char* section_pattern,
+				 bool section_is_wildcard)
+{
+  gold_assert(!this->specs_.empty());
+  unsigned int spec = this->specs_.size() - 1;
+
+  if (section_pattern != NULL && !section_is_wildcard)
+    {
+      add_to_bucket(&this->names_[section_pattern], file_pattern,
+		    file_is_wildcard, spec);
+      return;
+    }
+
+  // A backslash quotes the next character in a wildcard pattern, so
+  // such patterns go on the general list.
+  if (section_pattern != NULL && strchr(section_pattern, '\\') == NULL)
+    {
+      size_t len = strlen(section_pattern);
+      std::string prefix(section_pattern, len - 1);
+      if (section_pattern[len - 1] == '*'
+	  && !is_wildcard_string(prefix.c_str()))
+	{
+	  add_to_bucket(&this->prefixes_[len - 1][prefix], file_pattern,
+			file_is_wildcard, spec);
+	  return;
+	}
+    }
+
+  add_to_bucket(&this->others_, file_pattern, file_is_wildcard, spec);
+}
+
+// Look for a spec in LIST before *BEST which matches FILE_NAME and
+// SECTION_NAME.  If there is one, set *BEST and *KEEP.
+
+void
+Input_section_index::find_in_list(const Spec_list& list,
+				  const char* file_name,
+				  const char* section_name,
+				  unsigned int* best, bool* keep) const
+{
+  for (Spec_list::const_iterator p = list.begin();
+       p != list.end() && *p < *best;
+       ++p)
+    {
+      bool spec_keep;
+      if (this->specs_[*p].element->match_name(file_name, section_name,
+					       &spec_keep))
+	{
+	  *best = *p;
+	  *keep = spec_keep;
+	  return;
+	}
+    }
+}
+
+// Look for a spec in BUCKET before *BEST which matches FILE_NAME and
+// SECTION_NAME.  If there is one, set *BEST and *KEEP.
+
+void
+Input_section_index::find_in_bucket(const Bucket& bucket,
+				    const char* file_name,
+				    const char* section_name,
+				    unsigned int* best, bool* keep) const
+{
+  this->find_in_list(bucket.any_file, file_name, section_name, best, keep);
+  if (file_name != NULL && !bucket.by_file.empty())
+    {
+      Unordered_map<std::string, Spec_list>::const_iterator p =
+	bucket.by_file.find(file_name);
+      if (p != bucket.by_file.end())
+	this->find_in_list(p->second, file_name, section_name, best, keep);
+    }
+}
+
+Output_section_definition*
+Input_section_index::find(const char* file_name, const char* section_name,
+			  bool* keep) const
+{
+  unsigned int best = this->specs_.size();
+
+  this->find_in_bucket(this->others_, file_name, section_name, &best, keep);
+
+  Buckets::const_iterator p = this->names_.find(section_name);
+  if (p != this->names_.end())
+    this->find_in_bucket(p->second, file_name, section_name, &best, keep);
+
+  size_t len = strlen(section_name);
+  for (std::map<size_t, Buckets>::const_iterator q = this->prefixes_.begin();
+       q != this->prefixes_.end() && q->first <= len;
+       ++q)
+    {
+      p = q->second.find(std::string(section_name, q->first));
+      if (p != q->second.end())
+	this->find_in_bucket(p->second, file_name, section_name, &best,
+			     keep);
+    }
+
+  if (best == this->specs_.size())
+    return NULL;
+  return this->specs_[best].posd;
+}
+
+// Add this input section spec to INDEX.
+
+void
+Output_section_element_input::index_input_sections(
+    Input_section_index* index,
+    Output_section_definition* posd)
+{
+  index->add_spec(this, posd);
+  if (this->input_section_patterns_.empty())
+    index->add_pattern(this->filename_pattern_, this->filename_is_wildcard_,
+		       NULL, false);
+  for (Input_section_patterns::const_iterator p =
+	 this->input_section_patterns_.begin();
+       p != this->input_section_patterns_.end();
+       ++p)
+    index->add_pattern(this->filename_pattern_, this->filename_is_wildcard_,
+		       p->pattern.c_str(), p->pattern_is_wildcard);
+}
+
 // Information we use to sort the input sections.
 
 class Input_section_info
@@ -2005,6 +2248,22 @@ class Output_section_definition : public Sections_element
 		      Output_section***, Script_sections::Section_type*,
 		      bool*, bool);
 
+  // Add the input section specs to INDEX.
+  void
+  index_input_sections(Input_section_index* index);
+
+  // Return the output section name to use for an input section which
+  // matched one of our input section specs, and set *SLOT and
+  // *PSECTION_TYPE as output_section_name does.
+  const char*
+  matched_output_section_name(Output_section*** slot,
+			      Script_sections::Section_type* psection_type)
+  {
+    *slot = &this->output_section_;
+    *psection_type = this->section_type();
+    return this->name_.c_str();
+  }
+
   // Initialize OSP with an output section.
   void
   orphan_section_init(Orphan_section_placement* osp,
@@ -2322,6 +2581,17 @@ Output_section_definition::output_section_name(
   return NULL;
 }
 
+// Add the input section specs to INDEX.
+
+void
+Output_section_definition::index_input_sections(Input_section_index* index)
+{
+  for (Output_section_elements::const_iterator p = this->elements_.begin();
+       p != this->elements_.end();
+       ++p)
+    (*p)->index_input_sections(index, this);
+}
+
 // Return true if memory from START to START + LENGTH is contained
 // within a memory region.
 
@@ -3347,7 +3617,8 @@ Script_sections::Script_sections()
     saw_data_segment_align_(false),
     saw_relro_end_(false),
     saw_segment_start_expression_(false),
-    segments_created_(false)
+    segments_created_(false),
+    input_section_index_(NULL)
 {
 }
 
@@ -3482,6 +3753,10 @@ Script_sections::add_input_section(const Input_section_spec* spec, bool keep)
 {
   gold_assert(this->output_section_ != NULL);
   this->output_section_->add_input_section(spec, keep);
+
+  // The index no longer covers all the specs.
+  delete this->input_section_index_;
+  this->input_section_index_ = NULL;
 }
 
 // This is called when we see DATA_SEGMENT_ALIGN.  It means that any
@@ -3572,27 +3847,53 @@ Script_sections::output_section_name(
     bool* keep,
     bool is_input_section)
 {
-  for (Sections_elements::const_iterator p = this->sections_elements_->begin();
-       p != this->sections_elements_->end();
-       ++p)
+  const char* ret = NULL;
+  if (is_input_section)
+    {
+      // Find the first input section spec which matches, using an
+      // index of the specs built the first time we get here.
+      if (this->input_section_index_ == NULL)
+	{
+	  this->input_section_index_ = new Input_section_index();
+	  for (Sections_elements::const_iterator p =
+		 this->sections_elements_->begin();
+	       p != this->sections_elements_->end();
+	       ++p)
+	    (*p)->index_input_sections(this->input_section_index_);
+	}
+      Output_section_definition* posd =
+	this->input_section_index_->find(file_name, section_name, keep);
+      if (posd != NULL)
+	ret = posd->matched_output_section_name(output_section_slot,
+						 psection_type);
+    }
+  else
     {
-      const char* ret = (*p)->output_section_name(file_name, section_name,
-						  output_section_slot,
-						  psection_type, keep,
-						  is_input_section);
+      for (Sections_elements::const_iterator p =
+	     this->sections_elements_->begin();
+	   p != this->sections_elements_->end();
+	   ++p)
+	{
+	  ret = (*p)->output_section_name(file_name, section_name,
+					  output_section_slot,
+					  psection_type, keep,
+					  is_input_section);
+	  if (ret != NULL)
+	    break;
+	}
+    }
 
-      if (ret != NULL)
+  if (ret != NULL)
+    {
+      // The special name /DISCARD/ means that the input section
+      // should be discarded.
+      if (strcmp(ret, "/DISCARD/") == 0)
 	{
-	  // The special name /DISCARD/ means that the input section
-	  // should be discarded.
-	  if (strcmp(ret, "/DISCARD/") == 0)
-	    {
-	      *output_section_slot = NULL;
-	      *psection_type = Script_sections::ST_NONE;
-	      return NULL;
-	    }
-	  return ret;
+	  *output_section_slot = NULL;
+	  *psection_type = Script_sections::ST_NONE;
+	  return NULL;
 	}
+      return ret;
     }
 
   // We have an orphan section.
@@ -44,6 +44,7 @@ class Output_section_definition;
 class Output_section;
 class Output_segment;
 class Orphan_section_placement;
+class Input_section_index;
 
 class Script_sections
 {
@@ -324,6 +325,9 @@ class Script_sections
   bool saw_segment_start_expression_;
   // Whether we have created all necessary segments.
   bool segments_created_;
+  // An index of the input section specs, used to find the output
+  // section for an input section.  This is built when first needed.
+  Input_section_index* input_section_index_;
 };
 
 // Attributes for memory regions.
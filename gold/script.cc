@@ -28,6 +28,8 @@
 #include <fnmatch.h>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <functional>
 #include "filenames.h"
 
 #include "elfcpp.h"
@@ -2295,6 +2297,8 @@ Version_script_info::build_expression_list_lookup(
 	  if (this->unquote(&pattern))
 	    {
 	      this->globs_.push_back(Glob(&exp, v, is_global));
+	      this->glob_tries_[exp.language].add(exp.pattern,
+						  this->globs_.size() - 1);
 	      continue;
 	    }
 	}
@@ -2306,6 +2310,62 @@ Version_script_info::build_expression_list_lookup(
     }
 }
 
+// Class Version_script_info::Glob_trie.
+
+// Add the glob at INDEX in globs_, whose pattern is PATTERN.  We match
+// patterns with FNM_NOESCAPE, so the literal prefix is everything
+// before the first wildcard character.
+
+void
+Version_script_info::Glob_trie::add(const std::string& pattern,
+				    unsigned int index)
+{
+  size_t len = pattern.find_first_of("*?[");
+  if (len == std::string::npos)
+    len = pattern.length();
+
+  unsigned int node = 0;
+  for (size_t i = 0; i < len; ++i)
+    {
+      std::pair<Children::iterator, bool> ins =
+	this->children_.insert(std::make_pair(child_key(node, pattern[i]),
+					      0U));
+      if (ins.second)
+	{
+	  ins.first->second = this->node_globs_.size();
+	  this->node_globs_.push_back(std::vector<unsigned int>());
+	}
+      node = ins.first->second;
+    }
+  this->node_globs_[node].push_back(index);
+  this->empty_ = false;
+}
+
+// Add to *CANDIDATES the indexes of the globs whose literal prefix is
+// a prefix of NAME.
+
+void
+Version_script_info::Glob_trie::find(
+    const char* name,
+    std::vector<unsigned int>* candidates) const
+{
+  unsigned int node = 0;
+  const char* p = name;
+  while (true)
+    {
+      const std::vector<unsigned int>& globs(this->node_globs_[node]);
+      candidates->insert(candidates->end(), globs.begin(), globs.end());
+      if (*p == '\0')
+	break;
+      Children::const_iterator pc =
+	this->children_.find(child_key(node, *p));
+      if (pc == this->children_.end())
+	break;
+      node = pc->second;
+      ++p;
+    }
+}
+
 // Return the name to match given a name, a language code, and two
 // lazy demanglers.
 
@@ -2338,6 +2398,24 @@ bool
 Version_script_info::get_symbol_version(const char* symbol_name,
 					std::string* pversion,
 					bool* p_is_global) const
+{
+  const std::string* version;
+  if (!this->find_symbol_version(symbol_name, &version, p_is_global))
+    return false;
+  if (pversion != NULL)
+    *pversion = *version;
+  return true;
+}
+
+// Look up SYMBOL_NAME in the list of versions, as for
+// get_symbol_version.  This does not modify anything except
+// Version_expression::was_matched_by_symbol, which is only ever set to
+// true, so it may be called by several threads at once.
+
+bool
+Version_script_info::find_symbol_version(const char* symbol_name,
+					 const std::string** pversion,
+					 bool* p_is_global) const
 {
   Lazy_demangler cpp_demangled_name(symbol_name, DMGL_ANSI | DMGL_PARAMS);
   Lazy_demangler java_demangled_name(symbol_name,
@@ -2372,7 +2450,7 @@ Version_script_info::get_symbol_version(const char* symbol_name,
 			 vtm.ambiguous->tag.c_str());
 
 	  if (pversion != NULL)
-	    *pversion = vtm.real->tag;
+	    *pversion = &vtm.real->tag;
 	  if (p_is_global != NULL)
 	    *p_is_global = vtm.is_global;
 
@@ -2389,27 +2467,46 @@ Version_script_info::get_symbol_version(const char* symbol_name,
 	}
     }
 
-  // Look through the glob patterns in reverse order.
+  // Look through the glob patterns in reverse order.  We only try the
+  // patterns whose literal prefix matches the name.
 
-  for (Globs::const_reverse_iterator p = this->globs_.rbegin();
-       p != this->globs_.rend();
-       ++p)
+  std::vector<unsigned int> candidates;
+  for (int i = 0; i < LANGUAGE_COUNT; ++i)
     {
-      int language = p->expression->language;
-      const char* name_to_match = this->get_name_to_match(symbol_name,
-							  language,
+      const Glob_trie& trie(this->glob_tries_[i]);
+      if (trie.empty())
+	continue;
+
+      const char* name_to_match = this->get_name_to_match(symbol_name, i,
 							  &cpp_demangled_name,
 							  &java_demangled_name);
       if (name_to_match == NULL)
 	continue;
 
-      if (fnmatch(p->expression->pattern.c_str(), name_to_match,
+      trie.find(name_to_match, &candidates);
+    }
+  std::sort(candidates.begin(), candidates.end(),
+	    std::greater<unsigned int>());
+
+  for (std::vector<unsigned int>::const_iterator pc = candidates.begin();
+       pc != candidates.end();
+       ++pc)
+    {
+      const Glob& glob(this->globs_[*pc]);
+      int language = glob.expression->language;
+      const char* name_to_match = this->get_name_to_match(symbol_name,
+							  language,
+							  &cpp_demangled_name,
+							  &java_demangled_name);
+      gold_assert(name_to_match != NULL);
+
+      if (fnmatch(glob.expression->pattern.c_str(), name_to_match,
 		  FNM_NOESCAPE) == 0)
 	{
 	  if (pversion != NULL)
-	    *pversion = p->version->tag;
+	    *pversion = &glob.version->tag;
 	  if (p_is_global != NULL)
-	    *p_is_global = p->is_global;
+	    *p_is_global = glob.is_global;
 	  return true;
 	}
     }
@@ -2418,7 +2515,7 @@ Version_script_info::get_symbol_version(const char* symbol_name,
   if (this->default_version_ != NULL)
     {
       if (pversion != NULL)
-	*pversion = this->default_version_->tag;
+	*pversion = &this->default_version_->tag;
       if (p_is_global != NULL)
 	*p_is_global = this->default_is_global_;
       return true;
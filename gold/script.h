@@ -186,6 +186,13 @@ class Version_script_info
   get_symbol_version(const char* symbol, std::string* version,
 		     bool* is_global) const;
 
+  // Like get_symbol_version, but if PVERSION is not NULL, set
+  // *PVERSION to point to the version, which is owned by this object.
+  // This may be called by several threads at once.
+  bool
+  find_symbol_version(const char* symbol, const std::string** pversion,
+		      bool* is_global) const;
+
   // Return whether this symbol matches the local: section of some
   // version.
   bool
@@ -291,6 +298,53 @@ class Version_script_info
 
   typedef std::vector<Glob> Globs;
 
+  // A trie of the literal prefixes of the glob patterns for one
+  // language.  A pattern can only match a name which starts with its
+  // literal prefix, so this lets us find the few patterns worth trying
+  // with fnmatch without looking at all of them.  Patterns which start
+  // with a wildcard are at the root of the trie.
+  class Glob_trie
+  {
+   public:
+    Glob_trie()
+      : children_(), node_globs_(1), empty_(true)
+    { }
+
+    // Add the glob at INDEX in globs_, whose pattern is PATTERN.
+    void
+    add(const std::string& pattern, unsigned int index);
+
+    // Add to *CANDIDATES the indexes of the globs whose literal prefix
+    // is a prefix of NAME.
+    void
+    find(const char* name, std::vector<unsigned int>* candidates) const;
+
+    // Return whether there are no globs in the trie.
+    bool
+    empty() const
+    { return this->empty_; }
+
+   private:
+    // Map a node index and a character, combined by child_key, to the
+    // index of the child node.
+    typedef Unordered_map<uint64_t, unsigned int> Children;
+
+    static uint64_t
+    child_key(unsigned int node, char c)
+    {
+      return ((static_cast<uint64_t>(node) << 8)
+	      | static_cast<unsigned char>(c));
+    }
+
+    // The children of all the nodes.
+    Children children_;
+    // The indexes of the globs whose literal prefix ends at each
+    // node.  Node 0 is the root.
+    std::vector<std::vector<unsigned int> > node_globs_;
+    // Whether no globs have been added.
+    bool empty_;
+  };
+
   bool
   unquote(std::string*) const;
 
@@ -316,6 +370,8 @@ class Version_script_info
   Exact* exact_[LANGUAGE_COUNT];
   // A vector of glob patterns mapping to Version_trees.
   Globs globs_;
+  // The literal prefixes of the glob patterns, by language.
+  Glob_trie glob_tries_[LANGUAGE_COUNT];
   // The default version to use, if there is one.  This is from a
   // pattern of "*".
   const Version_tree* default_version_;
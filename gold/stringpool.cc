@@ -28,6 +28,7 @@
 
 #include "output.h"
 #include "parameters.h"
+#include "gold-threads.h"
 #include "stringpool.h"
 
 namespace gold
@@ -35,9 +36,9 @@ namespace gold
 
 template<typename Stringpool_char>
 Stringpool_template<Stringpool_char>::Stringpool_template(uint64_t addralign)
-  : string_set_(), key_to_offset_(), strings_(), strtab_size_(0),
-    zero_null_(true), optimize_(false), offset_(sizeof(Stringpool_char)),
-    addralign_(addralign)
+  : key_to_offset_(), strtab_size_(0), zero_null_(true), optimize_(false),
+    offset_(sizeof(Stringpool_char)), addralign_(addralign),
+    concurrent_(false), concurrent_adds_(0), lock_waits_(0)
 {
   if (parameters->options_valid()
       && parameters->options().optimize() >= 2
@@ -49,13 +50,19 @@ template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::clear()
 {
-  for (typename std::list<Stringdata*>::iterator p = this->strings_.begin();
-       p != this->strings_.end();
-       ++p)
-    delete[] reinterpret_cast<char*>(*p);
-  this->strings_.clear();
+  gold_assert(!this->concurrent_);
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      Shard* shard = &this->shards_[i];
+      for (typename std::list<Stringdata*>::iterator p =
+	     shard->strings.begin();
+	   p != shard->strings.end();
+	   ++p)
+	delete[] reinterpret_cast<char*>(*p);
+      shard->strings.clear();
+      shard->string_set.clear();
+    }
   this->key_to_offset_.clear();
-  this->string_set_.clear();
 }
 
 template<typename Stringpool_char>
@@ -67,7 +74,8 @@ Stringpool_template<Stringpool_char>::~Stringpool_template()
 // Resize the internal hashtable with the expectation we'll get n new
 // elements.  Note that the hashtable constructor takes a "number of
 // buckets you'd like," rather than "number of elements you'd like,"
-// but that's the best we can do.
+// but that's the best we can do.  We assume that the new elements
+// are spread evenly over the shards.
 
 template<typename Stringpool_char>
 void
@@ -75,22 +83,35 @@ Stringpool_template<Stringpool_char>::reserve(unsigned int n)
 {
   this->key_to_offset_.reserve(n);
 
+  n = n / shard_count + 1;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      String_set_type& string_set(this->shards_[i].string_set);
 #if defined(HAVE_UNORDERED_MAP)
-  this->string_set_.rehash(this->string_set_.size() + n);
-  return;
-#elif defined(HAVE_TR1_UNORDERED_MAP)
-  // rehash() implementation is broken in gcc 4.0.3's stl
-  //this->string_set_.rehash(this->string_set_.size() + n);
-  //return;
-#elif defined(HAVE_EXT_HASH_MAP)
-  this->string_set_.resize(this->string_set_.size() + n);
-  return;
+      string_set.rehash(string_set.size() + n);
+#elif !defined(HAVE_TR1_UNORDERED_MAP) && defined(HAVE_EXT_HASH_MAP)
+      string_set.resize(string_set.size() + n);
+#else
+      // This is the generic "reserve" code.  We also use it for
+      // tr1::unordered_map, since the rehash() implementation is
+      // broken in gcc 4.0.3's stl.
+      String_set_type new_string_set(string_set.size() + n);
+      new_string_set.insert(string_set.begin(), string_set.end());
+      string_set.swap(new_string_set);
 #endif
+    }
+}
+
+// Return the number of strings in the pool.
 
-  // This is the generic "reserve" code, if no #ifdef above triggers.
-  String_set_type new_string_set(this->string_set_.size() + n);
-  new_string_set.insert(this->string_set_.begin(), this->string_set_.end());
-  this->string_set_.swap(new_string_set);
+template<typename Stringpool_char>
+size_t
+Stringpool_template<Stringpool_char>::string_count() const
+{
+  size_t count = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    count += this->shards_[i].string_set.size();
+  return count;
 }
 
 // Compare two strings of arbitrary character type for equality.
@@ -140,14 +161,14 @@ Stringpool_template<Stringpool_char>::string_hash(const Stringpool_char* s,
   return gold::string_hash<Stringpool_char>(s, length);
 }
 
-// Add the string S to the list of canonical strings.  Return a
-// pointer to the canonical string.  If PKEY is not NULL, set *PKEY to
-// the key.  LENGTH is the length of S in characters.  Note that S may
-// not be NUL terminated.
+// Add the string S to the list of canonical strings STRINGS.  Return
+// a pointer to the canonical string.  LENGTH is the length of S in
+// characters.  Note that S may not be NUL terminated.
 
 template<typename Stringpool_char>
 const Stringpool_char*
-Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
+Stringpool_template<Stringpool_char>::add_string(Stringdata_list* strings,
+						 const Stringpool_char* s,
 						 size_t len)
 {
   // We are in trouble if we've already computed the string offsets.
@@ -171,11 +192,11 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
       alc = sizeof(Stringdata) + len;
       front = false;
     }
-  else if (this->strings_.empty())
+  else if (strings->empty())
     alc = sizeof(Stringdata) + buffer_size;
   else
     {
-      Stringdata* psd = this->strings_.front();
+      Stringdata* psd = strings->front();
       if (len > psd->alc - psd->len)
 	alc = sizeof(Stringdata) + buffer_size;
       else
@@ -199,9 +220,9 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
   psd->len = len;
 
   if (front)
-    this->strings_.push_front(psd);
+    strings->push_front(psd);
   else
-    this->strings_.push_back(psd);
+    strings->push_back(psd);
 
   return reinterpret_cast<const Stringpool_char*>(psd->data);
 }
@@ -237,13 +258,18 @@ Stringpool_template<Stringpool_char>::new_key_offset(size_t length)
 
 template<typename Stringpool_char>
 const Stringpool_char*
-Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
-						      size_t length,
-						      bool copy,
-						      Key* pkey)
+Stringpool_template<Stringpool_char>::add_prehashed(const Stringpool_char* s,
+						    size_t length,
+						    size_t hash_code,
+						    bool copy,
+						    Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
+  gold_assert(!this->concurrent_);
+
+  Shard* shard = this->shard(hash_code);
+
   // We add 1 so that 0 is always invalid.
   const Key k = this->key_to_offset_.size() + 1;
 
@@ -252,9 +278,9 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(Hashkey(s, length, hash_code), k);
 
-      Insert_type ins = this->string_set_.insert(element);
+      Insert_type ins = shard->string_set.insert(element);
 
       typename String_set_type::const_iterator p = ins.first;
 
@@ -279,9 +305,9 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   // canonicalize it by copying it into the canonical list. The hash
   // code will only be computed once.
 
-  Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
+  Hashkey hk(s, length, hash_code);
+  typename String_set_type::const_iterator p = shard->string_set.find(hk);
+  if (p != shard->string_set.end())
     {
       if (pkey != NULL)
 	*pkey = p->second;
@@ -290,13 +316,13 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 
   this->new_key_offset(length);
 
-  hk.string = this->add_string(s, length);
+  hk.string = this->add_string(&shard->strings, s, length);
   // The contents of the string stay the same, so we don't need to
   // adjust hk.hash_code or hk.length.
 
   std::pair<Hashkey, Hashval> element(hk, k);
 
-  Insert_type ins = this->string_set_.insert(element);
+  Insert_type ins = shard->string_set.insert(element);
   gold_assert(ins.second);
 
   if (pkey != NULL)
@@ -304,14 +330,135 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   return hk.string;
 }
 
+// Start adding strings from several threads.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::begin_concurrent_adds()
+{
+  gold_assert(!this->concurrent_ && this->strtab_size_ == 0);
+  for (unsigned int i = 0; i < shard_count; ++i)
+    this->shards_[i].lock = new Lock();
+  this->concurrent_ = true;
+}
+
+// Add a string, which may be done from any thread between
+// begin_concurrent_adds and end_concurrent_adds.  We only hold the
+// lock of the string's shard.  A new string is copied into the
+// shard's buffers, and waits for its key in the shard's pending
+// vector.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_ordered(const Stringpool_char* s,
+						  uint64_t order)
+{
+  if (!this->concurrent_)
+    return this->add(s, true, NULL);
+
+  Hashkey hk(s);
+  Shard* shard = this->shard(hk.hash_code);
+
+  bool waited = false;
+  if (!shard->lock->try_acquire())
+    {
+      shard->lock->acquire();
+      waited = true;
+    }
+
+  ++shard->adds;
+  if (waited)
+    ++shard->waits;
+
+  typename String_set_type::iterator p = shard->string_set.find(hk);
+  if (p != shard->string_set.end())
+    {
+      // If the string is still waiting for a key, it gets the key
+      // for the earliest of the adds.
+      if ((p->second & pending_key) != 0)
+	{
+	  Pending_string& ps(shard->pending[p->second & ~pending_key]);
+	  if (order < ps.order)
+	    ps.order = order;
+	}
+      hk.string = p->first.string;
+    }
+  else
+    {
+      hk.string = this->add_string(&shard->strings, s, hk.length);
+      std::pair<Hashkey, Hashval> element(hk,
+					  pending_key | shard->pending.size());
+      p = shard->string_set.insert(element).first;
+
+      Pending_string ps;
+      ps.order = order;
+      ps.length = hk.length;
+      // The hash table does not move its elements when it grows.
+      ps.pkey = &p->second;
+      shard->pending.push_back(ps);
+    }
+
+  shard->lock->release();
+
+  return hk.string;
+}
+
+// Finish adding strings from several threads.  Here we are back to
+// a single thread, so we can give out the keys and string offsets in
+// the same order as add would have.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::end_concurrent_adds()
+{
+  gold_assert(this->concurrent_);
+
+  size_t count = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    count += this->shards_[i].pending.size();
+
+  std::vector<Pending_string> pending;
+  pending.reserve(count);
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      Shard* shard = &this->shards_[i];
+      pending.insert(pending.end(), shard->pending.begin(),
+		     shard->pending.end());
+      std::vector<Pending_string>().swap(shard->pending);
+
+      this->concurrent_adds_ += shard->adds;
+      this->lock_waits_ += shard->waits;
+      shard->adds = 0;
+      shard->waits = 0;
+
+      delete shard->lock;
+      shard->lock = NULL;
+    }
+
+  // No two strings can have the same ORDER.
+  std::sort(pending.begin(), pending.end(), Pending_string_comparison());
+
+  for (typename std::vector<Pending_string>::const_iterator p =
+	 pending.begin();
+       p != pending.end();
+       ++p)
+    {
+      *p->pkey = this->key_to_offset_.size() + 1;
+      this->new_key_offset(p->length);
+    }
+
+  this->concurrent_ = false;
+}
+
 template<typename Stringpool_char>
 const Stringpool_char*
 Stringpool_template<Stringpool_char>::find(const Stringpool_char* s,
 					   Key* pkey) const
 {
   Hashkey hk(s);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p == this->string_set_.end())
+  const Shard* shard = this->shard(hk.hash_code);
+  typename String_set_type::const_iterator p = shard->string_set.find(hk);
+  if (p == shard->string_set.end())
     return NULL;
 
   if (pkey != NULL)
@@ -354,6 +501,87 @@ Stringpool_template<Stringpool_char>::Stringpool_sort_comparison::operator()(
   return len1 > len2;
 }
 
+// The key used by sort_for_suffixes for a string which has no
+// character at the current depth.  This is smaller than any
+// character, so that a string sorts after any longer string which it
+// is a suffix of.
+
+static const int64_t suffix_sort_end = -0x100000000LL;
+
+// Return the key used by sort_for_suffixes for HK: the character
+// DEPTH characters from the end of the string, or suffix_sort_end.
+
+template<typename Stringpool_char>
+inline int64_t
+Stringpool_template<Stringpool_char>::suffix_sort_key(const Hashkey& hk,
+						      size_t depth)
+{
+  if (depth >= hk.length)
+    return suffix_sort_end;
+  return static_cast<int64_t>(hk.string[hk.length - 1 - depth]);
+}
+
+// Sorting the strings with std::sort compares each pair of strings
+// from the end, which is slow when many strings share long suffixes,
+// as they do in mergeable string sections.  Instead we use a
+// multikey quicksort on the reversed strings, which looks at each
+// character only once in each partitioning step.  Small groups are
+// handed to std::sort.  Since no two strings in the pool are equal,
+// this gives the same order as sorting with
+// Stringpool_sort_comparison.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::sort_for_suffixes(
+    Stringpool_sort_info* v,
+    size_t n,
+    size_t depth)
+{
+  while (n >= 16)
+    {
+      // Use the median of three keys as the pivot.
+      int64_t k0 = suffix_sort_key(v[0]->first, depth);
+      int64_t k1 = suffix_sort_key(v[n / 2]->first, depth);
+      int64_t k2 = suffix_sort_key(v[n - 1]->first, depth);
+      int64_t pivot;
+      if (k0 < k1)
+	pivot = k1 < k2 ? k1 : (k0 < k2 ? k2 : k0);
+      else
+	pivot = k0 < k2 ? k0 : (k1 < k2 ? k2 : k1);
+
+      // Partition into strings with a larger character at DEPTH,
+      // which sort first, strings with the same character, and
+      // strings with a smaller character.
+      size_t lt = 0;
+      size_t i = 0;
+      size_t gt = n;
+      while (i < gt)
+	{
+	  int64_t k = suffix_sort_key(v[i]->first, depth);
+	  if (k > pivot)
+	    std::swap(v[lt++], v[i++]);
+	  else if (k < pivot)
+	    std::swap(v[i], v[--gt]);
+	  else
+	    ++i;
+	}
+
+      sort_for_suffixes(v, lt, depth);
+      sort_for_suffixes(v + gt, n - gt, depth);
+
+      // All the strings which are shorter than DEPTH are the same
+      // string, so there is at most one of them.
+      if (pivot == suffix_sort_end)
+	return;
+
+      v += lt;
+      n = gt - lt;
+      ++depth;
+    }
+
+  std::sort(v, v + n, Stringpool_sort_comparison());
+}
+
 // Return whether s1 is a suffix of s2.
 
 template<typename Stringpool_char>
@@ -381,6 +609,8 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
       return;
     }
 
+  gold_assert(!this->concurrent_);
+
   const size_t charsize = sizeof(Stringpool_char);
 
   // Offset 0 may be reserved for the empty string.
@@ -398,17 +628,22 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
     }
   else
     {
-      size_t count = this->string_set_.size();
+      size_t count = this->string_count();
 
       std::vector<Stringpool_sort_info> v;
       v.reserve(count);
 
-      for (typename String_set_type::iterator p = this->string_set_.begin();
-           p != this->string_set_.end();
-           ++p)
-        v.push_back(Stringpool_sort_info(p));
+      for (unsigned int i = 0; i < shard_count; ++i)
+	{
+	  String_set_type& string_set(this->shards_[i].string_set);
+	  for (typename String_set_type::iterator p = string_set.begin();
+	       p != string_set.end();
+	       ++p)
+	    v.push_back(Stringpool_sort_info(p));
+	}
 
-      std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
+      if (!v.empty())
+	sort_for_suffixes(&v[0], v.size(), 0);
 
       section_offset_type last_offset = -1;
       for (typename std::vector<Stringpool_sort_info>::iterator last = v.end(),
@@ -461,8 +696,9 @@ Stringpool_template<Stringpool_char>::get_offset_with_length(
 {
   gold_assert(this->strtab_size_ != 0);
   Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
+  const Shard* shard = this->shard(hk.hash_code);
+  typename String_set_type::const_iterator p = shard->string_set.find(hk);
+  if (p != shard->string_set.end())
     return this->key_to_offset_[p->second - 1];
   gold_unreachable();
 }
@@ -479,15 +715,20 @@ Stringpool_template<Stringpool_char>::write_to_buffer(
   gold_assert(bufsize >= this->strtab_size_);
   if (this->zero_null_)
     buffer[0] = '\0';
-  for (typename String_set_type::const_iterator p = this->string_set_.begin();
-       p != this->string_set_.end();
-       ++p)
+  for (unsigned int i = 0; i < shard_count; ++i)
     {
-      const int len = (p->first.length + 1) * sizeof(Stringpool_char);
-      const section_offset_type offset = this->key_to_offset_[p->second - 1];
-      gold_assert(static_cast<section_size_type>(offset) + len
-		  <= this->strtab_size_);
-      memcpy(buffer + offset, p->first.string, len);
+      const String_set_type& string_set(this->shards_[i].string_set);
+      for (typename String_set_type::const_iterator p = string_set.begin();
+	   p != string_set.end();
+	   ++p)
+	{
+	  const int len = (p->first.length + 1) * sizeof(Stringpool_char);
+	  const section_offset_type offset =
+	    this->key_to_offset_[p->second - 1];
+	  gold_assert(static_cast<section_size_type>(offset) + len
+		      <= this->strtab_size_);
+	  memcpy(buffer + offset, p->first.string, len);
+	}
     }
 }
 
@@ -509,16 +750,25 @@ template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::print_stats(const char* name) const
 {
+  size_t strings = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    strings += this->shards_[i].strings.size();
+
 #if defined(HAVE_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+  size_t buckets = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    buckets += this->shards_[i].string_set.bucket_count();
   fprintf(stderr, _("%s: %s entries: %zu; buckets: %zu\n"),
-	  program_name, name, this->string_set_.size(),
-	  this->string_set_.bucket_count());
+	  program_name, name, this->string_count(), buckets);
 #else
   fprintf(stderr, _("%s: %s entries: %zu\n"),
-	  program_name, name, this->table_.size());
+	  program_name, name, this->string_count());
 #endif
   fprintf(stderr, _("%s: %s Stringdata structures: %zu\n"),
-	  program_name, name, this->strings_.size());
+	  program_name, name, strings);
+  if (this->concurrent_adds_ > 0)
+    fprintf(stderr, _("%s: %s concurrent adds: %zu; lock waits: %zu\n"),
+	    program_name, name, this->concurrent_adds_, this->lock_waits_);
 }
 
 // Instantiate the templates we need.
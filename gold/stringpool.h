@@ -31,6 +31,7 @@ namespace gold
 {
 
 class Output_file;
+class Lock;
 
 // Return the length of a string in units of Char_type.
 
@@ -89,6 +90,15 @@ string_length(const char* p)
 // string "abc" will be stored, and "bc" will be represented by an
 // offset into the middle of the string "abc".
 
+// Strings may be added to a Stringpool from several threads at once,
+// between calls to begin_concurrent_adds and end_concurrent_adds.
+// The hash table is split into shards, each with its own lock, so
+// threads adding different strings rarely wait for each other.  A
+// string added this way does not get its key until
+// end_concurrent_adds, which assigns keys in the order the strings
+// would have been added by a single thread, so the keys and the
+// string table do not depend on how the threads were scheduled.
+
 
 // A simple chunked vector class--this is a subset of std::vector
 // which stores memory in chunks.  We don't provide iterators, because
@@ -200,7 +210,7 @@ class Stringpool_template
   void
   set_no_zero_null()
   {
-    gold_assert(this->string_set_.empty()
+    gold_assert(this->string_count() == 0
 		&& this->offset_ == sizeof(Stringpool_char));
     this->zero_null_ = false;
     this->offset_ = 0;
@@ -227,7 +237,44 @@ class Stringpool_template
   // Add string S of length LEN characters to the pool.  If COPY is
   // true, S need not be null terminated.
   const Stringpool_char*
-  add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
+  add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey)
+  { return this->add_prehashed(s, len, string_hash(s, len), copy, pkey); }
+
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is hash_string(S, LEN).  This permits the hash code to
+  // be computed ahead of time, perhaps in a different thread.
+  const Stringpool_char*
+  add_prehashed(const Stringpool_char* s, size_t len, size_t hash_code,
+		bool copy, Key* pkey);
+
+  // Return the hash code of string S of length LEN characters, for
+  // use with add_prehashed.
+  static size_t
+  hash_string(const Stringpool_char* s, size_t len)
+  { return string_hash(s, len); }
+
+  // Prepare to add strings to the pool from several threads at once.
+  // Until end_concurrent_adds is called, strings may only be added
+  // by calling add_ordered, and nothing else may be done with the
+  // pool.
+  void
+  begin_concurrent_adds();
+
+  // Add the null terminated string S to the pool, copying it, and
+  // return the canonical string.  ORDER is the position of this call
+  // among the calls which a single thread would make, and determines
+  // the key of a new string.  Between begin_concurrent_adds and
+  // end_concurrent_adds this may be called from any thread.  At other
+  // times ORDER is ignored, and this is the same as add(S, true,
+  // NULL).
+  const Stringpool_char*
+  add_ordered(const Stringpool_char* s, uint64_t order);
+
+  // Finish adding strings from several threads, and give keys to the
+  // new strings in the order of the ORDER arguments passed to
+  // add_ordered.
+  void
+  end_concurrent_adds();
 
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
@@ -317,9 +364,10 @@ class Stringpool_template
   void
   new_key_offset(size_t);
 
-  // Copy a string into the buffers, returning a canonical string.
+  // Copy a string into a list of buffers, returning a canonical
+  // string.
   const Stringpool_char*
-  add_string(const Stringpool_char*, size_t);
+  add_string(std::list<Stringdata*>*, const Stringpool_char*, size_t);
 
   // Return whether s1 is a suffix of s2.
   static bool
@@ -353,6 +401,10 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
@@ -388,6 +440,16 @@ class Stringpool_template
     operator()(const Stringpool_sort_info&, const Stringpool_sort_info&) const;
   };
 
+  // Return the key used by sort_for_suffixes for a string.
+  static int64_t
+  suffix_sort_key(const Hashkey&, size_t depth);
+
+  // Sort N strings starting at V into the order defined by
+  // Stringpool_sort_comparison, given that the last DEPTH characters
+  // of all of them are the same.
+  static void
+  sort_for_suffixes(Stringpool_sort_info* v, size_t n, size_t depth);
+
   // Keys map to offsets via a Chunked_vector.  We only use the
   // offsets if we turn this into an string table section.
   typedef Chunked_vector<section_offset_type> Key_to_offset;
@@ -395,12 +457,71 @@ class Stringpool_template
   // List of Stringdata structures.
   typedef std::list<Stringdata*> Stringdata_list;
 
-  // Mapping from const char* to namepool entry.
-  String_set_type string_set_;
+  // A string added by add_ordered which has not yet been given a
+  // key.  While it is waiting, its Hashval is pending_key plus its
+  // index in the pending vector of its shard.
+  struct Pending_string
+  {
+    // The smallest ORDER argument passed for the string.
+    uint64_t order;
+    // The length of the string in characters.
+    size_t length;
+    // The key in the hash table, set by end_concurrent_adds.
+    Hashval* pkey;
+  };
+
+  // Comparison routine used to sort Pending_strings by ORDER.
+  struct Pending_string_comparison
+  {
+    bool
+    operator()(const Pending_string& p1, const Pending_string& p2) const
+    { return p1.order < p2.order; }
+  };
+
+  static const Hashval pending_key = ~(~static_cast<Hashval>(0) >> 1);
+
+  // A piece of the hash table.  Each string goes in the shard chosen
+  // by its hash code.
+  struct Shard
+  {
+    Shard()
+      : string_set(), strings(), lock(NULL), pending(), adds(0), waits(0)
+    { }
+
+    // Mapping from const char* to namepool entry.
+    String_set_type string_set;
+    // List of buffers.
+    Stringdata_list strings;
+    // Controls access to the shard between begin_concurrent_adds and
+    // end_concurrent_adds.
+    Lock* lock;
+    // Strings waiting for keys.
+    std::vector<Pending_string> pending;
+    // The number of concurrent adds, for --stats.
+    size_t adds;
+    // The number of concurrent adds which had to wait for the lock.
+    size_t waits;
+  };
+
+  static const unsigned int shard_count = 16;
+
+  // Return the shard for a string with hash code HASH_CODE.
+  Shard*
+  shard(size_t hash_code)
+  { return &this->shards_[(hash_code ^ (hash_code >> 16)) % shard_count]; }
+
+  const Shard*
+  shard(size_t hash_code) const
+  { return &this->shards_[(hash_code ^ (hash_code >> 16)) % shard_count]; }
+
+  // Return the number of strings in the pool.
+  size_t
+  string_count() const;
+
+  // The hash table.
+  Shard shards_[shard_count];
   // Mapping from Key to string table offset.
   Key_to_offset key_to_offset_;
-  // List of buffers.
-  Stringdata_list strings_;
   // Size of string table.
   section_size_type strtab_size_;
   // Whether to reserve offset 0 to hold the null string.
@@ -411,6 +532,14 @@ class Stringpool_template
   section_offset_type offset_;
   // The alignment of strings in the stringpool.
   uint64_t addralign_;
+  // Whether we are between begin_concurrent_adds and
+  // end_concurrent_adds.
+  bool concurrent_;
+  // The number of strings added by add_ordered from several threads,
+  // for --stats.
+  size_t concurrent_adds_;
+  // The number of those adds which had to wait for a lock.
+  size_t lock_waits_;
 };
 
 // The most common type of Stringpool.
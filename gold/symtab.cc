@@ -41,6 +41,7 @@
 #include "script.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -568,6 +569,8 @@ Symbol_table::Symbol_table(unsigned int count,
   : saw_undefined_(0), offset_(0), table_(count), namepool_(),
     forwarders_(), commons_(), tls_commons_(), small_commons_(),
     large_commons_(), forced_locals_(), warnings_(),
+    candidate_odr_violations_(), odr_symbol_count_(0),
+    odr_location_count_(0), odr_object_count_(0), odr_usec_(0),
     version_script_(version_script), gc_(NULL), icf_(NULL),
     target_symbols_()
 {
@@ -1171,6 +1174,56 @@ Symbol_table::add_from_object(Object* object,
   return ret;
 }
 
+// Split the name of a symbol in a relocatable object into the name
+// and the version, and compute the hash code of the name.  In an
+// object file, an '@' in the name separates the symbol name from the
+// version name.  If there are two '@' characters, this is the default
+// version.
+
+void
+Symbol_table::prepare_symbol_name(const char* name, Prepared_symbol* ps)
+{
+  const char* ver = strchr(name, '@');
+  ps->is_default_version = false;
+  if (ver == NULL)
+    {
+      ps->name_length = strlen(name);
+      ps->version = NULL;
+    }
+  else
+    {
+      // The symbol name is of the form foo@VERSION or foo@@VERSION
+      ps->name_length = ver - name;
+      ++ver;
+      if (*ver == '@')
+	{
+	  ps->is_default_version = true;
+	  ++ver;
+	}
+      ps->version = ver;
+    }
+  ps->name_hash = Stringpool::hash_string(name, ps->name_length);
+  ps->version_script_checked = false;
+}
+
+// Look up NAME in the version script, unless it has a version in the
+// name.  This does the version script lookup of add_from_relobj ahead
+// of time, since matching the patterns of a large version script can
+// be expensive.
+
+void
+Symbol_table::prepare_symbol_version(const char* name,
+				     Prepared_symbol* ps) const
+{
+  if (ps->version != NULL || this->version_script_.empty())
+    return;
+  ps->version_script_checked = true;
+  ps->version_script_matched =
+    this->version_script_.find_symbol_version(name,
+					      &ps->version_script_version,
+					      &ps->version_script_is_global);
+}
+
 // Add all the symbols in a relocatable object to the hash table.
 
 template<int size, bool big_endian>
@@ -1182,6 +1235,7 @@ Symbol_table::add_from_relobj(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Prepared_symbols* prepared,
     typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
     size_t* defined)
 {
@@ -1240,59 +1294,69 @@ Symbol_table::add_from_relobj(
 	  is_defined_in_discarded_section = true;
 	}
 
-      // In an object file, an '@' in the name separates the symbol
-      // name from the version name.  If there are two '@' characters,
-      // this is the default version.
-      const char* ver = strchr(name, '@');
+      // Split the name into the name and the version.  When running
+      // multi-threaded this has normally been done already.
+      Prepared_symbol local_ps;
+      const Prepared_symbol* ps;
+      if (prepared != NULL)
+	ps = &(*prepared)[i];
+      else
+	{
+	  Symbol_table::prepare_symbol_name(name, &local_ps);
+	  ps = &local_ps;
+	}
+
+      const char* ver = ps->version;
       Stringpool::Key ver_key = 0;
-      int namelen = 0;
+      size_t namelen = ps->name_length;
+      size_t name_hash = ps->name_hash;
       // IS_DEFAULT_VERSION: is the version default?
       // IS_FORCED_LOCAL: is the symbol forced local?
-      bool is_default_version = false;
+      bool is_default_version = ps->is_default_version;
       bool is_forced_local = false;
 
       // FIXME: For incremental links, we don't store version information,
-      // so we need to ignore version symbols for now.
+      // so we need to ignore version symbols for now, and treat the
+      // version as part of the name.
       if (parameters->incremental_update() && ver != NULL)
 	{
-	  namelen = ver - name;
 	  ver = NULL;
+	  is_default_version = false;
+	  namelen = strlen(name);
+	  name_hash = Stringpool::hash_string(name, namelen);
 	}
 
       if (ver != NULL)
-        {
-          // The symbol name is of the form foo@VERSION or foo@@VERSION
-          namelen = ver - name;
-          ++ver;
-	  if (*ver == '@')
-	    {
-	      is_default_version = true;
-	      ++ver;
-	    }
-	  ver = this->namepool_.add(ver, true, &ver_key);
-        }
+	ver = this->namepool_.add(ver, true, &ver_key);
       // We don't want to assign a version to an undefined symbol,
       // even if it is listed in the version script.  FIXME: What
       // about a common symbol?
       else
 	{
-	  namelen = strlen(name);
 	  if (!this->version_script_.empty()
 	      && st_shndx != elfcpp::SHN_UNDEF)
 	    {
 	      // The symbol name did not have a version, but the
-	      // version script may assign a version anyway.
-	      std::string version;
-	      bool is_global;
-	      if (this->version_script_.get_symbol_version(name, &version,
-							   &is_global))
+	      // version script may assign a version anyway.  When
+	      // running multi-threaded this has normally been looked up
+	      // already.
+	      Prepared_symbol local_vps;
+	      const Prepared_symbol* vps = ps;
+	      if (!ps->version_script_checked)
+		{
+		  local_vps = *ps;
+		  this->prepare_symbol_version(name, &local_vps);
+		  vps = &local_vps;
+		}
+	      if (vps->version_script_matched)
 		{
-		  if (!is_global)
+		  const std::string* version = vps->version_script_version;
+		  if (!vps->version_script_is_global)
 		    is_forced_local = true;
-		  else if (!version.empty())
+		  else if (!version->empty())
 		    {
-		      ver = this->namepool_.add_with_length(version.c_str(),
-							    version.length(),
+		      ver = this->namepool_.add_with_length(version->c_str(),
+							    version->length(),
 							    true,
 							    &ver_key);
 		      is_default_version = true;
@@ -1348,8 +1412,8 @@ Symbol_table::add_from_relobj(
         }
 
       Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+      name = this->namepool_.add_prehashed(name, namelen, name_hash,
+					   true, &name_key);
 
       Sized_symbol<size>* res;
       res = this->add_from_object(relobj, name, name_key, ver, ver_key,
@@ -3034,6 +3098,112 @@ Symbol_table::write_globals(const Stringpool* sympool,
     }
 }
 
+// The number of pieces in which the global symbols were written, for
+// --stats.  This is zero if they were written by a single thread.
+
+static unsigned int write_globals_pieces;
+
+// A Parallel_job which writes out the global symbols.  The symbols
+// are added in the order of the symbol table, and each piece writes
+// a fixed number of them.  Every symbol has its own slot in the
+// output views, and the string table offsets were fixed when the
+// string pools were finalized, so the pieces do not interfere.  The
+// extended section indexes found by each piece are saved, and added
+// to the tables after the job has run.
+
+template<int size, bool big_endian>
+class Symbol_table::Write_globals_job : public Parallel_job
+{
+ public:
+  // The number of symbols written by each piece.
+  static const size_t symbols_per_piece = 8192;
+
+  Write_globals_job(const Symbol_table* symtab, const Stringpool* sympool,
+		    const Stringpool* dynpool, unsigned char* psyms,
+		    unsigned char* dynamic_view)
+    : symtab_(symtab), sympool_(sympool), dynpool_(dynpool),
+      psyms_(psyms), dynamic_view_(dynamic_view), symbols_(), xindexes_()
+  { }
+
+  // Reserve space for COUNT symbols.
+  void
+  reserve(size_t count)
+  { this->symbols_.reserve(count); }
+
+  // Add a symbol to write.
+  void
+  add_symbol(Sized_symbol<size>* sym)
+  { this->symbols_.push_back(sym); }
+
+  // Write out the symbols, and return the number of pieces.
+  unsigned int
+  write()
+  {
+    unsigned int count = ((this->symbols_.size() + symbols_per_piece - 1)
+			  / symbols_per_piece);
+    this->xindexes_.resize(count);
+    this->run(count);
+    return count;
+  }
+
+  // Add the extended section indexes to the tables.
+  void
+  add_xindexes(Output_symtab_xindex* symtab_xindex,
+	       Output_symtab_xindex* dynsym_xindex) const;
+
+  void
+  run_piece(unsigned int index);
+
+ private:
+  // The symbols in one piece which need extended section indexes,
+  // with their output section indexes.
+  typedef std::vector<std::pair<const Symbol*, unsigned int> > Xindexes;
+
+  const Symbol_table* symtab_;
+  const Stringpool* sympool_;
+  const Stringpool* dynpool_;
+  unsigned char* psyms_;
+  unsigned char* dynamic_view_;
+  std::vector<Sized_symbol<size>*> symbols_;
+  std::vector<Xindexes> xindexes_;
+};
+
+template<int size, bool big_endian>
+void
+Symbol_table::Write_globals_job<size, big_endian>::run_piece(
+    unsigned int index)
+{
+  size_t start = static_cast<size_t>(index) * symbols_per_piece;
+  size_t end = std::min(start + symbols_per_piece, this->symbols_.size());
+  Xindexes* xindexes = &this->xindexes_[index];
+  for (size_t i = start; i < end; ++i)
+    {
+      Sized_symbol<size>* sym = this->symbols_[i];
+      unsigned int shndx =
+	this->symtab_->template sized_write_global<size, big_endian>(
+	    sym, this->sympool_, this->dynpool_, this->psyms_,
+	    this->dynamic_view_);
+      if (shndx != 0)
+	xindexes->push_back(std::make_pair(sym, shndx));
+    }
+}
+
+template<int size, bool big_endian>
+void
+Symbol_table::Write_globals_job<size, big_endian>::add_xindexes(
+    Output_symtab_xindex* symtab_xindex,
+    Output_symtab_xindex* dynsym_xindex) const
+{
+  for (typename std::vector<Xindexes>::const_iterator p =
+	 this->xindexes_.begin();
+       p != this->xindexes_.end();
+       ++p)
+    for (typename Xindexes::const_iterator q = p->begin(); q != p->end(); ++q)
+      this->symtab_->add_global_xindex(q->first, q->second, symtab_xindex,
+				       dynsym_xindex,
+				       this->dynamic_view_ != NULL);
+}
+
 // Write out the global symbols.
 
 template<int size, bool big_endian>
@@ -3044,8 +3214,6 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
 				  Output_symtab_xindex* dynsym_xindex,
 				  Output_file* of) const
 {
-  const Target& target = parameters->target();
-
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
 
   const unsigned int output_count = this->output_count_;
@@ -3067,184 +3235,44 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
   else
     dynamic_view = of->get_output_view(this->dynamic_offset_, dynamic_size);
 
-  for (Symbol_table_type::const_iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  // If there are workqueue threads with nothing to do, write the
+  // symbols in pieces; the pieces run as workqueue tasks, so this
+  // stays within --thread-count-final.  The warnings about undefined
+  // symbols are issued here, in the order of the symbol table, so
+  // that they do not depend on the threads.
+  typedef Write_globals_job<size, big_endian> Job;
+  if (Parallel_job::thread_count() > 1
+      && this->table_.size() > Job::symbols_per_piece)
     {
-      Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
-
-      // Possibly warn about unresolved symbols in shared libraries.
-      this->warn_about_undefined_dynobj_symbol(sym);
-
-      unsigned int sym_index = sym->symtab_index();
-      unsigned int dynsym_index;
-      if (dynamic_view == NULL)
-	dynsym_index = -1U;
-      else
-	dynsym_index = sym->dynsym_index();
-
-      if (sym_index == -1U && dynsym_index == -1U)
+      Job job(this, sympool, dynpool, psyms, dynamic_view);
+      job.reserve(this->table_.size());
+      for (Symbol_table_type::const_iterator p = this->table_.begin();
+	   p != this->table_.end();
+	   ++p)
 	{
-	  // This symbol is not included in the output file.
-	  continue;
+	  this->warn_about_undefined_dynobj_symbol(p->second);
+	  job.add_symbol(static_cast<Sized_symbol<size>*>(p->second));
 	}
-
-      unsigned int shndx;
-      typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
-      typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
-      elfcpp::STB binding = sym->binding();
-
-      // If --weak-unresolved-symbols is set, change binding of unresolved
-      // global symbols to STB_WEAK.
-      if (parameters->options().weak_unresolved_symbols()
-	  && binding == elfcpp::STB_GLOBAL
-	  && sym->is_undefined())
-	binding = elfcpp::STB_WEAK;
-
-      // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
-      if (binding == elfcpp::STB_GNU_UNIQUE
-	  && !parameters->options().gnu_unique())
-	binding = elfcpp::STB_GLOBAL;
-
-      switch (sym->source())
+      write_globals_pieces += job.write();
+      job.add_xindexes(symtab_xindex, dynsym_xindex);
+    }
+  else
+    {
+      for (Symbol_table_type::const_iterator p = this->table_.begin();
+	   p != this->table_.end();
+	   ++p)
 	{
-	case Symbol::FROM_OBJECT:
-	  {
-	    bool is_ordinary;
-	    unsigned int in_shndx = sym->shndx(&is_ordinary);
-
-	    if (!is_ordinary
-		&& in_shndx != elfcpp::SHN_ABS
-		&& !Symbol::is_common_shndx(in_shndx))
-	      {
-		gold_error(_("%s: unsupported symbol section 0x%x"),
-			   sym->demangled_name().c_str(), in_shndx);
-		shndx = in_shndx;
-	      }
-	    else
-	      {
-		Object* symobj = sym->object();
-		if (symobj->is_dynamic())
-		  {
-		    if (sym->needs_dynsym_value())
-		      dynsym_value = target.dynsym_value(sym);
-		    shndx = elfcpp::SHN_UNDEF;
-		    if (sym->is_undef_binding_weak())
-		      binding = elfcpp::STB_WEAK;
-		    else
-		      binding = elfcpp::STB_GLOBAL;
-		  }
-		else if (symobj->pluginobj() != NULL)
-		  shndx = elfcpp::SHN_UNDEF;
-		else if (in_shndx == elfcpp::SHN_UNDEF
-			 || (!is_ordinary
-			     && (in_shndx == elfcpp::SHN_ABS
-				 || Symbol::is_common_shndx(in_shndx))))
-		  shndx = in_shndx;
-		else
-		  {
-		    Relobj* relobj = static_cast<Relobj*>(symobj);
-		    Output_section* os = relobj->output_section(in_shndx);
-                    if (this->is_section_folded(relobj, in_shndx))
-                      {
-                        // This global symbol must be written out even though
-                        // it is folded.
-                        // Get the os of the section it is folded onto.
-                        Section_id folded =
-                             this->icf_->get_folded_section(relobj, in_shndx);
-                        gold_assert(folded.first !=NULL);
-                        Relobj* folded_obj = 
-                          reinterpret_cast<Relobj*>(folded.first);
-                        os = folded_obj->output_section(folded.second);  
-                        gold_assert(os != NULL);
-                      }
-		    gold_assert(os != NULL);
-		    shndx = os->out_shndx();
-
-		    if (shndx >= elfcpp::SHN_LORESERVE)
-		      {
-			if (sym_index != -1U)
-			  symtab_xindex->add(sym_index, shndx);
-			if (dynsym_index != -1U)
-			  dynsym_xindex->add(dynsym_index, shndx);
-			shndx = elfcpp::SHN_XINDEX;
-		      }
-
-		    // In object files symbol values are section
-		    // relative.
-		    if (parameters->options().relocatable())
-		      sym_value -= os->address();
-		  }
-	      }
-	  }
-	  break;
-
-	case Symbol::IN_OUTPUT_DATA:
-	  {
-	    Output_data* od = sym->output_data();
-
-	    shndx = od->out_shndx();
-	    if (shndx >= elfcpp::SHN_LORESERVE)
-	      {
-		if (sym_index != -1U)
-		  symtab_xindex->add(sym_index, shndx);
-		if (dynsym_index != -1U)
-		  dynsym_xindex->add(dynsym_index, shndx);
-		shndx = elfcpp::SHN_XINDEX;
-	      }
+	  Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
 
-	    // In object files symbol values are section
-	    // relative.
-	    if (parameters->options().relocatable())
-	      {
-		Output_section* os = od->output_section();
-		gold_assert(os != NULL);
-		sym_value -= os->address();
-	      }
-	  }
-	  break;
-
-	case Symbol::IN_OUTPUT_SEGMENT:
-	  {
-	    Output_segment* oseg = sym->output_segment();
-	    Output_section* osect = oseg->first_section();
-	    if (osect == NULL)
-	      shndx = elfcpp::SHN_ABS;
-	    else
-	      shndx = osect->out_shndx();
-	  }
-	  break;
+	  // Possibly warn about unresolved symbols in shared libraries.
+	  this->warn_about_undefined_dynobj_symbol(sym);
 
-	case Symbol::IS_CONSTANT:
-	  shndx = elfcpp::SHN_ABS;
-	  break;
-
-	case Symbol::IS_UNDEFINED:
-	  shndx = elfcpp::SHN_UNDEF;
-	  break;
-
-	default:
-	  gold_unreachable();
-	}
-
-      if (sym_index != -1U)
-	{
-	  sym_index -= first_global_index;
-	  gold_assert(sym_index < output_count);
-	  unsigned char* ps = psyms + (sym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
-						     binding, sympool, ps);
-	}
-
-      if (dynsym_index != -1U)
-	{
-	  dynsym_index -= first_dynamic_global_index;
-	  gold_assert(dynsym_index < dynamic_count);
-	  unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
-						     binding, dynpool, pd);
-          // Allow a target to adjust dynamic symbol value.
-          parameters->target().adjust_dyn_symbol(sym, pd);
+	  unsigned int shndx =
+	    this->sized_write_global<size, big_endian>(sym, sympool, dynpool,
+						       psyms, dynamic_view);
+	  if (shndx != 0)
+	    this->add_global_xindex(sym, shndx, symtab_xindex, dynsym_xindex,
+				    dynamic_view != NULL);
 	}
     }
 
@@ -3301,6 +3329,215 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
     of->write_output_view(this->dynamic_offset_, dynamic_size, dynamic_view);
 }
 
+// Write out the global symbol SYM.  This may be called from several
+// threads at once, for different symbols.
+
+template<int size, bool big_endian>
+unsigned int
+Symbol_table::sized_write_global(Sized_symbol<size>* sym,
+				 const Stringpool* sympool,
+				 const Stringpool* dynpool,
+				 unsigned char* psyms,
+				 unsigned char* dynamic_view) const
+{
+  const Target& target = parameters->target();
+
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  const unsigned int output_count = this->output_count_;
+  const unsigned int first_global_index = this->first_global_index_;
+  const unsigned int dynamic_count = this->dynamic_count_;
+  const unsigned int first_dynamic_global_index =
+    this->first_dynamic_global_index_;
+
+  unsigned int sym_index = sym->symtab_index();
+  unsigned int dynsym_index;
+  if (dynamic_view == NULL)
+    dynsym_index = -1U;
+  else
+    dynsym_index = sym->dynsym_index();
+
+  if (sym_index == -1U && dynsym_index == -1U)
+    {
+      // This symbol is not included in the output file.
+      return 0;
+    }
+
+  unsigned int shndx;
+  unsigned int xindex_shndx = 0;
+  typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
+  typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
+  elfcpp::STB binding = sym->binding();
+
+  // If --weak-unresolved-symbols is set, change binding of unresolved
+  // global symbols to STB_WEAK.
+  if (parameters->options().weak_unresolved_symbols()
+      && binding == elfcpp::STB_GLOBAL
+      && sym->is_undefined())
+    binding = elfcpp::STB_WEAK;
+
+  // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
+  if (binding == elfcpp::STB_GNU_UNIQUE
+      && !parameters->options().gnu_unique())
+    binding = elfcpp::STB_GLOBAL;
+
+  switch (sym->source())
+    {
+    case Symbol::FROM_OBJECT:
+      {
+	bool is_ordinary;
+	unsigned int in_shndx = sym->shndx(&is_ordinary);
+
+	if (!is_ordinary
+	    && in_shndx != elfcpp::SHN_ABS
+	    && !Symbol::is_common_shndx(in_shndx))
+	  {
+	    gold_error(_("%s: unsupported symbol section 0x%x"),
+		       sym->demangled_name().c_str(), in_shndx);
+	    shndx = in_shndx;
+	  }
+	else
+	  {
+	    Object* symobj = sym->object();
+	    if (symobj->is_dynamic())
+	      {
+		if (sym->needs_dynsym_value())
+		  dynsym_value = target.dynsym_value(sym);
+		shndx = elfcpp::SHN_UNDEF;
+		if (sym->is_undef_binding_weak())
+		  binding = elfcpp::STB_WEAK;
+		else
+		  binding = elfcpp::STB_GLOBAL;
+	      }
+	    else if (symobj->pluginobj() != NULL)
+	      shndx = elfcpp::SHN_UNDEF;
+	    else if (in_shndx == elfcpp::SHN_UNDEF
+		     || (!is_ordinary
+			 && (in_shndx == elfcpp::SHN_ABS
+			     || Symbol::is_common_shndx(in_shndx))))
+	      shndx = in_shndx;
+	    else
+	      {
+		Relobj* relobj = static_cast<Relobj*>(symobj);
+		Output_section* os = relobj->output_section(in_shndx);
+		if (this->is_section_folded(relobj, in_shndx))
+		  {
+		    // This global symbol must be written out even though
+		    // it is folded.
+		    // Get the os of the section it is folded onto.
+		    Section_id folded =
+			 this->icf_->get_folded_section(relobj, in_shndx);
+		    gold_assert(folded.first !=NULL);
+		    Relobj* folded_obj = 
+		      reinterpret_cast<Relobj*>(folded.first);
+		    os = folded_obj->output_section(folded.second);  
+		    gold_assert(os != NULL);
+		  }
+		gold_assert(os != NULL);
+		shndx = os->out_shndx();
+
+		if (shndx >= elfcpp::SHN_LORESERVE)
+		  {
+		    xindex_shndx = shndx;
+		    shndx = elfcpp::SHN_XINDEX;
+		  }
+
+		// In object files symbol values are section
+		// relative.
+		if (parameters->options().relocatable())
+		  sym_value -= os->address();
+	      }
+	  }
+      }
+      break;
+
+    case Symbol::IN_OUTPUT_DATA:
+      {
+	Output_data* od = sym->output_data();
+
+	shndx = od->out_shndx();
+	if (shndx >= elfcpp::SHN_LORESERVE)
+	  {
+	    xindex_shndx = shndx;
+	    shndx = elfcpp::SHN_XINDEX;
+	  }
+
+	// In object files symbol values are section
+	// relative.
+	if (parameters->options().relocatable())
+	  {
+	    Output_section* os = od->output_section();
+	    gold_assert(os != NULL);
+	    sym_value -= os->address();
+	  }
+      }
+      break;
+
+    case Symbol::IN_OUTPUT_SEGMENT:
+      {
+	Output_segment* oseg = sym->output_segment();
+	Output_section* osect = oseg->first_section();
+	if (osect == NULL)
+	  shndx = elfcpp::SHN_ABS;
+	else
+	  shndx = osect->out_shndx();
+      }
+      break;
+
+    case Symbol::IS_CONSTANT:
+      shndx = elfcpp::SHN_ABS;
+      break;
+
+    case Symbol::IS_UNDEFINED:
+      shndx = elfcpp::SHN_UNDEF;
+      break;
+
+    default:
+      gold_unreachable();
+    }
+
+  if (sym_index != -1U)
+    {
+      sym_index -= first_global_index;
+      gold_assert(sym_index < output_count);
+      unsigned char* ps = psyms + (sym_index * sym_size);
+      this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
+						 binding, sympool, ps);
+    }
+
+  if (dynsym_index != -1U)
+    {
+      dynsym_index -= first_dynamic_global_index;
+      gold_assert(dynsym_index < dynamic_count);
+      unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
+      this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
+						 binding, dynpool, pd);
+      // Allow a target to adjust dynamic symbol value.
+      parameters->target().adjust_dyn_symbol(sym, pd);
+    }
+
+  return xindex_shndx;
+}
+
+// Add the global symbol SYM to the extended section index tables.
+
+void
+Symbol_table::add_global_xindex(const Symbol* sym, unsigned int shndx,
+				Output_symtab_xindex* symtab_xindex,
+				Output_symtab_xindex* dynsym_xindex,
+				bool write_dynamic) const
+{
+  unsigned int sym_index = sym->symtab_index();
+  if (sym_index != -1U)
+    symtab_xindex->add(sym_index, shndx);
+  if (write_dynamic)
+    {
+      unsigned int dynsym_index = sym->dynsym_index();
+      if (dynsym_index != -1U)
+	dynsym_xindex->add(dynsym_index, shndx);
+    }
+}
+
 // Write out the symbol SYM, in section SHNDX, to P.  POOL is the
 // strtab holding the name.
 
@@ -3456,6 +3693,20 @@ Symbol_table::print_stats() const
 	  program_name, this->table_.size());
 #endif
   this->namepool_.print_stats("symbol table stringpool");
+  fprintf(stderr, _("%s: global symbol write pieces: %u\n"),
+	  program_name, write_globals_pieces);
+  if (parameters->options().detect_odr_violations())
+    {
+      fprintf(stderr,
+	      _("%s: ODR candidate symbols: %zu; locations: %zu; "
+		"objects: %zu\n"),
+	      program_name, this->odr_symbol_count_,
+	      this->odr_location_count_, this->odr_object_count_);
+      fprintf(stderr, _("%s: ODR check time: %llu.%06llu\n"),
+	      program_name,
+	      static_cast<unsigned long long>(this->odr_usec_ / 1000000),
+	      static_cast<unsigned long long>(this->odr_usec_ % 1000000));
+    }
 }
 
 // We check for ODR violations by looking for symbols with the same
@@ -3494,26 +3745,19 @@ struct Odr_violation_compare
 };
 
 // Returns all of the lines attached to LOC, not just the one the
-// instruction actually came from.
-std::vector<std::string>
-Symbol_table::linenos_from_loc(const Task* task,
-                               const Symbol_location& loc)
-{
-  // We need to lock the object in order to read it.  This
-  // means that we have to run in a singleton Task.  If we
-  // want to run this in a general Task for better
-  // performance, we will need one Task for object, plus
-  // appropriate locking to ensure that we don't conflict with
-  // other uses of the object.  Also note, one_addr2line is not
-  // currently thread-safe.
-  Task_lock_obj<Object> tl(task, loc.object);
+// instruction actually came from.  This helps the ODR checker avoid
+// false positives.  LINEINFO is the line information for LOC.object,
+// which the caller must have locked.
 
+static std::vector<std::string>
+linenos_from_loc(Dwarf_line_info* lineinfo, const Symbol_location& loc)
+{
   std::vector<std::string> result;
   Symbol_location code_loc = loc;
   parameters->target().function_location(&code_loc);
-  // 16 is the size of the object-cache that one_addr2line should use.
-  std::string canonical_result = Dwarf_line_info::one_addr2line(
-      code_loc.object, code_loc.shndx, code_loc.offset, 16, &result);
+  std::string canonical_result = lineinfo->addr2line(code_loc.shndx,
+						     code_loc.offset,
+						     &result);
   if (!canonical_result.empty())
     result.push_back(canonical_result);
   return result;
@@ -3548,92 +3792,328 @@ struct Check_intersection
   bool value_;
 };
 
+// A job which finds the source lines of the candidate ODR
+// violations.  The line programs of each object are decoded once, and
+// then all the candidate locations in that object are looked up.  The
+// objects from one input file share a piece, because archive members
+// share a File_read.
+
+class Odr_lines_job : public Parallel_job
+{
+ public:
+  Odr_lines_job(const Task* task)
+    : task_(task), locations_(), linenos_(), pieces_(), piece_index_(),
+      object_index_()
+  { }
+
+  // Add LOC and return its index.
+  unsigned int
+  add_location(const Symbol_location& loc);
+
+  // Return the number of locations.
+  size_t
+  location_count() const
+  { return this->locations_.size(); }
+
+  // Return the number of objects.
+  size_t
+  object_count() const
+  { return this->object_index_.size(); }
+
+  // Return the number of pieces.
+  unsigned int
+  piece_count() const
+  { return this->pieces_.size(); }
+
+  // Return the location with index I.
+  const Symbol_location&
+  location(unsigned int i) const
+  { return this->locations_[i]; }
+
+  // Return the source lines of the location with index I, once the
+  // job has run.  The canonical line is last.  This is empty if there
+  // is no line information.
+  const std::vector<std::string>&
+  linenos(unsigned int i) const
+  { return this->linenos_[i]; }
+
+  void
+  run_piece(unsigned int index);
+
+ private:
+  // The indexes of the locations in one object.
+  struct Object_locations
+  {
+    Object* object;
+    std::vector<unsigned int> locations;
+  };
+
+  // The objects from one input file.
+  typedef std::vector<Object_locations> Piece;
+  // Map from an input file to the index of its piece.
+  typedef Unordered_map<const Input_file*, unsigned int> Piece_index;
+  // Map from an object to its piece and its index in the piece.
+  typedef Unordered_map<const Object*, std::pair<unsigned int, unsigned int> >
+    Object_index;
+
+  const Task* task_;
+  std::vector<Symbol_location> locations_;
+  std::vector<std::vector<std::string> > linenos_;
+  std::vector<Piece> pieces_;
+  Piece_index piece_index_;
+  Object_index object_index_;
+};
+
+unsigned int
+Odr_lines_job::add_location(const Symbol_location& loc)
+{
+  unsigned int index = this->locations_.size();
+  this->locations_.push_back(loc);
+  this->linenos_.push_back(std::vector<std::string>());
+
+  Object_index::const_iterator p = this->object_index_.find(loc.object);
+  if (p == this->object_index_.end())
+    {
+      std::pair<Piece_index::iterator, bool> ins =
+	this->piece_index_.insert(std::make_pair(loc.object->input_file(),
+						 this->pieces_.size()));
+      if (ins.second)
+	this->pieces_.push_back(Piece());
+      unsigned int piece = ins.first->second;
+      Object_locations ol;
+      ol.object = loc.object;
+      this->pieces_[piece].push_back(ol);
+      unsigned int pos = this->pieces_[piece].size() - 1;
+      p = this->object_index_.insert(
+	  std::make_pair(loc.object, std::make_pair(piece, pos))).first;
+    }
+  this->pieces_[p->second.first][p->second.second].locations.push_back(index);
+  return index;
+}
+
+void
+Odr_lines_job::run_piece(unsigned int index)
+{
+  const Piece& piece(this->pieces_[index]);
+  for (Piece::const_iterator p = piece.begin(); p != piece.end(); ++p)
+    {
+      // We need to lock the object in order to read it.
+      Task_lock_obj<Object> tl(this->task_, p->object);
+      Dwarf_line_info* lineinfo = Dwarf_line_info::make(p->object);
+      for (std::vector<unsigned int>::const_iterator q = p->locations.begin();
+	   q != p->locations.end();
+	   ++q)
+	this->linenos_[*q] = linenos_from_loc(lineinfo, this->locations_[*q]);
+      delete lineinfo;
+    }
+}
+
+// A job which compares the source lines of the definitions of each
+// candidate symbol.  The warnings are printed after the job has run,
+// in the order in which the symbols were added, so that the output
+// does not depend on the number of threads.
+
+class Odr_check_job : public Parallel_job
+{
+ public:
+  Odr_check_job(const Odr_lines_job* lines)
+    : lines_(lines), symbols_()
+  { }
+
+  // Add a symbol named NAME whose definitions have the locations
+  // LOCATIONS, which are indexes in the Odr_lines_job.
+  void
+  add_symbol(const char* name, const std::vector<unsigned int>& locations)
+  {
+    Odr_symbol sym;
+    sym.name = name;
+    sym.locations = locations;
+    sym.is_violation = false;
+    this->symbols_.push_back(sym);
+  }
+
+  // Return the number of pieces.
+  unsigned int
+  piece_count() const
+  {
+    return ((this->symbols_.size() + symbols_per_piece - 1)
+	    / symbols_per_piece);
+  }
+
+  void
+  run_piece(unsigned int index);
+
+  // Warn about the violations which were found.
+  void
+  report(const char* output_file_name) const;
+
+ private:
+  // The number of symbols checked by each piece.
+  static const size_t symbols_per_piece = 64;
+
+  // A candidate symbol.
+  struct Odr_symbol
+  {
+    // The name of the symbol.
+    const char* name;
+    // The indexes of its locations.
+    std::vector<unsigned int> locations;
+    // Whether the definitions were found to be different.
+    bool is_violation;
+    // If is_violation, the locations of two differing definitions,
+    // and the canonical lines of each.
+    unsigned int first_location;
+    unsigned int second_location;
+    std::string first_lineno;
+    std::string second_lineno;
+  };
+
+  // Check one symbol.
+  void
+  check_symbol(Odr_symbol*) const;
+
+  const Odr_lines_job* lines_;
+  std::vector<Odr_symbol> symbols_;
+};
+
+void
+Odr_check_job::run_piece(unsigned int index)
+{
+  size_t start = index * symbols_per_piece;
+  size_t end = std::min(start + symbols_per_piece, this->symbols_.size());
+  for (size_t i = start; i < end; ++i)
+    this->check_symbol(&this->symbols_[i]);
+}
+
+// Compare the line numbers of the first definition of SYM with those
+// of the other definitions.
+
+void
+Odr_check_job::check_symbol(Odr_symbol* sym) const
+{
+  std::vector<std::string> first_object_linenos;
+  unsigned int first_location = 0;
+
+  std::vector<unsigned int>::const_iterator locs = sym->locations.begin();
+  const std::vector<unsigned int>::const_iterator locs_end =
+    sym->locations.end();
+  for (; locs != locs_end && first_object_linenos.empty(); ++locs)
+    {
+      // Save the line numbers from the first definition to compare
+      // to the other definitions.  Ideally, we'd compare every
+      // definition to every other, but we don't want to take O(N^2)
+      // time to do this.  This shortcut may cause false negatives
+      // that appear or disappear depending on the link order, but it
+      // won't cause false positives.
+      first_location = *locs;
+      first_object_linenos = this->lines_->linenos(*locs);
+    }
+  if (first_object_linenos.empty())
+    return;
+
+  // Sort by Odr_violation_compare to make std::set_intersection work.
+  std::string first_object_canonical_result = first_object_linenos.back();
+  std::sort(first_object_linenos.begin(), first_object_linenos.end(),
+	    Odr_violation_compare());
+
+  for (; locs != locs_end; ++locs)
+    {
+      std::vector<std::string> linenos = this->lines_->linenos(*locs);
+      // linenos will be empty if we couldn't parse the debug info.
+      if (linenos.empty())
+	continue;
+      // Sort by Odr_violation_compare to make std::set_intersection work.
+      std::string second_object_canonical_result = linenos.back();
+      std::sort(linenos.begin(), linenos.end(), Odr_violation_compare());
+
+      Check_intersection intersection_result =
+	  std::set_intersection(first_object_linenos.begin(),
+				first_object_linenos.end(),
+				linenos.begin(),
+				linenos.end(),
+				Check_intersection(),
+				Odr_violation_compare());
+      if (!intersection_result.had_intersection())
+	{
+	  // Only record one broken pair, to avoid needing to compare
+	  // against a list of the disjoint definition locations we've
+	  // found so far.  (If we kept comparing against just the
+	  // first one, we'd get a lot of redundant complaints about
+	  // the second definition location.)
+	  sym->is_violation = true;
+	  sym->first_location = first_location;
+	  sym->second_location = *locs;
+	  sym->first_lineno = first_object_canonical_result;
+	  sym->second_lineno = second_object_canonical_result;
+	  break;
+	}
+    }
+}
+
+void
+Odr_check_job::report(const char* output_file_name) const
+{
+  for (std::vector<Odr_symbol>::const_iterator p = this->symbols_.begin();
+       p != this->symbols_.end();
+       ++p)
+    {
+      if (!p->is_violation)
+	continue;
+      gold_warning(_("while linking %s: symbol '%s' defined in "
+		     "multiple places (possible ODR violation):"),
+		   output_file_name, demangle(p->name).c_str());
+      // This only prints one location from each definition, which may
+      // not be the location we expect to intersect with another
+      // definition.  We could print the whole set of locations, but
+      // that seems too verbose.
+      const Object* first = this->lines_->location(p->first_location).object;
+      const Object* second =
+	this->lines_->location(p->second_location).object;
+      fprintf(stderr, _("  %s from %s\n"),
+	      p->first_lineno.c_str(), first->name().c_str());
+      fprintf(stderr, _("  %s from %s\n"),
+	      p->second_lineno.c_str(), second->name().c_str());
+    }
+}
+
 // Check candidate_odr_violations_ to find symbols with the same name
 // but apparently different definitions (different source-file/line-no
-// for each line assigned to the first instruction).
+// for each line assigned to the first instruction).  This runs in the
+// singleton Layout_task_runner task, but with --threads the line
+// information is read and compared by several threads.
 
 void
 Symbol_table::detect_odr_violations(const Task* task,
-				    const char* output_file_name) const
+				    const char* output_file_name)
 {
+  if (this->candidate_odr_violations_.empty())
+    return;
+
+  uint64_t start_usec = Timer::wall_time_usec();
+
+  Odr_lines_job lines(task);
+  Odr_check_job check(&lines);
   for (Odr_map::const_iterator it = candidate_odr_violations_.begin();
        it != candidate_odr_violations_.end();
        ++it)
     {
-      const char* const symbol_name = it->first;
-
-      std::string first_object_name;
-      std::vector<std::string> first_object_linenos;
-
-      Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs = it->second.begin();
-      const Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs_end = it->second.end();
-      for (; locs != locs_end && first_object_linenos.empty(); ++locs)
-        {
-          // Save the line numbers from the first definition to
-          // compare to the other definitions.  Ideally, we'd compare
-          // every definition to every other, but we don't want to
-          // take O(N^2) time to do this.  This shortcut may cause
-          // false negatives that appear or disappear depending on the
-          // link order, but it won't cause false positives.
-          first_object_name = locs->object->name();
-          first_object_linenos = this->linenos_from_loc(task, *locs);
-        }
-      if (first_object_linenos.empty())
-	continue;
+      std::vector<unsigned int> locations;
+      for (Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
+	     p = it->second.begin();
+	   p != it->second.end();
+	   ++p)
+	locations.push_back(lines.add_location(*p));
+      check.add_symbol(it->first, locations);
+    }
 
-      // Sort by Odr_violation_compare to make std::set_intersection work.
-      std::string first_object_canonical_result = first_object_linenos.back();
-      std::sort(first_object_linenos.begin(), first_object_linenos.end(),
-                Odr_violation_compare());
+  lines.run(lines.piece_count());
+  check.run(check.piece_count());
+  check.report(output_file_name);
 
-      for (; locs != locs_end; ++locs)
-        {
-          std::vector<std::string> linenos =
-              this->linenos_from_loc(task, *locs);
-          // linenos will be empty if we couldn't parse the debug info.
-          if (linenos.empty())
-            continue;
-          // Sort by Odr_violation_compare to make std::set_intersection work.
-          gold_assert(!linenos.empty());
-          std::string second_object_canonical_result = linenos.back();
-          std::sort(linenos.begin(), linenos.end(), Odr_violation_compare());
-
-          Check_intersection intersection_result =
-              std::set_intersection(first_object_linenos.begin(),
-                                    first_object_linenos.end(),
-                                    linenos.begin(),
-                                    linenos.end(),
-                                    Check_intersection(),
-                                    Odr_violation_compare());
-          if (!intersection_result.had_intersection())
-            {
-              gold_warning(_("while linking %s: symbol '%s' defined in "
-                             "multiple places (possible ODR violation):"),
-                           output_file_name, demangle(symbol_name).c_str());
-              // This only prints one location from each definition,
-              // which may not be the location we expect to intersect
-              // with another definition.  We could print the whole
-              // set of locations, but that seems too verbose.
-              fprintf(stderr, _("  %s from %s\n"),
-                      first_object_canonical_result.c_str(),
-                      first_object_name.c_str());
-              fprintf(stderr, _("  %s from %s\n"),
-                      second_object_canonical_result.c_str(),
-                      locs->object->name().c_str());
-              // Only print one broken pair, to avoid needing to
-              // compare against a list of the disjoint definition
-              // locations we've found so far.  (If we kept comparing
-              // against just the first one, we'd get a lot of
-              // redundant complaints about the second definition
-              // location.)
-              break;
-            }
-        }
-    }
-  // We only call one_addr2line() in this function, so we can clear its cache.
-  Dwarf_line_info::clear_addr2line_cache();
+  this->odr_symbol_count_ = this->candidate_odr_violations_.size();
+  this->odr_location_count_ = lines.location_count();
+  this->odr_object_count_ = lines.object_count();
+  this->odr_usec_ = Timer::wall_time_usec() - start_usec;
 }
 
 // Warnings functions.
@@ -3715,6 +4195,7 @@ Symbol_table::add_from_relobj<32, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Prepared_symbols* prepared,
     Sized_relobj_file<32, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3729,6 +4210,7 @@ Symbol_table::add_from_relobj<32, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Prepared_symbols* prepared,
     Sized_relobj_file<32, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3743,6 +4225,7 @@ Symbol_table::add_from_relobj<64, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Prepared_symbols* prepared,
     Sized_relobj_file<64, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3757,6 +4240,7 @@ Symbol_table::add_from_relobj<64, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Prepared_symbols* prepared,
     Sized_relobj_file<64, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -1464,18 +1464,34 @@ class Symbol_table
   // Add COUNT external symbols from the relocatable object RELOBJ to
   // the symbol table.  SYMS is the symbols, SYMNDX_OFFSET is the
   // offset in the symbol table of the first symbol, SYM_NAMES is
-  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  This sets
-  // SYMPOINTERS to point to the symbols in the symbol table.  It sets
-  // *DEFINED to the number of defined symbols.
+  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  PREPARED,
+  // if not NULL, is the information computed by prepare_symbol_name
+  // for each symbol.  This sets SYMPOINTERS to point to the symbols
+  // in the symbol table.  It sets *DEFINED to the number of defined
+  // symbols.
   template<int size, bool big_endian>
   void
   add_from_relobj(Sized_relobj_file<size, big_endian>* relobj,
 		  const unsigned char* syms, size_t count,
 		  size_t symndx_offset, const char* sym_names,
 		  size_t sym_name_size,
+		  const Prepared_symbols* prepared,
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
+  // Split NAME, the name of a symbol in a relocatable object, into
+  // the name and any version, and compute the hash code of the name.
+  // This does not depend on the contents of the symbol table, so it
+  // may be called from any thread.
+  static void
+  prepare_symbol_name(const char* name, Prepared_symbol*);
+
+  // Look up NAME, a defined symbol prepared by prepare_symbol_name, in
+  // the version script, and record the result in the Prepared_symbol.
+  // This may also be called from any thread.
+  void
+  prepare_symbol_version(const char* name, Prepared_symbol*) const;
+
   // Add one external symbol from the plugin object OBJ to the symbol table.
   // Returns a pointer to the resolved symbol in the symbol table.
   template<int size, bool big_endian>
@@ -1606,8 +1622,10 @@ class Symbol_table
 
   // Check candidate_odr_violations_ to find symbols with the same name
   // but apparently different definitions (different source-file/line-no).
+  // With --threads the line information is read and compared by
+  // several threads.
   void
-  detect_odr_violations(const Task*, const char* output_file_name) const;
+  detect_odr_violations(const Task*, const char* output_file_name);
 
   // Add any undefined symbols named on the command line to the symbol
   // table.
@@ -1904,12 +1922,6 @@ class Symbol_table
   do_allocate_commons_list(Layout*, Commons_section_type, Commons_type*,
 			   Mapfile*, Sort_commons_order);
 
-  // Returns all of the lines attached to LOC, not just the one the
-  // instruction actually came from.  This helps the ODR checker avoid
-  // false positives.
-  static std::vector<std::string>
-  linenos_from_loc(const Task* task, const Symbol_location& loc);
-
   // Implement detect_odr_violations.
   template<int size, bool big_endian>
   void
@@ -1938,6 +1950,27 @@ class Symbol_table
 		      Output_symtab_xindex*, Output_symtab_xindex*,
 		      Output_file*) const;
 
+  // Write out the global symbol SYM to the views PSYMS and
+  // DYNAMIC_VIEW.  If the symbol needs an extended section index,
+  // return the index; otherwise return 0.
+  template<int size, bool big_endian>
+  unsigned int
+  sized_write_global(Sized_symbol<size>* sym, const Stringpool* sympool,
+		     const Stringpool* dynpool, unsigned char* psyms,
+		     unsigned char* dynamic_view) const;
+
+  // Add SYM, in the output section with index SHNDX, to the extended
+  // section index tables.
+  void
+  add_global_xindex(const Symbol* sym, unsigned int shndx,
+		    Output_symtab_xindex* symtab_xindex,
+		    Output_symtab_xindex* dynsym_xindex,
+		    bool write_dynamic) const;
+
+  // A Parallel_job which writes out a range of the global symbols.
+  template<int size, bool big_endian>
+  class Write_globals_job;
+
   // Write out a symbol to P.
   template<int size, bool big_endian>
   void
@@ -2012,6 +2045,13 @@ class Symbol_table
   Warnings warnings_;
   // Manage potential One Definition Rule (ODR) violations.
   Odr_map candidate_odr_violations_;
+  // Statistics about detect_odr_violations, for --stats: the number
+  // of candidate symbols, of their locations, and of the objects
+  // whose line information was read, and the time taken.
+  size_t odr_symbol_count_;
+  size_t odr_location_count_;
+  size_t odr_object_count_;
+  uint64_t odr_usec_;
 
   // When we emit a COPY reloc for a symbol, we define it in an
   // Output_data.  When it's time to emit version information for it,
@@ -274,6 +274,13 @@ class Target
   reloc_addend(void* arg, unsigned int type, uint64_t addend) const
   { return this->do_reloc_addend(arg, type, addend); }
 
+  // Return the type of the RELATIVE dynamic reloc which may be packed
+  // into a .relr.dyn section for -z pack-relative-relocs, or -1U if
+  // the target does not support that.
+  unsigned int
+  relr_reloc_type() const
+  { return this->do_relr_reloc_type(); }
+
   // Return the PLT address to use for a global symbol.
   uint64_t
   plt_address_for_global(const Symbol* sym) const
@@ -637,6 +644,13 @@ class Target
   do_reloc_addend(void*, unsigned int, uint64_t) const
   { gold_unreachable(); }
 
+  // Virtual function which may be overridden by a target which
+  // supports packed relative relocs.  The target must write the final
+  // value of the relocation into the section contents.
+  virtual unsigned int
+  do_relr_reloc_type() const
+  { return -1U; }
+
   // Virtual functions that must be overridden by a target that uses
   // STT_GNU_IFUNC symbols.
   virtual uint64_t
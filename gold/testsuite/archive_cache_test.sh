@@ -0,0 +1,51 @@
+#!/bin/sh
+
+# archive_cache_test.sh -- test --archive-cache
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The first link with --archive-cache writes the symbol map of
+# libweak_undef_2.a to the cache directory, and the second link reads
+# it from there.  Check that both give the same output file as a link
+# without the cache, and that the second link used the cache.
+
+if ! cmp -s archive_cache_test_1 archive_cache_test_2; then
+  echo "archive_cache_test_1 and archive_cache_test_2 differ"
+  exit 1
+fi
+
+if ! cmp -s archive_cache_test_1 archive_cache_test_3; then
+  echo "archive_cache_test_1 and archive_cache_test_3 differ"
+  exit 1
+fi
+
+if ! grep -q "archive cache hits: [1-9]" archive_cache_test_3.stats; then
+  echo "Did not find archive cache hits in archive_cache_test_3.stats:"
+  cat archive_cache_test_3.stats
+  exit 1
+fi
+
+if ! grep -q "archive cache misses: 0" archive_cache_test_3.stats; then
+  echo "Found archive cache misses in archive_cache_test_3.stats:"
+  cat archive_cache_test_3.stats
+  exit 1
+fi
+
+exit 0
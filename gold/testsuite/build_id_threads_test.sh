@@ -0,0 +1,45 @@
+#!/bin/sh
+
+# build_id_threads_test.sh -- test chunked build IDs with threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The chunks of a tree-style or fast build ID are hashed while the
+# output file is being written when using threads.  Check that this
+# gives the same output as a single-threaded link, and that a fast
+# build ID is 8 bytes long.
+
+if ! cmp -s build_id_threads_test_1 build_id_threads_test_2; then
+  echo "build_id_threads_test_1 and build_id_threads_test_2 differ"
+  exit 1
+fi
+
+if ! cmp -s build_id_threads_test_3 build_id_threads_test_4; then
+  echo "build_id_threads_test_3 and build_id_threads_test_4 differ"
+  exit 1
+fi
+
+if ! grep -q "Build ID: [0-9a-f]\{16\}$" build_id_threads_test.stdout; then
+  echo "Did not find expected fast build ID in build_id_threads_test.stdout:"
+  cat build_id_threads_test.stdout
+  exit 1
+fi
+
+exit 0
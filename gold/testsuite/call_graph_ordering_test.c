@@ -0,0 +1,44 @@
+// call_graph_ordering_test.c -- test --call-graph-ordering-file
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// Each function is compiled into its own section with
+// -ffunction-sections.  The profile used for the link says that
+// main calls hot_a, which calls hot_b, which calls hot_c, so gold
+// should place those four together, in that order, ahead of cold_1
+// and cold_2.
+
+#define NOINLINE __attribute__ ((noinline, noclone))
+
+int NOINLINE cold_1(int i) { return i * 3 + 1; }
+int NOINLINE hot_c(int i) { return i + 7; }
+int NOINLINE cold_2(int i) { return cold_1(i) - 2; }
+int NOINLINE hot_b(int i) { return hot_c(i) * 2; }
+int NOINLINE hot_a(int i) { return hot_b(i) - 1; }
+
+int
+main(void)
+{
+  if (hot_a(1) != 15)
+    return 1;
+  if (cold_2(1) != 2)
+    return 1;
+  return 0;
+}
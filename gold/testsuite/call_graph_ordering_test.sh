@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# call_graph_ordering_test.sh -- test --call-graph-ordering-file
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# call_graph_ordering_test was linked with a profile in which main
+# calls hot_a, hot_a calls hot_b, and hot_b calls hot_c.  Check that
+# those functions come first, in that order, followed by the
+# functions which are not in the profile, and that --stats counted
+# the one name which is not defined.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check call_graph_ordering_test.err "call graph names not found: 1"
+check call_graph_ordering_test.err "call graph edges used: 3"
+check call_graph_ordering_test.err "call graph sections ordered: 4 in 1 clusters"
+
+order=`awk '$3 ~ /^(main|hot_[abc]|cold_[12])$/ { printf "%s ", $3 }' \
+    call_graph_ordering_test.stdout`
+if test "$order" != "main hot_a hot_b hot_c cold_1 cold_2 "
+then
+    echo "Unexpected order of functions: $order"
+    echo ""
+    echo "Actual output below:"
+    cat call_graph_ordering_test.stdout
+    exit 1
+fi
+
+if ! ./call_graph_ordering_test
+then
+    echo "call_graph_ordering_test failed"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,85 @@
+#!/bin/sh
+
+# compress_debug_sections_threads.sh -- test parallel compression
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Output sections are compressed in independent 1 MiB chunks, which
+# are compressed in parallel.  The input has a 4.8 MB debug section.
+# Check that each of its five chunks was compressed by a task, that
+# the compressed section decompresses to the same contents as an
+# uncompressed link, and that linking with several threads produces
+# the same output as a single-threaded link.  Do the same for zstd,
+# unless gold was built without zstd support.
+
+check()
+{
+  if ! grep -q -- "$2" "$1"
+  then
+    echo "Did not find expected output in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+check_count()
+{
+  if test "`grep -c -- "$2" "$1"`" != "$3"
+  then
+    echo "Expected $3 matches in $1:"
+    echo "   $2"
+    exit 1
+  fi
+}
+
+check_same()
+{
+  if ! cmp -s "$1" "$2"; then
+    echo "$1 and $2 differ"
+    exit 1
+  fi
+}
+
+check compress_debug_sections_threads_zlib_2.stdout \
+  ' \.debug_gold_test .* C  '
+check_count compress_debug_sections_threads_zlib_2.json \
+  '"name":"Compress_chunk_task \.debug_gold_test"' 5
+check_same compress_debug_sections_threads_none.dec \
+  compress_debug_sections_threads_zlib_2.dec
+check_same compress_debug_sections_threads_zlib_1 \
+  compress_debug_sections_threads_zlib_2
+
+if grep -q 'without zstd support' compress_debug_sections_threads_zstd.err
+then
+  echo "zstd not supported, skipping the zstd checks"
+  exit 0
+fi
+
+check compress_debug_sections_threads_zstd.stdout \
+  ' \.debug_gold_test .* C  '
+check_count compress_debug_sections_threads_zstd.json \
+  '"name":"Compress_chunk_task \.debug_gold_test"' 5
+check_same compress_debug_sections_threads_none.dec \
+  compress_debug_sections_threads_zstd.dec
+
+exit 0
@@ -90,6 +90,20 @@ check debug_msg.err ": symbol 'SometimesInlineFunction(int)' defined in multiple
 check debug_msg.err "debug_msg.cc:6[89]"
 check debug_msg.err "odr_violation2.cc:3[0-7]"
 
+# Check for the same ODR violations when the debug information is
+# read by several threads.
+check debug_msg_threads.err ": symbol 'Ordering::operator()(int, int)' defined in multiple places (possible ODR violation):"
+check debug_msg_threads.err "odr_violation1.cc:6"
+check debug_msg_threads.err "odr_violation2.cc:1[256]"
+check_missing debug_msg_threads.err "OdrDerived::~OdrDerived()"
+check_missing debug_msg_threads.err "__adjust_heap"
+check_missing debug_msg_threads.err ": symbol 'OverriddenCFunction' defined in multiple places (possible ODR violation):"
+check debug_msg_threads.err ": symbol 'SometimesInlineFunction(int)' defined in multiple places (possible ODR violation):"
+check debug_msg_threads.err "debug_msg.cc:6[89]"
+check debug_msg_threads.err "odr_violation2.cc:3[0-7]"
+check debug_msg_threads.err "ODR candidate symbols: [1-9]"
+check debug_msg_threads.err "ODR check time: "
+
 # Check for the same error messages when using --compressed-debug-sections.
 if test -r debug_msg_cdebug.err
 then
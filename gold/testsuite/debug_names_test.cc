@@ -0,0 +1,76 @@
+// debug_names_test.cc -- a test case for the --debug-names option.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This source file defines nested scopes, whose DIEs are indexed by
+// their own names in the .debug_names section, with a reference to
+// the entry for the enclosing scope.  It is compiled with DWARF 5.
+
+namespace dn_outer
+{
+int dn_outer_var = 1;
+
+namespace dn_inner
+{
+
+struct dn_struct
+{
+  int dn_member;
+  static int dn_count;
+  int dn_get();
+};
+
+int dn_struct::dn_count;
+
+int
+dn_struct::dn_get()
+{ return this->dn_member + dn_count; }
+
+enum dn_color
+{
+  DN_RED,
+  DN_GREEN
+};
+
+enum class dn_shape
+{
+  DN_SQUARE,
+  DN_CIRCLE
+};
+
+} // End namespace dn_inner.
+} // End namespace dn_outer.
+
+namespace
+{
+int dn_anon_var;
+}
+
+int
+dn_function(int i)
+{
+  static int dn_static_local;
+  dn_outer::dn_inner::dn_struct s;
+  s.dn_member = i;
+  dn_static_local += s.dn_get() + dn_anon_var;
+  if (dn_outer::dn_inner::DN_GREEN == i)
+    return static_cast<int>(dn_outer::dn_inner::dn_shape::DN_CIRCLE);
+  return dn_static_local;
+}
@@ -0,0 +1,172 @@
+#!/bin/sh
+
+# debug_names_test.sh -- test --debug-names
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT=debug_names_test.stdout
+
+check $STDOUT "Contents of the .debug_names section"
+check $STDOUT "^Version 5"
+check_missing $STDOUT "\.gdb_index"
+
+# Each DIE is indexed by its own name, from both the DWARF 4 and the
+# DWARF 5 objects, along with the tag of the DIE.
+
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* main: .*DW_TAG_subprogram"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* main_3: .*DW_TAG_subprogram"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* check_int: .*DW_TAG_subprogram"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* check_enum: .*DW_TAG_subprogram"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* c1v: .*DW_TAG_variable.*DW_IDX_parent"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* one: .*DW_TAG_namespace"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* anonymous_union_var: .*DW_TAG_variable"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* dn_outer: .*DW_TAG_namespace"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* dn_inner: .*DW_TAG_namespace.*DW_IDX_parent"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* dn_struct: .*DW_TAG_structure_type.*DW_IDX_parent"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* dn_get: .*DW_TAG_subprogram.*DW_IDX_parent"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* dn_function: .*DW_TAG_subprogram"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* dn_static_local: .*DW_TAG_variable.*DW_IDX_parent"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* (anonymous namespace):"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* _ZN8dn_outer8dn_inner9dn_struct6dn_getEv: .*DW_TAG_subprogram"
+
+# Qualified names are not used, and neither are members, parameters
+# and local variables.
+check_missing $STDOUT " one::c1v: "
+check_missing $STDOUT " two::c2<int>::c2: "
+check_missing $STDOUT " dn_member: "
+check_missing $STDOUT " s: "
+
+# Check the parent of some entries with llvm-dwarfdump, which gives
+# the offset of each entry.  The DW_IDX_parent attribute is the offset
+# of the parent entry in the entry pool, which starts with the first
+# entry.  Spaces in the names are replaced by underscores.
+
+DUMP=debug_names_test.dump
+VERIFY=debug_names_test.verify
+
+if grep -q "not found" $DUMP
+then
+    echo "llvm-dwarfdump not found; not checking parents"
+    exit 0
+fi
+
+awk '/String:/ { name = $0; sub(/^[^"]*"/, "", name); sub(/"$/, "", name);
+		gsub(/ /, "_", name) }
+     /Entry @/ { off = $3; tag = ""; parent = "-" }
+     /Tag:/ { tag = $2 }
+     /DW_IDX_parent:/ { parent = $2 }
+     /^ *}$/ { if (off != "") print off, name, tag, parent; off = "" }' \
+    $DUMP > debug_names_test.entries
+
+base=
+while read off name tag parent
+do
+    if test -z "$base" || test $((off)) -lt $((base))
+    then
+	base=$off
+    fi
+done < debug_names_test.entries
+
+# Print the name of the parent of the entry for NAME with TAG.
+parent_of()
+{
+    parent=`awk -v name="$1" -v tag="$2" \
+	'$2 == name && $3 == tag { print $4; exit }' debug_names_test.entries`
+    if test -z "$parent" || test "$parent" = "-"
+    then
+	echo "-"
+	return
+    fi
+    target=$((base + parent))
+    while read off name tag p
+    do
+	if test $((off)) -eq $target
+	then
+	    echo "$name"
+	    return
+	fi
+    done < debug_names_test.entries
+    echo "?"
+}
+
+check_parent()
+{
+    parent=`parent_of "$1" "$2"`
+    if test "$parent" != "$3"
+    then
+	echo "Parent of $1 is $parent, expected $3"
+	exit 1
+    fi
+}
+
+check_parent dn_outer DW_TAG_namespace -
+check_parent dn_outer_var DW_TAG_variable dn_outer
+check_parent dn_inner DW_TAG_namespace dn_outer
+check_parent dn_struct DW_TAG_structure_type dn_inner
+check_parent dn_count DW_TAG_variable dn_struct
+check_parent dn_get DW_TAG_subprogram dn_struct
+check_parent DN_RED DW_TAG_enumerator dn_inner
+check_parent DN_CIRCLE DW_TAG_enumerator dn_shape
+check_parent dn_anon_var DW_TAG_variable "(anonymous_namespace)"
+check_parent dn_static_local DW_TAG_variable dn_function
+check_parent c1v DW_TAG_variable one
+check_parent c1 DW_TAG_class_type one
+
+check $VERIFY "Verifying .debug_names"
+if sed -n '/^Verifying .debug_names/,$p' $VERIFY | grep -q "error:"
+then
+    echo "llvm-dwarfdump found errors in .debug_names:"
+    cat $VERIFY
+    exit 1
+fi
+
+# Debug info with type units cannot be indexed, so the section is
+# empty.
+
+check debug_names_test_2.err "cannot index debug info for --debug-names (type units are not supported)"
+check debug_names_test_2.stdout "\.debug_names *PROGBITS *[0-9a-f]* [0-9a-f]* 000000 "
+
+exit 0
@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# dwp_test_3.sh -- Test the dwp tool with --threads.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# dwp_test_3.dwp is built from the same inputs as dwp_test_1.dwp,
+# but reading the input files in parallel.  The input files are
+# still added in order, so the output should be identical.
+
+check_num()
+{
+    n=$(grep -c "$2" "$1")
+    if test "$n" -ne "$3"
+    then
+	echo "Found $n occurrences (should find $3):"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT="dwp_test_3.stdout"
+
+check_num $STDOUT "DW_TAG_compile_unit" 4
+check_num $STDOUT "DW_TAG_type_unit" 3
+
+if ! cmp -s dwp_test_1.dwp dwp_test_3.dwp
+then
+    echo "dwp_test_3.dwp differs from dwp_test_1.dwp"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/sh
+
+# eh_frame_threads_test.sh -- test parallel .eh_frame parsing.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# When using threads, the .eh_frame sections are parsed by parallel
+# tasks, and the .eh_frame_hdr table is built by merging sorted runs.
+# Check that the output is the same as a single-threaded link, also
+# when --gc-sections discards some of the FDEs.
+
+check()
+{
+  if ! cmp -s "$1" "$2"; then
+    echo "$1 and $2 differ"
+    exit 1
+  fi
+}
+
+check eh_frame_threads_test_1 eh_frame_threads_test_2
+check eh_frame_threads_test_3 eh_frame_threads_test_4
+
+exit 0
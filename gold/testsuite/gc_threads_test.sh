@@ -0,0 +1,44 @@
+#!/bin/sh
+
+# gc_threads_test.sh -- test --gc-sections with threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The sections reached for --gc-sections are marked by parallel tasks
+# when using threads.  Check that this removes the same sections as a
+# single-threaded link.
+
+if ! cmp -s gc_threads_test_1 gc_threads_test_2; then
+  echo "gc_threads_test_1 and gc_threads_test_2 differ"
+  exit 1
+fi
+
+if ! grep -q "removing unused section" gc_threads_test_1.err; then
+  echo "Did not find removed sections in gc_threads_test_1.err:"
+  cat gc_threads_test_1.err
+  exit 1
+fi
+
+if ! cmp -s gc_threads_test_1.err gc_threads_test_2.err; then
+  echo "gc_threads_test_1.err and gc_threads_test_2.err differ"
+  exit 1
+fi
+
+exit 0
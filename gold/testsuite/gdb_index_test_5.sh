@@ -0,0 +1,39 @@
+#!/bin/sh
+
+# gdb_index_test_5.sh -- test --gdb-index with threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The .gdb_index section should be the same whether or not the debug
+# info is scanned in parallel tasks.
+
+if ! cmp -s gdb_index_test_5 gdb_index_test_5_threads
+then
+    echo "gdb_index_test_5 and gdb_index_test_5_threads differ"
+    exit 1
+fi
+
+if ! grep -q "^\[ *[0-9]*\] check_int:" gdb_index_test_5.stdout
+then
+    echo "Did not find check_int in gdb_index_test_5.stdout"
+    exit 1
+fi
+
+exec ${srcdir}/gdb_index_test_comm.sh gdb_index_test_5.stdout
@@ -0,0 +1,42 @@
+/* hash_optimize_test.h -- test --hash-optimize for gold
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* Apply F to the hex digit strings 1000 through 4fff.  This gives
+   enough dynamic symbols that gold builds the hash tables in several
+   pieces when using threads.  */
+
+#define HEX16(F, p) \
+  F(p##0) F(p##1) F(p##2) F(p##3) F(p##4) F(p##5) F(p##6) F(p##7) \
+  F(p##8) F(p##9) F(p##a) F(p##b) F(p##c) F(p##d) F(p##e) F(p##f)
+#define HEX256(F, p) \
+  HEX16(F, p##0) HEX16(F, p##1) HEX16(F, p##2) HEX16(F, p##3) \
+  HEX16(F, p##4) HEX16(F, p##5) HEX16(F, p##6) HEX16(F, p##7) \
+  HEX16(F, p##8) HEX16(F, p##9) HEX16(F, p##a) HEX16(F, p##b) \
+  HEX16(F, p##c) HEX16(F, p##d) HEX16(F, p##e) HEX16(F, p##f)
+#define HEX4096(F, p) \
+  HEX256(F, p##0) HEX256(F, p##1) HEX256(F, p##2) HEX256(F, p##3) \
+  HEX256(F, p##4) HEX256(F, p##5) HEX256(F, p##6) HEX256(F, p##7) \
+  HEX256(F, p##8) HEX256(F, p##9) HEX256(F, p##a) HEX256(F, p##b) \
+  HEX256(F, p##c) HEX256(F, p##d) HEX256(F, p##e) HEX256(F, p##f)
+#define ALL(F) HEX4096(F, 1) HEX4096(F, 2) HEX4096(F, 3) HEX4096(F, 4)
+
+#define FIRST 0x1000
+#define COUNT 0x4000
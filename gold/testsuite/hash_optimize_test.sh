@@ -0,0 +1,79 @@
+#!/bin/sh
+
+# hash_optimize_test.sh -- test --hash-optimize
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The dynamic hash tables are built in parallel when using threads.
+# Check that the output is the same as a single-threaded link, both
+# with and without --hash-optimize, and that --hash-optimize changes
+# the tables.  Check that the pieces ran as tasks on the four
+# workqueue threads, rather than on threads of their own.  Then check
+# that the dynamic linker finds all the symbols using the GNU and the
+# standard ELF hash tables, and that --stats reports on both tables.
+
+check_same()
+{
+  if ! cmp -s "$1" "$2"; then
+    echo "$1 and $2 differ"
+    exit 1
+  fi
+}
+
+check()
+{
+  if ! grep -q "$2" "$1"
+  then
+    echo "Did not find expected output in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+check_same hash_optimize_test_1.so hash_optimize_test_2.so
+check_same hash_optimize_test_3.so hash_optimize_test_4.so
+
+check hash_optimize_test_2.json '"name":"Parallel_job_task"'
+if grep -o '"tid":[0-9]*' hash_optimize_test_2.json | grep -qv '"tid":[0-3]$'
+then
+  echo "hash_optimize_test_2.json has a task on a thread above 3"
+  exit 1
+fi
+
+if cmp -s hash_optimize_test_1.so hash_optimize_test_3.so; then
+  echo "--hash-optimize did not change the hash tables"
+  exit 1
+fi
+
+for t in hash_optimize_test_1 hash_optimize_test_5; do
+  if ! ./$t; then
+    echo "$t failed"
+    exit 1
+  fi
+done
+
+check hash_optimize_test.err ": \.gnu\.hash buckets: "
+check hash_optimize_test.err ": \.gnu\.hash bloom filter bits: "
+check hash_optimize_test.err ": \.hash chain entries read per defined symbol lookup: "
+
+exit 0
@@ -0,0 +1,43 @@
+/* hash_optimize_test_main.c -- test --hash-optimize for gold
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* Call every function in the shared library.  The dynamic linker
+   looks up each of them through the hash tables gold built.  */
+
+#include "hash_optimize_test.h"
+
+#define DECLARE(p) extern int f_##p(void);
+#define ADDRESS(p) &f_##p,
+
+ALL(DECLARE)
+
+static int (*const funcs[])(void) = { ALL(ADDRESS) };
+
+int
+main(void)
+{
+  int i;
+
+  for (i = 0; i < COUNT; ++i)
+    if (funcs[i]() != FIRST + i)
+      return 1;
+  return 0;
+}
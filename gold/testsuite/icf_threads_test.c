@@ -0,0 +1,90 @@
+/* icf_threads_test.c -- test identical code folding with threads
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* This file is compiled several times with different values of FILE,
+   with each function in a section of its own.  With threads, gold
+   computes the checksums of the sections of each object in a task of
+   its own, so the sections of different objects are compared after
+   being handled by different tasks.
+
+   icf_same_N is the same in every object, and is folded into
+   icf_same_1.  icf_caller_N only becomes identical to icf_caller_1
+   once the icf_same_N it calls is folded, which takes a second
+   iteration.  icf_diff_N is different in every object.  */
+
+#define CAT2(a, b) a ## b
+#define CAT(a, b) CAT2(a, b)
+
+#define SAME CAT(icf_same_, FILE)
+#define CALLER CAT(icf_caller_, FILE)
+#define DIFF CAT(icf_diff_, FILE)
+
+int SAME(int) __attribute__ ((noinline));
+int CALLER(int) __attribute__ ((noinline));
+int DIFF(int) __attribute__ ((noinline));
+
+int
+SAME(int x)
+{
+  return x * 7 + 3;
+}
+
+int
+CALLER(int x)
+{
+  return SAME(x + 1) * 5;
+}
+
+int
+DIFF(int x)
+{
+  return x * 11 + FILE;
+}
+
+#if FILE == 1
+
+extern int icf_caller_2(int);
+extern int icf_caller_3(int);
+extern int icf_caller_4(int);
+extern int icf_diff_2(int);
+extern int icf_diff_3(int);
+extern int icf_diff_4(int);
+
+int
+main(void)
+{
+  int (*volatile caller[4])(int) =
+    { icf_caller_1, icf_caller_2, icf_caller_3, icf_caller_4 };
+  int (*volatile diff[4])(int) =
+    { icf_diff_1, icf_diff_2, icf_diff_3, icf_diff_4 };
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (caller[i](i) != ((i + 1) * 7 + 3) * 5)
+	return 1;
+      if (diff[i](i) != i * 11 + i + 1)
+	return 1;
+    }
+  return 0;
+}
+
+#endif
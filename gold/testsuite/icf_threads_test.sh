@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# icf_threads_test.sh -- test parallel identical code folding
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The checksums of the sections are computed in parallel when using
+# threads.  Check that linking with several threads folds the same
+# sections as a single-threaded link.
+
+if ! cmp -s icf_threads_test_1 icf_threads_test_2; then
+  echo "icf_threads_test_1 and icf_threads_test_2 differ"
+  exit 1
+fi
+
+exit 0
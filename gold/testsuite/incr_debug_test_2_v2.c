@@ -0,0 +1,36 @@
+// incr_debug_test_2_v2.c -- test incremental update with growing debug info
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This version has much more debug information than the first, so
+// that .debug_info runs out of patch space and has to be moved.
+
+#define M10(p) int p##0, p##1, p##2, p##3, p##4, p##5, p##6, p##7, p##8, p##9;
+#define M100(p) M10(p##0) M10(p##1) M10(p##2) M10(p##3) M10(p##4) \
+		M10(p##5) M10(p##6) M10(p##7) M10(p##8) M10(p##9)
+
+struct big { M100(a) M100(b) M100(c) };
+
+int
+t2(void)
+{
+  struct big* p = 0;
+  return p == 0 ? 2 : 0;
+}
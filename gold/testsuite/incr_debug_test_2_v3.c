@@ -0,0 +1,31 @@
+// incr_debug_test_2_v3.c -- test incremental update with a new section
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This version adds an allocated section which is not in the base
+// file, so the incremental update has to fall back to a full link.
+
+int t2_data __attribute__ ((section (".incr_debug_test_data"))) = 2;
+
+int
+t2(void)
+{
+  return t2_data;
+}
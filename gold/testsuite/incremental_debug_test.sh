@@ -0,0 +1,55 @@
+#!/bin/sh
+
+# incremental_debug_test.sh -- test incremental update with growing debug info
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT=incremental_debug_test.stdout
+
+# The updated object adds a large structure to .debug_info, which has
+# to be moved.  Check that the debug info of the unchanged object was
+# copied to the new location, and the new debug info is complete.
+
+check $STDOUT "DW_AT_name.*incr_debug_test_1.c"
+check $STDOUT "DW_AT_name.*: main"
+check $STDOUT "DW_AT_name.*incr_debug_test_2_v2.c"
+check $STDOUT "DW_AT_name.*: big"
+check $STDOUT "DW_AT_name.*: a00"
+check $STDOUT "DW_AT_name.*: c99"
+
+# The second update adds an allocated section, which has no room in the
+# segments of the base file.  Check that the linker asks for a full link.
+
+check incremental_debug_test_2.err "section .incr_debug_test_data is not in the base file"
+
+exit 0
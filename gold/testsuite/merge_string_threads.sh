@@ -0,0 +1,80 @@
+#!/bin/sh
+
+# merge_string_threads.sh -- test parallel string merging
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# When using threads, the strings in mergeable string sections are
+# scanned by separate tasks and then added in input order.  Check
+# that this happens for the compressed .debug_str section of
+# merge_string_threads_z.o too, that its strings are merged with
+# those of the uncompressed merge_string_threads_u.o, and that
+# linking with several threads produces the same output as a
+# single-threaded link.
+
+check()
+{
+  if ! grep -q -- "$2" "$1"
+  then
+    echo "Did not find expected output in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+check_count()
+{
+  if test "`grep -c -- "$2" "$1"`" != "$3"
+  then
+    echo "Expected $3 matches in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+check merge_string_threads_z.stdout ' \.debug_str .* MSC '
+check merge_string_threads_u.stdout ' \.debug_str .* MS '
+
+# Each mergeable string section of the input objects, including the
+# compressed .debug_line_str section, which is not decompressed in
+# advance, should have been scanned by a task of its own.
+for f in merge_string_threads_z merge_string_threads_u; do
+  count=`grep -c ' MSC*  ' $f.stdout`
+  check_count merge_string_threads_2.json "\"Merge_string_scan_task $f.o\"" \
+    $count
+  check_count merge_string_threads_2.json "\"Merge_string_add_task $f.o\"" \
+    $count
+done
+
+check_count merge_string_threads_2.stdout '\]  OdrDerived$' 1
+check_count merge_string_threads_2.stdout '\]  unsigned int$' 1
+
+if ! cmp -s merge_string_threads_1.so merge_string_threads_2.so; then
+  echo "merge_string_threads_1.so and merge_string_threads_2.so differ"
+  exit 1
+fi
+
+exit 0
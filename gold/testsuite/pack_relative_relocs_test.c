@@ -0,0 +1,76 @@
+/* pack_relative_relocs_test.c -- test -z pack-relative-relocs for gold
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* When linked as a PIE, each pointer below needs a RELATIVE dynamic
+   reloc.  There are enough of them that gold sorts and writes the
+   .rela.dyn section in several tasks when using threads.  With -z
+   pack-relative-relocs, the dense array is packed into bitmaps, and
+   the sparse array into address entries.  Check that the dynamic
+   linker relocates all of them.  */
+
+#define COUNT 70000
+
+static int x[COUNT];
+
+#define P1(i) &x[i]
+#define P4(i) P1(i), P1((i) + 1), P1((i) + 2), P1((i) + 3)
+#define P16(i) P4(i), P4((i) + 4), P4((i) + 8), P4((i) + 12)
+#define P64(i) P16(i), P16((i) + 16), P16((i) + 32), P16((i) + 48)
+#define P256(i) P64(i), P64((i) + 64), P64((i) + 128), P64((i) + 192)
+#define P1024(i) P256(i), P256((i) + 256), P256((i) + 512), P256((i) + 768)
+#define P4096(i) \
+  P1024(i), P1024((i) + 1024), P1024((i) + 2048), P1024((i) + 3072)
+#define P16384(i) \
+  P4096(i), P4096((i) + 4096), P4096((i) + 8192), P4096((i) + 12288)
+
+int* dense[COUNT] =
+{
+  P16384(0), P16384(16384), P16384(32768), P16384(49152),
+  P4096(65536), P256(69632), P64(69888), P16(69952), P16(69968),
+  P16(69984)
+};
+
+struct sparse
+{
+  int* p;
+  long pad[99];
+};
+
+struct sparse sparse[] =
+{
+  { &x[1] }, { &x[10] }, { &x[100] }, { &x[1000] }, { &x[10000] }
+};
+
+static int sparse_index[] = { 1, 10, 100, 1000, 10000 };
+
+int
+main(void)
+{
+  int i;
+
+  for (i = 0; i < COUNT; ++i)
+    if (dense[i] != &x[i])
+      return 1;
+  for (i = 0; i < (int) (sizeof sparse / sizeof sparse[0]); ++i)
+    if (sparse[i].p != &x[sparse_index[i]])
+      return 2;
+  return 0;
+}
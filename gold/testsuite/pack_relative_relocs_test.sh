@@ -0,0 +1,76 @@
+#!/bin/sh
+
+# pack_relative_relocs_test.sh -- test -z pack-relative-relocs.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# pack_relative_relocs_test_1 and pack_relative_relocs_test_2 are
+# linked without and with threads.  With threads the dynamic relocs
+# are sorted and written by parallel tasks, which must give the same
+# output.  pack_relative_relocs_test_3 is linked with -z
+# pack-relative-relocs, and must have a .relr.dyn section and the
+# DT_RELR tags instead of the RELATIVE relocs.  All of them must run.
+
+check()
+{
+  if ! grep -q "$2" "$1"
+  then
+    echo "Did not find expected output in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+check_missing()
+{
+  if grep -q "$2" "$1"
+  then
+    echo "Found unexpected output in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+if ! cmp -s pack_relative_relocs_test_1 pack_relative_relocs_test_2; then
+  echo "pack_relative_relocs_test_1 and pack_relative_relocs_test_2 differ"
+  exit 1
+fi
+
+check pack_relative_relocs_test.stdout "\.relr\.dyn  *RELR"
+check pack_relative_relocs_test.stdout "(RELR) "
+check pack_relative_relocs_test.stdout "(RELRSZ) "
+check pack_relative_relocs_test.stdout "(RELRENT) *8 "
+check pack_relative_relocs_test.stdout "Name: GLIBC_ABI_DT_RELR"
+check_missing pack_relative_relocs_test.stdout "(RELACOUNT)"
+
+for p in pack_relative_relocs_test_1 pack_relative_relocs_test_3; do
+  if ! ./$p; then
+    echo "$p failed"
+    exit 1
+  fi
+done
+
+exit 0
@@ -52,6 +52,10 @@ struct sym_info
 static struct claimed_file* first_claimed_file = NULL;
 static struct claimed_file* last_claimed_file = NULL;
 
+/* Protects the list of claimed files if the claim file hook may be
+   called by several threads at once.  */
+static volatile int claimed_file_lock = 0;
+
 static ld_plugin_register_claim_file register_claim_file_hook = NULL;
 static ld_plugin_register_all_symbols_read register_all_symbols_read_hook = NULL;
 static ld_plugin_register_cleanup register_cleanup_hook = NULL;
@@ -70,6 +74,7 @@ static ld_plugin_get_input_section_contents get_input_section_contents = NULL;
 static ld_plugin_update_section_order update_section_order = NULL;
 static ld_plugin_allow_section_ordering allow_section_ordering = NULL;
 static ld_plugin_get_wrap_symbols get_wrap_symbols = NULL;
+static ld_plugin_allow_concurrent_claim_file allow_concurrent_claim_file = NULL;
 
 #define MAXOPTS 10
 
@@ -163,6 +168,10 @@ onload(struct ld_plugin_tv *tv)
 	case LDPT_GET_WRAP_SYMBOLS:
 	  get_wrap_symbols = *entry->tv_u.tv_get_wrap_symbols;
 	  break;
+	case LDPT_ALLOW_CONCURRENT_CLAIM_FILE:
+	  allow_concurrent_claim_file
+	    = *entry->tv_u.tv_allow_concurrent_claim_file;
+	  break;
         default:
           break;
         }
@@ -198,6 +207,19 @@ onload(struct ld_plugin_tv *tv)
   for (i = 0; i < nopts; ++i)
     (*message)(LDPL_INFO, "option: %s", opts[i]);
 
+  for (i = 0; i < nopts; ++i)
+    {
+      if (strcmp(opts[i], "allow_concurrent_claim_file") != 0)
+	continue;
+      if (allow_concurrent_claim_file == NULL
+	  || (*allow_concurrent_claim_file)() != LDPS_OK)
+	{
+	  (*message)(LDPL_ERROR, "error allowing concurrent claim file");
+	  return LDPS_ERR;
+	}
+      (*message)(LDPL_INFO, "allowing concurrent claim file");
+    }
+
   if ((*register_claim_file_hook)(claim_file_hook) != LDPS_OK)
     {
       (*message)(LDPL_ERROR, "error registering claim file hook");
@@ -423,11 +445,14 @@ claim_file_hook (const struct ld_plugin_input_file* file, int* claimed)
   claimed_file->nsyms = nsyms;
   claimed_file->syms = syms;
   claimed_file->next = NULL;
+  while (__sync_lock_test_and_set(&claimed_file_lock, 1))
+    ;
   if (last_claimed_file == NULL)
     first_claimed_file = claimed_file;
   else
     last_claimed_file->next = claimed_file;
   last_claimed_file = claimed_file;
+  __sync_lock_release(&claimed_file_lock);
 
   (*message)(LDPL_INFO, "%s: claiming file, adding %d symbols",
              file->name, nsyms);
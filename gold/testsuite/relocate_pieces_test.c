@@ -0,0 +1,40 @@
+// relocate_pieces_test.c -- test relocating one object in pieces
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This program uses a generated .h file to define 32 arrays of 2000
+// pointers each.  When compiled with -fdata-sections each array has
+// its own reloc section, and together they have enough relocations
+// for gold to split them between several threads with --threads.
+
+#include "relocate_pieces_define.h"
+
+int
+main(void)
+{
+  int i;
+  int j;
+
+  for (i = 0; i < 32; ++i)
+    for (j = 0; j < 2000; ++j)
+      if (all_ptrs[i][j] != &vars[i * 2000 + j])
+	return 1;
+  return 0;
+}
@@ -0,0 +1,68 @@
+#!/bin/sh
+
+# relocate_pieces_test.sh -- test relocating one object in pieces
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# relocate_pieces_test was linked with --threads, which splits the
+# relocations of its one large object between several threads, and
+# relocate_pieces_test_nothreads was linked without.  Check that
+# --stats reports the split, that the two files are the same, and
+# that the program runs.  relocate_pieces_test_final1 was linked with
+# --thread-count-final=1, which leaves no idle thread to take a
+# piece, so the object must not be split.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check relocate_pieces_test.err "split objects: 1; pieces: [1-9]"
+check relocate_pieces_test.err "longest relocate task: .*relocate_pieces_test.o"
+check relocate_pieces_test.err "relocate pass tail time: "
+check relocate_pieces_test_final1.err "split objects: 0; pieces: 0"
+
+if ! cmp -s relocate_pieces_test relocate_pieces_test_nothreads
+then
+    echo "relocate_pieces_test and relocate_pieces_test_nothreads differ"
+    exit 1
+fi
+
+if ! cmp -s relocate_pieces_test_final1 relocate_pieces_test_nothreads
+then
+    echo "relocate_pieces_test_final1 and relocate_pieces_test_nothreads differ"
+    exit 1
+fi
+
+if ! ./relocate_pieces_test
+then
+    echo "relocate_pieces_test failed"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,29 @@
+    .section .sec_a.x,"aw"
+    .byte 0xa1
+
+    .section .sec_a.y,"aw"
+    .byte 0xa2
+
+    .section .sec_b,"aw"
+    .byte 0xb0
+
+    .section .sec_c,"aw"
+    .byte 0xc0
+
+    .section .sec_d,"aw"
+    .byte 0xd0
+
+    .section .sec_e,"aw"
+    .byte 0xe0
+
+    .section .sec_f.1,"aw"
+    .byte 0xf1
+
+    .section .sec_g,"aw"
+    .byte 0x70
+
+    .section .sec_h,"aw"
+    .byte 0x80
+
+    .section .sec_x,"aw"
+    .byte 0xff
@@ -0,0 +1,75 @@
+#!/bin/sh
+
+# script_test_16.sh -- test that the first matching input section spec wins
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+file="script_test_16.stdout"
+
+check()
+{
+    section=$1
+    pattern=$2
+    found=`fgrep "Contents of section $section:" -A1 $file | tail -n 1`
+    if test -z "$found"; then
+        echo "Section \"$section\" not found in file $file"
+        echo ""
+        echo "Actual output below:"
+        cat "$file"
+        exit 1
+    fi
+    match_pattern=`echo "$found" | grep -e "$pattern"`
+    if test -z "$match_pattern"; then
+        echo "Expected pattern was not found in section \"$section\":"
+        echo "    $pattern"
+        echo ""
+        echo "Actual output below:"
+        cat "$file"
+        exit 1
+    fi
+}
+
+check_missing()
+{
+    if fgrep -q "Contents of section $1:" $file; then
+        echo "Section \"$1\" should be empty"
+        echo ""
+        echo "Actual output below:"
+        cat "$file"
+        exit 1
+    fi
+}
+
+# A prefix pattern comes before a literal name.
+check ".out_a" "\<a1a2\b"
+check ".out_b" "\<b0\b"
+# A spec for another file does not match.
+check ".out_c" "\<c0\b"
+# EXCLUDE_FILE is honored, and a later general wildcard matches.
+check ".out_e" "\<d0\b"
+check ".out_f" "\<e0f1\b"
+# A wildcard file name comes before a literal one.
+check ".out_d" "\<70\b"
+check ".out_g" "\<80\b"
+check_missing ".out_h"
+# /DISCARD/ comes first.
+check_missing ".out_x"
+
+exit 0
@@ -0,0 +1,39 @@
+/* script_test_16.t -- test that the first matching input section spec wins.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* gold files the specs in a SECTIONS clause by literal section name,
+   by prefix, and by literal file name.  Each input section must
+   still go to the first output section with a spec which matches it,
+   whichever way the specs are filed.  */
+
+SECTIONS
+{
+    .out_a : { *(.sec_a.*) }
+    .out_b : { *(.sec_a.x) *(.sec_b) }
+    .out_c : { other.o(.sec_c) *(.sec_c) }
+    .out_d : { *(EXCLUDE_FILE(*script_test_16.o) .sec_d) *(.sec_g) }
+    .out_e : { *(.sec_[d]) }
+    .out_f : { *(.sec_e .sec_f*) }
+    .out_g : { script_test_16.o(.sec_g .sec_h) }
+    .out_h : { *(.sec_h) }
+    /DISCARD/ : { *(.sec_x) }
+    .out_x : { *(.sec_x) }
+}
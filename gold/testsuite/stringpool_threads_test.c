@@ -0,0 +1,62 @@
+/* stringpool_threads_test.c -- test adding local symbol names in threads
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* This file is compiled several times with different values of FILE.
+   Each object defines many local symbols, some with names which are
+   the same in every object and some with names which are different.
+   With threads, gold adds the names of the local symbols of several
+   objects to the output string table at once.  */
+
+#define CAT2(a, b) a ## b
+#define CAT(a, b) CAT2(a, b)
+
+#define L1(i) \
+  static int CAT(local_, i) __attribute__ ((used)) = i; \
+  static int CAT(CAT(CAT(file, FILE), _local_), i) __attribute__ ((used)) = i;
+#define L4(i) L1(i) L1(i ## 1) L1(i ## 2) L1(i ## 3)
+#define L16(i) L4(i) L4(i ## 4) L4(i ## 5) L4(i ## 6)
+#define L64(i) L16(i) L16(i ## 7) L16(i ## 8) L16(i ## 9)
+
+L64(1)
+L64(2)
+L64(3)
+L64(4)
+
+#if FILE == 1
+
+extern int f2(void);
+extern int f3(void);
+
+int
+main(void)
+{
+  return f2() + f3();
+}
+
+#else
+
+int
+CAT(f, FILE)(void)
+{
+  return 0;
+}
+
+#endif
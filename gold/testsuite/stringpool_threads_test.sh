@@ -0,0 +1,50 @@
+#!/bin/sh
+
+# stringpool_threads_test.sh -- test adding local symbol names in threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# With threads, gold adds the names of the local symbols of several
+# objects to the output string table at once.  Check that the output
+# is the same as a single-threaded link, and that --stats reports the
+# concurrent adds.
+
+check()
+{
+  if ! grep -q "$2" "$1"
+  then
+    echo "Did not find expected output in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+if ! cmp -s stringpool_threads_test_1 stringpool_threads_test_2; then
+  echo "stringpool_threads_test_1 and stringpool_threads_test_2 differ"
+  exit 1
+fi
+
+check stringpool_threads_test_2.stats \
+  ": output symbol name pool concurrent adds: [1-9][0-9]*; lock waits: "
+
+exit 0
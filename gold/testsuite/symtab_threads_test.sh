@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# symtab_threads_test.sh -- test the symbol table built with --threads.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# When using threads, the global symbol names of each object are split
+# at the version and hashed by the Read_symbols tasks, which run in
+# parallel.  Check that the symbol tables of the link with threads
+# are resolved and versioned as expected, and that they and the
+# output file are the same as without threads.
+
+check_count()
+{
+  if test "`grep -c -- "$2" "$1"`" != "$3"
+  then
+    echo "Expected $3 matches in $1:"
+    echo "   $2"
+    echo ""
+    echo "Actual output below:"
+    cat "$1"
+    exit 1
+  fi
+}
+
+for f in symtab_threads_test_1.stdout symtab_threads_test_2.stdout; do
+  # readelf shows the versions of the symbols in .dynsym.
+  check_count $f ' GLOBAL DEFAULT .* sym1_[0-9]*@@VER_1$' 5000
+  check_count $f ' GLOBAL DEFAULT .* sym2_[0-9]*@@VER_2$' 5000
+  # The strong definitions of dup_N override the weak ones.
+  check_count $f ' GLOBAL DEFAULT .* dup_[0-9]*@@VER_2$' 5000
+  check_count $f ' WEAK .* dup_[0-9]*' 0
+  check_count $f ' FUNC .* ver_[0-9]*@VER_1$' 5000
+  check_count $f ' FUNC .* ver_[0-9]*@@VER_2$' 5000
+done
+
+if ! cmp -s symtab_threads_test_1.stdout symtab_threads_test_2.stdout; then
+  echo "symtab_threads_test_1.stdout and symtab_threads_test_2.stdout differ"
+  exit 1
+fi
+
+if ! cmp -s symtab_threads_test_1.so symtab_threads_test_2.so; then
+  echo "symtab_threads_test_1.so and symtab_threads_test_2.so differ"
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# trace_file_test.sh -- test --trace-file
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# trace_file_test was linked with --threads and --trace-file.  Check
+# that the trace has an event for the tasks we expect, names the
+# threads, and records what each task waited for.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check trace_file_test.json '^{"traceEvents":\['
+check trace_file_test.json '"ph":"X"'
+check trace_file_test.json '"name":"Relocate_task two_file_test_1.o"'
+check trace_file_test.json '"name":"thread_name"'
+check trace_file_test.json '"unblocked_by":'
+check trace_file_test.json '"waited_for":"blocker '
+
+if ! ./trace_file_test
+then
+    echo "trace_file_test failed"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,39 @@
+// ver_test_15.cc -- a test case for version script glob patterns
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The version script ver_test_15.script has several glob patterns
+// with overlapping literal prefixes.
+
+extern "C"
+{
+int abc_1() { return 1; }
+int abcd_2() { return 2; }
+int abq_3() { return 3; }
+int xyz_4() { return 4; }
+int other_5() { return 5; }
+}
+
+namespace ns15
+{
+int f(int i) { return i + 6; }
+int g(int i) { return i + 7; }
+int h(int i) { return i + 8; }
+}
@@ -0,0 +1,63 @@
+#!/bin/sh
+
+# ver_test_15.sh -- a test case for version scripts
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# When a symbol matches more than one glob pattern, the pattern which
+# appears later in the script is used.  Link with --threads so that the
+# version script is matched while reading the symbols.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check ver_test_15.syms "V1 *abc_1$"
+check ver_test_15.syms "V2 *abcd_2$"
+check ver_test_15.syms "V1 *abq_3$"
+check_missing ver_test_15.syms "xyz_4"
+check ver_test_15.syms "V2 *other_5$"
+check ver_test_15.syms "V1 *ns15::f(int)$"
+check ver_test_15.syms "V2 *ns15::g(int)$"
+check ver_test_15.syms "V2 *ns15::h(int)$"
+
+exit 0
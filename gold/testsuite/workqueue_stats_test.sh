@@ -0,0 +1,36 @@
+#!/bin/sh
+
+# workqueue_stats_test.sh -- test the workqueue statistics in --stats
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# workqueue_stats_test was linked with --threads and --stats.  Check
+# that the statistics report, for the threads which ran tasks, how
+# many they ran and how long they waited for the workqueue lock and
+# for work.
+
+if ! grep -q "thread [0-9]*: tasks: [1-9][0-9]* lock wait: [0-9]*\.[0-9]* idle: [0-9]*\.[0-9]*$" workqueue_stats_test.err
+then
+    echo "Did not find per-thread statistics in workqueue_stats_test.err:"
+    cat workqueue_stats_test.err
+    exit 1
+fi
+
+exit 0
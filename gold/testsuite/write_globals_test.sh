@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# write_globals_test.sh -- test writing the global symbols with --threads.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# write_globals_test.so defines enough global symbols that, with idle
+# threads in the final pass, its .symtab and .dynsym are written in
+# several pieces.  write_globals_test_final1.so was linked with
+# --thread-count-final=1, which leaves no thread to write a piece, and
+# write_globals_test_nothreads.so was linked without --threads.  Check
+# that --stats reports the pieces only when there were threads to run
+# them, and that the three files are the same.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_same()
+{
+    if ! cmp -s "$1" "$2"
+    then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+}
+
+check write_globals_test.err "global symbol write pieces: [1-9]"
+check write_globals_test_final1.err "global symbol write pieces: 0$"
+
+check_same write_globals_test.so write_globals_test_nothreads.so
+check_same write_globals_test_final1.so write_globals_test_nothreads.so
+
+exit 0
@@ -23,13 +23,19 @@
 #include "gold.h"
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #ifdef HAVE_TIMES
 #include <sys/times.h>
 #endif
 
+#ifdef HAVE_GETRUSAGE
+#include <sys/resource.h>
+#endif
+
 #include "libiberty.h"
 
+#include "gold-threads.h"
 #include "timer.h"
 
 namespace gold
@@ -37,11 +43,19 @@ namespace gold
 
 // Class Timer
 
+// The total time in microseconds spent waiting for reads from input
+// files, and a lock to protect it.
+static uint64_t io_wait_usec;
+static Lock* io_wait_lock = NULL;
+static Initialize_lock io_wait_initialize_lock(&io_wait_lock);
+
 Timer::Timer()
 {
   this->start_time_.wall = 0;
   this->start_time_.user = 0;
   this->start_time_.sys = 0;
+  this->start_time_.io_wait = 0;
+  this->start_time_.major_faults = 0;
 }
 
 // Start counting the time.
@@ -102,6 +116,62 @@ Timer::get_time(TimeStats *now)
   now->user = 0;
   now->sys = 0;
 #endif
+
+  io_wait_initialize_lock.initialize();
+  {
+    Hold_optional_lock hl(io_wait_lock);
+    now->io_wait = io_wait_usec / 1000;
+  }
+
+#ifdef HAVE_GETRUSAGE
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == 0)
+    now->major_faults = ru.ru_majflt;
+  else
+    now->major_faults = 0;
+#else
+  now->major_faults = 0;
+#endif
+}
+
+// Return the current wall clock time in microseconds.
+
+uint64_t
+Timer::wall_time_usec()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (static_cast<uint64_t>(tv.tv_sec) * 1000000
+	  + static_cast<uint64_t>(tv.tv_usec));
+}
+
+// Record time spent waiting for a read from an input file.
+
+void
+Timer::add_io_wait(uint64_t usec)
+{
+  io_wait_initialize_lock.initialize();
+  Hold_optional_lock hl(io_wait_lock);
+  io_wait_usec += usec;
+}
+
+// Return the I/O done by the calling thread.  ru_inblock counts
+// 512-byte blocks.
+
+void
+Timer::thread_io(uint64_t* input_bytes, long* major_faults)
+{
+#if defined(HAVE_GETRUSAGE) && defined(RUSAGE_THREAD)
+  struct rusage ru;
+  if (getrusage(RUSAGE_THREAD, &ru) == 0)
+    {
+      *input_bytes = static_cast<uint64_t>(ru.ru_inblock) * 512;
+      *major_faults = ru.ru_majflt;
+      return;
+    }
+#endif
+  *input_bytes = 0;
+  *major_faults = 0;
 }
 
 // Return the stats since start was called.
@@ -114,6 +184,8 @@ Timer::get_elapsed_time()
   delta.wall = now.wall - this->start_time_.wall;
   delta.user = now.user - this->start_time_.user;
   delta.sys = now.sys - this->start_time_.sys;
+  delta.io_wait = now.io_wait - this->start_time_.io_wait;
+  delta.major_faults = now.major_faults - this->start_time_.major_faults;
   return delta;
 }
 
@@ -127,6 +199,8 @@ Timer::get_pass_time(int n)
   thispass.wall -= lastpass.wall;
   thispass.user -= lastpass.user;
   thispass.sys -= lastpass.sys;
+  thispass.io_wait -= lastpass.io_wait;
+  thispass.major_faults -= lastpass.major_faults;
   return thispass;
 }
 
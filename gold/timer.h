@@ -40,6 +40,12 @@ class Timer
 
     /* Wall clock time.  */
     long wall;
+
+    /* Time spent waiting for reads from input files.  */
+    long io_wait;
+
+    /* Page faults which required reading from a file.  */
+    long major_faults;
   };
 
   Timer();
@@ -60,6 +66,24 @@ class Timer
   void
   stamp(int n);
 
+  // Return the current wall clock time in microseconds.  This has a
+  // finer resolution than the times in TimeStats, and is used to
+  // measure short intervals.
+  static uint64_t
+  wall_time_usec();
+
+  // Record USEC microseconds spent waiting for a read from an input
+  // file.  This may be called from any thread.
+  static void
+  add_io_wait(uint64_t usec);
+
+  // Set *INPUT_BYTES to the number of bytes which the calling thread
+  // has read from disk, and *MAJOR_FAULTS to the number of its page
+  // faults which required a read.  Both are set to zero if the system
+  // does not count them for each thread.
+  static void
+  thread_io(uint64_t* input_bytes, long* major_faults);
+
  private:
   // This class cannot be copied.
   Timer(const Timer&);
@@ -54,6 +54,10 @@ class Workqueue_threader
   virtual void
   set_thread_count(int) = 0;
 
+  // Return the number of threads we want to have running.
+  virtual int
+  thread_count() = 0;
+
   // Return whether to cancel the current thread.
   virtual bool
   should_cancel_thread(int thread_number) = 0;
@@ -82,6 +86,10 @@ class Workqueue_threader_threadpool : public Workqueue_threader
   void
   set_thread_count(int);
 
+  // Return the thread count.
+  int
+  thread_count();
+
   // Return whether to cancel a thread.
   bool
   should_cancel_thread(int thread_number);
@@ -171,6 +171,15 @@ Workqueue_threader_threadpool::set_thread_count(int thread_count)
     }
 }
 
+// Return the thread count.
+
+int
+Workqueue_threader_threadpool::thread_count()
+{
+  Hold_lock hl(this->lock_);
+  return this->desired_thread_count_;
+}
+
 // Return whether the current thread should be cancelled.
 
 bool
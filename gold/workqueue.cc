@@ -22,8 +22,14 @@
 
 #include "gold.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
 #include "debug.h"
 #include "options.h"
+#include "parameters.h"
 #include "timer.h"
 #include "workqueue.h"
 #include "workqueue-internal.h"
@@ -109,6 +115,10 @@ class Workqueue_threader_single : public Workqueue_threader
   set_thread_count(int thread_count)
   { gold_assert(thread_count > 0); }
 
+  int
+  thread_count()
+  { return 1; }
+
   bool
   should_cancel_thread(int)
   { return false; }
@@ -123,8 +133,16 @@ Workqueue::Workqueue(const General_options& options)
     running_(0),
     waiting_(0),
     condvar_(this->lock_),
+    gather_stats_(options.stats()),
+    thread_stats_(),
+    tracing_(options.trace_file() != NULL),
+    trace_start_usec_(0),
+    trace_events_(),
     threader_(NULL)
 {
+  if (this->tracing_)
+    this->trace_start_usec_ = Timer::wall_time_usec();
+
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
   threads = false;
@@ -139,10 +157,43 @@ Workqueue::Workqueue(const General_options& options)
       gold_unreachable();
 #endif
     }
+
+  Parallel_job::set_workqueue(this);
 }
 
 Workqueue::~Workqueue()
 {
+  Parallel_job::set_workqueue(NULL);
+}
+
+// Acquire the Workqueue lock.  When gathering statistics, record how
+// long THREAD_NUMBER waited for it.
+
+void
+Workqueue::acquire_lock(int thread_number)
+{
+  if (!this->gather_stats_)
+    {
+      this->lock_.acquire();
+      return;
+    }
+
+  uint64_t start = Timer::wall_time_usec();
+  this->lock_.acquire();
+  this->thread_stats(thread_number).lock_wait_usec +=
+    Timer::wall_time_usec() - start;
+}
+
+// Return the statistics for THREAD_NUMBER.  The Workqueue lock must
+// be held.
+
+Workqueue::Thread_stats&
+Workqueue::thread_stats(int thread_number)
+{
+  gold_assert(thread_number >= 0);
+  if (static_cast<size_t>(thread_number) >= this->thread_stats_.size())
+    this->thread_stats_.resize(thread_number + 1);
+  return this->thread_stats_[thread_number];
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -153,9 +204,13 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 {
   Hold_lock hl(this->lock_);
 
+  if (this->tracing_ && t->trace_info().queued_usec == 0)
+    t->trace_info().queued_usec = Timer::wall_time_usec();
+
   Task_token* token = t->is_runnable();
   if (token != NULL)
     {
+      this->trace_wait(t, token);
       if (front)
 	token->add_waiting_front(t);
       else
@@ -222,6 +277,7 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
       if (token == NULL)
 	return t;
 
+      this->trace_wait(t, token);
       token->add_waiting(t);
       ++this->waiting_;
     }
@@ -267,11 +323,7 @@ Workqueue::find_runnable_or_wait(int thread_number)
       if (this->should_cancel_thread(thread_number))
 	return NULL;
 
-      gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
-
-      this->condvar_.wait();
-
-      gold_debug(DEBUG_TASK, "%3d awake", thread_number);
+      this->wait_for_task(thread_number);
 
       t = this->find_runnable();
     }
@@ -279,6 +331,27 @@ Workqueue::find_runnable_or_wait(int thread_number)
   return t;
 }
 
+// Wait for a task to be queued.  The workqueue lock must be held
+// when this is called.
+
+void
+Workqueue::wait_for_task(int thread_number)
+{
+  gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
+
+  if (!this->gather_stats_)
+    this->condvar_.wait();
+  else
+    {
+      uint64_t start = Timer::wall_time_usec();
+      this->condvar_.wait();
+      this->thread_stats(thread_number).idle_usec +=
+	Timer::wall_time_usec() - start;
+    }
+
+  gold_debug(DEBUG_TASK, "%3d awake", thread_number);
+}
+
 // Find and run tasks.  If we can't find a runnable task, wait for one
 // to become available.  If we run a task, and it frees up another
 // runnable task, then run that one too.  This returns true if we
@@ -292,7 +365,7 @@ Workqueue::find_and_run_task(int thread_number)
   Task_locker tl;
 
   {
-    Hold_lock hl(this->lock_);
+    Hold_workqueue_lock hl(this, thread_number);
 
     // Find a runnable task.
     t = this->find_runnable_or_wait(thread_number);
@@ -316,8 +389,27 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      Trace_event event;
+      if (this->tracing_)
+	{
+	  event.name = t->name();
+	  event.thread_number = thread_number;
+	  Timer::thread_io(&event.input_bytes, &event.major_faults);
+	  event.start_usec = Timer::wall_time_usec();
+	}
+
       t->run(this);
 
+      if (this->tracing_)
+	{
+	  event.end_usec = Timer::wall_time_usec();
+	  uint64_t input_bytes;
+	  long major_faults;
+	  Timer::thread_io(&input_bytes, &major_faults);
+	  event.input_bytes = input_bytes - event.input_bytes;
+	  event.major_faults = major_faults - event.major_faults;
+	}
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -333,9 +425,18 @@ Workqueue::find_and_run_task(int thread_number)
 
       Task* next;
       {
-	Hold_lock hl(this->lock_);
+	Hold_workqueue_lock hl(this, thread_number);
 
 	--this->running_;
+	if (this->gather_stats_)
+	  ++this->thread_stats(thread_number).tasks;
+
+	if (this->tracing_)
+	  {
+	    t->trace_info().id = this->trace_events_.size() + 1;
+	    event.info = t->trace_info();
+	    this->trace_events_.push_back(event);
+	  }
 
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
@@ -400,6 +501,7 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 
   if (token != NULL)
     {
+      this->trace_wait(t, token);
       token->add_waiting(t);
       ++this->waiting_;
       return false;
@@ -439,13 +541,14 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 }
 
 // Release the locks associated with a Task.  Return the first
-// runnable Task that we find.  If we find more runnable tasks, add
-// them to the run queue and signal any other threads.  This must be
-// called with the Workqueue lock held.
+// runnable Task that we find.  If we find more
+// runnable tasks, add them to the run queue and signal any other
+// threads.  This must be called with the Workqueue lock held.
 
 Task*
 Workqueue::release_locks(Task* t, Task_locker* tl)
 {
+  unsigned int trace_id = t->trace_info().id;
   Task* ret = NULL;
   for (Task_locker::iterator p = tl->begin(); p != tl->end(); ++p)
     {
@@ -460,6 +563,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	      while ((t = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
+		  t->trace_info().unblocked_by = trace_id;
 		  this->return_or_queue(t, true, &ret);
 		}
 	    }
@@ -477,6 +581,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  while ((t = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
+	      t->trace_info().unblocked_by = trace_id;
 	      if (this->return_or_queue(t, false, &ret))
 		break;
 	    }
@@ -509,6 +614,16 @@ Workqueue::set_thread_count(int threads)
   this->condvar_.broadcast();
 }
 
+// Return the number of threads wanted for the current pass which are
+// not running a Task.
+
+int
+Workqueue::idle_thread_count()
+{
+  Hold_lock hl(this->lock_);
+  return std::max(this->threader_->thread_count() - this->running_, 0);
+}
+
 // Add a new blocker to an existing Task_token.
 
 void
@@ -518,4 +633,309 @@ Workqueue::add_blocker(Task_token* token)
   token->add_blocker();
 }
 
+// Print scheduling statistics to stderr.  This is used for --stats.
+
+void
+Workqueue::print_stats()
+{
+  Hold_lock hl(this->lock_);
+
+  for (size_t i = 0; i < this->thread_stats_.size(); ++i)
+    {
+      const Thread_stats& ts(this->thread_stats_[i]);
+      if (ts.tasks == 0 && ts.lock_wait_usec == 0 && ts.idle_usec == 0)
+	continue;
+      fprintf(stderr,
+	      _("%s: thread %u: tasks: %llu "
+		"lock wait: %llu.%06llu idle: %llu.%06llu\n"),
+	      program_name, static_cast<unsigned int>(i),
+	      static_cast<unsigned long long>(ts.tasks),
+	      static_cast<unsigned long long>(ts.lock_wait_usec / 1000000),
+	      static_cast<unsigned long long>(ts.lock_wait_usec % 1000000),
+	      static_cast<unsigned long long>(ts.idle_usec / 1000000),
+	      static_cast<unsigned long long>(ts.idle_usec % 1000000));
+    }
+}
+
+// Write S to F as a JSON string.
+
+static void
+write_trace_string(FILE* f, const char* s)
+{
+  putc('"', f);
+  for (; *s != '\0'; ++s)
+    {
+      unsigned char c = *s;
+      if (c == '"' || c == '\\')
+	{
+	  putc('\\', f);
+	  putc(c, f);
+	}
+      else if (c < 0x20)
+	fprintf(f, "\\u%04x", c);
+      else
+	putc(c, f);
+    }
+  putc('"', f);
+}
+
+// Write the trace for --trace-file.  Each Task is a complete ("X")
+// event on the row for the thread which ran it, with its category
+// taken from the first word of its name.  The arguments record when
+// it was queued, the Token it last waited for, and the Task which
+// released that Token, which is also drawn as a flow arrow.  Times
+// are in microseconds from when the Workqueue was created.
+
+void
+Workqueue::write_trace(const char* filename)
+{
+  FILE* f = fopen(filename, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open trace file %s: %s"), filename,
+		 strerror(errno));
+      return;
+    }
+
+  Hold_lock hl(this->lock_);
+
+  const uint64_t base = this->trace_start_usec_;
+
+  fprintf(f, "{\"traceEvents\":[\n");
+  fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+	  "\"tid\":0,\"args\":{\"name\":");
+  write_trace_string(f, program_name);
+  fprintf(f, "}}");
+
+  std::vector<bool> seen_threads;
+  for (std::vector<Trace_event>::const_iterator p =
+	 this->trace_events_.begin();
+       p != this->trace_events_.end();
+       ++p)
+    {
+      if (static_cast<size_t>(p->thread_number) >= seen_threads.size())
+	seen_threads.resize(p->thread_number + 1);
+      if (!seen_threads[p->thread_number])
+	{
+	  seen_threads[p->thread_number] = true;
+	  fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\","
+		  "\"pid\":1,\"tid\":%d,\"args\":{\"name\":"
+		  "\"thread %d\"}}",
+		  p->thread_number, p->thread_number);
+	}
+
+      size_t len = p->name.find(' ');
+      std::string category(p->name, 0, len);
+
+      fprintf(f, ",\n{\"name\":");
+      write_trace_string(f, p->name.c_str());
+      fprintf(f, ",\"cat\":");
+      write_trace_string(f, category.c_str());
+      fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+	      "\"ts\":%llu,\"dur\":%llu,\"args\":{\"id\":%u",
+	      p->thread_number,
+	      static_cast<unsigned long long>(p->start_usec - base),
+	      static_cast<unsigned long long>(p->end_usec - p->start_usec),
+	      p->info.id);
+      if (p->info.queued_usec >= base && p->info.queued_usec <= p->start_usec)
+	fprintf(f, ",\"queued\":%llu,\"wait\":%llu",
+		static_cast<unsigned long long>(p->info.queued_usec - base),
+		static_cast<unsigned long long>(p->start_usec
+						- p->info.queued_usec));
+      if (p->info.token != NULL)
+	fprintf(f, ",\"waited_for\":\"%s %p\"",
+		p->info.token_is_blocker ? "blocker" : "lock",
+		static_cast<const void*>(p->info.token));
+      if (p->info.unblocked_by != 0)
+	fprintf(f, ",\"unblocked_by\":%u", p->info.unblocked_by);
+      fprintf(f, ",\"input_bytes\":%llu,\"major_faults\":%ld}}",
+	      static_cast<unsigned long long>(p->input_bytes),
+	      p->major_faults);
+
+      if (p->info.unblocked_by != 0
+	  && p->info.unblocked_by <= this->trace_events_.size())
+	{
+	  const Trace_event& from(this->trace_events_[p->info.unblocked_by
+						      - 1]);
+	  uint64_t from_usec = std::min(from.end_usec, p->start_usec);
+	  fprintf(f, ",\n{\"name\":\"unblock\",\"cat\":\"unblock\","
+		  "\"ph\":\"s\",\"id\":%u,\"pid\":1,\"tid\":%d,"
+		  "\"ts\":%llu}",
+		  p->info.id, from.thread_number,
+		  static_cast<unsigned long long>(from_usec - base));
+	  fprintf(f, ",\n{\"name\":\"unblock\",\"cat\":\"unblock\","
+		  "\"ph\":\"f\",\"bp\":\"e\",\"id\":%u,\"pid\":1,"
+		  "\"tid\":%d,\"ts\":%llu}",
+		  p->info.id, p->thread_number,
+		  static_cast<unsigned long long>(p->start_usec - base));
+	}
+    }
+
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+  if (fclose(f) != 0)
+    gold_error(_("cannot write trace file %s: %s"), filename,
+	       strerror(errno));
+}
+
+// Class Parallel_job.
+
+Workqueue* Parallel_job::workqueue_;
+
+// The pieces of a Parallel_job which is running.  This is shared by
+// the calling thread and the helper Tasks, and is deleted by
+// whichever finishes with it last, since a helper Task may not start
+// running until after Parallel_job::run has returned.
+
+class Parallel_job_pieces
+{
+ public:
+  Parallel_job_pieces(Parallel_job* job, unsigned int count,
+		      unsigned int refs)
+    : lock_(), condvar_(this->lock_), job_(job), next_(0), count_(count),
+      active_(0), refs_(refs)
+  { }
+
+  // Run pieces until there are none left.
+  void
+  run_pieces();
+
+  // Wait until the pieces taken by other threads are done.  This is
+  // called after run_pieces, so every piece has been taken.
+  void
+  wait();
+
+  // Drop a reference.  Return true if this was the last one, in
+  // which case the caller should delete this.
+  bool
+  release();
+
+ private:
+  Parallel_job_pieces(const Parallel_job_pieces&);
+  Parallel_job_pieces& operator=(const Parallel_job_pieces&);
+
+  // Controls access to the remaining members.
+  Lock lock_;
+  // Signalled when the last running piece is done.
+  Condvar condvar_;
+  // The job.  This is only used while there are pieces left to run,
+  // and the calling thread does not return until they are done.
+  Parallel_job* job_;
+  // The next piece to run.
+  unsigned int next_;
+  // The number of pieces.
+  unsigned int count_;
+  // The number of pieces which are running.
+  unsigned int active_;
+  // The number of threads and Tasks which refer to this.
+  unsigned int refs_;
+};
+
+void
+Parallel_job_pieces::run_pieces()
+{
+  this->lock_.acquire();
+  while (this->next_ < this->count_)
+    {
+      unsigned int index = this->next_;
+      ++this->next_;
+      ++this->active_;
+      this->lock_.release();
+
+      this->job_->run_piece(index);
+
+      this->lock_.acquire();
+      --this->active_;
+    }
+  if (this->active_ == 0)
+    this->condvar_.broadcast();
+  this->lock_.release();
+}
+
+void
+Parallel_job_pieces::wait()
+{
+  Hold_lock hl(this->lock_);
+  while (this->active_ > 0)
+    this->condvar_.wait();
+}
+
+bool
+Parallel_job_pieces::release()
+{
+  Hold_lock hl(this->lock_);
+  gold_assert(this->refs_ > 0);
+  --this->refs_;
+  return this->refs_ == 0;
+}
+
+// A Task which helps to run the pieces of a Parallel_job.  If it
+// does not start until all the pieces have been taken, it does
+// nothing.
+
+class Parallel_job_task : public Task
+{
+ public:
+  Parallel_job_task(Parallel_job_pieces* pieces)
+    : pieces_(pieces)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->pieces_->run_pieces();
+    if (this->pieces_->release())
+      delete this->pieces_;
+  }
+
+  std::string
+  get_name() const
+  { return "Parallel_job_task"; }
+
+ private:
+  Parallel_job_pieces* pieces_;
+};
+
+// Return the number of threads to use.
+
+unsigned int
+Parallel_job::thread_count()
+{
+  if (!parameters->options().threads() || Parallel_job::workqueue_ == NULL)
+    return 1;
+  return Parallel_job::workqueue_->idle_thread_count() + 1;
+}
+
+// Run all the pieces.
+
+void
+Parallel_job::run(unsigned int count)
+{
+  unsigned int thread_count = std::min(Parallel_job::thread_count(), count);
+  if (thread_count <= 1)
+    {
+      for (unsigned int i = 0; i < count; ++i)
+	this->run_piece(i);
+      return;
+    }
+
+  Parallel_job_pieces* pieces = new Parallel_job_pieces(this, count,
+							thread_count);
+  for (unsigned int i = 1; i < thread_count; ++i)
+    Parallel_job::workqueue_->queue_soon(new Parallel_job_task(pieces));
+
+  pieces->run_pieces();
+  pieces->wait();
+  if (pieces->release())
+    delete pieces;
+}
+
 } // End namespace gold.
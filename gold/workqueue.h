@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -45,7 +46,7 @@ class Task
 {
  public:
   Task()
-    : list_next_(NULL), name_(), should_run_soon_(false)
+    : list_next_(NULL), name_(), should_run_soon_(false), trace_info_()
   { }
   virtual ~Task()
   { }
@@ -106,6 +107,34 @@ class Task
     return this->name_;
   }
 
+  // Scheduling information recorded by the Workqueue for
+  // --trace-file.  This is only used with the workqueue lock held.
+  struct Trace_info
+  {
+    Trace_info()
+      : id(0), unblocked_by(0), token(NULL), token_is_blocker(false),
+	queued_usec(0)
+    { }
+
+    // The number of the trace event for this Task once it has run,
+    // counting from 1.
+    unsigned int id;
+    // The ID of the Task which last released a Token this Task was
+    // waiting for, or 0.
+    unsigned int unblocked_by;
+    // The Token this Task last waited for, or NULL.  This is only
+    // used to identify the Token; it may have been deleted.
+    const Task_token* token;
+    // Whether TOKEN is a blocker rather than a lock.
+    bool token_is_blocker;
+    // When the Task was first queued.
+    uint64_t queued_usec;
+  };
+
+  Trace_info&
+  trace_info()
+  { return this->trace_info_; }
+
  protected:
   // Get the name of the task.  This must be implemented by the child
   // class.
@@ -127,6 +156,8 @@ class Task
   // Whether this Task should be executed soon.  This is used for
   // Tasks which can be run after some data is read.
   bool should_run_soon_;
+  // Information for --trace-file.
+  Trace_info trace_info_;
 };
 
 // An interface for Task_function.  This is a convenience class to run
@@ -227,17 +258,96 @@ class Workqueue
   void
   set_thread_count(int);
 
+  // Return the number of threads wanted for the current pass which
+  // are not running a Task.  This is used by Parallel_job.
+  int
+  idle_thread_count();
+
   // Add a new blocker to an existing Task_token. This must be done
   // with the workqueue lock held.  This should not be done routinely,
   // only in special circumstances.
   void
   add_blocker(Task_token*);
 
+  // Print scheduling statistics to stderr.  This is used for --stats.
+  void
+  print_stats();
+
+  // Write the tasks which have run to FILENAME as a timeline in the
+  // Chrome trace event format.  This is used for --trace-file.
+  void
+  write_trace(const char* filename);
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
   Workqueue& operator=(const Workqueue&);
 
+  // Scheduling statistics for a single thread, used for --stats.
+  struct Thread_stats
+  {
+    Thread_stats()
+      : tasks(0), lock_wait_usec(0), idle_usec(0)
+    { }
+
+    // Number of tasks run by this thread.
+    uint64_t tasks;
+    // Time spent waiting to acquire the Workqueue lock.
+    uint64_t lock_wait_usec;
+    // Time spent waiting for a runnable task.
+    uint64_t idle_usec;
+  };
+
+  // A Task which has run, recorded for --trace-file.
+  struct Trace_event
+  {
+    Trace_event()
+      : name(), thread_number(0), info(), start_usec(0), end_usec(0),
+	input_bytes(0), major_faults(0)
+    { }
+
+    // The name of the Task.
+    std::string name;
+    // The thread which ran it.
+    int thread_number;
+    // Scheduling information from the Task.
+    Task::Trace_info info;
+    // When the Task started and finished running.
+    uint64_t start_usec;
+    uint64_t end_usec;
+    // The bytes read from disk and major page faults while it ran.
+    uint64_t input_bytes;
+    long major_faults;
+  };
+
+  // RAII class to hold the Workqueue lock, recording the time spent
+  // waiting for it when gathering statistics.
+  class Hold_workqueue_lock
+  {
+   public:
+    Hold_workqueue_lock(Workqueue* workqueue, int thread_number)
+      : workqueue_(workqueue)
+    { workqueue->acquire_lock(thread_number); }
+
+    ~Hold_workqueue_lock()
+    { this->workqueue_->lock_.release(); }
+
+   private:
+    Hold_workqueue_lock(const Hold_workqueue_lock&);
+    Hold_workqueue_lock& operator=(const Hold_workqueue_lock&);
+
+    Workqueue* workqueue_;
+  };
+
+  // Acquire the Workqueue lock on behalf of THREAD_NUMBER.
+  void
+  acquire_lock(int thread_number);
+
+  // Return the statistics for THREAD_NUMBER.  The Workqueue lock
+  // must be held.
+  Thread_stats&
+  thread_stats(int thread_number);
+
   // Add a task to a queue.
   void
   add_to_queue(Task_list* queue, Task* t, bool front);
@@ -250,6 +360,10 @@ class Workqueue
   Task*
   find_runnable();
 
+  // Wait for a task to be queued.
+  void
+  wait_for_task(int thread_number);
+
   // Find a runnable task in a list.
   Task*
   find_runnable_in_list(Task_list*);
@@ -270,6 +384,18 @@ class Workqueue
   bool
   should_cancel_thread(int thread_number);
 
+  // Record for --trace-file that T is waiting for TOKEN.  The
+  // Workqueue lock must be held.
+  void
+  trace_wait(Task* t, const Task_token* token)
+  {
+    if (this->tracing_)
+      {
+	t->trace_info().token = token;
+	t->trace_info().token_is_blocker = token->is_blocker();
+      }
+  }
+
   // Master Workqueue lock.  This controls access to the following
   // member variables.
   Lock lock_;
@@ -284,12 +410,73 @@ class Workqueue
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
+  // Whether to gather statistics for --stats.
+  bool gather_stats_;
+  // Statistics indexed by thread number.
+  std::vector<Thread_stats> thread_stats_;
+  // Whether to record the tasks for --trace-file.
+  bool tracing_;
+  // When the Workqueue was created, the start of the timeline.
+  uint64_t trace_start_usec_;
+  // The tasks which have run, in the order in which they finished.
+  std::vector<Trace_event> trace_events_;
 
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
 };
 
+// A job made up of a number of independent pieces, which may be run
+// by several threads at once.  This is for work done inside a single
+// Task, such as in Layout::finalize, which can not be split into
+// separate Tasks because the result is needed before the Task
+// returns.  The pieces are run on the threads of the Workqueue, so a
+// job never uses more threads than the thread count for the current
+// pass.
+
+class Parallel_job
+{
+ public:
+  Parallel_job()
+  { }
+
+  virtual
+  ~Parallel_job()
+  { }
+
+  // Run piece INDEX of the job.  This may be called from any thread.
+  virtual void
+  run_piece(unsigned int index) = 0;
+
+  // Run pieces 0 through COUNT - 1 and return when they are all
+  // done.  This must be called from a running Task.  With --threads
+  // this queues up to thread_count() - 1 helper Tasks, which run
+  // pieces on Workqueue threads which are otherwise idle, and the
+  // calling thread runs pieces too.  Otherwise the pieces are run in
+  // order by the calling thread.
+  void
+  run(unsigned int count);
+
+  // Return the number of threads which run() may use: the calling
+  // thread plus the idle Workqueue threads.  This is for callers
+  // which want to pick the number of pieces.
+  static unsigned int
+  thread_count();
+
+  // Set the Workqueue on which to run the pieces.  This is called
+  // when the Workqueue is created and destroyed.
+  static void
+  set_workqueue(Workqueue* workqueue)
+  { Parallel_job::workqueue_ = workqueue; }
+
+ private:
+  Parallel_job(const Parallel_job&);
+  Parallel_job& operator=(const Parallel_job&);
+
+  // The Workqueue which runs the link.
+  static Workqueue* workqueue_;
+};
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_WORKQUEUE_H)
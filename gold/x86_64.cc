@@ -832,6 +832,13 @@ class Target_x86_64 : public Sized_target<size, false>
   uint64_t
   do_reloc_addend(void* arg, unsigned int r_type, uint64_t addend) const;
 
+  // Return the type of the relative reloc which may be packed into
+  // .relr.dyn.  R_X86_64_64 and GOT entries always hold the link-time
+  // value.  x32 is not supported.
+  unsigned int
+  do_relr_reloc_type() const
+  { return size == 64 ? elfcpp::R_X86_64_RELATIVE : -1U; }
+
   // Return the PLT section.
   uint64_t
   do_plt_address_for_global(const Symbol* gsym) const
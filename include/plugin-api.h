@@ -387,6 +387,15 @@ enum ld_plugin_status
 (*ld_plugin_get_wrap_symbols) (uint64_t *num_symbols,
                                const char ***wrap_symbol_list);
 
+/* The linker's interface for declaring that the plugin's claim-file and
+   new-input handlers may be called by several threads at once, for
+   different input files.  This may only be called from the plugin's
+   onload entry point.  */
+
+typedef
+enum ld_plugin_status
+(*ld_plugin_allow_concurrent_claim_file) (void);
+
 enum ld_plugin_level
 {
   LDPL_INFO,
@@ -431,7 +440,11 @@ enum ld_plugin_tag
   LDPT_GET_INPUT_SECTION_ALIGNMENT = 29,
   LDPT_GET_INPUT_SECTION_SIZE = 30,
   LDPT_REGISTER_NEW_INPUT_HOOK = 31,
-  LDPT_GET_WRAP_SYMBOLS = 32
+  LDPT_GET_WRAP_SYMBOLS = 32,
+  /* Tags 33 to 35 are assigned in the upstream copy of this header,
+     which is kept with GCC, to interfaces which gold does not yet
+     support.  They must not be reused here.  */
+  LDPT_ALLOW_CONCURRENT_CLAIM_FILE = 36
 };
 
 /* The plugin transfer vector.  */
@@ -467,6 +480,7 @@ struct ld_plugin_tv
     ld_plugin_get_input_section_size tv_get_input_section_size;
     ld_plugin_register_new_input tv_register_new_input;
     ld_plugin_get_wrap_symbols tv_get_wrap_symbols;
+    ld_plugin_allow_concurrent_claim_file tv_allow_concurrent_claim_file;
   } tv_u;
 };
 